@@ -91,6 +91,11 @@ namespace dxvk {
       importInfo.buffer = VkBuffer(m_11on12.VulkanHandle);
       importInfo.offset = m_11on12.VulkanOffset;
 
+      // vkd3d-proton creates all buffers with device address
+      // usage, which descriptor buffers need to reference them
+      if (m_parent->GetDXVKDevice()->canUseDescriptorBuffer())
+        info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
       if (m_desc.CPUAccessFlags)
         m_11on12.Resource->Map(0, nullptr, &importInfo.mapPtr);
 
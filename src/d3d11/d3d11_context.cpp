@@ -17,7 +17,7 @@ namespace dxvk {
     m_annotation(GetTypedContext(), Device),
     m_device    (Device),
     m_flags     (ContextFlags),
-    m_staging   (Device, StagingBufferSize),
+    m_staging   (Device),
     m_csFlags   (CsFlags),
     m_csChunk   (AllocCsChunk()),
     m_cmdData   (nullptr) {
@@ -71,8 +71,6 @@ namespace dxvk {
 
     template<typename T> friend class D3D11DeviceContextExt;
     template<typename T> friend class D3D11UserDefinedAnnotation;
-
-    constexpr static VkDeviceSize StagingBufferSize = 4ull << 20;
   public:
     
     D3D11CommonContext(
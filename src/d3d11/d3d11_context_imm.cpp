@@ -978,6 +978,7 @@ namespace dxvk {
     // Notify flush tracker about the flush
     m_flushSeqNum = m_csSeqNum;
     m_flushTracker.notifyFlush(m_flushSeqNum, submissionId);
+    m_flushTracker.notifyGpuStats(m_device->getGpuFlushStats());
 
     // If necessary, block calling thread until the
     // Vulkan queue submission is performed.
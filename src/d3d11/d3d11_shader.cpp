@@ -29,25 +29,41 @@ namespace dxvk {
         std::ios_base::binary | std::ios_base::trunc));
     }
 
-    // Error out if the shader is invalid
-    DxbcModule module(reader);
-    auto programInfo = module.programInfo();
+    // Check whether the shader has been compiled in a previous
+    // session. The D3D11 frontend needs no extra metadata.
+    DxvkShaderCache& shaderCache = pDevice->GetDXVKDevice()->shaderCache();
 
-    if (!programInfo)
-      throw DxvkError("Invalid shader binary.");
+    Sha1Hash cacheKey = GetCacheKey(pShaderKey, pDxbcModuleInfo);
+    std::vector<char> cacheMetadata;
 
-    // Decide whether we need to create a pass-through
-    // geometry shader for vertex shader stream output
-    bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
-      && (programInfo->type() == DxbcProgramType::VertexShader
-       || programInfo->type() == DxbcProgramType::DomainShader);
+    if (shaderCache.isEnabled())
+      m_shader = shaderCache.lookupShader(cacheKey, cacheMetadata);
 
-    if (programInfo->shaderStage() != pShaderKey->type() && !passthroughShader)
-      throw DxvkError("Mismatching shader type.");
+    if (m_shader == nullptr) {
+      // Error out if the shader is invalid
+      DxbcModule module(reader);
+      auto programInfo = module.programInfo();
+
+      if (!programInfo)
+        throw DxvkError("Invalid shader binary.");
+
+      // Decide whether we need to create a pass-through
+      // geometry shader for vertex shader stream output
+      bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
+        && (programInfo->type() == DxbcProgramType::VertexShader
+         || programInfo->type() == DxbcProgramType::DomainShader);
+
+      if (programInfo->shaderStage() != pShaderKey->type() && !passthroughShader)
+        throw DxvkError("Mismatching shader type.");
+
+      m_shader = passthroughShader
+        ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
+        : module.compile                 (*pDxbcModuleInfo, name);
+
+      if (shaderCache.isEnabled())
+        shaderCache.storeShader(cacheKey, m_shader, cacheMetadata);
+    }
 
-    m_shader = passthroughShader
-      ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
-      : module.compile                 (*pDxbcModuleInfo, name);
     m_shader->setShaderKey(*pShaderKey);
     
     if (dumpPath.size() != 0) {
@@ -80,6 +96,35 @@ namespace dxvk {
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
 
+
+  Sha1Hash D3D11CommonShader::GetCacheKey(
+    const DxvkShaderKey*  pShaderKey,
+    const DxbcModuleInfo* pDxbcModuleInfo) {
+    // The shader key already covers the bytecode as well as
+    // stream output declarations, so we only need to add
+    // compiler options. Write options one by one in order
+    // to not depend on struct padding.
+    const DxbcOptions& options = pDxbcModuleInfo->options;
+
+    DxvkShaderCacheWriter writer;
+    writer.write(pShaderKey->type());
+    writer.write(pShaderKey->sha1());
+    writer.write(options.useDepthClipWorkaround);
+    writer.write(options.supportsTypedUavLoadR32);
+    writer.write(options.useSubgroupOpsForAtomicCounters);
+    writer.write(options.zeroInitWorkgroupMemory);
+    writer.write(options.invariantPosition);
+    writer.write(options.forceVolatileTgsmAccess);
+    writer.write(options.disableMsaa);
+    writer.write(options.forceSampleRateShading);
+    writer.write(options.enableSampleShadingInterlock);
+    writer.write(options.floatControl.raw());
+    writer.write(options.minSsboAlignment);
+    writer.write(pDxbcModuleInfo->tess ? pDxbcModuleInfo->tess->maxTessFactor : 0.0f);
+    writer.write(pDxbcModuleInfo->xfb != nullptr);
+    return writer.computeHash();
+  }
+
   
   D3D11ShaderModuleSet:: D3D11ShaderModuleSet() { }
   D3D11ShaderModuleSet::~D3D11ShaderModuleSet() { }
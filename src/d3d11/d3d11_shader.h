@@ -57,6 +57,10 @@ namespace dxvk {
     
     Rc<DxvkShader> m_shader;
     Rc<DxvkBuffer> m_buffer;
+
+    static Sha1Hash GetCacheKey(
+      const DxvkShaderKey*  pShaderKey,
+      const DxbcModuleInfo* pDxbcModuleInfo);
     
   };
 
@@ -298,6 +298,8 @@ namespace dxvk {
     // applications using the semaphore may deadlock. This works because
     // we do not increment the frame ID in those situations.
     SyncFrameLatency();
+
+    m_presenter->latencySleep(m_frameId + 1);
     return hr;
   }
 
@@ -502,6 +504,10 @@ namespace dxvk {
 
     m_presenter = new Presenter(m_device, m_frameLatencySignal, presenterDesc);
     m_presenter->setFrameRateLimit(m_parent->GetOptions()->maxFrameRate);
+
+    // Begin the first frame here, since latencySleep
+    // is otherwise only called after presenting
+    m_presenter->latencySleep(m_frameId + 1);
   }
 
 
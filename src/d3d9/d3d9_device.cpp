@@ -49,7 +49,7 @@ namespace dxvk {
     , m_memoryAllocator ( )
     , m_shaderAllocator ( )
     , m_shaderModules   ( new D3D9ShaderModuleSet )
-    , m_stagingBuffer   ( dxvkDevice, StagingBufferSize )
+    , m_stagingBuffer   ( dxvkDevice )
     , m_d3d9Options     ( dxvkDevice, pParent->GetInstance()->config() )
     , m_multithread     ( BehaviorFlags & D3DCREATE_MULTITHREADED )
     , m_isSWVP          ( (BehaviorFlags & D3DCREATE_SOFTWARE_VERTEXPROCESSING) ? true : false )
@@ -73,6 +73,9 @@ namespace dxvk {
     m_initializer      = new D3D9Initializer(m_dxvkDevice);
     m_converter        = new D3D9FormatHelper(m_dxvkDevice);
 
+    if (m_d3d9Options.ffUbershader)
+      m_ffModules.EnableUberShader(this);
+
     EmitCs([
       cDevice = m_dxvkDevice
     ] (DxvkContext* ctx) {
@@ -195,6 +198,8 @@ namespace dxvk {
     Flush();
     SynchronizeCsThread(DxvkCsThread::SynchronizeAll);
 
+    m_ffModules.StopWorker();
+
     if (m_annotation)
       delete m_annotation;
 
@@ -2392,6 +2397,8 @@ namespace dxvk {
     if (unlikely(ppSB == nullptr || m_recorder == nullptr))
       return D3DERR_INVALIDCALL;
 
+    m_recorder->Compile();
+
     *ppSB = m_recorder.ref();
     if (!m_isD3D8Compatible)
       m_losableResourceCounter++;
@@ -2809,23 +2816,12 @@ namespace dxvk {
         return D3DERR_INVALIDCALL;
     }
 
-    if (!SupportsSWVP()) {
-      static bool s_errorShown = false;
-
-      if (!std::exchange(s_errorShown, true))
-        Logger::err("D3D9DeviceEx::ProcessVertices: SWVP emu unsupported (vertexPipelineStoresAndAtomics)");
-
-      return D3D_OK;
-    }
-
     if (!VertexCount)
       return D3D_OK;
 
     D3D9CommonBuffer* dst  = static_cast<D3D9VertexBuffer*>(pDestBuffer)->GetCommonBuffer();
     D3D9VertexDecl*   decl = static_cast<D3D9VertexDecl*>  (pVertexDecl);
 
-    PrepareDraw(D3DPT_FORCE_DWORD);
-
     if (decl == nullptr) {
       DWORD FVF = dst->Desc()->FVF;
 
@@ -2839,6 +2835,24 @@ namespace dxvk {
         decl = iter->second.ptr();
     }
 
+    // Interpreting the shader on the CPU avoids the GPU round trip,
+    // and is the only option if vertex pipeline stores are missing.
+    if (UseProgrammableVS() && (m_d3d9Options.cpuVertexProcessing || !SupportsSWVP())) {
+      if (ProcessVerticesCpu(SrcStartIndex, DestIndex, VertexCount, dst, decl))
+        return D3D_OK;
+    }
+
+    if (!SupportsSWVP()) {
+      static bool s_errorShown = false;
+
+      if (!std::exchange(s_errorShown, true))
+        Logger::err("D3D9DeviceEx::ProcessVertices: SWVP emu unsupported (vertexPipelineStoresAndAtomics)");
+
+      return D3D_OK;
+    }
+
+    PrepareDraw(D3DPT_FORCE_DWORD);
+
     uint32_t offset = DestIndex * decl->GetSize();
 
     auto slice = dst->GetBufferSlice<D3D9_COMMON_BUFFER_TYPE_REAL>();
@@ -2905,6 +2919,98 @@ namespace dxvk {
   }
 
 
+  bool D3D9DeviceEx::ProcessVerticesCpu(
+          UINT                              SrcStartIndex,
+          UINT                              DestIndex,
+          UINT                              VertexCount,
+          D3D9CommonBuffer*                 pDst,
+          D3D9VertexDecl*                   pDecl) {
+    Rc<DxsoInterpreterProgram> program = m_swvpProcessor.GetProgram(
+      m_dxsoOptions, m_state.vertexShader.ptr());
+
+    if (program == nullptr || m_state.vertexDecl == nullptr)
+      return false;
+
+    // Unlike the GPU path, we write to the destination
+    // directly, so make sure to not overrun the buffer.
+    uint32_t vertexSize = pDecl->GetSize();
+    uint32_t bufferSize = pDst->Desc()->Size;
+    uint32_t offset     = DestIndex * vertexSize;
+
+    if (!vertexSize || offset >= bufferSize)
+      return true;
+
+    VertexCount = std::min(VertexCount, (bufferSize - offset) / vertexSize);
+
+    if (!VertexCount)
+      return true;
+
+    const auto& vsLayout = GetVertexConstantLayout();
+
+    D3D9SWVPProcessInfo info;
+    info.program              = program.ptr();
+    info.constants.floats     = m_state.vsConsts->fConsts;
+    info.constants.floatCount = vsLayout.floatCount;
+    info.constants.ints       = m_state.vsConsts->iConsts;
+    info.constants.intCount   = vsLayout.intCount;
+    info.constants.bools      = m_state.vsConsts->bConsts;
+    info.constants.boolCount  = vsLayout.boolCount;
+    info.inputElements        = &m_state.vertexDecl->GetElements();
+    info.outputElements       = &pDecl->GetElements();
+    info.outputStride         = vertexSize;
+    info.firstVertex          = SrcStartIndex;
+    info.vertexCount          = VertexCount;
+    info.viewport             = m_state.viewport;
+
+    std::array<D3D9CommonBuffer*, caps::MaxStreams> srcBuffers = { };
+
+    for (const auto& element : m_state.vertexDecl->GetElements()) {
+      uint32_t stream = element.Stream;
+
+      if (stream >= caps::MaxStreams || srcBuffers[stream] != nullptr)
+        continue;
+
+      const D3D9VBO& vbo = m_state.vertexBuffers[stream];
+
+      if (vbo.vertexBuffer == nullptr)
+        continue;
+
+      D3D9CommonBuffer* src = vbo.vertexBuffer->GetCommonBuffer();
+
+      if (vbo.offset >= src->Desc()->Size)
+        continue;
+
+      void* data = nullptr;
+
+      if (FAILED(LockBuffer(src, 0, 0, &data, D3DLOCK_READONLY)))
+        continue;
+
+      srcBuffers[stream] = src;
+
+      D3D9SWVPStream& dstStream = info.streams[stream];
+      dstStream.data      = reinterpret_cast<const uint8_t*>(data) + vbo.offset;
+      dstStream.size      = src->Desc()->Size - vbo.offset;
+      dstStream.stride    = vbo.stride;
+      dstStream.instanced = (m_state.streamFreq[stream] & D3DSTREAMSOURCE_INSTANCEDATA) != 0;
+    }
+
+    void* dstData = nullptr;
+
+    if (SUCCEEDED(LockBuffer(pDst, offset, VertexCount * vertexSize, &dstData, 0))) {
+      info.output = reinterpret_cast<uint8_t*>(dstData);
+      m_swvpProcessor.ProcessVertices(info);
+      UnlockBuffer(pDst);
+    }
+
+    for (auto src : srcBuffers) {
+      if (src != nullptr)
+        UnlockBuffer(src);
+    }
+
+    return true;
+  }
+
+
   HRESULT STDMETHODCALLTYPE D3D9DeviceEx::CreateVertexDeclaration(
     const D3DVERTEXELEMENT9*            pVertexElements,
           IDirect3DVertexDeclaration9** ppDecl) {
@@ -3064,7 +3170,8 @@ namespace dxvk {
 
     if (newShader && oldShader) {
       m_consts[DxsoProgramTypes::VertexShader].dirty
-        |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
+        |= HasDifferentConstantLayout(oldShader->GetMeta(), newShader->GetMeta())
+        || newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
         || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
         || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
     }
@@ -3399,7 +3506,8 @@ namespace dxvk {
 
     if (newShader && oldShader) {
       m_consts[DxsoProgramTypes::PixelShader].dirty
-        |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
+        |= HasDifferentConstantLayout(oldShader->GetMeta(), newShader->GetMeta())
+        || newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
         || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
         || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
     }
@@ -4208,61 +4316,182 @@ namespace dxvk {
 
 
   D3D9BufferSlice D3D9DeviceEx::AllocUPBuffer(VkDeviceSize size) {
-    constexpr VkDeviceSize UPBufferSize = 1 << 20;
-
-    if (unlikely(m_upBuffer == nullptr || size > UPBufferSize)) {
-      VkMemoryPropertyFlags memoryFlags
-        = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-        | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-      DxvkBufferCreateInfo info;
-      info.size   = std::max(UPBufferSize, size);
-      info.usage  = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
-                  | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-      info.access = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
-                  | VK_ACCESS_INDEX_READ_BIT;
-      info.stages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-
-      Rc<DxvkBuffer> buffer = m_dxvkDevice->createBuffer(info, memoryFlags);
-
-      if (size <= UPBufferSize) {
-        m_upBuffer = std::move(buffer);
-        m_upBufferMapPtr = m_upBuffer->mapPtr(0);
-      } else {
-        // Temporary buffer
-        D3D9BufferSlice result;
-        result.slice = DxvkBufferSlice(std::move(buffer), 0, size);
-        result.mapPtr = buffer->mapPtr(0);
-        return result;
-      }
-    }
-
     VkDeviceSize alignedSize = align(size, CACHE_LINE_SIZE);
+    m_upBufferFrameBytes += alignedSize;
 
-    if (unlikely(m_upBufferOffset + alignedSize > UPBufferSize)) {
-      auto sliceHandle = m_upBuffer->allocSlice();
+    // Grow the ring if the draw does not fit at all, so that
+    // subsequent large draws can reuse the same buffer.
+    if (unlikely(alignedSize > m_upBufferDesiredSize))
+      m_upBufferDesiredSize = VkDeviceSize(1) << (64u - bit::lzcnt(uint64_t(alignedSize - 1)));
 
-      m_upBufferOffset = 0;
-      m_upBufferMapPtr = sliceHandle.mapPtr;
+    if (unlikely(alignedSize > m_upBufferSize))
+      CreateUPBuffer(m_upBufferDesiredSize);
 
-      EmitCs([
-        cBuffer = m_upBuffer,
-        cSlice  = sliceHandle
-      ] (DxvkContext* ctx) {
-        ctx->invalidateBuffer(cBuffer, cSlice);
-      });
+    VkDeviceSize offset = m_upBufferAllocated & (m_upBufferSize - 1);
+
+    if (unlikely(offset + alignedSize > m_upBufferSize)) {
+      // Apply pending size changes when wrapping around since
+      // the ring has to start at the beginning either way
+      if (m_upBufferDesiredSize != m_upBufferSize)
+        CreateUPBuffer(m_upBufferDesiredSize);
+      else
+        m_upBufferAllocated += m_upBufferSize - offset;
     }
 
+    // Make sure that the GPU is done reading the
+    // part of the ring that we are about to overwrite
+    if (unlikely(m_upBufferAllocated + alignedSize > m_upBufferLastSignaled + m_upBufferSize))
+      WaitUPBuffer(alignedSize);
+
+    offset = m_upBufferAllocated & (m_upBufferSize - 1);
+
     D3D9BufferSlice result;
-    result.slice = DxvkBufferSlice(m_upBuffer, m_upBufferOffset, size);
-    result.mapPtr = reinterpret_cast<char*>(m_upBufferMapPtr) + m_upBufferOffset;
+    result.slice = DxvkBufferSlice(m_upBuffer, offset, size);
+    result.mapPtr = reinterpret_cast<char*>(m_upBufferMapPtr) + offset;
+
+    m_upBufferAllocated += alignedSize;
+
+    if (m_upBufferAllocated - m_upBufferLastAllocated >= m_upBufferSize / UPBufferMarkerCount)
+      EmitUPBufferMarker();
 
-    m_upBufferOffset += alignedSize;
     return result;
   }
 
 
+  void D3D9DeviceEx::CreateUPBuffer(VkDeviceSize size) {
+    VkMemoryPropertyFlags memoryFlags
+      = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+      | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+      | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    DxvkBufferCreateInfo info;
+    info.size   = size;
+    info.usage  = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    info.access = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+                | VK_ACCESS_INDEX_READ_BIT;
+    info.stages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    // The old buffer stays alive until the GPU is done with it,
+    // so none of the pending markers are relevant anymore.
+    m_upBuffer = m_dxvkDevice->createBuffer(info, memoryFlags);
+    m_upBufferMapPtr = m_upBuffer->mapPtr(0);
+
+    m_upBufferSize = size;
+    m_upBufferDesiredSize = size;
+    m_upBufferAllocated = 0;
+    m_upBufferLastAllocated = 0;
+    m_upBufferLastSignaled = 0;
+    m_upBufferMarkers = std::queue<Rc<D3D9UPBufferMarker>>();
+
+    m_upBufferStatSize.store(size);
+  }
+
+
+  void D3D9DeviceEx::EmitUPBufferMarker() {
+    if (m_upBufferLastAllocated == m_upBufferAllocated)
+      return;
+
+    D3D9StagingBufferMarkerPayload payload;
+    payload.sequenceNumber = GetCurrentSequenceNumber();
+    payload.allocated = m_upBufferAllocated;
+    m_upBufferLastAllocated = m_upBufferAllocated;
+
+    Rc<D3D9UPBufferMarker> marker = new D3D9UPBufferMarker(payload);
+    m_upBufferMarkers.push(marker);
+
+    EmitCs([
+      cMarker = std::move(marker)
+    ] (DxvkContext* ctx) {
+      ctx->insertMarker(cMarker);
+    });
+  }
+
+
+  void D3D9DeviceEx::WaitUPBuffer(VkDeviceSize size) {
+    // Retire all regions that the GPU has finished reading
+    // without stalling. If that is not enough, grow the ring
+    // rather than waiting, up to a fixed maximum size.
+    uint64_t lastSequenceNumber = m_csThread.lastSequenceNumber();
+
+    while (!m_upBufferMarkers.empty()) {
+      const auto& marker = m_upBufferMarkers.front();
+      const auto& payload = marker->payload();
+
+      if (payload.sequenceNumber > lastSequenceNumber
+       || marker->isInUse(DxvkAccess::Read))
+        break;
+
+      m_upBufferLastSignaled = payload.allocated;
+      m_upBufferMarkers.pop();
+    }
+
+    if (m_upBufferAllocated + size <= m_upBufferLastSignaled + m_upBufferSize)
+      return;
+
+    if (m_upBufferSize < UPBufferMaxSize) {
+      CreateUPBuffer(m_upBufferSize * 2);
+      return;
+    }
+
+    // The ring is as large as it gets, wait for the GPU to catch
+    // up. Make sure all data written so far is covered by a marker.
+    EmitUPBufferMarker();
+
+    bool didFlush = false;
+
+    while (m_upBufferAllocated + size > m_upBufferLastSignaled + m_upBufferSize) {
+      const auto& marker = m_upBufferMarkers.front();
+      const auto& payload = marker->payload();
+
+      if (payload.sequenceNumber > lastSequenceNumber) {
+        SynchronizeCsThread(payload.sequenceNumber);
+        lastSequenceNumber = payload.sequenceNumber;
+      }
+
+      if (marker->isInUse(DxvkAccess::Read)) {
+        if (!didFlush) {
+          Flush();
+          didFlush = true;
+        }
+
+        m_dxvkDevice->waitForResource(marker, DxvkAccess::Read);
+      }
+
+      m_upBufferLastSignaled = payload.allocated;
+      m_upBufferMarkers.pop();
+    }
+  }
+
+
+  void D3D9DeviceEx::UpdateUPBufferSize() {
+    m_upBufferStatFrameBytes.store(m_upBufferFrameBytes);
+
+    m_upBufferPeakFrameBytes = std::max(m_upBufferPeakFrameBytes, m_upBufferFrameBytes);
+    m_upBufferFrameBytes = 0;
+
+    // Size the ring so that it can hold the data of every frame
+    // in flight, so that wrapping around never has to stall.
+    VkDeviceSize targetSize = m_upBufferPeakFrameBytes * (GetFrameLatency() + 1);
+    targetSize = std::clamp(targetSize, UPBufferMinSize, UPBufferMaxSize);
+    targetSize = VkDeviceSize(1) << (64u - bit::lzcnt(uint64_t(targetSize - 1)));
+
+    if (targetSize > m_upBufferDesiredSize)
+      m_upBufferDesiredSize = targetSize;
+
+    // Only shrink the ring if usage stays low for a while, since
+    // recreating it on every fluctuation would be wasteful
+    if (++m_upBufferFrameCount < UPBufferShrinkInterval)
+      return;
+
+    if (targetSize * 4 <= m_upBufferSize)
+      m_upBufferDesiredSize = targetSize;
+
+    m_upBufferPeakFrameBytes = 0;
+    m_upBufferFrameCount = 0;
+  }
+
+
   D3D9BufferSlice D3D9DeviceEx::AllocStagingBuffer(VkDeviceSize size) {
     m_stagingBufferAllocated += size;
 
@@ -5303,6 +5532,32 @@ namespace dxvk {
   }
 
 
+  inline bool D3D9DeviceEx::HasDifferentConstantLayout(const DxsoShaderMetaInfo& a, const DxsoShaderMetaInfo& b) {
+    if (!a.packedConstantsF && !b.packedConstantsF)
+      return false;
+
+    return a.packedConstantsF != b.packedConstantsF
+        || a.packedConstantMaskF != b.packedConstantMaskF;
+  }
+
+
+  inline void D3D9DeviceEx::CopyPackedConstants(Vector4* dst, const Vector4* src, const DxsoShaderMetaInfo& meta, uint32_t count) {
+    // Registers past the last one set by the application are zero
+    // in the source array, so filling the entire allocation with
+    // packed registers preserves the out-of-bounds behaviour.
+    uint32_t index = 0;
+
+    for (uint32_t i = 0; i < meta.packedConstantMaskF.size() && index < count; i++) {
+      uint32_t mask = meta.packedConstantMaskF[i];
+
+      while (mask && index < count) {
+        dst[index++] = src[i * 32 + bit::tzcnt(mask)];
+        mask &= mask - 1;
+      }
+    }
+  }
+
+
   template <DxsoProgramType ShaderStage, typename HardwareLayoutType, typename SoftwareLayoutType, typename ShaderType>
   inline void D3D9DeviceEx::UploadConstantSet(const SoftwareLayoutType& Src, const D3D9ConstantLayout& Layout, const ShaderType& Shader) {
     /*
@@ -5323,6 +5578,11 @@ namespace dxvk {
     }
     floatCount = std::min(constSet.meta.maxConstIndexF, floatCount);
 
+    // Shaders with packed constants only read the registers in
+    // their mask, so skip all registers that are never accessed.
+    if (constSet.meta.packedConstantsF)
+      floatCount = constSet.meta.getPackedConstantCountF(floatCount);
+
     const uint32_t intRange = caps::MaxOtherConstants * sizeof(Vector4i);
     const uint32_t intDataSize = constSet.meta.maxConstIndexI * sizeof(Vector4i);
     uint32_t floatDataSize = floatCount * sizeof(Vector4);
@@ -5335,8 +5595,12 @@ namespace dxvk {
 
     if (constSet.meta.maxConstIndexI != 0)
       std::memcpy(dst->iConsts, Src.iConsts, intDataSize);
-    if (constSet.meta.maxConstIndexF != 0)
-      std::memcpy(dst->fConsts, Src.fConsts, floatDataSize);
+    if (constSet.meta.maxConstIndexF != 0) {
+      if (constSet.meta.packedConstantsF)
+        CopyPackedConstants(dst->fConsts, Src.fConsts, constSet.meta, floatDataSize / sizeof(Vector4));
+      else
+        std::memcpy(dst->fConsts, Src.fConsts, floatDataSize);
+    }
 
     if (constSet.meta.needsConstantCopies) {
       Vector4* data = reinterpret_cast<Vector4*>(dst->fConsts);
@@ -5460,6 +5724,7 @@ namespace dxvk {
     m_converter->Flush();
 
     EmitStagingBufferMarker();
+    EmitUPBufferMarker();
 
     // Add commands to flush the threaded
     // context, then flush the command list
@@ -5477,12 +5742,15 @@ namespace dxvk {
 
     m_flushSeqNum = m_csSeqNum;
     m_flushTracker.notifyFlush(m_flushSeqNum, submissionId);
+    m_flushTracker.notifyGpuStats(m_dxvkDevice->getGpuFlushStats());
   }
 
 
   void D3D9DeviceEx::EndFrame() {
     D3D9DeviceLock lock = LockDevice();
 
+    UpdateUPBufferSize();
+
     EmitCs<false>([] (DxvkContext* ctx) {
       ctx->endFrame();
     });
@@ -6594,6 +6862,8 @@ namespace dxvk {
 
         data->Stages[i].BumpEnvLScale    = bit::cast<float>(m_state.textureStages[i][DXVK_TSS_BUMPENVLSCALE]);
         data->Stages[i].BumpEnvLOffset   = bit::cast<float>(m_state.textureStages[i][DXVK_TSS_BUMPENVLOFFSET]);
+
+        PackFFShaderStage(m_ffKeyFS.Stages[i], data->Stages[i].FFKey);
       }
     }
 
@@ -6881,12 +7151,10 @@ namespace dxvk {
       }
     }
 
-    if constexpr (ConstantType != D3D9ConstantType::Bool) {
-      uint32_t maxCount = ConstantType == D3D9ConstantType::Float
-        ? m_consts[ProgramType].meta.maxConstIndexF
-        : m_consts[ProgramType].meta.maxConstIndexI;
-
-      m_consts[ProgramType].dirty |= StartRegister < maxCount;
+    if constexpr (ConstantType == D3D9ConstantType::Float) {
+      m_consts[ProgramType].dirty |= m_consts[ProgramType].meta.usesConstantsF(StartRegister, Count);
+    } else if constexpr (ConstantType == D3D9ConstantType::Int) {
+      m_consts[ProgramType].dirty |= StartRegister < m_consts[ProgramType].meta.maxConstIndexI;
     } else if constexpr (ProgramType == DxsoProgramType::VertexShader) {
       if (unlikely(CanSWVP())) {
         m_consts[DxsoProgramType::VertexShader].dirty |= StartRegister < m_consts[ProgramType].meta.maxConstIndexB;
@@ -7170,14 +7438,18 @@ namespace dxvk {
       if (idx >= 1)
         key.Stages[idx - 1].Contents.ResultIsTemp = false;
 
-      EmitCs([
-        this,
-        cKey     = key,
-       &cShaders = m_ffModules
-      ](DxvkContext* ctx) {
-        auto shader = cShaders.GetShaderModule(this, cKey);
-        ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(shader.GetShader());
-      });
+      // The über shader reads the stage state from
+      // the shared pixel shader data
+      if (m_ffModules.HasUberShader() && key != m_ffKeyFS)
+        m_flags.set(D3D9DeviceFlag::DirtySharedPixelShaderData);
+
+      m_ffKeyFS = key;
+
+      BindFixedFunctionPS();
+    } else if (m_ffPixelShaderPending && m_ffModules.IsShaderModuleReady(m_ffKeyFS)) {
+      // The specialized shader finished compiling in the
+      // background, replace the über shader with it
+      BindFixedFunctionPS();
     }
 
     // Constants
@@ -7194,6 +7466,21 @@ namespace dxvk {
   }
 
 
+  void D3D9DeviceEx::BindFixedFunctionPS() {
+    EmitCs([
+      this,
+      cKey     = m_ffKeyFS,
+     &cShaders = m_ffModules
+    ](DxvkContext* ctx) {
+      auto shader = cShaders.GetShaderModule(this, cKey);
+      ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(shader.GetShader());
+    });
+
+    m_ffPixelShaderPending = m_ffModules.HasUberShader()
+      && !m_ffModules.IsShaderModuleReady(m_ffKeyFS);
+  }
+
+
   bool D3D9DeviceEx::UseProgrammableVS() {
     return m_state.vertexShader != nullptr
       && m_state.vertexDecl != nullptr
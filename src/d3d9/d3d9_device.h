@@ -25,6 +25,7 @@
 #include "d3d9_sampler.h"
 #include "d3d9_fixed_function.h"
 #include "d3d9_swvp_emu.h"
+#include "d3d9_swvp_cpu.h"
 
 #include "d3d9_spec_constants.h"
 #include "d3d9_interop.h"
@@ -115,6 +116,8 @@ namespace dxvk {
 
   using D3D9StagingBufferMarker = DxvkMarker<D3D9StagingBufferMarkerPayload>;
 
+  using D3D9UPBufferMarker = DxvkMarker<D3D9StagingBufferMarkerPayload>;
+
   class D3D9DeviceEx final : public ComObjectClamp<IDirect3DDevice9Ex> {
     constexpr static uint32_t DefaultFrameLatency = 3;
     constexpr static uint32_t MaxFrameLatency     = 20;
@@ -127,6 +130,14 @@ namespace dxvk {
 
     constexpr static VkDeviceSize StagingBufferSize = 4ull << 20;
 
+    constexpr static VkDeviceSize UPBufferMinSize = 1ull << 20;
+    constexpr static VkDeviceSize UPBufferMaxSize = env::is32BitHostPlatform()
+      ? 16ull << 20
+      : 64ull << 20;
+
+    constexpr static uint32_t UPBufferMarkerCount     = 8;
+    constexpr static uint32_t UPBufferShrinkInterval  = 256;
+
     friend class D3D9SwapChainEx;
     friend struct D3D9WindowContext;
     friend class D3D9ConstantBuffer;
@@ -858,6 +869,10 @@ namespace dxvk {
 
     inline void* CopySoftwareConstants(D3D9ConstantBuffer& dstBuffer, const void* src, uint32_t size);
 
+    inline bool HasDifferentConstantLayout(const DxsoShaderMetaInfo& a, const DxsoShaderMetaInfo& b);
+
+    inline void CopyPackedConstants(Vector4* dst, const Vector4* src, const DxsoShaderMetaInfo& meta, uint32_t count);
+
     template <DxsoProgramType ShaderStage, typename HardwareLayoutType, typename SoftwareLayoutType, typename ShaderType>
     inline void UploadConstantSet(const SoftwareLayoutType& Src, const D3D9ConstantLayout& Layout, const ShaderType& Shader);
     
@@ -897,6 +912,20 @@ namespace dxvk {
 
     void PrepareDraw(D3DPRIMITIVETYPE PrimitiveType);
 
+    /**
+     * \brief Runs ProcessVertices on the CPU
+     *
+     * Interprets the current vertex shader and writes the
+     * results to the destination buffer directly.
+     * \returns \c false if the shader is not supported
+     */
+    bool ProcessVerticesCpu(
+            UINT                              SrcStartIndex,
+            UINT                              DestIndex,
+            UINT                              VertexCount,
+            D3D9CommonBuffer*                 pDst,
+            D3D9VertexDecl*                   pDecl);
+
     template <DxsoProgramType ShaderStage>
     void BindShader(
       const D3D9CommonShader*                 pShaderModule);
@@ -915,6 +944,10 @@ namespace dxvk {
       return m_multithread.AcquireLock();
     }
 
+    bool IsRecording() const {
+      return m_recorder != nullptr;
+    }
+
     const D3D9Options* GetOptions() const {
       return &m_d3d9Options;
     }
@@ -962,6 +995,20 @@ namespace dxvk {
       return m_samplerCount.load();
     }
 
+    /**
+     * \brief Bytes written to the UP buffer in the last frame
+     */
+    uint64_t GetUPBufferFrameBytes() const {
+      return m_upBufferStatFrameBytes.load();
+    }
+
+    /**
+     * \brief Current size of the UP buffer ring
+     */
+    uint64_t GetUPBufferRingSize() const {
+      return m_upBufferStatSize.load();
+    }
+
     D3D9MemoryAllocator* GetAllocator() {
       return &m_memoryAllocator;
     }
@@ -1037,6 +1084,14 @@ namespace dxvk {
 
     D3D9BufferSlice AllocUPBuffer(VkDeviceSize size);
 
+    void CreateUPBuffer(VkDeviceSize size);
+
+    void EmitUPBufferMarker();
+
+    void WaitUPBuffer(VkDeviceSize size);
+
+    void UpdateUPBufferSize();
+
     D3D9BufferSlice AllocStagingBuffer(VkDeviceSize size);
 
     void EmitStagingBufferMarker();
@@ -1182,6 +1237,8 @@ namespace dxvk {
 
     void UpdateFixedFunctionPS();
 
+    void BindFixedFunctionPS();
+
     void ApplyPrimitiveType(
       DxvkContext*      pContext,
       D3DPRIMITIVETYPE  PrimType);
@@ -1237,6 +1294,7 @@ namespace dxvk {
 
     D3D9FFShaderModuleSet           m_ffModules;
     D3D9SWVPEmulator                m_swvpEmulator;
+    D3D9SWVPProcessor               m_swvpProcessor;
 
     Com<D3D9StateBlock, false>      m_recorder;
 
@@ -1251,8 +1309,18 @@ namespace dxvk {
     D3D9ConstantBuffer              m_specBuffer;
 
     Rc<DxvkBuffer>                  m_upBuffer;
-    VkDeviceSize                    m_upBufferOffset  = 0ull;
-    void*                           m_upBufferMapPtr  = nullptr;
+    void*                           m_upBufferMapPtr              = nullptr;
+    VkDeviceSize                    m_upBufferSize                = 0ull;
+    VkDeviceSize                    m_upBufferDesiredSize         = UPBufferMinSize;
+    VkDeviceSize                    m_upBufferAllocated           = 0ull;
+    VkDeviceSize                    m_upBufferLastAllocated       = 0ull;
+    VkDeviceSize                    m_upBufferLastSignaled        = 0ull;
+    std::queue<Rc<D3D9UPBufferMarker>> m_upBufferMarkers;
+    VkDeviceSize                    m_upBufferFrameBytes          = 0ull;
+    VkDeviceSize                    m_upBufferPeakFrameBytes      = 0ull;
+    uint32_t                        m_upBufferFrameCount          = 0u;
+    std::atomic<uint64_t>           m_upBufferStatFrameBytes      = { 0ull };
+    std::atomic<uint64_t>           m_upBufferStatSize            = { 0ull };
 
     DxvkStagingBuffer               m_stagingBuffer;
     VkDeviceSize                    m_stagingBufferAllocated      = 0ull;
@@ -1323,6 +1391,9 @@ namespace dxvk {
     uint32_t                        m_lastHazardsDS = 0;
     uint32_t                        m_lastSamplerTypesFF = 0;
 
+    D3D9FFShaderKeyFS               m_ffKeyFS;
+    bool                            m_ffPixelShaderPending = false;
+
     D3D9SpecializationInfo          m_specInfo = D3D9SpecializationInfo();
 
     D3D9ShaderMasks                 m_vsShaderMasks = D3D9ShaderMasks();
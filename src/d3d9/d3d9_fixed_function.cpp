@@ -9,6 +9,7 @@
 #include "../spirv/spirv_module.h"
 
 #include <cfloat>
+#include <functional>
 
 namespace dxvk {
 
@@ -545,6 +546,9 @@ namespace dxvk {
     uint32_t vec2_t  = spvModule.defVectorType(float_t, 2);
     uint32_t vec4_t  = spvModule.defVectorType(float_t, 4);
 
+    uint32_t uint_t  = spvModule.defIntType(32, 0);
+    uint32_t uvec2_t = spvModule.defVectorType(uint_t, 2);
+
     std::array<uint32_t, D3D9SharedPSStages_Count> stageMembers = {
       vec4_t,
 
@@ -553,6 +557,8 @@ namespace dxvk {
 
       float_t,
       float_t,
+
+      uvec2_t,
     };
 
     std::array<decltype(stageMembers), caps::TextureStageCount> members;
@@ -582,8 +588,8 @@ namespace dxvk {
       spvModule.memberDecorateOffset(structType, stage * D3D9SharedPSStages_Count + D3D9SharedPSStages_BumpEnvLOffset, offset);
       offset += sizeof(float);
 
-      // Padding...
-      offset += sizeof(float) * 2;
+      spvModule.memberDecorateOffset(structType, stage * D3D9SharedPSStages_Count + D3D9SharedPSStages_FFKey, offset);
+      offset += sizeof(uint32_t) * 2;
     }
 
     uint32_t sharedState = spvModule.newVar(
@@ -707,17 +713,86 @@ namespace dxvk {
       uint32_t POS;
     } in;
 
-    struct {
+    struct Sampler {
       uint32_t texcoordCnt;
       uint32_t typeId;
       uint32_t varId;
     } samplers[8];
 
+    // 2D, 3D and cube samplers for each stage
+    Sampler uberSamplers[8][3];
+
     struct {
       uint32_t COLOR;
     } out;
   };
 
+
+  /**
+   * \brief Texture stage fields for the über pixel shader
+   *
+   * Each stage is packed into two dwords in the
+   * shared pixel shader data, see \c D3D9SharedPS.
+   */
+  enum class D3D9FFUberStageField : uint32_t {
+    ColorOp,
+    ColorArg0,
+    ColorArg1,
+    ColorArg2,
+    AlphaOp,
+    AlphaArg0,
+    AlphaArg1,
+    AlphaArg2,
+    Type,
+    ResultIsTemp,
+    Projected,
+    ProjectedCount,
+    TextureBound,
+    GlobalSpecularEnable,
+
+    Count
+  };
+
+  static constexpr std::array<BitfieldPosition, uint32_t(D3D9FFUberStageField::Count)> D3D9FFUberStageLayout = {{
+    { 0, 0,  5 }, // ColorOp
+    { 0, 5,  6 }, // ColorArg0
+    { 0, 11, 6 }, // ColorArg1
+    { 0, 17, 6 }, // ColorArg2
+    { 0, 23, 5 }, // AlphaOp
+
+    { 1, 0,  6 }, // AlphaArg0
+    { 1, 6,  6 }, // AlphaArg1
+    { 1, 12, 6 }, // AlphaArg2
+    { 1, 18, 2 }, // Type
+    { 1, 20, 1 }, // ResultIsTemp
+    { 1, 21, 1 }, // Projected
+    { 1, 22, 3 }, // ProjectedCount
+    { 1, 25, 1 }, // TextureBound
+    { 1, 26, 1 }, // GlobalSpecularEnable
+  }};
+
+
+  void PackFFShaderStage(const D3D9FFShaderStage& Stage, uint32_t* pDwords) {
+    const auto& stage = Stage.Contents;
+
+    std::array<uint32_t, uint32_t(D3D9FFUberStageField::Count)> values = {
+      stage.ColorOp,   stage.ColorArg0, stage.ColorArg1, stage.ColorArg2,
+      stage.AlphaOp,   stage.AlphaArg0, stage.AlphaArg1, stage.AlphaArg2,
+      stage.Type,      stage.ResultIsTemp,
+      stage.Projected, stage.ProjectedCount,
+      stage.TextureBound,
+      stage.GlobalSpecularEnable,
+    };
+
+    pDwords[0] = 0u;
+    pDwords[1] = 0u;
+
+    for (uint32_t i = 0; i < values.size(); i++) {
+      const auto& layout = D3D9FFUberStageLayout[i];
+      pDwords[layout.dwordOffset] |= (values[i] << layout.bitOffset) & layout.mask();
+    }
+  }
+
   class D3D9FFShaderCompiler {
 
   public:
@@ -734,6 +809,18 @@ namespace dxvk {
       const std::string&             Name,
             D3D9FixedFunctionOptions Options);
 
+    /**
+     * \brief Creates compiler for the über pixel shader
+     *
+     * The über pixel shader reads the texture stage
+     * state from the shared pixel shader data instead
+     * of baking it into the shader.
+     */
+    D3D9FFShaderCompiler(
+            Rc<DxvkDevice>           Device,
+      const std::string&             Name,
+            D3D9FixedFunctionOptions Options);
+
     Rc<DxvkShader> compile();
 
     DxsoIsgn isgn() { return m_isgn; }
@@ -758,6 +845,34 @@ namespace dxvk {
 
     void compilePS();
 
+    uint32_t emitTextureStages();
+
+    uint32_t emitUberTextureStages();
+
+    uint32_t emitUberTextureOp(
+            uint32_t                              op,
+            uint32_t                              dst,
+      const std::array<uint32_t, TextureArgCount>& arg,
+            uint32_t                              diffuse,
+            uint32_t                              current,
+            uint32_t                              texture);
+
+    uint32_t emitUberStageField(uint32_t key, D3D9FFUberStageField field);
+
+    uint32_t emitTextureOp(
+            D3DTEXTUREOP                          op,
+            uint32_t                              dst,
+            std::array<uint32_t, TextureArgCount> arg,
+            uint32_t                              diffuse,
+            uint32_t                              current,
+      const std::function<uint32_t()>&            getTexture);
+
+    uint32_t emitScalarReplicate(uint32_t reg);
+    uint32_t emitAlphaReplicate(uint32_t reg);
+    uint32_t emitComplement(uint32_t reg);
+    uint32_t emitSaturate(uint32_t reg);
+    uint32_t emitSelectVec4(uint32_t cond, uint32_t a, uint32_t b);
+
     void setupPS();
 
     void emitPsSharedConstants();
@@ -787,6 +902,7 @@ namespace dxvk {
     DxsoProgramType       m_programType;
     D3D9FFShaderKeyVS     m_vsKey;
     D3D9FFShaderKeyFS     m_fsKey;
+    bool                  m_uber = false;
 
     D3D9FFVertexData      m_vs = { };
     D3D9FFPixelData       m_ps = { };
@@ -837,6 +953,17 @@ namespace dxvk {
   }
 
 
+  D3D9FFShaderCompiler::D3D9FFShaderCompiler(
+          Rc<DxvkDevice>           Device,
+    const std::string&             Name,
+          D3D9FixedFunctionOptions Options)
+  : m_module(spvVersion(1, 3)), m_options(Options) {
+    m_programType = DxsoProgramTypes::PixelShader;
+    m_uber     = true;
+    m_filename = Name;
+  }
+
+
   Rc<DxvkShader> D3D9FFShaderCompiler::compile() {
     m_floatType  = m_module.defFloatType(32);
     m_uint32Type = m_module.defIntType(32, 0);
@@ -1747,6 +1874,31 @@ namespace dxvk {
   void D3D9FFShaderCompiler::compilePS() {
     setupPS();
 
+    uint32_t current = m_uber
+      ? emitUberTextureStages()
+      : emitTextureStages();
+
+    D3D9FogContext fogCtx;
+    fogCtx.IsPixel     = true;
+    fogCtx.RangeFog    = false;
+    fogCtx.RenderState = m_rsBlock;
+    fogCtx.vPos        = m_ps.in.POS;
+    fogCtx.vFog        = m_ps.in.FOG;
+    fogCtx.oColor      = current;
+    fogCtx.IsFixedFunction = true;
+    fogCtx.IsPositionT = false;
+    fogCtx.HasSpecular = false;
+    fogCtx.Specular    = 0;
+    fogCtx.SpecUBO     = m_specUbo;
+    current = DoFixedFunctionFog(m_spec, m_module, fogCtx);
+
+    m_module.opStore(m_ps.out.COLOR, current);
+
+    alphaTestPS();
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitTextureStages() {
     uint32_t diffuse  = m_ps.in.COLOR[0];
     uint32_t specular = m_ps.in.COLOR[1];
 
@@ -1868,30 +2020,6 @@ namespace dxvk {
         return texture;
       };
 
-      auto ScalarReplicate = [&](uint32_t reg) {
-        std::array<uint32_t, 4> replicant = { reg, reg, reg, reg };
-        return m_module.opCompositeConstruct(m_vec4Type, replicant.size(), replicant.data());
-      };
-
-      auto AlphaReplicate = [&](uint32_t reg) {
-        uint32_t alphaComponentId = 3;
-        uint32_t alpha = m_module.opCompositeExtract(m_floatType, reg, 1, &alphaComponentId);
-
-        return ScalarReplicate(alpha);
-      };
-
-      auto Complement = [&](uint32_t reg) {
-        return m_module.opFSub(m_vec4Type,
-          m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f),
-          reg);
-      };
-
-      auto Saturate = [&](uint32_t reg) {
-        return m_module.opFClamp(m_vec4Type, reg,
-          m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f),
-          m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f));
-      };
-
       auto GetArg = [&] (uint32_t arg) {
         uint32_t reg = m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -1932,165 +2060,15 @@ namespace dxvk {
 
         // reg = 1 - reg
         if (arg & D3DTA_COMPLEMENT)
-          reg = Complement(reg);
+          reg = emitComplement(reg);
 
         // reg = reg.wwww
         if (arg & D3DTA_ALPHAREPLICATE)
-          reg = AlphaReplicate(reg);
+          reg = emitAlphaReplicate(reg);
 
         return reg;
       };
 
-      auto DoOp = [&](D3DTEXTUREOP op, uint32_t dst, std::array<uint32_t, TextureArgCount> arg) {
-        switch (op) {
-          case D3DTOP_SELECTARG1:
-            dst = arg[1];
-            break;
-
-          case D3DTOP_SELECTARG2:
-            dst = arg[2];
-            break;
-
-          case D3DTOP_MODULATE4X:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(4.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATE2X:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATE:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            break;
-
-          case D3DTOP_ADDSIGNED2X:
-            arg[2] = m_module.opFSub(m_vec4Type, arg[2],
-              m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
-
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADDSIGNED:
-            arg[2] = m_module.opFSub(m_vec4Type, arg[2],
-              m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
-
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADD:
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_SUBTRACT:
-            dst = m_module.opFSub(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADDSMOOTH:
-            dst = m_module.opFFma(m_vec4Type, Complement(arg[1]), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BLENDDIFFUSEALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(diffuse));
-            break;
-
-          case D3DTOP_BLENDTEXTUREALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(GetTexture()));
-            break;
-
-          case D3DTOP_BLENDFACTORALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(m_ps.constants.textureFactor));
-            break;
-
-          case D3DTOP_BLENDTEXTUREALPHAPM:
-            dst = m_module.opFFma(m_vec4Type, arg[2], Complement(AlphaReplicate(GetTexture())), arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BLENDCURRENTALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(current));
-            break;
-
-          case D3DTOP_PREMODULATE:
-            Logger::warn("D3DTOP_PREMODULATE: not implemented");
-            break;
-
-          case D3DTOP_MODULATEALPHA_ADDCOLOR:
-            dst = m_module.opFFma(m_vec4Type, AlphaReplicate(arg[1]), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATECOLOR_ADDALPHA:
-            dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], AlphaReplicate(arg[1]));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATEINVALPHA_ADDCOLOR:
-            dst = m_module.opFFma(m_vec4Type, Complement(AlphaReplicate(arg[1])), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATEINVCOLOR_ADDALPHA:
-            dst = m_module.opFFma(m_vec4Type, Complement(arg[1]), arg[2], AlphaReplicate(arg[1]));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BUMPENVMAPLUMINANCE:
-          case D3DTOP_BUMPENVMAP:
-            // Load texture for the next stage...
-            texture = GetTexture();
-            break;
-
-          case D3DTOP_DOTPRODUCT3: {
-            // Get vec3 of arg1 & 2
-            uint32_t vec3Type = m_module.defVectorType(m_floatType, 3);
-            std::array<uint32_t, 3> indices = { 0, 1, 2 };
-            arg[1] = m_module.opVectorShuffle(vec3Type, arg[1], arg[1], indices.size(), indices.data());
-            arg[2] = m_module.opVectorShuffle(vec3Type, arg[2], arg[2], indices.size(), indices.data());
-
-            // Bias according to spec.
-            arg[1] = m_module.opFSub(vec3Type, arg[1], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
-            arg[2] = m_module.opFSub(vec3Type, arg[2], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
-
-            // Do the dotting!
-            dst = m_module.opDot(m_floatType, arg[1], arg[2]);
-
-            // Multiply by 4 and replicate -> vec4
-            dst = m_module.opFMul(m_floatType, dst, m_module.constf32(4.0f));
-            dst = ScalarReplicate(dst);
-
-            // Saturate
-            dst = Saturate(dst);
-
-            break;
-          }
-
-          case D3DTOP_MULTIPLYADD:
-            dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], arg[0]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_LERP:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], arg[0]);
-            break;
-
-          default:
-            Logger::warn("Unhandled texture op!");
-            break;
-        }
-
-        return dst;
-      };
-
       uint32_t& dst = stage.ResultIsTemp ? temp : current;
 
       D3DTEXTUREOP colorOp = (D3DTEXTUREOP)stage.ColorOp;
@@ -2121,7 +2099,7 @@ namespace dxvk {
       if (fastPath || colorOp == D3DTOP_DOTPRODUCT3) {
         if (colorOp != D3DTOP_DISABLE) {
           ProcessArgs(colorOp, colorArgs);
-          dst = DoOp(colorOp, dst, colorArgs);
+          dst = emitTextureOp(colorOp, dst, colorArgs, diffuse, current, GetTexture);
         }
       }
       else {
@@ -2131,12 +2109,12 @@ namespace dxvk {
         uint32_t alphaResult = dst;
         if (colorOp != D3DTOP_DISABLE) {
           ProcessArgs(colorOp, colorArgs);
-          colorResult = DoOp(colorOp, dst, colorArgs);
+          colorResult = emitTextureOp(colorOp, dst, colorArgs, diffuse, current, GetTexture);
         }
 
         if (alphaOp != D3DTOP_DISABLE) {
           ProcessArgs(alphaOp, alphaArgs);
-          alphaResult = DoOp(alphaOp, dst, alphaArgs);
+          alphaResult = emitTextureOp(alphaOp, dst, alphaArgs, diffuse, current, GetTexture);
         }
 
         // src0.x, src0.y, src0.z src1.w
@@ -2156,25 +2134,531 @@ namespace dxvk {
       current = m_module.opFAdd(m_vec4Type, current, specular);
     }
 
-    D3D9FogContext fogCtx;
-    fogCtx.IsPixel     = true;
-    fogCtx.RangeFog    = false;
-    fogCtx.RenderState = m_rsBlock;
-    fogCtx.vPos        = m_ps.in.POS;
-    fogCtx.vFog        = m_ps.in.FOG;
-    fogCtx.oColor      = current;
-    fogCtx.IsFixedFunction = true;
-    fogCtx.IsPositionT = false;
-    fogCtx.HasSpecular = false;
-    fogCtx.Specular    = 0;
-    fogCtx.SpecUBO     = m_specUbo;
-    current = DoFixedFunctionFog(m_spec, m_module, fogCtx);
+    return current;
+  }
 
-    m_module.opStore(m_ps.out.COLOR, current);
 
-    alphaTestPS();
+  uint32_t D3D9FFShaderCompiler::emitUberTextureStages() {
+    uint32_t diffuse  = m_ps.in.COLOR[0];
+    uint32_t specular = m_ps.in.COLOR[1];
+
+    uint32_t boolType  = m_module.defBoolType();
+    uint32_t uvec2Type = m_module.defVectorType(m_uint32Type, 2);
+
+    // Stages are executed conditionally, so keep the
+    // registers in variables rather than SSA values.
+    uint32_t vec4PtrType = m_module.defPointerType(m_vec4Type, spv::StorageClassPrivate);
+
+    uint32_t currentVar = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+    uint32_t tempVar    = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+    uint32_t textureVar = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+
+    m_module.setDebugName(currentVar, "current");
+    m_module.setDebugName(tempVar,    "temp");
+    m_module.setDebugName(textureVar, "texture");
+
+    m_module.opStore(currentVar, diffuse);
+    m_module.opStore(tempVar,    m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f));
+    m_module.opStore(textureVar, m_module.constvec4f32(0.0f, 0.0f, 0.0f, 1.0f));
+
+    uint32_t unboundTextureConstId = m_module.constvec4f32(0.0f, 0.0f, 0.0f, 1.0f);
+
+    uint32_t stage0Key = 0;
+    uint32_t prevColorOp = 0;
+
+    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+      uint32_t keyIndex = m_module.constu32(D3D9SharedPSStages_Count * i + D3D9SharedPSStages_FFKey);
+      uint32_t key = m_module.opLoad(uvec2Type,
+        m_module.opAccessChain(m_module.defPointerType(uvec2Type, spv::StorageClassUniform),
+          m_ps.sharedState, 1, &keyIndex));
+
+      if (!i)
+        stage0Key = key;
+
+      auto GetField = [&](D3D9FFUberStageField field) {
+        return emitUberStageField(key, field);
+      };
+
+      auto IsEqual = [&](uint32_t value, uint32_t constant) {
+        return m_module.opIEqual(boolType, value, m_module.constu32(constant));
+      };
+
+      uint32_t colorOp = GetField(D3D9FFUberStageField::ColorOp);
+      uint32_t alphaOp = GetField(D3D9FFUberStageField::AlphaOp);
+
+      // Stages after the first disabled stage are always disabled
+      // as well, so we can skip each stage individually. The keys
+      // of those stages are not packed, so their op is zero.
+      uint32_t stageLabel = m_module.allocateId();
+      uint32_t stageEndLabel = m_module.allocateId();
+
+      uint32_t stageEnabled = m_module.opLogicalAnd(boolType,
+        m_module.opINotEqual(boolType, colorOp, m_module.constu32(0)),
+        m_module.opINotEqual(boolType, colorOp, m_module.constu32(D3DTOP_DISABLE)));
+
+      m_module.opSelectionMerge(stageEndLabel, spv::SelectionControlMaskNone);
+      m_module.opBranchConditional(stageEnabled, stageLabel, stageEndLabel);
+      m_module.opLabel(stageLabel);
+
+      // Sample the texture unconditionally, the result is only
+      // used for texture arguments if a texture is bound.
+      uint32_t texcoord  = m_ps.in.TEXCOORD[i];
+      uint32_t projected = m_module.opINotEqual(boolType,
+        GetField(D3D9FFUberStageField::Projected), m_module.constu32(0));
+
+      uint32_t type = GetField(D3D9FFUberStageField::Type);
+      uint32_t texcoordCnt = m_module.opSelect(m_uint32Type,
+        IsEqual(type, 0u), m_module.constu32(3), m_module.constu32(4));
+
+      // Always use w if ProjectedCount is 0 or out of bounds
+      uint32_t projCount = GetField(D3D9FFUberStageField::ProjectedCount);
+      uint32_t projIdx = m_module.opSelect(m_uint32Type,
+        m_module.opLogicalOr(boolType, IsEqual(projCount, 0u),
+          m_module.opUGreaterThan(boolType, projCount, texcoordCnt)),
+        m_module.constu32(3),
+        m_module.opISub(m_uint32Type, projCount, m_module.constu32(1)));
+
+      uint32_t projValue = m_module.opVectorExtractDynamic(m_floatType, texcoord, projIdx);
+      projValue = m_module.opSelect(m_floatType, projected, projValue, m_module.constf32(1.0f));
+
+      uint32_t projRcp = m_module.opFDiv(m_floatType, m_module.constf32(1.0f), projValue);
+      texcoord = m_module.opVectorTimesScalar(m_vec4Type, texcoord, projRcp);
+
+      if (i != 0) {
+        uint32_t prevTexture = m_module.opLoad(m_vec4Type, textureVar);
+        uint32_t coords = texcoord;
+
+        for (uint32_t j = 0; j < 2; j++) {
+          std::array<uint32_t, 2> indices = { 0, 1 };
+
+          uint32_t tc_m_n = m_module.opCompositeExtract(m_floatType, coords, 1, &j);
+
+          uint32_t offset = m_module.constu32(D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvMat0 + j);
+          uint32_t bm     = m_module.opAccessChain(m_module.defPointerType(m_vec2Type, spv::StorageClassUniform),
+                                                   m_ps.sharedState, 1, &offset);
+                   bm     = m_module.opLoad(m_vec2Type, bm);
+
+          uint32_t t      = m_module.opVectorShuffle(m_vec2Type, prevTexture, prevTexture, 2, indices.data());
+
+          uint32_t dot    = m_module.opDot(m_floatType, bm, t);
+
+          uint32_t result = m_module.opFAdd(m_floatType, tc_m_n, dot);
+          coords  = m_module.opCompositeInsert(m_vec4Type, result, coords, 1, &j);
+        }
+
+        uint32_t isBumpEnvMap = m_module.opLogicalOr(boolType,
+          IsEqual(prevColorOp, D3DTOP_BUMPENVMAP),
+          IsEqual(prevColorOp, D3DTOP_BUMPENVMAPLUMINANCE));
+
+        texcoord = emitSelectVec4(isBumpEnvMap, coords, texcoord);
+      }
+
+      std::array<SpirvSwitchCaseLabel, 3> typeCaseLabels = {{
+        { uint32_t(D3DRTYPE_TEXTURE       - D3DRTYPE_TEXTURE), m_module.allocateId() },
+        { uint32_t(D3DRTYPE_VOLUMETEXTURE - D3DRTYPE_TEXTURE), m_module.allocateId() },
+        { uint32_t(D3DRTYPE_CUBETEXTURE   - D3DRTYPE_TEXTURE), m_module.allocateId() },
+      }};
+
+      uint32_t typeEndLabel = m_module.allocateId();
+
+      m_module.opSelectionMerge(typeEndLabel, spv::SelectionControlMaskNone);
+      m_module.opSwitch(type,
+        typeCaseLabels[0].labelId,
+        typeCaseLabels.size(),
+        typeCaseLabels.data());
+
+      for (const auto& label : typeCaseLabels) {
+        m_module.opLabel(label.labelId);
+
+        const auto& sampler = m_ps.uberSamplers[i][label.literal];
+
+        std::array<uint32_t, 3> indices = { 0, 1, 2 };
+        uint32_t coordType = m_module.defVectorType(m_floatType, sampler.texcoordCnt);
+        uint32_t coords = m_module.opVectorShuffle(coordType,
+          texcoord, texcoord, sampler.texcoordCnt, indices.data());
+
+        uint32_t imageVarId = m_module.opLoad(sampler.typeId, sampler.varId);
+        m_module.opStore(textureVar, m_module.opImageSampleImplicitLod(
+          m_vec4Type, imageVarId, coords, SpirvImageOperands()));
+
+        m_module.opBranch(typeEndLabel);
+      }
+
+      m_module.opLabel(typeEndLabel);
+
+      uint32_t texture = m_module.opLoad(m_vec4Type, textureVar);
+
+      if (i != 0) {
+        uint32_t index = m_module.constu32(D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvLScale);
+        uint32_t lScale = m_module.opAccessChain(m_module.defPointerType(m_floatType, spv::StorageClassUniform),
+                                                 m_ps.sharedState, 1, &index);
+                 lScale = m_module.opLoad(m_floatType, lScale);
+
+                 index = m_module.constu32(D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvLOffset);
+        uint32_t lOffset = m_module.opAccessChain(m_module.defPointerType(m_floatType, spv::StorageClassUniform),
+                                                  m_ps.sharedState, 1, &index);
+                 lOffset = m_module.opLoad(m_floatType, lOffset);
+
+        uint32_t zIndex = 2;
+        uint32_t scale = m_module.opCompositeExtract(m_floatType, texture, 1, &zIndex);
+                 scale = m_module.opFMul(m_floatType, scale, lScale);
+                 scale = m_module.opFAdd(m_floatType, scale, lOffset);
+                 scale = m_module.opFClamp(m_floatType, scale, m_module.constf32(0.0f), m_module.constf32(1.0));
+
+        texture = emitSelectVec4(IsEqual(prevColorOp, D3DTOP_BUMPENVMAPLUMINANCE),
+          m_module.opVectorTimesScalar(m_vec4Type, texture, scale), texture);
+
+        m_module.opStore(textureVar, texture);
+      }
+
+      uint32_t textureBound = m_module.opINotEqual(boolType,
+        GetField(D3D9FFUberStageField::TextureBound), m_module.constu32(0));
+      uint32_t textureArg = emitSelectVec4(textureBound, texture, unboundTextureConstId);
+
+      uint32_t offset = m_module.constu32(D3D9SharedPSStages_Count * i + D3D9SharedPSStages_Constant);
+      uint32_t constant = m_module.opLoad(m_vec4Type,
+        m_module.opAccessChain(m_module.defPointerType(m_vec4Type, spv::StorageClassUniform),
+          m_ps.sharedState, 1, &offset));
+
+      uint32_t current = m_module.opLoad(m_vec4Type, currentVar);
+      uint32_t temp    = m_module.opLoad(m_vec4Type, tempVar);
+
+      auto GetArg = [&] (D3D9FFUberStageField field) {
+        uint32_t arg = GetField(field);
+        uint32_t select = m_module.opBitwiseAnd(m_uint32Type, arg, m_module.constu32(D3DTA_SELECTMASK));
+
+        std::array<std::pair<uint32_t, uint32_t>, 7> sources = {{
+          { D3DTA_CONSTANT, constant },
+          { D3DTA_CURRENT,  current  },
+          { D3DTA_DIFFUSE,  diffuse  },
+          { D3DTA_SPECULAR, specular },
+          { D3DTA_TEMP,     temp     },
+          { D3DTA_TEXTURE,  textureArg },
+          { D3DTA_TFACTOR,  m_ps.constants.textureFactor },
+        }};
+
+        uint32_t reg = m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f);
+
+        for (const auto& source : sources)
+          reg = emitSelectVec4(IsEqual(select, source.first), source.second, reg);
+
+        // reg = 1 - reg
+        uint32_t complement = m_module.opINotEqual(boolType,
+          m_module.opBitwiseAnd(m_uint32Type, arg, m_module.constu32(D3DTA_COMPLEMENT)),
+          m_module.constu32(0));
+        reg = emitSelectVec4(complement, emitComplement(reg), reg);
+
+        // reg = reg.wwww
+        uint32_t alphaReplicate = m_module.opINotEqual(boolType,
+          m_module.opBitwiseAnd(m_uint32Type, arg, m_module.constu32(D3DTA_ALPHAREPLICATE)),
+          m_module.constu32(0));
+        reg = emitSelectVec4(alphaReplicate, emitAlphaReplicate(reg), reg);
+
+        return reg;
+      };
+
+      uint32_t resultIsTemp = m_module.opINotEqual(boolType,
+        GetField(D3D9FFUberStageField::ResultIsTemp), m_module.constu32(0));
+
+      uint32_t dst = emitSelectVec4(resultIsTemp, temp, current);
+
+      std::array<uint32_t, TextureArgCount> colorArgs = {
+        GetArg(D3D9FFUberStageField::ColorArg0),
+        GetArg(D3D9FFUberStageField::ColorArg1),
+        GetArg(D3D9FFUberStageField::ColorArg2) };
+
+      std::array<uint32_t, TextureArgCount> alphaArgs = {
+        GetArg(D3D9FFUberStageField::AlphaArg0),
+        GetArg(D3D9FFUberStageField::AlphaArg1),
+        GetArg(D3D9FFUberStageField::AlphaArg2) };
+
+      uint32_t colorResult = emitUberTextureOp(colorOp, dst, colorArgs, diffuse, current, texture);
+      uint32_t alphaResult = emitUberTextureOp(alphaOp, dst, alphaArgs, diffuse, current, texture);
+
+      // D3DTOP_DOTPRODUCT3 writes all four components, otherwise
+      // combine the color result with the alpha result.
+      std::array<uint32_t, 4> indices = { 0, 1, 2, 4 + 3 };
+
+      uint32_t result = m_module.opVectorShuffle(m_vec4Type,
+        colorResult, alphaResult, indices.size(), indices.data());
+      result = emitSelectVec4(IsEqual(colorOp, D3DTOP_DOTPRODUCT3), colorResult, result);
+
+      m_module.opStore(tempVar,    emitSelectVec4(resultIsTemp, result, temp));
+      m_module.opStore(currentVar, emitSelectVec4(resultIsTemp, current, result));
+
+      m_module.opBranch(stageEndLabel);
+      m_module.opLabel(stageEndLabel);
+
+      prevColorOp = colorOp;
+    }
+
+    uint32_t current = m_module.opLoad(m_vec4Type, currentVar);
+
+    uint32_t specularEnable = m_module.opINotEqual(boolType,
+      emitUberStageField(stage0Key, D3D9FFUberStageField::GlobalSpecularEnable),
+      m_module.constu32(0));
+
+    specular = m_module.opFMul(m_vec4Type, specular, m_module.constvec4f32(1.0f, 1.0f, 1.0f, 0.0f));
+    current = emitSelectVec4(specularEnable, m_module.opFAdd(m_vec4Type, current, specular), current);
+
+    return current;
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitUberTextureOp(
+          uint32_t                              op,
+          uint32_t                              dst,
+    const std::array<uint32_t, TextureArgCount>& arg,
+          uint32_t                              diffuse,
+          uint32_t                              current,
+          uint32_t                              texture) {
+    uint32_t resultVar = m_module.newVar(
+      m_module.defPointerType(m_vec4Type, spv::StorageClassPrivate),
+      spv::StorageClassPrivate);
+
+    // D3DTOP_DISABLE and D3DTOP_PREMODULATE leave the destination
+    // unchanged, so they are handled by the default case.
+    std::vector<SpirvSwitchCaseLabel> caseLabels;
+
+    for (uint32_t i = D3DTOP_SELECTARG1; i <= D3DTOP_LERP; i++) {
+      if (i != D3DTOP_PREMODULATE)
+        caseLabels.push_back({ i, m_module.allocateId() });
+    }
+
+    uint32_t defaultLabel = m_module.allocateId();
+    uint32_t endLabel = m_module.allocateId();
+
+    m_module.opSelectionMerge(endLabel, spv::SelectionControlMaskNone);
+    m_module.opSwitch(op, defaultLabel, caseLabels.size(), caseLabels.data());
+
+    for (const auto& label : caseLabels) {
+      m_module.opLabel(label.labelId);
+
+      uint32_t result = emitTextureOp(D3DTEXTUREOP(label.literal),
+        dst, arg, diffuse, current, [texture] { return texture; });
+
+      m_module.opStore(resultVar, result);
+      m_module.opBranch(endLabel);
+    }
+
+    m_module.opLabel(defaultLabel);
+    m_module.opStore(resultVar, dst);
+    m_module.opBranch(endLabel);
+
+    m_module.opLabel(endLabel);
+    return m_module.opLoad(m_vec4Type, resultVar);
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitUberStageField(uint32_t key, D3D9FFUberStageField field) {
+    const auto& layout = D3D9FFUberStageLayout[uint32_t(field)];
+
+    uint32_t dword = layout.dwordOffset;
+    uint32_t value = m_module.opCompositeExtract(m_uint32Type, key, 1, &dword);
+
+    return m_module.opBitFieldUExtract(m_uint32Type, value,
+      m_module.constu32(layout.bitOffset),
+      m_module.constu32(layout.sizeInBits));
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitTextureOp(
+          D3DTEXTUREOP                          op,
+          uint32_t                              dst,
+          std::array<uint32_t, TextureArgCount> arg,
+          uint32_t                              diffuse,
+          uint32_t                              current,
+    const std::function<uint32_t()>&            getTexture) {
+    switch (op) {
+      case D3DTOP_SELECTARG1:
+        dst = arg[1];
+        break;
+
+      case D3DTOP_SELECTARG2:
+        dst = arg[2];
+        break;
+
+      case D3DTOP_MODULATE4X:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(4.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATE2X:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATE:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        break;
+
+      case D3DTOP_ADDSIGNED2X:
+        arg[2] = m_module.opFSub(m_vec4Type, arg[2],
+          m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
+
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADDSIGNED:
+        arg[2] = m_module.opFSub(m_vec4Type, arg[2],
+          m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
+
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADD:
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_SUBTRACT:
+        dst = m_module.opFSub(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADDSMOOTH:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(arg[1]), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BLENDDIFFUSEALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(diffuse));
+        break;
+
+      case D3DTOP_BLENDTEXTUREALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(getTexture()));
+        break;
+
+      case D3DTOP_BLENDFACTORALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(m_ps.constants.textureFactor));
+        break;
+
+      case D3DTOP_BLENDTEXTUREALPHAPM:
+        dst = m_module.opFFma(m_vec4Type, arg[2], emitComplement(emitAlphaReplicate(getTexture())), arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BLENDCURRENTALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(current));
+        break;
+
+      case D3DTOP_PREMODULATE:
+        Logger::warn("D3DTOP_PREMODULATE: not implemented");
+        break;
+
+      case D3DTOP_MODULATEALPHA_ADDCOLOR:
+        dst = m_module.opFFma(m_vec4Type, emitAlphaReplicate(arg[1]), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATECOLOR_ADDALPHA:
+        dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], emitAlphaReplicate(arg[1]));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATEINVALPHA_ADDCOLOR:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(emitAlphaReplicate(arg[1])), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATEINVCOLOR_ADDALPHA:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(arg[1]), arg[2], emitAlphaReplicate(arg[1]));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BUMPENVMAPLUMINANCE:
+      case D3DTOP_BUMPENVMAP:
+        // Load texture for the next stage...
+        getTexture();
+        break;
+
+      case D3DTOP_DOTPRODUCT3: {
+        // Get vec3 of arg1 & 2
+        uint32_t vec3Type = m_module.defVectorType(m_floatType, 3);
+        std::array<uint32_t, 3> indices = { 0, 1, 2 };
+        arg[1] = m_module.opVectorShuffle(vec3Type, arg[1], arg[1], indices.size(), indices.data());
+        arg[2] = m_module.opVectorShuffle(vec3Type, arg[2], arg[2], indices.size(), indices.data());
+
+        // Bias according to spec.
+        arg[1] = m_module.opFSub(vec3Type, arg[1], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
+        arg[2] = m_module.opFSub(vec3Type, arg[2], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
+
+        // Do the dotting!
+        dst = m_module.opDot(m_floatType, arg[1], arg[2]);
+
+        // Multiply by 4 and replicate -> vec4
+        dst = m_module.opFMul(m_floatType, dst, m_module.constf32(4.0f));
+        dst = emitScalarReplicate(dst);
+
+        // Saturate
+        dst = emitSaturate(dst);
+
+        break;
+      }
+
+      case D3DTOP_MULTIPLYADD:
+        dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], arg[0]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_LERP:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], arg[0]);
+        break;
+
+      default:
+        Logger::warn("Unhandled texture op!");
+        break;
+    }
+
+    return dst;
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitScalarReplicate(uint32_t reg) {
+    std::array<uint32_t, 4> replicant = { reg, reg, reg, reg };
+    return m_module.opCompositeConstruct(m_vec4Type, replicant.size(), replicant.data());
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitAlphaReplicate(uint32_t reg) {
+    uint32_t alphaComponentId = 3;
+    uint32_t alpha = m_module.opCompositeExtract(m_floatType, reg, 1, &alphaComponentId);
+
+    return emitScalarReplicate(alpha);
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitComplement(uint32_t reg) {
+    return m_module.opFSub(m_vec4Type,
+      m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f),
+      reg);
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitSaturate(uint32_t reg) {
+    return m_module.opFClamp(m_vec4Type, reg,
+      m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f),
+      m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f));
   }
 
+
+  uint32_t D3D9FFShaderCompiler::emitSelectVec4(uint32_t cond, uint32_t a, uint32_t b) {
+    // Expand condition to bvec4 since the result has four components
+    std::array<uint32_t, 4> condIds = { cond, cond, cond, cond };
+
+    cond = m_module.opCompositeConstruct(
+      m_module.defVectorType(m_module.defBoolType(), 4),
+      condIds.size(), condIds.data());
+
+    return m_module.opSelect(m_vec4Type, cond, a, b);
+  }
+
+
   void D3D9FFShaderCompiler::setupPS() {
     setupRenderStateInfo();
     m_specUbo = SetupSpecUBO(m_module, m_bindings);
@@ -2256,14 +2740,11 @@ namespace dxvk {
     m_ps.constants.textureFactor = LoadConstant(m_vec4Type, uint32_t(D3D9FFPSMembers::TextureFactor));
 
     // Samplers
-    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
-      auto& sampler = m_ps.samplers[i];
-      D3DRESOURCETYPE type = D3DRESOURCETYPE(m_fsKey.Stages[i].Contents.Type + D3DRTYPE_TEXTURE);
-
+    auto DeclareSampler = [&](uint32_t stage, uint32_t type, VkImageViewType& viewType) {
+      D3D9FFPixelData::Sampler sampler;
       spv::Dim dimensionality;
-      VkImageViewType viewType;
 
-      switch (type) {
+      switch (D3DRESOURCETYPE(type + D3DRTYPE_TEXTURE)) {
         default:
         case D3DRTYPE_TEXTURE:
           dimensionality = spv::Dim2D;
@@ -2294,18 +2775,34 @@ namespace dxvk {
           sampler.typeId, spv::StorageClassUniformConstant),
         spv::StorageClassUniformConstant);
 
-      std::string name = str::format("s", i);
+      std::string name = str::format("s", stage);
       m_module.setDebugName(sampler.varId, name.c_str());
 
       const uint32_t bindingId = computeResourceSlotId(DxsoProgramType::PixelShader,
-        DxsoBindingType::Image, i);
+        DxsoBindingType::Image, stage);
 
       m_module.decorateDescriptorSet(sampler.varId, 0);
       m_module.decorateBinding(sampler.varId, bindingId);
+      return sampler;
+    };
+
+    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+      VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_MAX_ENUM;
+
+      if (m_uber) {
+        // Could be any of these, the shader checks the stage
+        // type at runtime, so leave the binding view type open.
+        VkImageViewType samplerViewType;
+
+        for (uint32_t j = 0; j < 3; j++)
+          m_ps.uberSamplers[i][j] = DeclareSampler(i, j, samplerViewType);
+      } else {
+        m_ps.samplers[i] = DeclareSampler(i, m_fsKey.Stages[i].Contents.Type, viewType);
+      }
 
       // Store descriptor info for the shader interface
       DxvkBindingInfo binding = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER };
-      binding.resourceBinding = bindingId;
+      binding.resourceBinding = computeResourceSlotId(DxsoProgramType::PixelShader, DxsoBindingType::Image, i);
       binding.viewType        = viewType;
       binding.access          = VK_ACCESS_SHADER_READ_BIT;
       m_bindings.push_back(binding);
@@ -2502,6 +2999,27 @@ namespace dxvk {
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
 
+
+  D3D9FFShader::D3D9FFShader(
+          D3D9DeviceEx*         pDevice) {
+    std::string name = "FF_UBER_PS";
+
+    Sha1Hash hash = Sha1Hash::compute(name.data(), name.size());
+    DxvkShaderKey shaderKey = { VK_SHADER_STAGE_FRAGMENT_BIT, hash };
+
+    D3D9FFShaderCompiler compiler(
+      pDevice->GetDXVKDevice(),
+      name, pDevice->GetOptions());
+
+    m_shader = compiler.compile();
+    m_isgn   = compiler.isgn();
+
+    Dump(pDevice, name, name);
+
+    m_shader->setShaderKey(shaderKey);
+    pDevice->GetDXVKDevice()->registerShader(m_shader);
+  }
+
   template <typename T>
   void D3D9FFShader::Dump(D3D9DeviceEx* pDevice, const T& Key, const std::string& Name) {
     const std::string& dumpPath = pDevice->GetOptions()->shaderDumpPath;
@@ -2536,11 +3054,24 @@ namespace dxvk {
   D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
           D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyFS&    ShaderKey) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
     // Use the shader's unique key for the lookup
     auto entry = m_fsModules.find(ShaderKey);
     if (entry != m_fsModules.end())
       return entry->second;
-    
+
+    // Compile specialized shader in the background and
+    // use the über shader until it becomes available
+    if (m_fsUberShader) {
+      if (!m_stopped && m_fsPending.insert(ShaderKey).second) {
+        m_fsQueue.push(ShaderKey);
+        m_cond.notify_one();
+      }
+
+      return *m_fsUberShader;
+    }
+
     D3D9FFShader shader(
       pDevice, ShaderKey);
 
@@ -2550,6 +3081,66 @@ namespace dxvk {
   }
 
 
+  D3D9FFShaderModuleSet::~D3D9FFShaderModuleSet() {
+    StopWorker();
+  }
+
+
+  void D3D9FFShaderModuleSet::EnableUberShader(
+          D3D9DeviceEx*         pDevice) {
+    m_device = pDevice;
+    m_fsUberShader.emplace(pDevice);
+
+    m_worker = dxvk::thread([this] { runWorker(); });
+  }
+
+
+  bool D3D9FFShaderModuleSet::IsShaderModuleReady(
+    const D3D9FFShaderKeyFS&    ShaderKey) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    return m_fsModules.find(ShaderKey) != m_fsModules.end();
+  }
+
+
+  void D3D9FFShaderModuleSet::StopWorker() {
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped = true;
+      m_cond.notify_one();
+    }
+
+    if (m_worker.joinable())
+      m_worker.join();
+  }
+
+
+  void D3D9FFShaderModuleSet::runWorker() {
+    env::setThreadName("dxvk-ff-shader");
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    while (true) {
+      m_cond.wait(lock, [this] {
+        return m_stopped || !m_fsQueue.empty();
+      });
+
+      if (m_stopped)
+        return;
+
+      D3D9FFShaderKeyFS key = m_fsQueue.front();
+      m_fsQueue.pop();
+
+      lock.unlock();
+
+      D3D9FFShader shader(m_device, key);
+
+      lock.lock();
+
+      m_fsModules.insert({ key, shader });
+      m_fsPending.erase(key);
+    }
+  }
+
+
   size_t D3D9FFShaderKeyHash::operator () (const D3D9FFShaderKeyVS& key) const {
     DxvkHashState state;
 
@@ -8,8 +8,13 @@
 
 #include "../dxso/dxso_isgn.h"
 
+#include "../util/thread.h"
+
 #include <unordered_map>
+#include <unordered_set>
 #include <bitset>
+#include <optional>
+#include <queue>
 
 namespace dxvk {
 
@@ -190,6 +195,14 @@ namespace dxvk {
     D3D9FFShaderStage Stages[caps::TextureStageCount];
   };
 
+  /**
+   * \brief Packs texture stage for the über pixel shader
+   *
+   * \param [in] Stage Texture stage key
+   * \param [out] pDwords Two dwords of packed stage data
+   */
+  void PackFFShaderStage(const D3D9FFShaderStage& Stage, uint32_t* pDwords);
+
   struct D3D9FFShaderKeyHash {
     size_t operator () (const D3D9FFShaderKeyVS& key) const;
     size_t operator () (const D3D9FFShaderKeyFS& key) const;
@@ -217,6 +230,17 @@ namespace dxvk {
             D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyFS&    Key);
 
+    /**
+     * \brief Creates über pixel shader
+     *
+     * Implements all texture stage states at runtime
+     * based on the stage data in the shared pixel
+     * shader constants.
+     * \param [in] pDevice Device
+     */
+    D3D9FFShader(
+            D3D9DeviceEx*         pDevice);
+
     template <typename T>
     void Dump(D3D9DeviceEx* pDevice, const T& Key, const std::string& Name);
 
@@ -237,16 +261,80 @@ namespace dxvk {
 
   public:
 
+    ~D3D9FFShaderModuleSet();
+
     D3D9FFShader GetShaderModule(
             D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyVS&    ShaderKey);
 
+    /**
+     * \brief Retrieves pixel shader module
+     *
+     * If the über shader is enabled and no specialized
+     * shader exists for the given key yet, this queues
+     * the key for compilation on the worker thread and
+     * returns the über shader in the meantime.
+     * \param [in] pDevice Device
+     * \param [in] ShaderKey Fixed function state
+     * \returns Shader module to bind
+     */
     D3D9FFShader GetShaderModule(
             D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyFS&    ShaderKey);
 
+    /**
+     * \brief Enables the über pixel shader
+     *
+     * Compiles the über shader and starts the
+     * worker thread for specialized shaders.
+     * \param [in] pDevice Device
+     */
+    void EnableUberShader(
+            D3D9DeviceEx*         pDevice);
+
+    /**
+     * \brief Checks whether a specialized pixel shader is ready
+     *
+     * \param [in] ShaderKey Fixed function state
+     * \returns \c true if the shader has been compiled
+     */
+    bool IsShaderModuleReady(
+      const D3D9FFShaderKeyFS&    ShaderKey);
+
+    /**
+     * \brief Checks whether the über shader is enabled
+     * \returns \c true if the über shader is used
+     */
+    bool HasUberShader() const {
+      return m_fsUberShader.has_value();
+    }
+
+    /**
+     * \brief Stops the worker thread
+     *
+     * Must be called before the device gets destroyed.
+     * Any keys still in the queue will be discarded.
+     */
+    void StopWorker();
+
   private:
 
+    D3D9DeviceEx*                       m_device = nullptr;
+
+    dxvk::mutex                         m_mutex;
+    dxvk::condition_variable            m_cond;
+    dxvk::thread                        m_worker;
+    bool                                m_stopped = false;
+
+    std::queue<D3D9FFShaderKeyFS>       m_fsQueue;
+    std::unordered_set<
+      D3D9FFShaderKeyFS,
+      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq> m_fsPending;
+
+    std::optional<D3D9FFShader>         m_fsUberShader;
+
+    void runWorker();
+
     std::unordered_map<
       D3D9FFShaderKeyVS,
       D3D9FFShader,
@@ -33,6 +33,51 @@ namespace dxvk::hud {
     return position;
   }
 
+  HudUPBufferUsage::HudUPBufferUsage(D3D9DeviceEx* device)
+    : m_device      (device)
+    , m_frameBytes  ("0 kB")
+    , m_ringSize    ("0 MB") {
+
+  }
+
+
+  void HudUPBufferUsage::update(dxvk::high_resolution_clock::time_point time) {
+    m_frameBytes = str::format(m_device->GetUPBufferFrameBytes() >> 10, " kB");
+    m_ringSize = str::format(m_device->GetUPBufferRingSize() >> 20, " MB");
+  }
+
+
+  HudPos HudUPBufferUsage::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.0f, 1.0f, 0.75f, 1.0f },
+      "UP data:");
+
+    renderer.drawText(16.0f,
+      { position.x + 120.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_frameBytes);
+
+    position.y += 24.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.0f, 1.0f, 0.75f, 1.0f },
+      "UP ring:");
+
+    renderer.drawText(16.0f,
+      { position.x + 120.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_ringSize);
+
+    position.y += 8.0f;
+    return position;
+  }
+
   HudTextureMemory::HudTextureMemory(D3D9DeviceEx* device)
           : m_device          (device)
           , m_allocatedString ("")
@@ -26,6 +26,30 @@ namespace dxvk::hud {
 
     std::string m_samplerCount;
 
+  };
+
+  /**
+   * \brief HUD item to display UP draw data per frame
+   */
+  class HudUPBufferUsage : public HudItem {
+
+  public:
+
+    HudUPBufferUsage(D3D9DeviceEx* device);
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    D3D9DeviceEx* m_device;
+
+    std::string m_frameBytes;
+    std::string m_ringSize;
+
   };
 
     /**
@@ -110,6 +110,14 @@ namespace dxvk {
     /// Works around a game bug in Halo CE where it gives cube textures to 2d/volume samplers
     bool forceSamplerTypeSpecConstants;
 
+    /// Use an über pixel shader for fixed function texture stages
+    /// while specialized shaders get compiled in the background
+    bool ffUbershader;
+
+    /// Run ProcessVertices with programmable vertex
+    /// shaders on the CPU instead of the GPU
+    bool cpuVertexProcessing;
+
     /// Forces an MSAA level on the swapchain
     int32_t forceSwapchainMSAA;
 
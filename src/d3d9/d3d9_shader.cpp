@@ -54,22 +54,41 @@ namespace dxvk {
     const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
       ? pDevice->GetVertexConstantLayout()
       : pDevice->GetPixelConstantLayout();
-    m_shader       = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
-    m_isgn         = pModule->isgn();
-    m_usedSamplers = pModule->usedSamplers();
 
-    // Shift up these sampler bits so we can just
-    // do an or per-draw in the device.
-    // We shift by 17 because 16 ps samplers + 1 dmap (tess)
-    if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT)
-      m_usedSamplers <<= caps::MaxTexturesPS + 1;
+    // Check whether the shader has been compiled in a previous
+    // session, and restore the shader metadata if it has.
+    DxvkShaderCache& shaderCache = pDevice->GetDXVKDevice()->shaderCache();
 
-    m_usedRTs      = pModule->usedRTs();
+    Sha1Hash cacheKey = GetCacheKey(Key, pDxsoModuleInfo, constantLayout);
+    std::vector<char> cacheMetadata;
 
-    m_info      = pModule->info();
-    m_meta      = pModule->meta();
-    m_constants = pModule->constants();
-    m_maxDefinedConst = pModule->maxDefinedConstant();
+    if (shaderCache.isEnabled())
+      m_shader = shaderCache.lookupShader(cacheKey, cacheMetadata);
+
+    if (m_shader != nullptr && !ReadCacheMetadata(cacheMetadata))
+      m_shader = nullptr;
+
+    if (m_shader == nullptr) {
+      m_shader       = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
+      m_isgn         = pModule->isgn();
+      m_usedSamplers = pModule->usedSamplers();
+
+      // Shift up these sampler bits so we can just
+      // do an or per-draw in the device.
+      // We shift by 17 because 16 ps samplers + 1 dmap (tess)
+      if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT)
+        m_usedSamplers <<= caps::MaxTexturesPS + 1;
+
+      m_usedRTs      = pModule->usedRTs();
+
+      m_info      = pModule->info();
+      m_meta      = pModule->meta();
+      m_constants = pModule->constants();
+      m_maxDefinedConst = pModule->maxDefinedConstant();
+
+      if (shaderCache.isEnabled())
+        shaderCache.storeShader(cacheKey, m_shader, WriteCacheMetadata());
+    }
 
     m_shader->setShaderKey(Key);
 
@@ -85,6 +104,66 @@ namespace dxvk {
   }
 
 
+  Sha1Hash D3D9CommonShader::GetCacheKey(
+    const DxvkShaderKey&        Key,
+    const DxsoModuleInfo*       pDxsoModuleInfo,
+    const D3D9ConstantLayout&   ConstantLayout) {
+    const DxsoOptions& options = pDxsoModuleInfo->options;
+
+    DxvkShaderCacheWriter writer;
+    writer.write(Key.type());
+    writer.write(Key.sha1());
+    writer.write(options.strictConstantCopies);
+    writer.write(options.d3d9FloatEmulation);
+    writer.write(options.strictPow);
+    writer.write(options.shaderModel);
+    writer.write(options.invariantPosition);
+    writer.write(options.forceSamplerTypeSpecConstants);
+    writer.write(options.forceSampleRateShading);
+    writer.write(options.vertexFloatConstantBufferAsSSBO);
+    writer.write(options.longMad);
+    writer.write(options.robustness2Supported);
+    writer.write(ConstantLayout.floatCount);
+    writer.write(ConstantLayout.intCount);
+    writer.write(ConstantLayout.boolCount);
+    writer.write(ConstantLayout.bitmaskCount);
+    return writer.computeHash();
+  }
+
+
+  std::vector<char> D3D9CommonShader::WriteCacheMetadata() const {
+    DxvkShaderCacheWriter writer;
+    writer.write(m_isgn);
+    writer.write(m_usedSamplers);
+    writer.write(m_usedRTs);
+    writer.write(m_info);
+    writer.write(m_meta);
+    writer.write(m_maxDefinedConst);
+    writer.write(uint32_t(m_constants.size()));
+    writer.write(m_constants.data(), m_constants.size() * sizeof(DxsoDefinedConstant));
+    return writer.data();
+  }
+
+
+  bool D3D9CommonShader::ReadCacheMetadata(
+    const std::vector<char>&    Metadata) {
+    DxvkShaderCacheReader reader(Metadata.data(), Metadata.size());
+    uint32_t constantCount = 0;
+
+    if (!reader.read(m_isgn)
+     || !reader.read(m_usedSamplers)
+     || !reader.read(m_usedRTs)
+     || !reader.read(m_info)
+     || !reader.read(m_meta)
+     || !reader.read(m_maxDefinedConst)
+     || !reader.read(constantCount))
+      return false;
+
+    m_constants.resize(constantCount);
+    return reader.read(m_constants.data(), m_constants.size() * sizeof(DxsoDefinedConstant));
+  }
+
+
   void D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
             D3D9CommonShader*     pShaderModule,
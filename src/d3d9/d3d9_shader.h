@@ -67,6 +67,16 @@ namespace dxvk {
 
     Rc<DxvkShader>        m_shader;
 
+    static Sha1Hash GetCacheKey(
+      const DxvkShaderKey&        Key,
+      const DxsoModuleInfo*       pDxsoModuleInfo,
+      const D3D9ConstantLayout&   ConstantLayout);
+
+    std::vector<char> WriteCacheMetadata() const;
+
+    bool ReadCacheMetadata(
+      const std::vector<char>&    Metadata);
+
   };
 
   /**
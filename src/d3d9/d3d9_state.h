@@ -147,6 +147,7 @@ namespace dxvk {
     D3D9SharedPSStages_BumpEnvMat1,
     D3D9SharedPSStages_BumpEnvLScale,
     D3D9SharedPSStages_BumpEnvLOffset,
+    D3D9SharedPSStages_FFKey,
     D3D9SharedPSStages_Count,
   };
 
@@ -156,7 +157,7 @@ namespace dxvk {
       float BumpEnvMat[2][2];
       float BumpEnvLScale;
       float BumpEnvLOffset;
-      float Padding[2];
+      uint32_t FFKey[2];
     } Stages[8];
   };
   
@@ -56,6 +56,8 @@ namespace dxvk {
 
 
   HRESULT STDMETHODCALLTYPE D3D9StateBlock::Apply() {
+    D3D9DeviceLock lock = m_parent->LockDevice();
+
     m_applying = true;
 
     if (m_captures.flags.test(D3D9CapturedStateFlag::VertexDecl) && m_state.vertexDecl != nullptr)
@@ -572,8 +574,100 @@ namespace dxvk {
       m_captures.flags.set(D3D9CapturedStateFlag::Material);
     }
 
+    m_program.Compile(m_captures);
+
     if (Type != D3D9StateBlockType::None)
       this->Capture();
   }
 
+
+  template <size_t Bits>
+  static void CompileConstantRanges(
+    const bit::bitset<Bits>&              captures,
+          std::vector<D3D9StateRange>&    ranges) {
+    for (uint32_t i = 0; i < captures.dwordCount(); i++) {
+      for (uint32_t bit : bit::BitMask(captures.dword(i))) {
+        uint32_t idx = i * 32 + bit;
+
+        if (!ranges.empty() && ranges.back().start + ranges.back().count == idx)
+          ranges.back().count += 1;
+        else
+          ranges.push_back({ uint16_t(idx), uint16_t(1) });
+      }
+    }
+  }
+
+
+  template <size_t Bits>
+  static void CompileBoolMasks(
+    const bit::bitset<Bits>&              captures,
+          std::vector<D3D9StateBoolMask>& masks) {
+    for (uint32_t i = 0; i < captures.dwordCount(); i++) {
+      if (captures.dword(i))
+        masks.push_back({ i, captures.dword(i) });
+    }
+  }
+
+
+  template <size_t Bits>
+  static void CompileIndices(
+    const bit::bitset<Bits>&              captures,
+          std::vector<uint16_t>&          indices) {
+    for (uint32_t i = 0; i < captures.dwordCount(); i++) {
+      for (uint32_t bit : bit::BitMask(captures.dword(i)))
+        indices.push_back(uint16_t(i * 32 + bit));
+    }
+  }
+
+
+  void D3D9StateProgram::Compile(const D3D9StateCaptures& captures) {
+    *this = D3D9StateProgram();
+
+    m_flags = captures.flags;
+
+    m_streamFreq    = captures.streamFreq.dword(0);
+    m_vertexBuffers = captures.vertexBuffers.dword(0);
+    m_textures      = captures.textures.dword(0);
+    m_clipPlanes    = captures.clipPlanes.dword(0);
+
+    if (m_flags.test(D3D9CapturedStateFlag::RenderStates))
+      CompileIndices(captures.renderStates, m_renderStates);
+
+    if (m_flags.test(D3D9CapturedStateFlag::SamplerStates)) {
+      for (uint32_t samplerIdx : bit::BitMask(captures.samplers.dword(0))) {
+        for (uint32_t stateIdx : bit::BitMask(captures.samplerStates[samplerIdx].dword(0)))
+          m_samplerStates.push_back({ uint8_t(samplerIdx), uint8_t(stateIdx) });
+      }
+    }
+
+    if (m_flags.test(D3D9CapturedStateFlag::Transforms))
+      CompileIndices(captures.transforms, m_transforms);
+
+    if (m_flags.test(D3D9CapturedStateFlag::TextureStages)) {
+      for (uint32_t stageIdx : bit::BitMask(captures.textureStages.dword(0))) {
+        for (uint32_t stateIdx : bit::BitMask(captures.textureStageStates[stageIdx].dword(0)))
+          m_textureStageStates.push_back({ uint8_t(stageIdx), uint8_t(stateIdx) });
+      }
+    }
+
+    if (m_flags.test(D3D9CapturedStateFlag::VsConstants)) {
+      CompileConstantRanges(captures.vsConsts.fConsts, m_vsConstsF);
+      CompileConstantRanges(captures.vsConsts.iConsts, m_vsConstsI);
+      CompileBoolMasks(captures.vsConsts.bConsts, m_vsConstsB);
+    }
+
+    if (m_flags.test(D3D9CapturedStateFlag::PsConstants)) {
+      CompileConstantRanges(captures.psConsts.fConsts, m_psConstsF);
+      CompileConstantRanges(captures.psConsts.iConsts, m_psConstsI);
+      CompileBoolMasks(captures.psConsts.bConsts, m_psConstsB);
+    }
+
+    if (m_flags.test(D3D9CapturedStateFlag::Lights)) {
+      for (uint32_t i = 0; i < captures.lightEnabledChanges.dwordCount(); i++) {
+        for (uint32_t bit : bit::BitMask(captures.lightEnabledChanges.dword(i)))
+          m_lightEnables.push_back(uint16_t(i * 32 + bit));
+      }
+    }
+  }
+
 }
@@ -66,6 +66,252 @@ namespace dxvk {
     bit::bitvector                                      lightEnabledChanges;
   };
 
+  /**
+   * \brief Captured sampler or texture stage state
+   */
+  struct D3D9StateIndex {
+    uint8_t slot;
+    uint8_t state;
+  };
+
+  /**
+   * \brief Captured range of constant registers
+   */
+  struct D3D9StateRange {
+    uint16_t start;
+    uint16_t count;
+  };
+
+  /**
+   * \brief Captured bool constants within one dword
+   */
+  struct D3D9StateBoolMask {
+    uint32_t dword;
+    uint32_t mask;
+  };
+
+  /**
+   * \brief Compiled state block program
+   *
+   * Flat lists of the state captured by a state block, so that
+   * Apply and Capture do not have to iterate over the capture
+   * bitsets. Consecutive constant registers are merged into
+   * ranges, which are then set with one call each.
+   */
+  class D3D9StateProgram {
+
+  public:
+
+    /**
+     * \brief Compiles captured state
+     *
+     * Must be called whenever the set of captured state changes.
+     * \param [in] captures Captured state
+     */
+    void Compile(const D3D9StateCaptures& captures);
+
+    /**
+     * \brief Copies captured state
+     *
+     * If the current destination state is provided, any state that
+     * already matches the source is skipped rather than going through
+     * the setter. Callers must not do this while the destination is
+     * recording a state block, since skipped state would be lost.
+     * \param [in] dst Destination device or state block
+     * \param [in] src Source state
+     * \param [in] cur Current destination state, or \c nullptr
+     */
+    template <typename Dst, typename Src>
+    void Execute(Dst* dst, const Src* src, const D3D9DeviceState* cur) const {
+      if (m_flags.test(D3D9CapturedStateFlag::StreamFreq)) {
+        for (uint32_t idx : bit::BitMask(m_streamFreq)) {
+          if (!cur || cur->streamFreq[idx] != src->streamFreq[idx])
+            dst->SetStreamSourceFreq(idx, src->streamFreq[idx]);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::Indices)) {
+        if (!cur || cur->indices.ptr() != src->indices.ptr())
+          dst->SetIndices(src->indices.ptr());
+      }
+
+      if (!m_renderStates.empty()) {
+        const auto* renderStates = &src->renderStates;
+
+        for (uint32_t idx : m_renderStates) {
+          DWORD value = (*renderStates)[idx];
+
+          if (!cur || cur->renderStates[idx] != value)
+            dst->SetRenderState(D3DRENDERSTATETYPE(idx), value);
+        }
+      }
+
+      if (!m_samplerStates.empty()) {
+        const auto* samplerStates = &src->samplerStates;
+
+        for (const auto& entry : m_samplerStates) {
+          DWORD value = (*samplerStates)[entry.slot][entry.state];
+
+          if (!cur || cur->samplerStates[entry.slot][entry.state] != value)
+            dst->SetStateSamplerState(entry.slot, D3DSAMPLERSTATETYPE(entry.state), value);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::VertexBuffers)) {
+        for (uint32_t idx : bit::BitMask(m_vertexBuffers)) {
+          const auto& vbo = src->vertexBuffers[idx];
+
+          if (cur) {
+            const auto& curVbo = cur->vertexBuffers[idx];
+
+            if (curVbo.vertexBuffer.ptr() == vbo.vertexBuffer.ptr()
+             && curVbo.offset == vbo.offset
+             && curVbo.stride == vbo.stride)
+              continue;
+          }
+
+          dst->SetStreamSource(
+            idx,
+            vbo.vertexBuffer.ptr(),
+            vbo.offset,
+            vbo.stride);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::Material)) {
+        if (!cur || std::memcmp(&cur->material, &src->material, sizeof(D3DMATERIAL9)))
+          dst->SetMaterial(&src->material);
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::Textures)) {
+        for (uint32_t idx : bit::BitMask(m_textures)) {
+          if (!cur || cur->textures[idx] != src->textures[idx])
+            dst->SetStateTexture(idx, src->textures[idx]);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::VertexShader)) {
+        if (!cur || cur->vertexShader.ptr() != src->vertexShader.ptr())
+          dst->SetVertexShader(src->vertexShader.ptr());
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::PixelShader)) {
+        if (!cur || cur->pixelShader.ptr() != src->pixelShader.ptr())
+          dst->SetPixelShader(src->pixelShader.ptr());
+      }
+
+      if (!m_transforms.empty()) {
+        const auto* transforms = &src->transforms;
+
+        for (uint32_t idx : m_transforms) {
+          const Matrix4& value = (*transforms)[idx];
+
+          if (!cur || std::memcmp(&cur->transforms[idx], &value, sizeof(Matrix4)))
+            dst->SetStateTransform(idx, reinterpret_cast<const D3DMATRIX*>(&value));
+        }
+      }
+
+      if (!m_textureStageStates.empty()) {
+        const auto* textureStages = &src->textureStages;
+
+        for (const auto& entry : m_textureStageStates) {
+          DWORD value = (*textureStages)[entry.slot][entry.state];
+
+          if (!cur || cur->textureStages[entry.slot][entry.state] != value)
+            dst->SetStateTextureStageState(entry.slot, D3D9TextureStageStateTypes(entry.state), value);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::Viewport)) {
+        if (!cur || cur->viewport != src->viewport)
+          dst->SetViewport(&src->viewport);
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::ScissorRect)) {
+        if (!cur || cur->scissorRect != src->scissorRect)
+          dst->SetScissorRect(&src->scissorRect);
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::ClipPlanes)) {
+        for (uint32_t idx : bit::BitMask(m_clipPlanes)) {
+          const auto& plane = src->clipPlanes[idx];
+
+          if (!cur || std::memcmp(&cur->clipPlanes[idx], &plane, sizeof(plane)))
+            dst->SetClipPlane(idx, plane.coeff);
+        }
+      }
+
+      // Constants are not compared since the device also uses
+      // the set of written registers to determine upload sizes.
+      if (m_flags.test(D3D9CapturedStateFlag::VsConstants)) {
+        for (const auto& range : m_vsConstsF)
+          dst->SetVertexShaderConstantF(range.start, src->vsConsts->fConsts[range.start].data, range.count);
+
+        for (const auto& range : m_vsConstsI)
+          dst->SetVertexShaderConstantI(range.start, src->vsConsts->iConsts[range.start].data, range.count);
+
+        for (const auto& entry : m_vsConstsB) {
+          uint32_t bits = src->vsConsts->bConsts[entry.dword];
+
+          if (!cur || ((cur->vsConsts->bConsts[entry.dword] ^ bits) & entry.mask))
+            dst->SetVertexBoolBitfield(entry.dword, entry.mask, bits);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::PsConstants)) {
+        for (const auto& range : m_psConstsF)
+          dst->SetPixelShaderConstantF(range.start, src->psConsts->fConsts[range.start].data, range.count);
+
+        for (const auto& range : m_psConstsI)
+          dst->SetPixelShaderConstantI(range.start, src->psConsts->iConsts[range.start].data, range.count);
+
+        for (const auto& entry : m_psConstsB) {
+          uint32_t bits = src->psConsts->bConsts[entry.dword];
+
+          if (!cur || ((cur->psConsts->bConsts[entry.dword] ^ bits) & entry.mask))
+            dst->SetPixelBoolBitfield(entry.dword, entry.mask, bits);
+        }
+      }
+
+      if (m_flags.test(D3D9CapturedStateFlag::Lights)) {
+        for (uint32_t i = 0; i < src->lights.size(); i++) {
+          if (!src->lights[i].has_value())
+            continue;
+
+          dst->SetLight(i, &src->lights[i].value());
+        }
+
+        for (uint32_t idx : m_lightEnables)
+          dst->LightEnable(idx, src->IsLightEnabled(idx));
+      }
+    }
+
+  private:
+
+    D3D9CapturedStateFlags          m_flags;
+
+    uint32_t                        m_streamFreq    = 0;
+    uint32_t                        m_vertexBuffers = 0;
+    uint32_t                        m_textures      = 0;
+    uint32_t                        m_clipPlanes    = 0;
+
+    std::vector<uint16_t>           m_renderStates;
+    std::vector<D3D9StateIndex>     m_samplerStates;
+    std::vector<uint16_t>           m_transforms;
+    std::vector<D3D9StateIndex>     m_textureStageStates;
+
+    std::vector<D3D9StateRange>     m_vsConstsF;
+    std::vector<D3D9StateRange>     m_vsConstsI;
+    std::vector<D3D9StateBoolMask>  m_vsConstsB;
+
+    std::vector<D3D9StateRange>     m_psConstsF;
+    std::vector<D3D9StateRange>     m_psConstsI;
+    std::vector<D3D9StateBoolMask>  m_psConstsB;
+
+    std::vector<uint16_t>           m_lightEnables;
+
+  };
+
   enum class D3D9StateBlockType :uint32_t {
     None,
     VertexState,
@@ -181,155 +427,22 @@ namespace dxvk {
       Capture
     };
 
-    template <typename Dst, typename Src>
-    void ApplyOrCapture(Dst* dst, const Src* src) {
-      if (m_captures.flags.test(D3D9CapturedStateFlag::StreamFreq)) {
-        for (uint32_t idx : bit::BitMask(m_captures.streamFreq.dword(0)))
-          dst->SetStreamSourceFreq(idx, src->streamFreq[idx]);
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Indices))
-        dst->SetIndices(src->indices.ptr());
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::RenderStates)) {
-        for (uint32_t i = 0; i < m_captures.renderStates.dwordCount(); i++) {
-          for (uint32_t rs : bit::BitMask(m_captures.renderStates.dword(i))) {
-            uint32_t idx = i * 32 + rs;
-
-            dst->SetRenderState(D3DRENDERSTATETYPE(idx), src->renderStates[idx]);
-          }
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::SamplerStates)) {
-        for (uint32_t samplerIdx : bit::BitMask(m_captures.samplers.dword(0))) {
-          for (uint32_t stateIdx : bit::BitMask(m_captures.samplerStates[samplerIdx].dword(0)))
-            dst->SetStateSamplerState(samplerIdx, D3DSAMPLERSTATETYPE(stateIdx), src->samplerStates[samplerIdx][stateIdx]);
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::VertexBuffers)) {
-        for (uint32_t idx : bit::BitMask(m_captures.vertexBuffers.dword(0))) {
-          const auto& vbo = src->vertexBuffers[idx];
-          dst->SetStreamSource(
-            idx,
-            vbo.vertexBuffer.ptr(),
-            vbo.offset,
-            vbo.stride);
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Material))
-        dst->SetMaterial(&src->material);
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Textures)) {
-        for (uint32_t idx : bit::BitMask(m_captures.textures.dword(0)))
-          dst->SetStateTexture(idx, src->textures[idx]);
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::VertexShader))
-        dst->SetVertexShader(src->vertexShader.ptr());
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::PixelShader))
-        dst->SetPixelShader(src->pixelShader.ptr());
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Transforms)) {
-        for (uint32_t i = 0; i < m_captures.transforms.dwordCount(); i++) {
-          for (uint32_t trans : bit::BitMask(m_captures.transforms.dword(i))) {
-            uint32_t idx = i * 32 + trans;
-
-            dst->SetStateTransform(idx, reinterpret_cast<const D3DMATRIX*>(&src->transforms[idx]));
-          }
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::TextureStages)) {
-        for (uint32_t stageIdx : bit::BitMask(m_captures.textureStages.dword(0))) {
-          for (uint32_t stateIdx : bit::BitMask(m_captures.textureStageStates[stageIdx].dword(0)))
-            dst->SetStateTextureStageState(stageIdx, D3D9TextureStageStateTypes(stateIdx), src->textureStages[stageIdx][stateIdx]);
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Viewport))
-        dst->SetViewport(&src->viewport);
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::ScissorRect))
-        dst->SetScissorRect(&src->scissorRect);
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::ClipPlanes)) {
-        for (uint32_t idx : bit::BitMask(m_captures.clipPlanes.dword(0)))
-          dst->SetClipPlane(idx, src->clipPlanes[idx].coeff);
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::VsConstants)) {
-        for (uint32_t i = 0; i < m_captures.vsConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetVertexShaderConstantF(idx, (float*)&src->vsConsts->fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.vsConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetVertexShaderConstantI(idx, (int*)&src->vsConsts->iConsts[idx], 1);
-          }
-        }
-
-        if (m_captures.vsConsts.bConsts.any()) {
-          for (uint32_t i = 0; i < m_captures.vsConsts.bConsts.dwordCount(); i++)
-            dst->SetVertexBoolBitfield(i, m_captures.vsConsts.bConsts.dword(i), src->vsConsts->bConsts[i]);
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::PsConstants)) {
-        for (uint32_t i = 0; i < m_captures.psConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetPixelShaderConstantF(idx, (float*)&src->psConsts->fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.psConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetPixelShaderConstantI(idx, (int*)&src->psConsts->iConsts[idx], 1);
-          }
-        }
-
-        if (m_captures.psConsts.bConsts.any()) {
-          for (uint32_t i = 0; i < m_captures.psConsts.bConsts.dwordCount(); i++)
-            dst->SetPixelBoolBitfield(i, m_captures.psConsts.bConsts.dword(i), src->psConsts->bConsts[i]);
-        }
-      }
-
-      if (m_captures.flags.test(D3D9CapturedStateFlag::Lights)) {
-        for (uint32_t i = 0; i < src->lights.size(); i++) {
-          if (!src->lights[i].has_value())
-            continue;
-
-          dst->SetLight(i, &src->lights[i].value());
-        }
-        for (uint32_t i = 0; i < m_captures.lightEnabledChanges.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.lightEnabledChanges.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->LightEnable(idx, src->IsLightEnabled(idx));
-          }
-        }
-      }
-    }
-
     template <D3D9StateFunction Func>
     void ApplyOrCapture() {
       if      constexpr (Func == D3D9StateFunction::Apply)
-        ApplyOrCapture(m_parent, &m_state);
+        m_program.Execute(m_parent, &m_state, m_parent->IsRecording() ? nullptr : m_deviceState);
       else if constexpr (Func == D3D9StateFunction::Capture)
-        ApplyOrCapture(this, m_deviceState);
+        m_program.Execute(this, m_deviceState, nullptr);
+    }
+
+    /**
+     * \brief Compiles captured state
+     *
+     * Needs to be called once recording into
+     * this state block has finished.
+     */
+    void Compile() {
+      m_program.Compile(m_captures);
     }
 
     template <
@@ -395,6 +508,7 @@ namespace dxvk {
 
     D3D9CapturableState  m_state;
     D3D9StateCaptures    m_captures;
+    D3D9StateProgram     m_program;
 
     D3D9DeviceState* m_deviceState;
 
@@ -802,6 +802,8 @@ namespace dxvk {
 
     SyncFrameLatency();
 
+    m_wctx->presenter->latencySleep(m_wctx->frameId + 1);
+
     // Rotate swap chain buffers so that the back
     // buffer at index 0 becomes the front buffer.
     for (uint32_t i = 1; i < m_backBuffers.size(); i++)
@@ -900,6 +902,10 @@ namespace dxvk {
 
     m_wctx->presenter = new Presenter(m_device, m_wctx->frameLatencySignal, presenterDesc);
     m_wctx->presenter->setFrameRateLimit(m_parent->GetOptions()->maxFrameRate);
+
+    // Begin the first frame here, since latencySleep
+    // is otherwise only called after presenting
+    m_wctx->presenter->latencySleep(m_wctx->frameId + 1);
   }
 
 
@@ -1060,6 +1066,7 @@ namespace dxvk {
     if (m_hud != nullptr) {
       m_hud->addItem<hud::HudClientApiItem>("api", 1, GetApiName());
       m_hud->addItem<hud::HudSamplerCount>("samplers", -1, m_parent);
+      m_hud->addItem<hud::HudUPBufferUsage>("updata", -1, m_parent);
 
 #ifdef D3D9_ALLOW_UNMAPPING
       m_hud->addItem<hud::HudTextureMemory>("memory", -1, m_parent);
@@ -0,0 +1,503 @@
+#include "d3d9_swvp_cpu.h"
+
+#include "d3d9_shader.h"
+
+#include "../util/util_env.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dxvk {
+
+  // Number of vertices per work item. Batches
+  // that fit into one chunk are processed inline.
+  constexpr uint32_t SWVPChunkSize = 1024;
+
+  // Upper bound for the number of worker threads,
+  // not including the thread that submits the job.
+  constexpr uint32_t SWVPMaxWorkers = 7;
+
+
+  static float HalfToFloat(uint16_t h) {
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exp  = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+
+    uint32_t bits;
+
+    if (exp == 0x1f) {
+      bits = sign | 0x7f800000u | (mant << 13);
+    } else if (exp != 0) {
+      bits = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if (mant != 0) {
+      // Denormal, normalize the mantissa
+      exp = 113;
+
+      while (!(mant & 0x400)) {
+        mant <<= 1;
+        exp -= 1;
+      }
+
+      bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    } else {
+      bits = sign;
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+
+  static uint16_t FloatToHalf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    int32_t  exp  = int32_t((bits >> 23) & 0xff) - 112;
+    uint32_t mant = bits & 0x7fffff;
+
+    if (exp >= 0x1f) {
+      // Overflow, infinity or NaN
+      bool nan = ((bits >> 23) & 0xff) == 0xff && mant;
+      return sign | 0x7c00 | (nan ? 0x200 : 0);
+    }
+
+    if (exp <= 0) {
+      if (exp < -10)
+        return sign;
+
+      // Denormal, round to nearest
+      mant |= 0x800000;
+      uint32_t shift = uint32_t(14 - exp);
+      return sign | uint16_t((mant + (1u << (shift - 1))) >> shift);
+    }
+
+    uint32_t result = (uint32_t(exp) << 10) | (mant >> 13);
+    result += (mant >> 12) & 1;
+    return sign | uint16_t(std::min(result, 0x7c00u));
+  }
+
+
+  template<typename T>
+  static T ReadData(const uint8_t* pData, uint32_t index) {
+    T result;
+    std::memcpy(&result, pData + index * sizeof(T), sizeof(T));
+    return result;
+  }
+
+
+  template<typename T>
+  static void WriteData(uint8_t* pData, uint32_t index, T value) {
+    std::memcpy(pData + index * sizeof(T), &value, sizeof(T));
+  }
+
+
+  static float Normalize(float value, float scale, float min, float max) {
+    return std::clamp(value, min, max) * scale;
+  }
+
+
+  static int32_t Round(float value) {
+    return int32_t(std::floor(value + 0.5f));
+  }
+
+
+  /**
+   * \brief Reads a vertex attribute
+   *
+   * Components that are not present in
+   * the data are set to (0, 0, 0, 1).
+   */
+  static Vector4 FetchAttribute(D3DDECLTYPE Type, const uint8_t* pData) {
+    Vector4 v(0.0f, 0.0f, 0.0f, 1.0f);
+
+    switch (Type) {
+      case D3DDECLTYPE_FLOAT4: v.w = ReadData<float>(pData, 3); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT3: v.z = ReadData<float>(pData, 2); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT2: v.y = ReadData<float>(pData, 1); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT1: v.x = ReadData<float>(pData, 0); break;
+
+      case D3DDECLTYPE_D3DCOLOR:
+        v.x = float(pData[2]) / 255.0f;
+        v.y = float(pData[1]) / 255.0f;
+        v.z = float(pData[0]) / 255.0f;
+        v.w = float(pData[3]) / 255.0f;
+        break;
+
+      case D3DDECLTYPE_UBYTE4:
+      case D3DDECLTYPE_UBYTE4N: {
+        float scale = Type == D3DDECLTYPE_UBYTE4N ? 1.0f / 255.0f : 1.0f;
+
+        for (uint32_t i = 0; i < 4; i++)
+          v[i] = float(pData[i]) * scale;
+      } break;
+
+      case D3DDECLTYPE_SHORT4:
+        v.z = float(ReadData<int16_t>(pData, 2));
+        v.w = float(ReadData<int16_t>(pData, 3));
+        [[fallthrough]];
+      case D3DDECLTYPE_SHORT2:
+        v.x = float(ReadData<int16_t>(pData, 0));
+        v.y = float(ReadData<int16_t>(pData, 1));
+        break;
+
+      case D3DDECLTYPE_SHORT4N:
+        v.z = std::max(float(ReadData<int16_t>(pData, 2)) / 32767.0f, -1.0f);
+        v.w = std::max(float(ReadData<int16_t>(pData, 3)) / 32767.0f, -1.0f);
+        [[fallthrough]];
+      case D3DDECLTYPE_SHORT2N:
+        v.x = std::max(float(ReadData<int16_t>(pData, 0)) / 32767.0f, -1.0f);
+        v.y = std::max(float(ReadData<int16_t>(pData, 1)) / 32767.0f, -1.0f);
+        break;
+
+      case D3DDECLTYPE_USHORT4N:
+        v.z = float(ReadData<uint16_t>(pData, 2)) / 65535.0f;
+        v.w = float(ReadData<uint16_t>(pData, 3)) / 65535.0f;
+        [[fallthrough]];
+      case D3DDECLTYPE_USHORT2N:
+        v.x = float(ReadData<uint16_t>(pData, 0)) / 65535.0f;
+        v.y = float(ReadData<uint16_t>(pData, 1)) / 65535.0f;
+        break;
+
+      case D3DDECLTYPE_UDEC3: {
+        uint32_t data = ReadData<uint32_t>(pData, 0);
+        v.x = float((data >>  0) & 0x3ff);
+        v.y = float((data >> 10) & 0x3ff);
+        v.z = float((data >> 20) & 0x3ff);
+      } break;
+
+      case D3DDECLTYPE_DEC3N: {
+        uint32_t data = ReadData<uint32_t>(pData, 0);
+
+        for (uint32_t i = 0; i < 3; i++) {
+          int32_t value = int32_t(data << (22 - 10 * i)) >> 22;
+          v[i] = std::max(float(value) / 511.0f, -1.0f);
+        }
+      } break;
+
+      case D3DDECLTYPE_FLOAT16_4:
+        v.z = HalfToFloat(ReadData<uint16_t>(pData, 2));
+        v.w = HalfToFloat(ReadData<uint16_t>(pData, 3));
+        [[fallthrough]];
+      case D3DDECLTYPE_FLOAT16_2:
+        v.x = HalfToFloat(ReadData<uint16_t>(pData, 0));
+        v.y = HalfToFloat(ReadData<uint16_t>(pData, 1));
+        break;
+
+      default:
+        break;
+    }
+
+    return v;
+  }
+
+
+  /**
+   * \brief Writes a vertex attribute
+   */
+  static void StoreAttribute(D3DDECLTYPE Type, uint8_t* pData, const Vector4& v) {
+    switch (Type) {
+      case D3DDECLTYPE_FLOAT4: WriteData<float>(pData, 3, v.w); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT3: WriteData<float>(pData, 2, v.z); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT2: WriteData<float>(pData, 1, v.y); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT1: WriteData<float>(pData, 0, v.x); break;
+
+      case D3DDECLTYPE_D3DCOLOR:
+        pData[0] = uint8_t(Round(Normalize(v.z, 255.0f, 0.0f, 1.0f)));
+        pData[1] = uint8_t(Round(Normalize(v.y, 255.0f, 0.0f, 1.0f)));
+        pData[2] = uint8_t(Round(Normalize(v.x, 255.0f, 0.0f, 1.0f)));
+        pData[3] = uint8_t(Round(Normalize(v.w, 255.0f, 0.0f, 1.0f)));
+        break;
+
+      case D3DDECLTYPE_UBYTE4:
+        for (uint32_t i = 0; i < 4; i++)
+          pData[i] = uint8_t(Round(std::clamp(v[i], 0.0f, 255.0f)));
+        break;
+
+      case D3DDECLTYPE_UBYTE4N:
+        for (uint32_t i = 0; i < 4; i++)
+          pData[i] = uint8_t(Round(Normalize(v[i], 255.0f, 0.0f, 1.0f)));
+        break;
+
+      case D3DDECLTYPE_SHORT2:
+      case D3DDECLTYPE_SHORT4: {
+        uint32_t count = Type == D3DDECLTYPE_SHORT4 ? 4 : 2;
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteData<int16_t>(pData, i, int16_t(Round(std::clamp(v[i], -32768.0f, 32767.0f))));
+      } break;
+
+      case D3DDECLTYPE_SHORT2N:
+      case D3DDECLTYPE_SHORT4N: {
+        uint32_t count = Type == D3DDECLTYPE_SHORT4N ? 4 : 2;
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteData<int16_t>(pData, i, int16_t(Round(Normalize(v[i], 32767.0f, -1.0f, 1.0f))));
+      } break;
+
+      case D3DDECLTYPE_USHORT2N:
+      case D3DDECLTYPE_USHORT4N: {
+        uint32_t count = Type == D3DDECLTYPE_USHORT4N ? 4 : 2;
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteData<uint16_t>(pData, i, uint16_t(Round(Normalize(v[i], 65535.0f, 0.0f, 1.0f))));
+      } break;
+
+      case D3DDECLTYPE_UDEC3: {
+        uint32_t data = 0;
+
+        for (uint32_t i = 0; i < 3; i++)
+          data |= uint32_t(Round(std::clamp(v[i], 0.0f, 1023.0f))) << (10 * i);
+
+        WriteData<uint32_t>(pData, 0, data);
+      } break;
+
+      case D3DDECLTYPE_DEC3N: {
+        uint32_t data = 0;
+
+        for (uint32_t i = 0; i < 3; i++)
+          data |= (uint32_t(Round(Normalize(v[i], 511.0f, -1.0f, 1.0f))) & 0x3ff) << (10 * i);
+
+        WriteData<uint32_t>(pData, 0, data);
+      } break;
+
+      case D3DDECLTYPE_FLOAT16_2:
+      case D3DDECLTYPE_FLOAT16_4: {
+        uint32_t count = Type == D3DDECLTYPE_FLOAT16_4 ? 4 : 2;
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteData<uint16_t>(pData, i, FloatToHalf(v[i]));
+      } break;
+
+      default:
+        break;
+    }
+  }
+
+
+  D3D9SWVPProcessor::D3D9SWVPProcessor() {
+
+  }
+
+
+  D3D9SWVPProcessor::~D3D9SWVPProcessor() {
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped = true;
+      m_workerCond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+
+  Rc<DxsoInterpreterProgram> D3D9SWVPProcessor::GetProgram(
+    const DxsoOptions&            options,
+          D3D9VertexShader*       pShader) {
+    const D3D9CommonShader* shader = pShader->GetCommonShader();
+    DxvkShaderKey key = shader->GetShader()->getShaderKey();
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    auto entry = m_programs.find(key);
+
+    if (entry != m_programs.end())
+      return entry->second;
+
+    UINT size = 0;
+    pShader->GetFunction(nullptr, &size);
+
+    std::vector<uint8_t> bytecode(size);
+    pShader->GetFunction(bytecode.data(), &size);
+
+    Rc<DxsoInterpreterProgram> program = new DxsoInterpreterProgram(options, bytecode.data());
+
+    if (!program->isSupported()) {
+      Logger::warn(str::format("D3D9SWVPProcessor: Cannot process ", key.toString(), " on the CPU"));
+      program = nullptr;
+    }
+
+    m_programs.insert({ key, program });
+    return program;
+  }
+
+
+  void D3D9SWVPProcessor::ProcessVertices(
+    const D3D9SWVPProcessInfo&    info) {
+    Job job;
+    job.info = &info;
+    job.chunkCount = (info.vertexCount + SWVPChunkSize - 1) / SWVPChunkSize;
+
+    // Match shader inputs against the vertex declaration.
+    // Inputs without a matching element read (0, 0, 0, 1).
+    for (const auto& input : info.program->inputs()) {
+      for (const auto& element : *info.inputElements) {
+        DxsoSemantic semantic = { DxsoUsage(element.Usage), element.UsageIndex };
+
+        if (semantic == input.semantic && element.Stream < caps::MaxStreams) {
+          job.inputs.push_back({ input.reg, element.Stream, element.Offset, D3DDECLTYPE(element.Type) });
+          break;
+        }
+      }
+    }
+
+    // Match destination elements against shader outputs. Screen space
+    // positions go through the viewport transform, all other elements
+    // are written as-is. Elements without matching output are skipped.
+    for (const auto& element : *info.outputElements) {
+      DxsoSemantic semantic = { DxsoUsage(element.Usage), element.UsageIndex };
+
+      bool transform = semantic.usage == DxsoUsage::PositionT;
+
+      if (transform)
+        semantic.usage = DxsoUsage::Position;
+
+      for (const auto& output : info.program->outputs()) {
+        if (output.semantic == semantic) {
+          job.outputs.push_back({ output.slot, output.component, element.Offset,
+            D3DDECLTYPE(element.Type), transform });
+          break;
+        }
+      }
+    }
+
+    if (job.chunkCount > 1)
+      StartWorkers();
+
+    if (job.chunkCount < 2 || m_workers.empty()) {
+      ProcessChunks(job);
+      return;
+    }
+
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_job = &job;
+      m_jobId += 1;
+      m_pendingWorkers = m_workers.size();
+      m_workerCond.notify_all();
+    }
+
+    ProcessChunks(job);
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, [this] { return !m_pendingWorkers; });
+    m_job = nullptr;
+  }
+
+
+  void D3D9SWVPProcessor::StartWorkers() {
+    if (!m_workers.empty())
+      return;
+
+    uint32_t workerCount = std::min(dxvk::thread::hardware_concurrency(), SWVPMaxWorkers + 1u);
+
+    if (workerCount < 2)
+      return;
+
+    for (uint32_t i = 1; i < workerCount; i++)
+      m_workers.emplace_back([this] { runWorker(); });
+  }
+
+
+  void D3D9SWVPProcessor::ProcessChunks(
+          Job&                    job) {
+    uint32_t vertexCount = job.info->vertexCount;
+    uint32_t chunk;
+
+    while ((chunk = job.nextChunk++) < job.chunkCount) {
+      uint32_t first = chunk * SWVPChunkSize;
+      ProcessRange(job, first, std::min(vertexCount - first, SWVPChunkSize));
+    }
+  }
+
+
+  void D3D9SWVPProcessor::ProcessRange(
+    const Job&                    job,
+          uint32_t                first,
+          uint32_t                count) {
+    const D3D9SWVPProcessInfo& info = *job.info;
+    const D3DVIEWPORT9& vp = info.viewport;
+
+    DxsoInterpreterIo io = { };
+
+    for (uint32_t base = 0; base < count; base += DxsoInterpreterLaneCount) {
+      uint32_t laneCount = std::min(count - base, DxsoInterpreterLaneCount);
+
+      // Transpose vertex attributes into the interpreter's
+      // register layout, with one vertex per lane.
+      for (uint32_t l = 0; l < laneCount; l++) {
+        uint32_t vertex = info.firstVertex + first + base + l;
+
+        for (const auto& input : job.inputs) {
+          const D3D9SWVPStream& stream = info.streams[input.stream];
+
+          size_t offset = size_t(stream.instanced ? 0 : vertex) * stream.stride + input.offset;
+
+          Vector4 value = stream.data && offset + GetDecltypeSize(input.type) <= stream.size
+            ? FetchAttribute(input.type, stream.data + offset)
+            : Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+
+          for (uint32_t i = 0; i < 4; i++)
+            io.inputs[input.reg].c[i][l] = value[i];
+        }
+      }
+
+      for (const auto& output : job.outputs)
+        std::memset(&io.outputs[output.slot], 0, sizeof(io.outputs[output.slot]));
+
+      info.program->execute(info.constants, io, (1u << laneCount) - 1u);
+
+      for (uint32_t l = 0; l < laneCount; l++) {
+        uint8_t* vertex = info.output + size_t(first + base + l) * info.outputStride;
+
+        for (const auto& output : job.outputs) {
+          Vector4 value(0.0f, 0.0f, 0.0f, 1.0f);
+
+          for (uint32_t i = 0; i + output.component < 4; i++)
+            value[i] = io.outputs[output.slot].c[i + output.component][l];
+
+          if (output.transform) {
+            float rhw = 1.0f / value.w;
+
+            value.x = (1.0f + value.x * rhw) * 0.5f * float(vp.Width)  + float(vp.X);
+            value.y = (1.0f - value.y * rhw) * 0.5f * float(vp.Height) + float(vp.Y);
+            value.z = value.z * rhw * (vp.MaxZ - vp.MinZ) + vp.MinZ;
+            value.w = rhw;
+          }
+
+          StoreAttribute(output.type, vertex + output.offset, value);
+        }
+      }
+    }
+  }
+
+
+  void D3D9SWVPProcessor::runWorker() {
+    env::setThreadName("dxvk-swvp");
+
+    uint64_t jobId = 0;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    while (true) {
+      m_workerCond.wait(lock, [this, jobId] {
+        return m_stopped || m_jobId != jobId;
+      });
+
+      if (m_stopped)
+        break;
+
+      jobId = m_jobId;
+      Job* job = m_job;
+
+      lock.unlock();
+      ProcessChunks(*job);
+      lock.lock();
+
+      if (!(--m_pendingWorkers))
+        m_doneCond.notify_one();
+    }
+  }
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+#include "d3d9_caps.h"
+#include "d3d9_include.h"
+
+#include "../dxso/dxso_interpreter.h"
+
+#include "../dxvk/dxvk_hash.h"
+#include "../dxvk/dxvk_shader_key.h"
+
+#include "../util/thread.h"
+
+namespace dxvk {
+
+  class D3D9VertexShader;
+
+  /**
+   * \brief Source vertex stream
+   *
+   * \c size is the number of bytes that can
+   * be read starting at \c data.
+   */
+  struct D3D9SWVPStream {
+    const uint8_t*              data      = nullptr;
+    uint32_t                    size      = 0;
+    uint32_t                    stride    = 0;
+    bool                        instanced = false;
+  };
+
+  /**
+   * \brief CPU vertex processing parameters
+   */
+  struct D3D9SWVPProcessInfo {
+    const DxsoInterpreterProgram* program         = nullptr;
+    DxsoInterpreterConstants    constants;
+    const D3D9VertexElements*   inputElements     = nullptr;
+    std::array<D3D9SWVPStream, caps::MaxStreams> streams;
+    const D3D9VertexElements*   outputElements    = nullptr;
+    uint32_t                    outputStride      = 0;
+    uint8_t*                    output            = nullptr;
+    uint32_t                    firstVertex       = 0;
+    uint32_t                    vertexCount       = 0;
+    D3DVIEWPORT9                viewport          = { };
+  };
+
+  /**
+   * \brief CPU vertex processor
+   *
+   * Runs vertex shaders on the CPU for \c ProcessVertices, so
+   * that it works without transform feedback or vertex pipeline
+   * stores. Vertices are processed in groups of four using the
+   * DXSO interpreter, and large batches are split into chunks
+   * that are processed by a small pool of worker threads.
+   */
+  class D3D9SWVPProcessor {
+
+  public:
+
+    D3D9SWVPProcessor();
+
+    ~D3D9SWVPProcessor();
+
+    /**
+     * \brief Retrieves interpreter program for a shader
+     *
+     * Programs are cached by shader key.
+     * \param [in] options Shader compiler options
+     * \param [in] pShader Vertex shader
+     * \returns Program, or \c nullptr if unsupported
+     */
+    Rc<DxsoInterpreterProgram> GetProgram(
+      const DxsoOptions&            options,
+            D3D9VertexShader*       pShader);
+
+    /**
+     * \brief Processes vertices
+     *
+     * Blocks until all vertices have been written.
+     * \param [in] info Vertex processing parameters
+     */
+    void ProcessVertices(
+      const D3D9SWVPProcessInfo&    info);
+
+  private:
+
+    struct InputBinding {
+      uint32_t                      reg;
+      uint32_t                      stream;
+      uint32_t                      offset;
+      D3DDECLTYPE                   type;
+    };
+
+    struct OutputBinding {
+      uint32_t                      slot;
+      uint32_t                      component;
+      uint32_t                      offset;
+      D3DDECLTYPE                   type;
+      bool                          transform;
+    };
+
+    struct Job {
+      const D3D9SWVPProcessInfo*    info;
+      std::vector<InputBinding>     inputs;
+      std::vector<OutputBinding>    outputs;
+      uint32_t                      chunkCount;
+      std::atomic<uint32_t>         nextChunk = { 0u };
+    };
+
+    dxvk::mutex                     m_mutex;
+    dxvk::condition_variable        m_workerCond;
+    dxvk::condition_variable        m_doneCond;
+
+    std::vector<dxvk::thread>       m_workers;
+    bool                            m_stopped         = false;
+
+    Job*                            m_job             = nullptr;
+    uint64_t                        m_jobId           = 0;
+    uint32_t                        m_pendingWorkers  = 0;
+
+    std::unordered_map<
+      DxvkShaderKey,
+      Rc<DxsoInterpreterProgram>,
+      DxvkHash, DxvkEq>             m_programs;
+
+    void StartWorkers();
+
+    void ProcessChunks(
+            Job&                    job);
+
+    void ProcessRange(
+      const Job&                    job,
+            uint32_t                first,
+            uint32_t                count);
+
+    void runWorker();
+
+  };
+
+}
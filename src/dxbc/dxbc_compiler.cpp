@@ -226,7 +226,8 @@ namespace dxvk {
   }
   
   
-  Rc<DxvkShader> DxbcCompiler::finalize() {
+  Rc<DxvkShader> DxbcCompiler::finalize(
+          DxvkShaderCompileTimings* timings) {
     // Depending on the shader type, this will prepare
     // input registers, call various shader functions
     // and write back the output registers.
@@ -272,7 +273,14 @@ namespace dxvk {
         info.xfbStrides[i] = m_moduleInfo.xfb->strides[i];
     }
 
-    return new DxvkShader(info, m_module.compile());
+    auto t0 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
+    SpirvCodeBuffer code = m_module.compile();
+
+    if (timings)
+      timings->spirv = high_resolution_clock::now() - t0;
+
+    return new DxvkShader(info, std::move(code));
   }
   
   
@@ -393,9 +393,13 @@ namespace dxvk {
     
     /**
      * \brief Finalizes the shader
+     *
+     * \param [out] timings Optional timings. Only
+     *    the SPIR-V assembly time will be written.
      * \returns The final shader object
      */
-    Rc<DxvkShader> finalize();
+    Rc<DxvkShader> finalize(
+            DxvkShaderCompileTimings* timings = nullptr);
     
   private:
     
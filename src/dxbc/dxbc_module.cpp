@@ -42,7 +42,8 @@ namespace dxvk {
   
   Rc<DxvkShader> DxbcModule::compile(
     const DxbcModuleInfo& moduleInfo,
-    const std::string&    fileName) const {
+    const std::string&    fileName,
+          DxvkShaderCompileTimings* timings) const {
     if (m_shexChunk == nullptr)
       throw DxvkError("DxbcModule::compile: No SHDR/SHEX chunk");
     
@@ -53,6 +54,8 @@ namespace dxvk {
       m_isgnChunk, m_osgnChunk,
       m_psgnChunk, analysisInfo);
     
+    auto t0 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
     this->runAnalyzer(analyzer, m_shexChunk->slice());
     
     DxbcCompiler compiler(
@@ -61,15 +64,28 @@ namespace dxvk {
       m_isgnChunk, m_osgnChunk,
       m_psgnChunk, analysisInfo);
     
+    auto t1 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
     this->runCompiler(compiler, m_shexChunk->slice());
     
-    return compiler.finalize();
+    auto t2 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
+    Rc<DxvkShader> shader = compiler.finalize(timings);
+
+    if (timings) {
+      timings->analyze  = t1 - t0;
+      timings->compile  = t2 - t1;
+      timings->finalize = high_resolution_clock::now() - t2 - timings->spirv;
+    }
+
+    return shader;
   }
   
   
   Rc<DxvkShader> DxbcModule::compilePassthroughShader(
     const DxbcModuleInfo& moduleInfo,
-    const std::string&    fileName) const {
+    const std::string&    fileName,
+          DxvkShaderCompileTimings* timings) const {
     if (m_shexChunk == nullptr)
       throw DxvkError("DxbcModule::compile: No SHDR/SHEX chunk");
     
@@ -81,8 +97,20 @@ namespace dxvk {
       m_osgnChunk, m_osgnChunk,
       m_psgnChunk, analysisInfo);
     
+    auto t0 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
     compiler.processXfbPassthrough();
-    return compiler.finalize();
+
+    auto t1 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
+    Rc<DxvkShader> shader = compiler.finalize(timings);
+
+    if (timings) {
+      timings->compile  = t1 - t0;
+      timings->finalize = high_resolution_clock::now() - t1 - timings->spirv;
+    }
+
+    return shader;
   }
 
 
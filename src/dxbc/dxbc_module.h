@@ -57,11 +57,13 @@ namespace dxvk {
      * \param [in] moduleInfo DXBC module info
      * \param [in] fileName File name, will be added to
      *        the compiled SPIR-V for debugging purposes.
+     * \param [out] timings Optional per-pass timings
      * \returns The compiled shader object
      */
     Rc<DxvkShader> compile(
       const DxbcModuleInfo& moduleInfo,
-      const std::string&    fileName) const;
+      const std::string&    fileName,
+            DxvkShaderCompileTimings* timings = nullptr) const;
     
     /**
      * \brief Compiles a pass-through geometry shader
@@ -72,10 +74,12 @@ namespace dxvk {
      * shader, which operates in point to point mode.
      * \param [in] moduleInfo DXBC module info
      * \param [in] fileName SPIR-V shader name
+     * \param [out] timings Optional per-pass timings
      */
     Rc<DxvkShader> compilePassthroughShader(
       const DxbcModuleInfo& moduleInfo,
-      const std::string&    fileName) const;
+      const std::string&    fileName,
+            DxvkShaderCompileTimings* timings = nullptr) const;
     
   private:
     
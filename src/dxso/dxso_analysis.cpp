@@ -47,9 +47,73 @@ namespace dxvk {
      || opcode == DxsoOpcode::TexDepth)
       m_analysis->usesDerivatives = true;
 
+    processConstantReads(ctx);
+
     m_parentOpcode = ctx.instruction.opcode;
   }
 
+
+  void DxsoAnalyzer::processConstantReads(
+    const DxsoInstructionContext& ctx) {
+    DxsoOpcode opcode = ctx.instruction.opcode;
+
+    // Defined constants are emitted as literals by the
+    // compiler unless they are accessed via relative
+    // addressing, so they do not need to be uploaded.
+    if (opcode == DxsoOpcode::Def) {
+      uint32_t num = ctx.dst.id.num;
+
+      if (num < DxsoMaxPackedConstsF)
+        m_definedConstantsF[num / 32] |= 1u << (num % 32);
+      return;
+    }
+
+    if (opcode == DxsoOpcode::DefI
+     || opcode == DxsoOpcode::DefB
+     || opcode == DxsoOpcode::Dcl
+     || opcode == DxsoOpcode::Comment)
+      return;
+
+    // Matrix instructions read one row of the second
+    // source operand for each destination component.
+    uint32_t matrixRows = getMatrixRowCount(opcode);
+
+    // Source operands that the instruction does not use may
+    // still contain registers from previous instructions,
+    // which only makes the resulting mask conservative.
+    for (uint32_t i = 0; i < ctx.src.size(); i++) {
+      const auto& src = ctx.src[i];
+
+      if (src.id.type != DxsoRegisterType::Const)
+        continue;
+
+      uint32_t first = src.id.num;
+      uint32_t count = i == 1 ? matrixRows : 1u;
+
+      if (src.hasRelative || first + count > DxsoMaxPackedConstsF) {
+        m_analysis->canPackConstantsF = false;
+        continue;
+      }
+
+      for (uint32_t num = first; num < first + count; num++) {
+        if (!(m_definedConstantsF[num / 32] & (1u << (num % 32))))
+          m_analysis->constantMaskF[num / 32] |= 1u << (num % 32);
+      }
+    }
+  }
+
+
+  uint32_t DxsoAnalyzer::getMatrixRowCount(DxsoOpcode opcode) {
+    switch (opcode) {
+      case DxsoOpcode::M3x2: return 2;
+      case DxsoOpcode::M3x3: return 3;
+      case DxsoOpcode::M3x4: return 4;
+      case DxsoOpcode::M4x3: return 3;
+      case DxsoOpcode::M4x4: return 4;
+      default:               return 1;
+    }
+  }
+
   void DxsoAnalyzer::finalize(size_t tokenCount) {
     m_analysis->bytecodeByteLength = tokenCount * sizeof(uint32_t);
   }
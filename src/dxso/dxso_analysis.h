@@ -2,6 +2,7 @@
 
 #include "dxso_modinfo.h"
 #include "dxso_decoder.h"
+#include "dxso_isgn.h"
 
 namespace dxvk {
 
@@ -11,6 +12,11 @@ namespace dxvk {
     bool usesDerivatives = false;
     bool usesKill        = false;
 
+    // Float constant registers read before being defined. Packing
+    // is not possible if any float constant is relatively addressed.
+    DxsoConstantMaskF constantMaskF = { };
+    bool canPackConstantsF = true;
+
     std::vector<DxsoInstructionContext> coissues;
   };
 
@@ -36,6 +42,14 @@ namespace dxvk {
 
     DxsoOpcode m_parentOpcode;
 
+    DxsoConstantMaskF m_definedConstantsF = { };
+
+    void processConstantReads(
+      const DxsoInstructionContext& ctx);
+
+    static uint32_t getMatrixRowCount(
+            DxsoOpcode              opcode);
+
   };
 
 }
\ No newline at end of file
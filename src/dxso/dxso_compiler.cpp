@@ -68,6 +68,16 @@ namespace dxvk {
 
     m_loopCounter = DxsoRegisterPointer{ };
 
+    // Pack float constants that the shader reads if it never indexes
+    // them dynamically, so that the device only uploads those.
+    m_meta.packedConstantsF = !isSwvp() && m_analysis->canPackConstantsF;
+
+    for (uint32_t i = m_layout->floatCount; i < DxsoMaxPackedConstsF; i++)
+      m_meta.packedConstantsF &= !(m_analysis->constantMaskF[i / 32] & (1u << (i % 32)));
+
+    if (m_meta.packedConstantsF)
+      m_meta.packedConstantMaskF = m_analysis->constantMaskF;
+
     this->emitInit();
   }
 
@@ -221,7 +231,8 @@ namespace dxvk {
   }
 
 
-  Rc<DxvkShader> DxsoCompiler::compile() {
+  Rc<DxvkShader> DxsoCompiler::compile(
+          DxvkShaderCompileTimings* timings) {
     DxvkShaderCreateInfo info;
     info.stage = m_programInfo.shaderStage();
     info.bindingCount = m_bindings.size();
@@ -234,7 +245,14 @@ namespace dxvk {
     if (m_programInfo.type() == DxsoProgramTypes::PixelShader)
       info.flatShadingInputs = m_ps.flatShadingMask;
 
-    return new DxvkShader(info, m_module.compile());
+    auto t0 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
+    SpirvCodeBuffer code = m_module.compile();
+
+    if (timings)
+      timings->spirv = high_resolution_clock::now() - t0;
+
+    return new DxvkShader(info, std::move(code));
   }
 
   void DxsoCompiler::emitInit() {
@@ -921,7 +939,12 @@ namespace dxvk {
       default: break;
     }
 
-    uint32_t relativeIdx = this->emitArrayIndex(reg.id.num, relative);
+    uint32_t arrayIdx = reg.id.num;
+
+    if (reg.id.type == DxsoRegisterType::Const && m_meta.packedConstantsF)
+      arrayIdx = m_meta.getPackedConstantCountF(reg.id.num);
+
+    uint32_t relativeIdx = this->emitArrayIndex(arrayIdx, relative);
 
     if (reg.id.type != DxsoRegisterType::ConstBool) {
       uint32_t structIdx;
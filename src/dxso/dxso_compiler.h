@@ -236,9 +236,13 @@ namespace dxvk {
 
     /**
      * \brief Compiles the shader
+     *
+     * \param [out] timings Optional timings. Only
+     *    the SPIR-V assembly time will be written.
      * \returns The final shader objects
      */
-    Rc<DxvkShader> compile();
+    Rc<DxvkShader> compile(
+            DxvkShaderCompileTimings* timings = nullptr);
 
     const DxsoIsgn& isgn() { return m_isgn; }
     const DxsoIsgn& osgn() { return m_osgn; }
@@ -11,6 +11,10 @@ namespace dxvk {
   constexpr size_t DxsoMaxInterfaceRegs = 16;
   constexpr size_t DxsoMaxOperandCount  = 8;
 
+  // Float constant registers that can be packed. This
+  // covers the hardware vertex and pixel shader layouts.
+  constexpr size_t DxsoMaxPackedConstsF = 256;
+
   constexpr uint32_t DxsoRegModifierShift = 24;
 
   class DxsoDecodeContext;
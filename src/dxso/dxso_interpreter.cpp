@@ -0,0 +1,1500 @@
+#include "dxso_interpreter.h"
+
+#include "dxso_code.h"
+#include "dxso_header.h"
+#include "dxso_reader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace dxvk {
+
+  // Maximum nesting depth of if and loop blocks. D3D9
+  // allows 24 nested if blocks and 4 nested loops.
+  constexpr uint32_t DxsoInterpreterMaxDepth = 32;
+
+  enum class DxsoInterpreterRegFile : uint8_t {
+    None,
+    Temp,
+    Input,
+    Output,
+    Const,
+    ConstInt,
+    ConstBool,
+    Addr,
+    Loop,
+    Predicate,
+  };
+
+
+  struct DxsoInterpreterOperand {
+    DxsoInterpreterRegFile  file          = DxsoInterpreterRegFile::None;
+    uint32_t                index         = 0;
+    DxsoRegSwizzle          swizzle       = IdentitySwizzle;
+    DxsoRegMask             mask          = IdentityWriteMask;
+    DxsoRegModifier         modifier      = DxsoRegModifier::None;
+    bool                    saturate      = false;
+    DxsoInterpreterRegFile  relFile       = DxsoInterpreterRegFile::None;
+    uint32_t                relComponent  = 0;
+  };
+
+
+  struct DxsoInterpreterInstruction {
+    DxsoOpcode              opcode        = DxsoOpcode::Nop;
+    DxsoComparison          comparison    = DxsoComparison::Never;
+    bool                    predicated    = false;
+    DxsoInterpreterOperand  pred;
+    DxsoInterpreterOperand  dst;
+    std::array<DxsoInterpreterOperand, 3> src;
+    uint32_t                target        = 0;
+  };
+
+
+#ifdef DXVK_ARCH_X86
+  /**
+   * \brief Four-wide float vector
+   */
+  struct DxsoLane {
+    __m128 v;
+  };
+
+  /**
+   * \brief Four-wide comparison result
+   */
+  struct DxsoLaneMask {
+    __m128 v;
+  };
+
+  inline DxsoLane laneLoad(const float* p) {
+    return { _mm_load_ps(p) };
+  }
+
+  inline void laneStore(float* p, DxsoLane a) {
+    _mm_store_ps(p, a.v);
+  }
+
+  inline DxsoLane laneSplat(float f) {
+    return { _mm_set1_ps(f) };
+  }
+
+  inline DxsoLane operator + (DxsoLane a, DxsoLane b) { return { _mm_add_ps(a.v, b.v) }; }
+  inline DxsoLane operator - (DxsoLane a, DxsoLane b) { return { _mm_sub_ps(a.v, b.v) }; }
+  inline DxsoLane operator * (DxsoLane a, DxsoLane b) { return { _mm_mul_ps(a.v, b.v) }; }
+  inline DxsoLane operator / (DxsoLane a, DxsoLane b) { return { _mm_div_ps(a.v, b.v) }; }
+
+  inline DxsoLane laneMin (DxsoLane a, DxsoLane b) { return { _mm_min_ps(a.v, b.v) }; }
+  inline DxsoLane laneMax (DxsoLane a, DxsoLane b) { return { _mm_max_ps(a.v, b.v) }; }
+  inline DxsoLane laneSqrt(DxsoLane a) { return { _mm_sqrt_ps(a.v) }; }
+  inline DxsoLane laneAbs (DxsoLane a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+  inline DxsoLane laneNeg (DxsoLane a) { return { _mm_xor_ps(_mm_set1_ps(-0.0f), a.v) }; }
+
+  inline DxsoLane laneFloor(DxsoLane a) {
+    // SSE2 has no floor instruction. Truncate and fix up
+    // negative values, and pass through values that are
+    // too large to have a fractional part.
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+
+    __m128 big = _mm_cmpge_ps(laneAbs(a).v, _mm_set1_ps(8388608.0f));
+    return { _mm_or_ps(_mm_and_ps(big, a.v), _mm_andnot_ps(big, t)) };
+  }
+
+  inline DxsoLaneMask laneLt(DxsoLane a, DxsoLane b) { return { _mm_cmplt_ps (a.v, b.v) }; }
+  inline DxsoLaneMask laneLe(DxsoLane a, DxsoLane b) { return { _mm_cmple_ps (a.v, b.v) }; }
+  inline DxsoLaneMask laneGt(DxsoLane a, DxsoLane b) { return { _mm_cmpgt_ps (a.v, b.v) }; }
+  inline DxsoLaneMask laneGe(DxsoLane a, DxsoLane b) { return { _mm_cmpge_ps (a.v, b.v) }; }
+  inline DxsoLaneMask laneEq(DxsoLane a, DxsoLane b) { return { _mm_cmpeq_ps (a.v, b.v) }; }
+  inline DxsoLaneMask laneNe(DxsoLane a, DxsoLane b) { return { _mm_and_ps(_mm_cmpneq_ps(a.v, b.v), _mm_cmpord_ps(a.v, b.v)) }; }
+
+  inline DxsoLaneMask operator & (DxsoLaneMask a, DxsoLaneMask b) { return { _mm_and_ps(a.v, b.v) }; }
+  inline DxsoLaneMask operator ~ (DxsoLaneMask a) { return { _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+
+  inline DxsoLane laneSelect(DxsoLaneMask m, DxsoLane a, DxsoLane b) {
+    return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) };
+  }
+
+  inline uint32_t laneBits(DxsoLaneMask m) {
+    return uint32_t(_mm_movemask_ps(m.v));
+  }
+
+  inline DxsoLaneMask laneMaskFromBits(uint32_t bits) {
+    return { _mm_castsi128_ps(_mm_set_epi32(
+      -int32_t((bits >> 3) & 1), -int32_t((bits >> 2) & 1),
+      -int32_t((bits >> 1) & 1), -int32_t((bits >> 0) & 1))) };
+  }
+#else
+  struct DxsoLane {
+    float v[4];
+  };
+
+  struct DxsoLaneMask {
+    bool v[4];
+  };
+
+  template<typename Fn>
+  inline DxsoLane laneOp(DxsoLane a, DxsoLane b, Fn fn) {
+    DxsoLane r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = fn(a.v[i], b.v[i]);
+    return r;
+  }
+
+  template<typename Fn>
+  inline DxsoLaneMask laneCmp(DxsoLane a, DxsoLane b, Fn fn) {
+    DxsoLaneMask r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = fn(a.v[i], b.v[i]);
+    return r;
+  }
+
+  inline DxsoLane laneLoad(const float* p) {
+    DxsoLane r;
+    std::memcpy(r.v, p, sizeof(r.v));
+    return r;
+  }
+
+  inline void laneStore(float* p, DxsoLane a) {
+    std::memcpy(p, a.v, sizeof(a.v));
+  }
+
+  inline DxsoLane laneSplat(float f) {
+    return { { f, f, f, f } };
+  }
+
+  inline DxsoLane operator + (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x + y; }); }
+  inline DxsoLane operator - (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x - y; }); }
+  inline DxsoLane operator * (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x * y; }); }
+  inline DxsoLane operator / (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x / y; }); }
+
+  inline DxsoLane laneMin (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x < y ? x : y; }); }
+  inline DxsoLane laneMax (DxsoLane a, DxsoLane b) { return laneOp(a, b, [] (float x, float y) { return x > y ? x : y; }); }
+  inline DxsoLane laneSqrt(DxsoLane a) { return laneOp(a, a, [] (float x, float) { return std::sqrt(x); }); }
+  inline DxsoLane laneAbs (DxsoLane a) { return laneOp(a, a, [] (float x, float) { return std::fabs(x); }); }
+  inline DxsoLane laneNeg (DxsoLane a) { return laneOp(a, a, [] (float x, float) { return -x; }); }
+  inline DxsoLane laneFloor(DxsoLane a) { return laneOp(a, a, [] (float x, float) { return std::floor(x); }); }
+
+  inline DxsoLaneMask laneLt(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x <  y; }); }
+  inline DxsoLaneMask laneLe(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x <= y; }); }
+  inline DxsoLaneMask laneGt(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x >  y; }); }
+  inline DxsoLaneMask laneGe(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x >= y; }); }
+  inline DxsoLaneMask laneEq(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x == y; }); }
+  inline DxsoLaneMask laneNe(DxsoLane a, DxsoLane b) { return laneCmp(a, b, [] (float x, float y) { return x < y || x > y; }); }
+
+  inline DxsoLaneMask operator & (DxsoLaneMask a, DxsoLaneMask b) {
+    DxsoLaneMask r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = a.v[i] && b.v[i];
+    return r;
+  }
+
+  inline DxsoLaneMask operator ~ (DxsoLaneMask a) {
+    DxsoLaneMask r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = !a.v[i];
+    return r;
+  }
+
+  inline DxsoLane laneSelect(DxsoLaneMask m, DxsoLane a, DxsoLane b) {
+    DxsoLane r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = m.v[i] ? a.v[i] : b.v[i];
+    return r;
+  }
+
+  inline uint32_t laneBits(DxsoLaneMask m) {
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < 4; i++)
+      bits |= m.v[i] ? (1u << i) : 0u;
+    return bits;
+  }
+
+  inline DxsoLaneMask laneMaskFromBits(uint32_t bits) {
+    DxsoLaneMask r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = (bits & (1u << i)) != 0;
+    return r;
+  }
+#endif
+
+
+  template<typename Fn>
+  inline DxsoLane laneMap(DxsoLane a, Fn fn) {
+    alignas(16) float v[DxsoInterpreterLaneCount];
+    laneStore(v, a);
+
+    for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++)
+      v[i] = fn(v[i]);
+
+    return laneLoad(v);
+  }
+
+
+  template<typename Fn>
+  inline DxsoLane laneMap(DxsoLane a, DxsoLane b, Fn fn) {
+    alignas(16) float u[DxsoInterpreterLaneCount];
+    alignas(16) float v[DxsoInterpreterLaneCount];
+    laneStore(u, a);
+    laneStore(v, b);
+
+    for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++)
+      u[i] = fn(u[i], v[i]);
+
+    return laneLoad(u);
+  }
+
+
+  inline DxsoLaneMask laneCompare(DxsoComparison cmp, DxsoLane a, DxsoLane b) {
+    switch (cmp) {
+      case DxsoComparison::Never:        return laneMaskFromBits(0x0);
+      case DxsoComparison::GreaterThan:  return laneGt(a, b);
+      case DxsoComparison::Equal:        return laneEq(a, b);
+      case DxsoComparison::GreaterEqual: return laneGe(a, b);
+      case DxsoComparison::LessThan:     return laneLt(a, b);
+      case DxsoComparison::NotEqual:     return laneNe(a, b);
+      case DxsoComparison::LessEqual:    return laneLe(a, b);
+      case DxsoComparison::Always:       return laneMaskFromBits(0xF);
+    }
+
+    return laneMaskFromBits(0x0);
+  }
+
+
+  template<typename T>
+  static const T* findDefinition(
+    const std::vector<std::pair<uint32_t, T>>& defs,
+          uint32_t                             index) {
+    auto entry = std::lower_bound(defs.begin(), defs.end(), index,
+      [] (const std::pair<uint32_t, T>& def, uint32_t idx) { return def.first < idx; });
+
+    return (entry != defs.end() && entry->first == index) ? &entry->second : nullptr;
+  }
+
+
+  template<typename T>
+  static void addDefinition(
+          std::vector<std::pair<uint32_t, T>>& defs,
+          uint32_t                             index,
+    const T&                                   value) {
+    auto entry = std::lower_bound(defs.begin(), defs.end(), index,
+      [] (const std::pair<uint32_t, T>& def, uint32_t idx) { return def.first < idx; });
+
+    if (entry != defs.end() && entry->first == index)
+      entry->second = value;
+    else
+      defs.insert(entry, std::make_pair(index, value));
+  }
+
+
+  static uint32_t getFloatConstantIndex(const DxsoRegisterId& id) {
+    switch (id.type) {
+      case DxsoRegisterType::Const2: return id.num + 2048;
+      case DxsoRegisterType::Const3: return id.num + 4096;
+      case DxsoRegisterType::Const4: return id.num + 6144;
+      default:                       return id.num;
+    }
+  }
+
+
+  static uint32_t getSourceCount(DxsoOpcode opcode) {
+    switch (opcode) {
+      case DxsoOpcode::Else:
+      case DxsoOpcode::EndIf:
+      case DxsoOpcode::EndLoop:
+      case DxsoOpcode::EndRep:
+      case DxsoOpcode::Break:
+        return 0;
+
+      case DxsoOpcode::Mad:
+      case DxsoOpcode::Lrp:
+        return 3;
+
+      case DxsoOpcode::Add:
+      case DxsoOpcode::Sub:
+      case DxsoOpcode::Mul:
+      case DxsoOpcode::Dp3:
+      case DxsoOpcode::Dp4:
+      case DxsoOpcode::Min:
+      case DxsoOpcode::Max:
+      case DxsoOpcode::Slt:
+      case DxsoOpcode::Sge:
+      case DxsoOpcode::Dst:
+      case DxsoOpcode::Pow:
+      case DxsoOpcode::Crs:
+      case DxsoOpcode::M4x4:
+      case DxsoOpcode::M4x3:
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M3x2:
+      case DxsoOpcode::SetP:
+      case DxsoOpcode::Ifc:
+      case DxsoOpcode::BreakC:
+      case DxsoOpcode::Loop:
+        return 2;
+
+      // Sgn and SinCos may have additional scratch
+      // operands in shader model 2, which we ignore.
+      default:
+        return 1;
+    }
+  }
+
+
+  static bool hasDestination(DxsoOpcode opcode) {
+    switch (opcode) {
+      case DxsoOpcode::If:
+      case DxsoOpcode::Ifc:
+      case DxsoOpcode::Else:
+      case DxsoOpcode::EndIf:
+      case DxsoOpcode::Loop:
+      case DxsoOpcode::EndLoop:
+      case DxsoOpcode::Rep:
+      case DxsoOpcode::EndRep:
+      case DxsoOpcode::Break:
+      case DxsoOpcode::BreakC:
+      case DxsoOpcode::BreakP:
+        return false;
+
+      default:
+        return true;
+    }
+  }
+
+
+  /**
+   * \brief Interpreter execution context
+   *
+   * Holds the register state for one invocation.
+   */
+  class DxsoInterpreterContext {
+
+  public:
+
+    DxsoInterpreterContext(
+      const DxsoInterpreterProgram&   program,
+      const DxsoInterpreterConstants& constants,
+            DxsoInterpreterIo&        io,
+            uint32_t                  laneMask)
+    : m_program(program), m_constants(constants), m_io(io), m_execMask(laneMask) {
+      std::memset(m_temps, 0, sizeof(DxsoInterpreterRegister) * program.m_tempCount);
+      std::memset(&m_addr, 0, sizeof(m_addr));
+      std::memset(&m_pred, 0, sizeof(m_pred));
+    }
+
+    void run() {
+      const auto& code = m_program.m_code;
+
+      uint32_t pc = 0;
+
+      while (pc < code.size()) {
+        const DxsoInterpreterInstruction& ins = code[pc];
+
+        switch (ins.opcode) {
+          case DxsoOpcode::If:
+          case DxsoOpcode::Ifc: {
+            uint32_t cond = m_execMask & evalCondition(ins);
+
+            Frame& frame = m_frames[m_depth++];
+            frame.savedMask = m_execMask;
+            frame.condMask  = cond;
+            frame.isLoop    = false;
+
+            m_execMask = cond;
+            pc = m_execMask ? pc + 1 : ins.target;
+          } break;
+
+          case DxsoOpcode::Else: {
+            const Frame& frame = m_frames[m_depth - 1];
+            m_execMask = frame.savedMask & ~frame.condMask & ~getBrokenMask();
+            pc = m_execMask ? pc + 1 : ins.target;
+          } break;
+
+          case DxsoOpcode::EndIf: {
+            m_execMask = m_frames[--m_depth].savedMask;
+            m_execMask &= ~getBrokenMask();
+            pc += 1;
+          } break;
+
+          case DxsoOpcode::Loop:
+          case DxsoOpcode::Rep: {
+            bool hasCounter = ins.opcode == DxsoOpcode::Loop;
+
+            Vector4i args = loadInt(hasCounter ? ins.src[1] : ins.src[0]);
+            uint32_t count = uint32_t(std::clamp(args.x, 0, 255));
+
+            if (!count || !m_execMask) {
+              pc = ins.target + 1;
+              break;
+            }
+
+            Frame& frame = m_frames[m_depth++];
+            frame.savedMask   = m_execMask;
+            frame.brokenMask  = 0;
+            frame.isLoop      = true;
+            frame.hasCounter  = hasCounter;
+            frame.iterations  = count;
+            frame.begin       = pc + 1;
+            frame.savedLoop   = m_loop;
+            frame.step        = args.z;
+
+            if (hasCounter)
+              m_loop = args.y;
+
+            pc += 1;
+          } break;
+
+          case DxsoOpcode::EndLoop:
+          case DxsoOpcode::EndRep: {
+            Frame& frame = m_frames[m_depth - 1];
+
+            if (frame.hasCounter)
+              m_loop += frame.step;
+
+            m_execMask = frame.savedMask & ~frame.brokenMask;
+
+            if (--frame.iterations && m_execMask) {
+              pc = frame.begin;
+              break;
+            }
+
+            m_execMask = frame.savedMask;
+
+            if (frame.hasCounter)
+              m_loop = frame.savedLoop;
+
+            m_depth -= 1;
+            pc += 1;
+          } break;
+
+          case DxsoOpcode::Break:
+            breakLanes(m_execMask);
+            pc += 1;
+            break;
+
+          case DxsoOpcode::BreakC:
+          case DxsoOpcode::BreakP:
+            breakLanes(m_execMask & evalCondition(ins));
+            pc += 1;
+            break;
+
+          default:
+            if (m_execMask)
+              executeAlu(ins);
+            pc += 1;
+        }
+      }
+    }
+
+  private:
+
+    struct Frame {
+      uint32_t  savedMask;
+      uint32_t  condMask;
+      uint32_t  brokenMask;
+      bool      isLoop;
+      bool      hasCounter;
+      uint32_t  iterations;
+      uint32_t  begin;
+      int32_t   savedLoop;
+      int32_t   step;
+    };
+
+    const DxsoInterpreterProgram&   m_program;
+    const DxsoInterpreterConstants& m_constants;
+          DxsoInterpreterIo&        m_io;
+
+    uint32_t                        m_execMask;
+    int32_t                         m_loop  = 0;
+    uint32_t                        m_depth = 0;
+
+    std::array<Frame, DxsoInterpreterMaxDepth> m_frames;
+
+    DxsoInterpreterRegister         m_addr;
+    DxsoInterpreterRegister         m_pred;
+    DxsoInterpreterRegister         m_temps[DxsoMaxTempRegs];
+
+    uint32_t getBrokenMask() const {
+      for (uint32_t i = m_depth; i; i--) {
+        if (m_frames[i - 1].isLoop)
+          return m_frames[i - 1].brokenMask;
+      }
+
+      return 0;
+    }
+
+    void breakLanes(uint32_t lanes) {
+      for (uint32_t i = m_depth; i; i--) {
+        if (m_frames[i - 1].isLoop) {
+          m_frames[i - 1].brokenMask |= lanes;
+          break;
+        }
+      }
+
+      m_execMask &= ~lanes;
+    }
+
+    Vector4 loadConstFloat(int32_t index) const {
+      if (!m_program.m_defFloats.empty()) {
+        const Vector4* def = findDefinition(m_program.m_defFloats, uint32_t(index));
+
+        if (def)
+          return *def;
+      }
+
+      return index >= 0 && uint32_t(index) < m_constants.floatCount
+        ? m_constants.floats[index]
+        : Vector4(0.0f);
+    }
+
+    Vector4i loadInt(const DxsoInterpreterOperand& op) const {
+      const Vector4i* def = findDefinition(m_program.m_defInts, op.index);
+
+      if (def)
+        return *def;
+
+      return op.index < m_constants.intCount
+        ? m_constants.ints[op.index]
+        : Vector4i(0);
+    }
+
+    bool loadBool(const DxsoInterpreterOperand& op) const {
+      const bool* def = findDefinition(m_program.m_defBools, op.index);
+
+      if (def)
+        return *def;
+
+      return op.index < m_constants.boolCount
+        && (m_constants.bools[op.index / 32] & (1u << (op.index % 32)));
+    }
+
+    DxsoLaneMask loadPredicate(const DxsoInterpreterOperand& op, uint32_t component) const {
+      DxsoLaneMask result = laneNe(laneLoad(m_pred.c[op.swizzle[component]]), laneSplat(0.0f));
+
+      if (op.modifier == DxsoRegModifier::Not)
+        result = ~result;
+
+      return result;
+    }
+
+    uint32_t evalCondition(const DxsoInterpreterInstruction& ins) {
+      if (ins.opcode == DxsoOpcode::Ifc || ins.opcode == DxsoOpcode::BreakC) {
+        DxsoLane a[4], b[4];
+        load(ins.src[0], 0, a);
+        load(ins.src[1], 0, b);
+
+        return laneBits(laneCompare(ins.comparison, a[0], b[0]));
+      }
+
+      if (ins.src[0].file == DxsoInterpreterRegFile::Predicate)
+        return laneBits(loadPredicate(ins.src[0], 0));
+
+      bool cond = loadBool(ins.src[0]);
+
+      if (ins.src[0].modifier == DxsoRegModifier::Not)
+        cond = !cond;
+
+      return cond ? 0xF : 0x0;
+    }
+
+    void load(
+      const DxsoInterpreterOperand& op,
+            uint32_t                offset,
+            DxsoLane              (&result)[4]) const {
+      DxsoLane raw[4];
+
+      switch (op.file) {
+        case DxsoInterpreterRegFile::Temp:
+        case DxsoInterpreterRegFile::Input: {
+          uint32_t index = op.index + offset;
+
+          if (op.relFile == DxsoInterpreterRegFile::Loop)
+            index += uint32_t(m_loop);
+
+          const DxsoInterpreterRegister* reg = nullptr;
+
+          if (op.file == DxsoInterpreterRegFile::Temp)
+            reg = index < m_program.m_tempCount ? &m_temps[index] : nullptr;
+          else
+            reg = index < DxsoMaxInterfaceRegs ? &m_io.inputs[index] : nullptr;
+
+          for (uint32_t i = 0; i < 4; i++)
+            raw[i] = reg ? laneLoad(reg->c[i]) : laneSplat(0.0f);
+        } break;
+
+        case DxsoInterpreterRegFile::Const: {
+          int32_t index = int32_t(op.index + offset);
+
+          if (op.relFile == DxsoInterpreterRegFile::Addr) {
+            // Each lane can use a different address, so this
+            // turns into a gather from the constant registers
+            alignas(16) float values[4][DxsoInterpreterLaneCount];
+
+            for (uint32_t l = 0; l < DxsoInterpreterLaneCount; l++) {
+              Vector4 value = loadConstFloat(index + int32_t(m_addr.c[op.relComponent][l]));
+
+              for (uint32_t i = 0; i < 4; i++)
+                values[i][l] = value[i];
+            }
+
+            for (uint32_t i = 0; i < 4; i++)
+              raw[i] = laneLoad(values[i]);
+          } else {
+            if (op.relFile == DxsoInterpreterRegFile::Loop)
+              index += m_loop;
+
+            Vector4 value = loadConstFloat(index);
+
+            for (uint32_t i = 0; i < 4; i++)
+              raw[i] = laneSplat(value[i]);
+          }
+        } break;
+
+        case DxsoInterpreterRegFile::Addr:
+          for (uint32_t i = 0; i < 4; i++)
+            raw[i] = laneLoad(m_addr.c[i]);
+          break;
+
+        case DxsoInterpreterRegFile::Predicate:
+          for (uint32_t i = 0; i < 4; i++)
+            raw[i] = laneLoad(m_pred.c[i]);
+          break;
+
+        case DxsoInterpreterRegFile::Loop:
+          for (uint32_t i = 0; i < 4; i++)
+            raw[i] = laneSplat(float(m_loop));
+          break;
+
+        default:
+          for (uint32_t i = 0; i < 4; i++)
+            raw[i] = laneSplat(0.0f);
+      }
+
+      // Projection modifiers apply before the swizzle
+      if (op.modifier == DxsoRegModifier::Dz || op.modifier == DxsoRegModifier::Dw) {
+        DxsoLane divisor = raw[op.modifier == DxsoRegModifier::Dz ? 2 : 3];
+
+        for (uint32_t i = 0; i < 4; i++)
+          raw[i] = raw[i] / divisor;
+      }
+
+      for (uint32_t i = 0; i < 4; i++) {
+        DxsoLane value = raw[op.swizzle[i]];
+
+        switch (op.modifier) {
+          case DxsoRegModifier::Neg:      value = laneNeg(value); break;
+          case DxsoRegModifier::Bias:     value = value - laneSplat(0.5f); break;
+          case DxsoRegModifier::BiasNeg:  value = laneSplat(0.5f) - value; break;
+          case DxsoRegModifier::Sign:     value = value * laneSplat(2.0f) - laneSplat(1.0f); break;
+          case DxsoRegModifier::SignNeg:  value = laneSplat(1.0f) - value * laneSplat(2.0f); break;
+          case DxsoRegModifier::Comp:     value = laneSplat(1.0f) - value; break;
+          case DxsoRegModifier::X2:       value = value * laneSplat(2.0f); break;
+          case DxsoRegModifier::X2Neg:    value = value * laneSplat(-2.0f); break;
+          case DxsoRegModifier::Abs:      value = laneAbs(value); break;
+          case DxsoRegModifier::AbsNeg:   value = laneNeg(laneAbs(value)); break;
+          default: break;
+        }
+
+        result[i] = value;
+      }
+    }
+
+    void store(
+      const DxsoInterpreterInstruction& ins,
+      const DxsoLane                  (&value)[4]) {
+      const DxsoInterpreterOperand& dst = ins.dst;
+
+      DxsoInterpreterRegister* reg = nullptr;
+
+      switch (dst.file) {
+        case DxsoInterpreterRegFile::Temp:
+          reg = &m_temps[dst.index];
+          break;
+
+        case DxsoInterpreterRegFile::Addr:
+          reg = &m_addr;
+          break;
+
+        case DxsoInterpreterRegFile::Predicate:
+          reg = &m_pred;
+          break;
+
+        case DxsoInterpreterRegFile::Output: {
+          uint32_t index = dst.index;
+
+          if (dst.relFile == DxsoInterpreterRegFile::Loop)
+            index += uint32_t(m_loop);
+
+          if (index < DxsoMaxInterfaceRegs)
+            reg = &m_io.outputs[index];
+        } break;
+
+        default:
+          break;
+      }
+
+      if (!reg)
+        return;
+
+      DxsoLaneMask lanes = laneMaskFromBits(m_execMask);
+
+      for (uint32_t i = 0; i < 4; i++) {
+        if (!dst.mask[i])
+          continue;
+
+        DxsoLane result = value[i];
+
+        if (dst.saturate)
+          result = laneMin(laneMax(result, laneSplat(0.0f)), laneSplat(1.0f));
+
+        DxsoLaneMask mask = lanes;
+
+        if (ins.predicated)
+          mask = mask & loadPredicate(ins.pred, i);
+
+        laneStore(reg->c[i], laneSelect(mask, result, laneLoad(reg->c[i])));
+      }
+    }
+
+    DxsoLane mulOperand(DxsoLane a, DxsoLane b) const {
+      if (m_program.m_floatEmulation != D3D9FloatEmulation::Strict)
+        return a;
+
+      return laneSelect(laneEq(b, laneSplat(0.0f)), laneSplat(0.0f), a);
+    }
+
+    DxsoLane mul(DxsoLane a, DxsoLane b) const {
+      return mulOperand(a, b) * mulOperand(b, a);
+    }
+
+    DxsoLane dot(const DxsoLane (&a)[4], const DxsoLane (&b)[4], uint32_t n) const {
+      DxsoLane result = mul(a[0], b[0]);
+
+      for (uint32_t i = 1; i < n; i++)
+        result = result + mul(a[i], b[i]);
+
+      return result;
+    }
+
+    DxsoLane clampMax(DxsoLane a) const {
+      return m_program.m_floatEmulation == D3D9FloatEmulation::Enabled
+        ? laneMin(a, laneSplat(FLT_MAX))
+        : a;
+    }
+
+    void executeAlu(const DxsoInterpreterInstruction& ins) {
+      DxsoLane s[3][4];
+      DxsoLane r[4];
+
+      uint32_t srcCount = getSourceCount(ins.opcode);
+
+      for (uint32_t i = 0; i < srcCount; i++)
+        load(ins.src[i], 0, s[i]);
+
+      switch (ins.opcode) {
+        case DxsoOpcode::Mov:
+        case DxsoOpcode::Mova:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = s[0][i];
+
+          if (ins.dst.file == DxsoInterpreterRegFile::Addr) {
+            // Shader model 1.1 floors, later versions round
+            const auto& info = m_program.m_info;
+            bool useFloor = info.majorVersion() < 2 && info.minorVersion() < 2;
+
+            for (uint32_t i = 0; i < 4; i++)
+              r[i] = laneFloor(useFloor ? r[i] : r[i] + laneSplat(0.5f));
+          }
+          break;
+
+        case DxsoOpcode::Add:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = s[0][i] + s[1][i];
+          break;
+
+        case DxsoOpcode::Sub:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = s[0][i] - s[1][i];
+          break;
+
+        case DxsoOpcode::Mul:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = mul(s[0][i], s[1][i]);
+          break;
+
+        case DxsoOpcode::Mad:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = mul(s[0][i], s[1][i]) + s[2][i];
+          break;
+
+        case DxsoOpcode::Rcp:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = clampMax(laneSplat(1.0f) / s[0][i]);
+          break;
+
+        case DxsoOpcode::Rsq:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = clampMax(laneSplat(1.0f) / laneSqrt(laneAbs(s[0][i])));
+          break;
+
+        case DxsoOpcode::Dp3:
+        case DxsoOpcode::Dp4:
+          r[0] = dot(s[0], s[1], ins.opcode == DxsoOpcode::Dp3 ? 3 : 4);
+          r[1] = r[2] = r[3] = r[0];
+          break;
+
+        case DxsoOpcode::Min:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = laneMin(s[0][i], s[1][i]);
+          break;
+
+        case DxsoOpcode::Max:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = laneMax(s[0][i], s[1][i]);
+          break;
+
+        case DxsoOpcode::Slt:
+        case DxsoOpcode::Sge:
+          for (uint32_t i = 0; i < 4; i++) {
+            DxsoLaneMask cmp = ins.opcode == DxsoOpcode::Slt
+              ? laneLt(s[0][i], s[1][i])
+              : laneGe(s[0][i], s[1][i]);
+            r[i] = laneSelect(cmp, laneSplat(1.0f), laneSplat(0.0f));
+          }
+          break;
+
+        case DxsoOpcode::SetP:
+          for (uint32_t i = 0; i < 4; i++) {
+            r[i] = laneSelect(laneCompare(ins.comparison, s[0][i], s[1][i]),
+              laneSplat(1.0f), laneSplat(0.0f));
+          }
+          break;
+
+        case DxsoOpcode::ExpP:
+          if (m_program.m_info.majorVersion() < 2) {
+            DxsoLane intPart = laneFloor(s[0][0]);
+
+            r[0] = laneMap(intPart, [] (float x) { return std::exp2(x); });
+            r[1] = s[0][0] - intPart;
+            r[2] = laneMap(s[0][0], [] (float x) { return std::exp2(x); });
+            r[3] = laneSplat(1.0f);
+            break;
+          }
+          [[fallthrough]];
+
+        case DxsoOpcode::Exp:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = laneMap(s[0][i], [] (float x) { return std::exp2(x); });
+          break;
+
+        case DxsoOpcode::Log:
+        case DxsoOpcode::LogP:
+          for (uint32_t i = 0; i < 4; i++) {
+            r[i] = laneMap(laneAbs(s[0][i]), [] (float x) { return std::log2(x); });
+
+            if (m_program.m_floatEmulation == D3D9FloatEmulation::Enabled)
+              r[i] = laneMax(r[i], laneSplat(-FLT_MAX));
+          }
+          break;
+
+        case DxsoOpcode::Pow:
+          for (uint32_t i = 0; i < 4; i++) {
+            r[i] = laneMap(laneAbs(s[0][i]), s[1][i], [] (float x, float y) { return std::pow(x, y); });
+
+            if (m_program.m_strictPow && m_program.m_floatEmulation != D3D9FloatEmulation::Disabled)
+              r[i] = laneSelect(laneEq(s[1][i], laneSplat(0.0f)), laneSplat(1.0f), r[i]);
+          }
+          break;
+
+        case DxsoOpcode::Lit: {
+          DxsoLane zero  = laneSplat(0.0f);
+          DxsoLane power = laneMin(laneMax(s[0][3], laneSplat(-127.9961f)), laneSplat(127.9961f));
+
+          r[0] = laneSplat(1.0f);
+          r[1] = laneMax(s[0][0], zero);
+          r[2] = laneMap(laneMax(s[0][1], zero), power, [] (float x, float y) { return std::pow(x, y); });
+          r[2] = laneSelect(laneGe(s[0][0], zero) & laneGe(s[0][1], zero), r[2], zero);
+          r[3] = laneSplat(1.0f);
+        } break;
+
+        case DxsoOpcode::Dst:
+          r[0] = laneSplat(1.0f);
+          r[1] = mul(s[0][1], s[1][1]);
+          r[2] = s[0][2];
+          r[3] = s[1][3];
+          break;
+
+        case DxsoOpcode::Lrp:
+          for (uint32_t i = 0; i < 4; i++) {
+            r[i] = m_program.m_floatEmulation == D3D9FloatEmulation::Strict
+              ? mul(s[0][i], s[1][i] - s[2][i]) + s[2][i]
+              : s[2][i] + s[0][i] * (s[1][i] - s[2][i]);
+          }
+          break;
+
+        case DxsoOpcode::Frc:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = s[0][i] - laneFloor(s[0][i]);
+          break;
+
+        case DxsoOpcode::Crs:
+          r[0] = mul(s[0][1], s[1][2]) - mul(s[0][2], s[1][1]);
+          r[1] = mul(s[0][2], s[1][0]) - mul(s[0][0], s[1][2]);
+          r[2] = mul(s[0][0], s[1][1]) - mul(s[0][1], s[1][0]);
+          r[3] = laneSplat(0.0f);
+          break;
+
+        case DxsoOpcode::Abs:
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = laneAbs(s[0][i]);
+          break;
+
+        case DxsoOpcode::Sgn:
+          for (uint32_t i = 0; i < 4; i++) {
+            r[i] = laneSelect(laneGt(s[0][i], laneSplat(0.0f)), laneSplat(1.0f),
+                   laneSelect(laneLt(s[0][i], laneSplat(0.0f)), laneSplat(-1.0f), laneSplat(0.0f)));
+          }
+          break;
+
+        case DxsoOpcode::Nrm: {
+          DxsoLane length = s[0][0] * s[0][0] + s[0][1] * s[0][1] + s[0][2] * s[0][2];
+          DxsoLane factor = clampMax(laneSplat(1.0f) / laneSqrt(length));
+
+          for (uint32_t i = 0; i < 4; i++)
+            r[i] = mul(s[0][i], factor);
+        } break;
+
+        case DxsoOpcode::SinCos:
+          r[0] = laneMap(s[0][0], [] (float x) { return std::cos(x); });
+          r[1] = laneMap(s[0][0], [] (float x) { return std::sin(x); });
+          r[2] = laneSplat(0.0f);
+          r[3] = laneSplat(0.0f);
+          break;
+
+        case DxsoOpcode::M4x4:
+        case DxsoOpcode::M4x3:
+        case DxsoOpcode::M3x4:
+        case DxsoOpcode::M3x3:
+        case DxsoOpcode::M3x2: {
+          uint32_t dotCount = (ins.opcode == DxsoOpcode::M4x4 || ins.opcode == DxsoOpcode::M4x3) ? 4 : 3;
+          uint32_t rowCount = 4;
+
+          if (ins.opcode == DxsoOpcode::M4x3 || ins.opcode == DxsoOpcode::M3x3)
+            rowCount = 3;
+          else if (ins.opcode == DxsoOpcode::M3x2)
+            rowCount = 2;
+
+          // The destination mask is fixed up at compile time, so
+          // results are stored in consecutive enabled components
+          uint32_t component = 0;
+
+          for (uint32_t i = 0; i < rowCount; i++) {
+            DxsoLane row[4];
+            load(ins.src[1], i, row);
+
+            while (component < 4 && !ins.dst.mask[component])
+              component++;
+
+            if (component < 4)
+              r[component++] = dot(s[0], row, dotCount);
+          }
+
+          for (; component < 4; component++)
+            r[component] = laneSplat(0.0f);
+        } break;
+
+        default:
+          return;
+      }
+
+      store(ins, r);
+    }
+
+  };
+
+
+  DxsoInterpreterProgram::DxsoInterpreterProgram(
+    const DxsoOptions&  options,
+    const void*         pBytecode)
+  : m_floatEmulation  (options.d3d9FloatEmulation),
+    m_strictPow       (options.strictPow) {
+    try {
+      compile(pBytecode);
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+      m_supported = false;
+    }
+  }
+
+
+  DxsoInterpreterProgram::~DxsoInterpreterProgram() {
+
+  }
+
+
+  void DxsoInterpreterProgram::execute(
+    const DxsoInterpreterConstants& constants,
+          DxsoInterpreterIo&        io,
+          uint32_t                  laneMask) const {
+    if (unlikely(!m_supported))
+      return;
+
+    DxsoInterpreterContext context(*this, constants, io, laneMask);
+    context.run();
+  }
+
+
+  void DxsoInterpreterProgram::compile(const void* pBytecode) {
+    DxsoReader reader(reinterpret_cast<const char*>(pBytecode));
+    DxsoHeader header(reader);
+    DxsoCode   code(reader);
+
+    m_info = header.info();
+
+    if (m_info.type() != DxsoProgramTypes::VertexShader) {
+      m_supported = false;
+      return;
+    }
+
+    // Gather definitions and declarations first since
+    // instructions can refer to them in any order
+    DxsoDecodeContext dclDecoder(m_info);
+    DxsoCodeIter dclIter = code.iter();
+
+    while (dclDecoder.decodeInstruction(dclIter)) {
+      const DxsoInstructionContext& ctx = dclDecoder.getInstructionContext();
+
+      switch (ctx.instruction.opcode) {
+        case DxsoOpcode::Def:
+          addDefinition(m_defFloats, getFloatConstantIndex(ctx.dst.id),
+            Vector4(ctx.def.float32));
+          break;
+
+        case DxsoOpcode::DefI:
+          addDefinition(m_defInts, ctx.dst.id.num,
+            Vector4i(ctx.def.int32));
+          break;
+
+        case DxsoOpcode::DefB:
+          addDefinition(m_defBools, ctx.dst.id.num,
+            ctx.def.uint32[0] != 0);
+          break;
+
+        case DxsoOpcode::Dcl:
+          if (ctx.dst.id.type == DxsoRegisterType::Input && ctx.dst.id.num < DxsoMaxInterfaceRegs)
+            m_inputs.push_back({ ctx.dcl.semantic, ctx.dst.id.num });
+
+          if (ctx.dst.id.type == DxsoRegisterType::Output && m_info.majorVersion() >= 3 && ctx.dst.id.num < DxsoMaxInterfaceRegs)
+            declareOutput(ctx.dcl.semantic, ctx.dst.id.num, ctx.dst.mask.firstSet());
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    DxsoDecodeContext decoder(m_info);
+    DxsoCodeIter iter = code.iter();
+
+    while (m_supported && decoder.decodeInstruction(iter)) {
+      const DxsoInstructionContext& ctx = decoder.getInstructionContext();
+
+      if (!compileInstruction(ctx)) {
+        Logger::warn(str::format("DxsoInterpreter: Unsupported instruction ", ctx.instruction.opcode));
+        m_supported = false;
+      }
+    }
+
+    if (!m_supported)
+      return;
+
+    // Resolve jump targets for control flow blocks
+    std::array<uint32_t, DxsoInterpreterMaxDepth> blocks;
+    uint32_t depth = 0;
+    uint32_t loopDepth = 0;
+
+    for (uint32_t i = 0; i < m_code.size() && m_supported; i++) {
+      DxsoInterpreterInstruction& ins = m_code[i];
+
+      switch (ins.opcode) {
+        case DxsoOpcode::If:
+        case DxsoOpcode::Ifc:
+        case DxsoOpcode::Loop:
+        case DxsoOpcode::Rep:
+          if (depth == DxsoInterpreterMaxDepth) {
+            m_supported = false;
+            break;
+          }
+
+          if (ins.opcode == DxsoOpcode::Loop || ins.opcode == DxsoOpcode::Rep)
+            loopDepth += 1;
+
+          blocks[depth++] = i;
+          break;
+
+        case DxsoOpcode::Else:
+        case DxsoOpcode::EndIf: {
+          DxsoOpcode block = depth ? m_code[blocks[depth - 1]].opcode : DxsoOpcode::Nop;
+
+          if (block != DxsoOpcode::If && block != DxsoOpcode::Ifc
+           && (block != DxsoOpcode::Else || ins.opcode == DxsoOpcode::Else)) {
+            m_supported = false;
+            break;
+          }
+
+          m_code[blocks[depth - 1]].target = i;
+
+          if (ins.opcode == DxsoOpcode::Else)
+            blocks[depth - 1] = i;
+          else
+            depth -= 1;
+        } break;
+
+        case DxsoOpcode::EndLoop:
+        case DxsoOpcode::EndRep: {
+          DxsoOpcode block = depth ? m_code[blocks[depth - 1]].opcode : DxsoOpcode::Nop;
+          DxsoOpcode expected = ins.opcode == DxsoOpcode::EndLoop ? DxsoOpcode::Loop : DxsoOpcode::Rep;
+
+          if (block != expected) {
+            m_supported = false;
+            break;
+          }
+
+          m_code[blocks[--depth]].target = i;
+          loopDepth -= 1;
+        } break;
+
+        case DxsoOpcode::Break:
+        case DxsoOpcode::BreakC:
+        case DxsoOpcode::BreakP:
+          m_supported = loopDepth != 0;
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    if (depth != 0)
+      m_supported = false;
+
+    if (!m_supported)
+      Logger::warn("DxsoInterpreter: Invalid control flow");
+  }
+
+
+  bool DxsoInterpreterProgram::compileInstruction(
+    const DxsoInstructionContext&   ctx) {
+    DxsoOpcode opcode = ctx.instruction.opcode;
+
+    switch (opcode) {
+      case DxsoOpcode::Nop:
+      case DxsoOpcode::Dcl:
+      case DxsoOpcode::Def:
+      case DxsoOpcode::DefI:
+      case DxsoOpcode::DefB:
+      case DxsoOpcode::Comment:
+      case DxsoOpcode::Phase:
+      case DxsoOpcode::End:
+        return true;
+
+      case DxsoOpcode::Mov:
+      case DxsoOpcode::Mova:
+      case DxsoOpcode::Add:
+      case DxsoOpcode::Sub:
+      case DxsoOpcode::Mad:
+      case DxsoOpcode::Mul:
+      case DxsoOpcode::Rcp:
+      case DxsoOpcode::Rsq:
+      case DxsoOpcode::Dp3:
+      case DxsoOpcode::Dp4:
+      case DxsoOpcode::Min:
+      case DxsoOpcode::Max:
+      case DxsoOpcode::Slt:
+      case DxsoOpcode::Sge:
+      case DxsoOpcode::Exp:
+      case DxsoOpcode::ExpP:
+      case DxsoOpcode::Log:
+      case DxsoOpcode::LogP:
+      case DxsoOpcode::Lit:
+      case DxsoOpcode::Dst:
+      case DxsoOpcode::Lrp:
+      case DxsoOpcode::Frc:
+      case DxsoOpcode::M4x4:
+      case DxsoOpcode::M4x3:
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M3x2:
+      case DxsoOpcode::Pow:
+      case DxsoOpcode::Crs:
+      case DxsoOpcode::Sgn:
+      case DxsoOpcode::Abs:
+      case DxsoOpcode::Nrm:
+      case DxsoOpcode::SinCos:
+      case DxsoOpcode::SetP:
+      case DxsoOpcode::If:
+      case DxsoOpcode::Ifc:
+      case DxsoOpcode::Else:
+      case DxsoOpcode::EndIf:
+      case DxsoOpcode::Loop:
+      case DxsoOpcode::EndLoop:
+      case DxsoOpcode::Rep:
+      case DxsoOpcode::EndRep:
+      case DxsoOpcode::Break:
+      case DxsoOpcode::BreakC:
+      case DxsoOpcode::BreakP:
+        break;
+
+      // Subroutines and texture fetches
+      // are not supported on the CPU
+      default:
+        return false;
+    }
+
+    DxsoInterpreterInstruction ins;
+    ins.opcode      = opcode;
+    ins.comparison  = ctx.instruction.specificData.comparison;
+    ins.predicated  = ctx.instruction.predicated;
+
+    if (ins.predicated && !compileSrc(ins.pred, ctx.pred))
+      return false;
+
+    if (hasDestination(opcode) && !compileDst(ins.dst, ctx.dst))
+      return false;
+
+    uint32_t srcCount = getSourceCount(opcode);
+
+    for (uint32_t i = 0; i < srcCount; i++) {
+      if (!compileSrc(ins.src[i], ctx.src[i]))
+        return false;
+    }
+
+    switch (opcode) {
+      case DxsoOpcode::M4x4:
+      case DxsoOpcode::M4x3:
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M3x2: {
+        // Matrix instructions read consecutive registers and
+        // only write as many components as the matrix has rows
+        uint32_t rowCount = 4;
+
+        if (opcode == DxsoOpcode::M4x3 || opcode == DxsoOpcode::M3x3)
+          rowCount = 3;
+        else if (opcode == DxsoOpcode::M3x2)
+          rowCount = 2;
+
+        if (ins.src[1].file == DxsoInterpreterRegFile::Temp)
+          m_tempCount = std::min(std::max(m_tempCount, ins.src[1].index + rowCount), uint32_t(DxsoMaxTempRegs));
+
+        uint8_t mask = 0;
+
+        for (uint32_t i = 0, n = 0; i < 4 && n < rowCount; i++) {
+          if (ins.dst.mask[i]) {
+            mask |= 1u << i;
+            n++;
+          }
+        }
+
+        ins.dst.mask = DxsoRegMask(mask);
+      } break;
+
+      case DxsoOpcode::If:
+        if (ins.src[0].file != DxsoInterpreterRegFile::ConstBool
+         && ins.src[0].file != DxsoInterpreterRegFile::Predicate)
+          return false;
+        break;
+
+      case DxsoOpcode::BreakP:
+        if (ins.src[0].file != DxsoInterpreterRegFile::Predicate)
+          return false;
+        break;
+
+      case DxsoOpcode::Loop:
+        if (ins.src[1].file != DxsoInterpreterRegFile::ConstInt)
+          return false;
+        break;
+
+      case DxsoOpcode::Rep:
+        if (ins.src[0].file != DxsoInterpreterRegFile::ConstInt)
+          return false;
+        break;
+
+      default:
+        break;
+    }
+
+    m_code.push_back(ins);
+    return true;
+  }
+
+
+  bool DxsoInterpreterProgram::compileSrc(
+          DxsoInterpreterOperand&   operand,
+    const DxsoRegister&             reg) {
+    operand.index     = reg.id.num;
+    operand.swizzle   = reg.swizzle;
+    operand.modifier  = reg.modifier;
+
+    switch (reg.id.type) {
+      case DxsoRegisterType::Temp:
+        if (reg.id.num >= DxsoMaxTempRegs)
+          return false;
+
+        operand.file = DxsoInterpreterRegFile::Temp;
+        m_tempCount = std::max(m_tempCount, reg.id.num + 1);
+        break;
+
+      case DxsoRegisterType::Input:
+        operand.file = DxsoInterpreterRegFile::Input;
+        break;
+
+      case DxsoRegisterType::Const:
+      case DxsoRegisterType::Const2:
+      case DxsoRegisterType::Const3:
+      case DxsoRegisterType::Const4:
+        operand.file  = DxsoInterpreterRegFile::Const;
+        operand.index = getFloatConstantIndex(reg.id);
+        break;
+
+      case DxsoRegisterType::ConstInt:
+        operand.file = DxsoInterpreterRegFile::ConstInt;
+        break;
+
+      case DxsoRegisterType::ConstBool:
+        operand.file = DxsoInterpreterRegFile::ConstBool;
+        break;
+
+      case DxsoRegisterType::Addr:
+        operand.file = DxsoInterpreterRegFile::Addr;
+        break;
+
+      case DxsoRegisterType::Loop:
+        operand.file = DxsoInterpreterRegFile::Loop;
+        break;
+
+      case DxsoRegisterType::Predicate:
+        operand.file = DxsoInterpreterRegFile::Predicate;
+        break;
+
+      default:
+        return false;
+    }
+
+    if (reg.hasRelative) {
+      if (reg.relative.id.type == DxsoRegisterType::Addr && operand.file == DxsoInterpreterRegFile::Const)
+        operand.relFile = DxsoInterpreterRegFile::Addr;
+      else if (reg.relative.id.type == DxsoRegisterType::Loop)
+        operand.relFile = DxsoInterpreterRegFile::Loop;
+      else
+        return false;
+
+      operand.relComponent = reg.relative.swizzle[0];
+    }
+
+    return true;
+  }
+
+
+  bool DxsoInterpreterProgram::compileDst(
+          DxsoInterpreterOperand&   operand,
+    const DxsoRegister&             reg) {
+    operand.index     = reg.id.num;
+    operand.mask      = reg.mask;
+    operand.saturate  = reg.saturate;
+
+    bool legacy = m_info.majorVersion() < 3;
+
+    switch (reg.id.type) {
+      case DxsoRegisterType::Temp:
+        if (reg.id.num >= DxsoMaxTempRegs)
+          return false;
+
+        operand.file = DxsoInterpreterRegFile::Temp;
+        m_tempCount = std::max(m_tempCount, reg.id.num + 1);
+        break;
+
+      case DxsoRegisterType::Addr:
+        operand.file = DxsoInterpreterRegFile::Addr;
+        break;
+
+      case DxsoRegisterType::Predicate:
+        operand.file = DxsoInterpreterRegFile::Predicate;
+        break;
+
+      // Legacy output registers are mapped to fixed slots:
+      // oPos, oFog and oPts use slots 0-2, oD# slots 3-4
+      // and oT# slots 5-12. Fog and point size are scalar.
+      case DxsoRegisterType::RasterizerOut: {
+        static const std::array<DxsoSemantic, 3> semantics = {{
+          { DxsoUsage::Position,  0 },
+          { DxsoUsage::Fog,       0 },
+          { DxsoUsage::PointSize, 0 },
+        }};
+
+        if (!legacy || reg.id.num >= semantics.size())
+          return false;
+
+        operand.file  = DxsoInterpreterRegFile::Output;
+        operand.index = reg.id.num;
+
+        if (reg.id.num != RasterOutPosition)
+          operand.mask = DxsoRegMask(true, false, false, false);
+
+        declareOutput(semantics[reg.id.num], operand.index, 0);
+      } break;
+
+      case DxsoRegisterType::AttributeOut:
+        if (!legacy || reg.id.num >= 2)
+          return false;
+
+        operand.file  = DxsoInterpreterRegFile::Output;
+        operand.index = 3 + reg.id.num;
+
+        declareOutput({ DxsoUsage::Color, reg.id.num }, operand.index, 0);
+        break;
+
+      case DxsoRegisterType::Output:
+        operand.file = DxsoInterpreterRegFile::Output;
+
+        if (legacy) {
+          if (reg.id.num >= 8)
+            return false;
+
+          operand.index = 5 + reg.id.num;
+
+          declareOutput({ DxsoUsage::Texcoord, reg.id.num }, operand.index, 0);
+        } else if (reg.id.num >= DxsoMaxInterfaceRegs) {
+          return false;
+        }
+        break;
+
+      default:
+        return false;
+    }
+
+    if (reg.hasRelative) {
+      if (operand.file != DxsoInterpreterRegFile::Output
+       || reg.relative.id.type != DxsoRegisterType::Loop)
+        return false;
+
+      operand.relFile = DxsoInterpreterRegFile::Loop;
+    }
+
+    return true;
+  }
+
+
+  void DxsoInterpreterProgram::declareOutput(
+    const DxsoSemantic&             semantic,
+          uint32_t                  slot,
+          uint32_t                  component) {
+    for (const auto& output : m_outputs) {
+      if (output.semantic == semantic)
+        return;
+    }
+
+    m_outputs.push_back({ semantic, slot, component });
+  }
+
+}
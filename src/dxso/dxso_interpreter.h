@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+
+#include "dxso_decoder.h"
+#include "dxso_options.h"
+
+#include "../util/util_vector.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Number of vertices per interpreter invocation
+   *
+   * Registers are stored as structures of arrays, so that each
+   * instruction processes one vertex per SIMD lane.
+   */
+  constexpr uint32_t DxsoInterpreterLaneCount = 4;
+
+  /**
+   * \brief Interpreter register
+   *
+   * Stores one four-component register for each lane,
+   * with all lanes of a given component next to each other.
+   */
+  struct DxsoInterpreterRegister {
+    alignas(16) float c[4][DxsoInterpreterLaneCount];
+  };
+
+  /**
+   * \brief Interpreter input and output registers
+   *
+   * Inputs are indexed by \c v# register. Outputs are indexed
+   * by the slots listed in \ref DxsoInterpreterOutput.
+   */
+  struct DxsoInterpreterIo {
+    DxsoInterpreterRegister inputs [DxsoMaxInterfaceRegs];
+    DxsoInterpreterRegister outputs[DxsoMaxInterfaceRegs];
+  };
+
+  /**
+   * \brief Interpreter input declaration
+   */
+  struct DxsoInterpreterInput {
+    DxsoSemantic  semantic;
+    uint32_t      reg;
+  };
+
+  /**
+   * \brief Interpreter output declaration
+   *
+   * Shader model 3 shaders can pack multiple semantics into
+   * one register, in which case \c component is the first
+   * register component that belongs to the semantic.
+   */
+  struct DxsoInterpreterOutput {
+    DxsoSemantic  semantic;
+    uint32_t      slot;
+    uint32_t      component;
+  };
+
+  /**
+   * \brief Constant registers
+   *
+   * Points to the application-provided constant
+   * set. Registers outside the given ranges read
+   * as zero, same as with robust buffer access.
+   */
+  struct DxsoInterpreterConstants {
+    const Vector4*  floats     = nullptr;
+    uint32_t        floatCount = 0;
+    const Vector4i* ints       = nullptr;
+    uint32_t        intCount   = 0;
+    const uint32_t* bools      = nullptr;
+    uint32_t        boolCount  = 0;
+  };
+
+  struct DxsoInterpreterOperand;
+  struct DxsoInterpreterInstruction;
+
+  class DxsoInterpreterContext;
+
+  /**
+   * \brief DXSO vertex shader interpreter
+   *
+   * Translates vertex shader bytecode into a flat instruction
+   * list that can be executed on the CPU. Each invocation runs
+   * the shader for \ref DxsoInterpreterLaneCount vertices at
+   * once, using per-lane execution masks for control flow.
+   * Programs are immutable after creation and can be executed
+   * from multiple threads at the same time.
+   */
+  class DxsoInterpreterProgram : public RcObject {
+    friend class DxsoInterpreterContext;
+  public:
+
+    DxsoInterpreterProgram(
+      const DxsoOptions&  options,
+      const void*         pBytecode);
+
+    ~DxsoInterpreterProgram();
+
+    /**
+     * \brief Checks whether the shader can be interpreted
+     *
+     * Shaders that use subroutines or vertex texture
+     * fetch are not supported by the interpreter.
+     * \returns \c true if the program is valid
+     */
+    bool isSupported() const {
+      return m_supported;
+    }
+
+    /**
+     * \brief Program info
+     * \returns Shader type and version
+     */
+    const DxsoProgramInfo& info() const {
+      return m_info;
+    }
+
+    /**
+     * \brief Declared inputs
+     * \returns Input registers and their semantics
+     */
+    const std::vector<DxsoInterpreterInput>& inputs() const {
+      return m_inputs;
+    }
+
+    /**
+     * \brief Declared outputs
+     * \returns Output slots and their semantics
+     */
+    const std::vector<DxsoInterpreterOutput>& outputs() const {
+      return m_outputs;
+    }
+
+    /**
+     * \brief Executes the program
+     *
+     * \param [in] constants Constant registers
+     * \param [in,out] io Input and output registers
+     * \param [in] laneMask Lanes that contain valid vertices
+     */
+    void execute(
+      const DxsoInterpreterConstants& constants,
+            DxsoInterpreterIo&        io,
+            uint32_t                  laneMask) const;
+
+  private:
+
+    DxsoProgramInfo                             m_info;
+    bool                                        m_supported = true;
+
+    D3D9FloatEmulation                          m_floatEmulation;
+    bool                                        m_strictPow;
+
+    uint32_t                                    m_tempCount = 0;
+
+    std::vector<DxsoInterpreterInput>           m_inputs;
+    std::vector<DxsoInterpreterOutput>          m_outputs;
+
+    std::vector<DxsoInterpreterInstruction>     m_code;
+
+    std::vector<std::pair<uint32_t, Vector4>>   m_defFloats;
+    std::vector<std::pair<uint32_t, Vector4i>>  m_defInts;
+    std::vector<std::pair<uint32_t, bool>>      m_defBools;
+
+    void compile(const void* pBytecode);
+
+    bool compileInstruction(
+      const DxsoInstructionContext&   ctx);
+
+    bool compileSrc(
+            DxsoInterpreterOperand&   operand,
+      const DxsoRegister&             reg);
+
+    bool compileDst(
+            DxsoInterpreterOperand&   operand,
+      const DxsoRegister&             reg);
+
+    void declareOutput(
+      const DxsoSemantic&             semantic,
+            uint32_t                  slot,
+            uint32_t                  component);
+
+    bool resolveControlFlow();
+
+  };
+
+}
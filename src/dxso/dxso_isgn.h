@@ -29,6 +29,8 @@ namespace dxvk {
 
   using DxsoDefinedConstants = std::vector<DxsoDefinedConstant>;
 
+  using DxsoConstantMaskF = std::array<uint32_t, DxsoMaxPackedConstsF / 32>;
+
   struct DxsoShaderMetaInfo {
     bool needsConstantCopies = false;
     uint32_t maxConstIndexF = 0;
@@ -36,6 +38,56 @@ namespace dxvk {
     uint32_t maxConstIndexB = 0;
 
     uint32_t boolConstantMask = 0;
+
+    // If set, the float constant array only contains the registers
+    // in packedConstantMaskF, in ascending order of register index.
+    bool packedConstantsF = false;
+    DxsoConstantMaskF packedConstantMaskF = { };
+
+    /**
+     * \brief Checks whether a float constant range is read
+     *
+     * \param [in] first First register
+     * \param [in] count Number of registers
+     * \returns \c true if the shader may read any register in the range
+     */
+    bool usesConstantsF(uint32_t first, uint32_t count) const {
+      if (first >= maxConstIndexF)
+        return false;
+
+      if (!packedConstantsF)
+        return true;
+
+      uint32_t end = std::min(first + count, maxConstIndexF);
+
+      for (uint32_t i = first; i < end; i++) {
+        if (packedConstantMaskF[i / 32] & (1u << (i % 32)))
+          return true;
+      }
+
+      return false;
+    }
+
+    /**
+     * \brief Computes packed float constant count
+     *
+     * \param [in] count Number of registers to consider
+     * \returns Number of packed registers with an index below \c count
+     */
+    uint32_t getPackedConstantCountF(uint32_t count) const {
+      uint32_t result = 0;
+
+      for (uint32_t i = 0; i < packedConstantMaskF.size() && i * 32 < count; i++) {
+        uint32_t mask = packedConstantMaskF[i];
+
+        if (count - i * 32 < 32)
+          mask &= (1u << (count - i * 32)) - 1;
+
+        result += bit::popcnt(mask);
+      }
+
+      return result;
+    }
   };
 
 }
\ No newline at end of file
@@ -25,12 +25,15 @@ namespace dxvk {
     const DxsoModuleInfo&     moduleInfo,
     const std::string&        fileName,
     const DxsoAnalysisInfo&   analysis,
-    const D3D9ConstantLayout& layout) {
+    const D3D9ConstantLayout& layout,
+          DxvkShaderCompileTimings* timings) {
     auto compiler = std::make_unique<DxsoCompiler>(
       fileName, moduleInfo,
       m_header.info(), analysis,
       layout);
 
+    auto t0 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
     this->runCompiler(*compiler, m_code.iter());
     m_isgn = compiler->isgn();
 
@@ -39,6 +42,8 @@ namespace dxvk {
     m_maxDefinedConst = compiler->maxDefinedConstant();
     m_usedSamplers    = compiler->usedSamplers();
 
+    auto t1 = timings ? high_resolution_clock::now() : high_resolution_clock::time_point();
+
     compiler->finalize();
 
     // SM 1 doesn't have explicit output registers and uses R0 instead.
@@ -46,7 +51,14 @@ namespace dxvk {
     // after that.
     m_usedRTs = compiler->usedRTs();
 
-    return compiler->compile();
+    Rc<DxvkShader> shader = compiler->compile(timings);
+
+    if (timings) {
+      timings->compile  = t1 - t0;
+      timings->finalize = high_resolution_clock::now() - t1 - timings->spirv;
+    }
+
+    return shader;
   }
 
   void DxsoModule::runAnalyzer(
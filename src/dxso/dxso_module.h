@@ -39,13 +39,16 @@ namespace dxvk {
      * \param [in] moduleInfo DXSO module info
      * \param [in] fileName File name, will be added to
      *        the compiled SPIR-V for debugging purposes.
+     * \param [out] timings Optional per-pass timings. The
+     *        analysis pass is run separately via \ref analyze.
      * \returns The compiled shader object
      */
     Rc<DxvkShader> compile(
       const DxsoModuleInfo&     moduleInfo,
       const std::string&        fileName,
       const DxsoAnalysisInfo&   analysis,
-      const D3D9ConstantLayout& layout);
+      const D3D9ConstantLayout& layout,
+            DxvkShaderCompileTimings* timings = nullptr);
 
     const DxsoIsgn& isgn() {
       return m_isgn;
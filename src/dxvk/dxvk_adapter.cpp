@@ -160,6 +160,7 @@ namespace dxvk {
 
     DxvkAdapterQueueIndices queues;
     queues.graphics = graphicsQueue;
+    queues.compute = computeQueue;
     queues.transfer = transferQueue;
     queues.sparse = sparseQueue;
     return queues;
@@ -248,6 +249,7 @@ namespace dxvk {
         && CHECK_FEATURE_NEED(extDepthBiasControl.leastRepresentableValueForceUnormRepresentation)
         && CHECK_FEATURE_NEED(extDepthBiasControl.floatRepresentation)
         && CHECK_FEATURE_NEED(extDepthBiasControl.depthBiasExact)
+        && CHECK_FEATURE_NEED(extDescriptorBuffer.descriptorBuffer)
         && CHECK_FEATURE_NEED(extGraphicsPipelineLibrary.graphicsPipelineLibrary)
         && CHECK_FEATURE_NEED(extMemoryBudget)
         && CHECK_FEATURE_NEED(extMemoryPriority.memoryPriority)
@@ -293,6 +295,20 @@ namespace dxvk {
       enabledFeatures.vk12.bufferDeviceAddress = VK_TRUE;
     }
 
+    // Descriptor buffers are opt-in since they require buffer device
+    // addresses for all shader-visible buffers, which is not free.
+    bool enableDescriptorBuffer = instance->options().enableDescriptorBuffer &&
+      m_deviceExtensions.supports(devExtensions.extDescriptorBuffer.name()) &&
+      m_deviceFeatures.extDescriptorBuffer.descriptorBuffer &&
+      m_deviceFeatures.vk12.bufferDeviceAddress;
+
+    if (enableDescriptorBuffer) {
+      devExtensions.extDescriptorBuffer.setMode(DxvkExtMode::Optional);
+
+      enabledFeatures.extDescriptorBuffer.descriptorBuffer = VK_TRUE;
+      enabledFeatures.vk12.bufferDeviceAddress = VK_TRUE;
+    }
+
     DxvkNameSet extensionsEnabled;
 
     if (!m_deviceExtensions.enableExtensions(
@@ -442,6 +458,7 @@ namespace dxvk {
 
     DxvkAdapterQueueIndices queueFamilies = findQueueFamilies();
     queueFamiliySet.insert(queueFamilies.graphics);
+    queueFamiliySet.insert(queueFamilies.compute);
     queueFamiliySet.insert(queueFamilies.transfer);
 
     if (queueFamilies.sparse != VK_QUEUE_FAMILY_IGNORED)
@@ -479,7 +496,7 @@ namespace dxvk {
       extensionsEnabled.disableExtension(devExtensions.nvxBinaryImport);
       extensionsEnabled.disableExtension(devExtensions.nvxImageViewHandle);
 
-      enabledFeatures.vk12.bufferDeviceAddress = VK_FALSE;
+      enabledFeatures.vk12.bufferDeviceAddress = enableDescriptorBuffer;
 
       extensionNameList = extensionsEnabled.toNameList();
       info.enabledExtensionCount      = extensionNameList.count();
@@ -495,6 +512,7 @@ namespace dxvk {
 
     DxvkDeviceQueueSet queues = { };
     queues.graphics = getDeviceQueue(vkd, queueFamilies.graphics, 0);
+    queues.compute = getDeviceQueue(vkd, queueFamilies.compute, 0);
     queues.transfer = getDeviceQueue(vkd, queueFamilies.transfer, 0);
     queues.sparse = getDeviceQueue(vkd, queueFamilies.sparse, 0);
 
@@ -550,6 +568,10 @@ namespace dxvk {
           enabledFeatures.extDepthBiasControl = *reinterpret_cast<const VkPhysicalDeviceDepthBiasControlFeaturesEXT*>(f);
           break;
 
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT:
+          enabledFeatures.extDescriptorBuffer = *reinterpret_cast<const VkPhysicalDeviceDescriptorBufferFeaturesEXT*>(f);
+          break;
+
         case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT:
           enabledFeatures.extExtendedDynamicState3 = *reinterpret_cast<const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT*>(f);
           break;
@@ -632,6 +654,7 @@ namespace dxvk {
     // We only support one queue when importing devices, and no sparse.
     DxvkDeviceQueueSet queues = { };
     queues.graphics = { args.queue, args.queueFamily };
+    queues.compute = queues.graphics;
     queues.transfer = queues.graphics;
 
     return new DxvkDevice(instance, this, vkd, enabledFeatures, queues, args.queueCallback);
@@ -738,6 +761,11 @@ namespace dxvk {
       m_deviceInfo.extCustomBorderColor.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extCustomBorderColor);
     }
 
+    if (m_deviceExtensions.supports(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+      m_deviceInfo.extDescriptorBuffer.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+      m_deviceInfo.extDescriptorBuffer.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extDescriptorBuffer);
+    }
+
     if (m_deviceExtensions.supports(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)) {
       m_deviceInfo.extExtendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_PROPERTIES_EXT;
       m_deviceInfo.extExtendedDynamicState3.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extExtendedDynamicState3);
@@ -836,6 +864,11 @@ namespace dxvk {
       m_deviceFeatures.extDepthBiasControl.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extDepthBiasControl);
     }
 
+    if (m_deviceExtensions.supports(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+      m_deviceFeatures.extDescriptorBuffer.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+      m_deviceFeatures.extDescriptorBuffer.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extDescriptorBuffer);
+    }
+
     if (m_deviceExtensions.supports(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)) {
       m_deviceFeatures.extExtendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
       m_deviceFeatures.extExtendedDynamicState3.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extExtendedDynamicState3);
@@ -970,6 +1003,7 @@ namespace dxvk {
       &devExtensions.extCustomBorderColor,
       &devExtensions.extDepthClipEnable,
       &devExtensions.extDepthBiasControl,
+      &devExtensions.extDescriptorBuffer,
       &devExtensions.extExtendedDynamicState3,
       &devExtensions.extFragmentShaderInterlock,
       &devExtensions.extFullScreenExclusive,
@@ -1042,6 +1076,11 @@ namespace dxvk {
       enabledFeatures.extDepthBiasControl.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extDepthBiasControl);
     }
 
+    if (devExtensions.extDescriptorBuffer) {
+      enabledFeatures.extDescriptorBuffer.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+      enabledFeatures.extDescriptorBuffer.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extDescriptorBuffer);
+    }
+
     if (devExtensions.extExtendedDynamicState3) {
       enabledFeatures.extExtendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
       enabledFeatures.extExtendedDynamicState3.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extExtendedDynamicState3);
@@ -1227,6 +1266,8 @@ namespace dxvk {
       "\n  leastRepresentableValueForceUnormRepresentation : ", features.extDepthBiasControl.leastRepresentableValueForceUnormRepresentation ? "1" : "0",
       "\n  floatRepresentation                    : ", features.extDepthBiasControl.floatRepresentation ? "1" : "0",
       "\n  depthBiasExact                         : ", features.extDepthBiasControl.depthBiasExact ? "1" : "0",
+      "\n", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME,
+      "\n  descriptorBuffer                       : ", features.extDescriptorBuffer.descriptorBuffer ? "1" : "0",
       "\n", VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
       "\n  extDynamicState3AlphaToCoverageEnable  : ", features.extExtendedDynamicState3.extendedDynamicState3AlphaToCoverageEnable ? "1" : "0",
       "\n  extDynamicState3DepthClipEnable        : ", features.extExtendedDynamicState3.extendedDynamicState3DepthClipEnable ? "1" : "0",
@@ -1291,6 +1332,7 @@ namespace dxvk {
   void DxvkAdapter::logQueueFamilies(const DxvkAdapterQueueIndices& queues) {
     Logger::info(str::format("Queue families:",
       "\n  Graphics : ", queues.graphics,
+      "\n  Compute  : ", queues.compute,
       "\n  Transfer : ", queues.transfer,
       "\n  Sparse   : ", queues.sparse != VK_QUEUE_FAMILY_IGNORED ? str::format(queues.sparse) : "n/a"));
   }
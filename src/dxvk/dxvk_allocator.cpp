@@ -0,0 +1,255 @@
+#include "dxvk_allocator.h"
+
+namespace dxvk {
+
+  DxvkTlsfAllocator::DxvkTlsfAllocator(uint64_t capacity)
+  : m_capacity(capacity), m_freeSize(capacity) {
+    m_freeHeads.fill(InvalidBlock);
+
+    // Mark the entire address range as free
+    if (capacity)
+      insertFreeBlock(createBlock(0, capacity));
+  }
+
+
+  DxvkTlsfAllocator::~DxvkTlsfAllocator() {
+
+  }
+
+
+  DxvkTlsfAllocator::Range DxvkTlsfAllocator::alloc(
+          uint64_t              size,
+          uint64_t              align) {
+    size = dxvk::align(size, align);
+
+    if (!size || size > m_freeSize)
+      return Range();
+
+    auto canUseBlock = [this, size, align] (uint32_t index) {
+      const Block& block = m_blocks[index];
+      uint64_t start = dxvk::align(block.offset, align);
+      return start + size <= block.offset + block.length;
+    };
+
+    // Any block in the selected bin is large enough to hold the requested
+    // size, but the block may be misaligned. If that's the case, retry with
+    // a size that accounts for the worst-case amount of alignment padding.
+    uint32_t index = findFreeBlock(size);
+
+    if (index != InvalidBlock && !canUseBlock(index))
+      index = align > 1 ? findFreeBlock(size + align - 1) : InvalidBlock;
+
+    if (index == InvalidBlock)
+      return Range();
+
+    removeFreeBlock(index);
+
+    const uint64_t blockStart = m_blocks[index].offset;
+    const uint64_t blockEnd   = m_blocks[index].offset + m_blocks[index].length;
+
+    const uint64_t allocStart = dxvk::align(blockStart, align);
+    const uint64_t allocEnd   = allocStart + size;
+
+    // Return alignment padding and unused space back to the free lists.
+    // Since adjacent free blocks are always merged, the physical neighbours
+    // of the selected block are allocated, so no further merging is needed.
+    if (allocStart != blockStart) {
+      uint32_t pad = createBlock(blockStart, allocStart - blockStart);
+      uint32_t prev = m_blocks[index].prevPhys;
+
+      m_blocks[pad].prevPhys = prev;
+      m_blocks[pad].nextPhys = index;
+      m_blocks[index].prevPhys = pad;
+
+      if (prev != InvalidBlock)
+        m_blocks[prev].nextPhys = pad;
+
+      insertFreeBlock(pad);
+    }
+
+    if (allocEnd != blockEnd) {
+      uint32_t tail = createBlock(allocEnd, blockEnd - allocEnd);
+      uint32_t next = m_blocks[index].nextPhys;
+
+      m_blocks[tail].prevPhys = index;
+      m_blocks[tail].nextPhys = next;
+      m_blocks[index].nextPhys = tail;
+
+      if (next != InvalidBlock)
+        m_blocks[next].prevPhys = tail;
+
+      insertFreeBlock(tail);
+    }
+
+    m_blocks[index].offset = allocStart;
+    m_blocks[index].length = size;
+
+    m_freeSize -= size;
+
+    Range result;
+    result.offset = allocStart;
+    result.length = size;
+    result.block  = index;
+    return result;
+  }
+
+
+  void DxvkTlsfAllocator::free(
+          uint32_t              block) {
+    m_freeSize += m_blocks[block].length;
+
+    uint32_t next = m_blocks[block].nextPhys;
+
+    if (next != InvalidBlock && m_blocks[next].isFree) {
+      removeFreeBlock(next);
+      mergeWithNext(block);
+    }
+
+    uint32_t prev = m_blocks[block].prevPhys;
+
+    if (prev != InvalidBlock && m_blocks[prev].isFree) {
+      removeFreeBlock(prev);
+      mergeWithNext(prev);
+      block = prev;
+    }
+
+    insertFreeBlock(block);
+  }
+
+
+  uint32_t DxvkTlsfAllocator::findFreeBlock(
+          uint64_t              size) {
+    // Round the size up to the next bin boundary so
+    // that every block in the bin is large enough
+    if (size >= SlCount) {
+      uint32_t msb = 63u - bit::lzcnt(size);
+      size += (uint64_t(1u) << (msb - SlIndexBits)) - 1u;
+    }
+
+    BinIndex bin = computeBinIndex(size);
+
+    uint32_t slMask = m_slMasks[bin.fl] & (~0u << bin.sl);
+
+    if (!slMask) {
+      uint64_t flMask = bin.fl + 1 < FlCount
+        ? m_flMask & (~uint64_t(0u) << (bin.fl + 1))
+        : uint64_t(0u);
+
+      if (!flMask)
+        return InvalidBlock;
+
+      bin.fl = bit::tzcnt(flMask);
+      slMask = m_slMasks[bin.fl];
+    }
+
+    bin.sl = bit::tzcnt(slMask);
+    return m_freeHeads[bin.fl * SlCount + bin.sl];
+  }
+
+
+  uint32_t DxvkTlsfAllocator::createBlock(
+          uint64_t              offset,
+          uint64_t              length) {
+    uint32_t index = m_unusedBlocks;
+
+    if (index != InvalidBlock) {
+      m_unusedBlocks = m_blocks[index].nextFree;
+      m_blocks[index] = Block();
+    } else {
+      index = uint32_t(m_blocks.size());
+      m_blocks.emplace_back();
+    }
+
+    m_blocks[index].offset = offset;
+    m_blocks[index].length = length;
+    return index;
+  }
+
+
+  void DxvkTlsfAllocator::destroyBlock(
+          uint32_t              block) {
+    m_blocks[block] = Block();
+    m_blocks[block].nextFree = m_unusedBlocks;
+    m_unusedBlocks = block;
+  }
+
+
+  void DxvkTlsfAllocator::insertFreeBlock(
+          uint32_t              block) {
+    BinIndex bin = computeBinIndex(m_blocks[block].length);
+    uint32_t& head = m_freeHeads[bin.fl * SlCount + bin.sl];
+
+    m_blocks[block].isFree = true;
+    m_blocks[block].prevFree = InvalidBlock;
+    m_blocks[block].nextFree = head;
+
+    if (head != InvalidBlock)
+      m_blocks[head].prevFree = block;
+
+    head = block;
+
+    m_slMasks[bin.fl] |= 1u << bin.sl;
+    m_flMask |= uint64_t(1u) << bin.fl;
+  }
+
+
+  void DxvkTlsfAllocator::removeFreeBlock(
+          uint32_t              block) {
+    BinIndex bin = computeBinIndex(m_blocks[block].length);
+
+    uint32_t prev = m_blocks[block].prevFree;
+    uint32_t next = m_blocks[block].nextFree;
+
+    if (next != InvalidBlock)
+      m_blocks[next].prevFree = prev;
+
+    if (prev != InvalidBlock) {
+      m_blocks[prev].nextFree = next;
+    } else {
+      m_freeHeads[bin.fl * SlCount + bin.sl] = next;
+
+      if (next == InvalidBlock) {
+        m_slMasks[bin.fl] &= ~(1u << bin.sl);
+
+        if (!m_slMasks[bin.fl])
+          m_flMask &= ~(uint64_t(1u) << bin.fl);
+      }
+    }
+
+    m_blocks[block].isFree = false;
+    m_blocks[block].prevFree = InvalidBlock;
+    m_blocks[block].nextFree = InvalidBlock;
+  }
+
+
+  void DxvkTlsfAllocator::mergeWithNext(
+          uint32_t              block) {
+    uint32_t next = m_blocks[block].nextPhys;
+    uint32_t nextNext = m_blocks[next].nextPhys;
+
+    m_blocks[block].length += m_blocks[next].length;
+    m_blocks[block].nextPhys = nextNext;
+
+    if (nextNext != InvalidBlock)
+      m_blocks[nextNext].prevPhys = block;
+
+    destroyBlock(next);
+  }
+
+
+  DxvkTlsfAllocator::BinIndex DxvkTlsfAllocator::computeBinIndex(
+          uint64_t              size) {
+    // Sizes below the second-level bin count are mapped linearly,
+    // everything else is binned by its most significant bit first
+    if (size < SlCount)
+      return BinIndex { 0u, uint32_t(size) };
+
+    uint32_t msb = 63u - bit::lzcnt(size);
+
+    BinIndex result;
+    result.fl = msb - SlIndexBits + 1u;
+    result.sl = uint32_t(size >> (msb - SlIndexBits)) - SlCount;
+    return result;
+  }
+
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../util/util_bit.h"
+
+namespace dxvk {
+
+  /**
+   * \brief TLSF range allocator
+   *
+   * Two-level segregated fit allocator that sub-allocates
+   * ranges from an abstract address space. Free blocks are
+   * binned by size class, so that finding a suitable block
+   * as well as coalescing freed blocks with their neighbours
+   * are constant-time operations, regardless of how badly
+   * fragmented the address space is.
+   *
+   * Block metadata is stored out-of-band since the memory
+   * being managed is not necessarily host-visible. This
+   * class is not thread-safe.
+   */
+  class DxvkTlsfAllocator {
+    // Number of second-level bins per first-level bin, as log2
+    constexpr static uint32_t SlIndexBits = 4;
+    constexpr static uint32_t SlCount = 1u << SlIndexBits;
+    constexpr static uint32_t FlCount = 64u - SlIndexBits + 1u;
+  public:
+
+    constexpr static uint32_t InvalidBlock = ~0u;
+
+    /**
+     * \brief Allocated range
+     *
+     * The block index must be passed back to
+     * the allocator in order to free the range.
+     */
+    struct Range {
+      uint64_t offset = 0;
+      uint64_t length = 0;
+      uint32_t block  = InvalidBlock;
+
+      explicit operator bool () const {
+        return block != InvalidBlock;
+      }
+    };
+
+    DxvkTlsfAllocator(uint64_t capacity);
+
+    ~DxvkTlsfAllocator();
+
+    /**
+     * \brief Total size of the address space
+     * \returns Capacity, in bytes
+     */
+    uint64_t capacity() const {
+      return m_capacity;
+    }
+
+    /**
+     * \brief Number of bytes not currently allocated
+     * \returns Free size, in bytes
+     */
+    uint64_t freeSize() const {
+      return m_freeSize;
+    }
+
+    /**
+     * \brief Checks whether no ranges are allocated
+     * \returns \c true if the allocator is empty
+     */
+    bool isEmpty() const {
+      return m_freeSize == m_capacity;
+    }
+
+    /**
+     * \brief Queries length of an allocated range
+     *
+     * \param [in] block Block index of the range
+     * \returns Range length, in bytes
+     */
+    uint64_t getLength(uint32_t block) const {
+      return m_blocks[block].length;
+    }
+
+    /**
+     * \brief Allocates a range
+     *
+     * Both the start offset and the length of the returned
+     * range will be aligned to the requested alignment.
+     * \param [in] size Number of bytes to allocate
+     * \param [in] align Required alignment, must be a power of two
+     * \returns Allocated range. Evaluates to \c false on failure.
+     */
+    Range alloc(
+            uint64_t              size,
+            uint64_t              align);
+
+    /**
+     * \brief Frees a range
+     *
+     * \param [in] block Block index of a range
+     *    previously returned from \ref alloc.
+     */
+    void free(
+            uint32_t              block);
+
+  private:
+
+    struct Block {
+      uint64_t offset   = 0;
+      uint64_t length   = 0;
+      uint32_t prevPhys = InvalidBlock;
+      uint32_t nextPhys = InvalidBlock;
+      uint32_t prevFree = InvalidBlock;
+      uint32_t nextFree = InvalidBlock;
+      bool     isFree   = false;
+    };
+
+    struct BinIndex {
+      uint32_t fl;
+      uint32_t sl;
+    };
+
+    uint64_t                m_capacity;
+    uint64_t                m_freeSize;
+
+    std::vector<Block>      m_blocks;
+    uint32_t                m_unusedBlocks = InvalidBlock;
+
+    uint64_t                m_flMask = 0;
+    std::array<uint32_t, FlCount> m_slMasks = { };
+    std::array<uint32_t, FlCount * SlCount> m_freeHeads;
+
+    uint32_t findFreeBlock(
+            uint64_t              size);
+
+    uint32_t createBlock(
+            uint64_t              offset,
+            uint64_t              length);
+
+    void destroyBlock(
+            uint32_t              block);
+
+    void insertFreeBlock(
+            uint32_t              block);
+
+    void removeFreeBlock(
+            uint32_t              block);
+
+    void mergeWithNext(
+            uint32_t              block);
+
+    static BinIndex computeBinIndex(
+            uint64_t              size);
+
+  };
+
+}
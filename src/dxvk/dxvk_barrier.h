@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -90,6 +91,22 @@ namespace dxvk {
       return DxvkAccessFlags(m_access);
     }
 
+    /**
+     * \brief Queries start address
+     * \returns Offset of the first byte
+     */
+    VkDeviceSize getLoAddr() const {
+      return m_loAddr;
+    }
+
+    /**
+     * \brief Queries end address
+     * \returns Offset past the last byte
+     */
+    VkDeviceSize getHiAddr() const {
+      return m_hiAddr;
+    }
+
   private:
 
     VkDeviceSize    m_loAddr;
@@ -222,12 +239,19 @@ namespace dxvk {
    * Implements a versioned hash table for fast resource
    * lookup, with a single-linked list accurately storing
    * each accessed slice if necessary.
+   *
+   * Buffers that are accessed in multiple disjoint ranges
+   * instead use a sorted array of non-overlapping ranges,
+   * with adjacent ranges being coalesced if their access
+   * flags match. This keeps lookups logarithmic even for
+   * large buffers with thousands of sub-allocations.
    * \tparam K Resource handle type
    * \tparam T Resource slice type
    */
   template<typename K, typename T>
   class DxvkBarrierSubresourceSet {
     constexpr static uint32_t NoEntry = ~0u;
+    constexpr static bool IsBuffer = std::is_same_v<T, DxvkBarrierBufferSlice>;
   public:
 
     /**
@@ -249,6 +273,13 @@ namespace dxvk {
       if (!entry->data.overlaps(slice))
         return DxvkAccessFlags();
 
+      if constexpr (IsBuffer) {
+        if (entry->next == NoEntry)
+          return entry->data.getAccess();
+
+        return getRangeAccess(m_ranges[entry->next], slice, entry->data.getAccess());
+      }
+
       ListEntry* list = getListEntry(entry->next);
 
       if (!list)
@@ -288,6 +319,13 @@ namespace dxvk {
       if (!entry->data.isDirty(slice))
         return false;
 
+      if constexpr (IsBuffer) {
+        if (entry->next == NoEntry)
+          return true;
+
+        return isRangeDirty(m_ranges[entry->next], slice);
+      }
+
       // We know that some subresources are dirty, so if
       // there is no list, the given slice must be dirty.
       ListEntry* list = getListEntry(entry->next);
@@ -318,28 +356,38 @@ namespace dxvk {
     void insert(K resource, const T& slice) {
       HashEntry* hashEntry = insertHashEntry(resource, slice);
 
+      if constexpr (IsBuffer) {
+        if (hashEntry) {
+          if (hashEntry->next != NoEntry) {
+            insertRange(m_ranges[hashEntry->next], slice);
+          } else if (!hashEntry->data.canMerge(slice)) {
+            // Only create the range array if absolutely necessary
+            hashEntry->next = allocRangeArray();
+            insertRange(m_ranges[hashEntry->next], hashEntry->data);
+            insertRange(m_ranges[hashEntry->next], slice);
+          }
+
+          hashEntry->data.merge(slice);
+        }
+
+        return;
+      }
+
       if (hashEntry) {
         ListEntry* listEntry = getListEntry(hashEntry->next);
 
         if (listEntry) {
-          if (std::is_same_v<T, DxvkBarrierImageSlice>) {
-            // For images, try to merge the slice with existing
-            // entries if possible to keep the list small
-            do {
-              if (listEntry->data.canMerge(slice)) {
-                listEntry->data.merge(slice);
-                break;
-              }
-            } while ((listEntry = getListEntry(listEntry->next)));
-
-            if (!listEntry)
-              insertListEntry(slice, hashEntry);
-          } else {
-            // For buffers it's not even worth trying. Most of the
-            // time we won't be able to merge, and traversing the
-            // entire list every time is slow.
+          // Try to merge the slice with existing
+          // entries if possible to keep the list small
+          do {
+            if (listEntry->data.canMerge(slice)) {
+              listEntry->data.merge(slice);
+              break;
+            }
+          } while ((listEntry = getListEntry(listEntry->next)));
+
+          if (!listEntry)
             insertListEntry(slice, hashEntry);
-          }
         } else if (!hashEntry->data.canMerge(slice)) {
           // Only create the linear list if absolutely necessary
           insertListEntry(hashEntry->data, hashEntry);
@@ -359,6 +407,7 @@ namespace dxvk {
       m_used = 0;
       m_version += 1;
       m_list.clear();
+      m_rangesUsed = 0;
     }
 
     /**
@@ -390,6 +439,11 @@ namespace dxvk {
     std::vector<ListEntry> m_list;
     std::vector<HashEntry> m_hashMap;
 
+    // Range arrays are recycled across clears in
+    // order to avoid frequent memory allocations
+    std::vector<std::vector<T>> m_ranges;
+    uint32_t               m_rangesUsed = 0;
+
     static size_t computeHash(K key) {
       size_t hash = size_t(key) * 93887;
       return hash ^ (hash >> 16);
@@ -494,6 +548,113 @@ namespace dxvk {
       return &m_list[newIndex];
     }
 
+    uint32_t allocRangeArray() {
+      if (m_rangesUsed == m_ranges.size())
+        m_ranges.emplace_back();
+
+      m_ranges[m_rangesUsed].clear();
+      return m_rangesUsed++;
+    }
+
+    static typename std::vector<T>::const_iterator findFirstRange(
+      const std::vector<T>&         ranges,
+            VkDeviceSize            addr) {
+      // Ranges are disjoint, so end addresses are sorted as well
+      return std::lower_bound(ranges.begin(), ranges.end(), addr,
+        [] (const T& range, VkDeviceSize addr) { return range.getHiAddr() <= addr; });
+    }
+
+    static DxvkAccessFlags getRangeAccess(
+      const std::vector<T>&         ranges,
+      const T&                      slice,
+            DxvkAccessFlags         maxAccess) {
+      DxvkAccessFlags access;
+
+      for (auto i = findFirstRange(ranges, slice.getLoAddr()); i != ranges.end() && access != maxAccess; i++) {
+        if (i->getLoAddr() >= slice.getHiAddr())
+          break;
+
+        access.set(i->getAccess());
+      }
+
+      return access;
+    }
+
+    static bool isRangeDirty(
+      const std::vector<T>&         ranges,
+      const T&                      slice) {
+      for (auto i = findFirstRange(ranges, slice.getLoAddr()); i != ranges.end(); i++) {
+        if (i->getLoAddr() >= slice.getHiAddr())
+          break;
+
+        if (i->isDirty(slice))
+          return true;
+      }
+
+      return false;
+    }
+
+    static void insertRange(
+            std::vector<T>&         ranges,
+      const T&                      slice) {
+      VkDeviceSize lo = slice.getLoAddr();
+      VkDeviceSize hi = slice.getHiAddr();
+
+      // Find all ranges that overlap or are adjacent to the new
+      // range. Usually, sub-allocations are written in ascending
+      // order, so this will typically append to the array.
+      auto first = std::lower_bound(ranges.begin(), ranges.end(), lo,
+        [] (const T& range, VkDeviceSize addr) { return range.getHiAddr() < addr; });
+      auto last = first;
+
+      while (last != ranges.end() && last->getLoAddr() <= hi)
+        last++;
+
+      // Split affected ranges so that each byte has the union of
+      // its old and new access flags, and coalesce neighbouring
+      // ranges with identical access flags.
+      small_vector<T, 8> result;
+
+      auto emit = [&result] (VkDeviceSize lo, VkDeviceSize hi, DxvkAccessFlags access) {
+        if (lo >= hi)
+          return;
+
+        if (!result.empty() && result[result.size() - 1].getHiAddr() == lo
+         && result[result.size() - 1].getAccess() == access)
+          result[result.size() - 1].merge(T(lo, hi - lo, access));
+        else
+          result.push_back(T(lo, hi - lo, access));
+      };
+
+      VkDeviceSize cur = lo;
+
+      for (auto i = first; i != last; i++) {
+        VkDeviceSize rangeLo = i->getLoAddr();
+        VkDeviceSize rangeHi = i->getHiAddr();
+
+        emit(rangeLo, std::min(rangeHi, lo), i->getAccess());
+        emit(cur, std::min(rangeLo, hi), slice.getAccess());
+        emit(std::max(rangeLo, lo), std::min(rangeHi, hi), i->getAccess() | slice.getAccess());
+        emit(std::max(rangeLo, hi), rangeHi, i->getAccess());
+
+        cur = std::max(cur, std::min(rangeHi, hi));
+      }
+
+      emit(cur, hi, slice.getAccess());
+
+      // Replace affected ranges with the new set of ranges
+      size_t index = size_t(first - ranges.begin());
+      size_t count = size_t(last - first);
+
+      if (count < result.size())
+        ranges.insert(ranges.begin() + index + count, result.size() - count, T());
+      else if (count > result.size())
+        ranges.erase(ranges.begin() + index + result.size(), ranges.begin() + index + count);
+
+      for (size_t i = 0; i < result.size(); i++)
+        ranges[index + i] = result[i];
+    }
+
   };
   
   /**
@@ -16,7 +16,13 @@ namespace dxvk {
     m_memAlloc      (&memAlloc),
     m_memFlags      (memFlags),
     m_shaderStages  (util::shaderStages(createInfo.stages)) {
+    if (needsDeviceAddress(device, m_info.usage))
+      m_info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
     if (!(m_info.flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT)) {
+      // Share regular buffers with the async compute queue if necessary
+      m_sharingMode = device->getBufferSharingMode();
+
       // Align slices so that we don't violate any alignment
       // requirements imposed by the Vulkan device/driver
       VkDeviceSize sliceAlignment = computeSliceAlignment(device);
@@ -40,8 +46,15 @@ namespace dxvk {
       m_physSlice.offset = 0;
       m_physSlice.length = m_physSliceLength;
       m_physSlice.mapPtr = m_buffer.memory.mapPtr(0);
+      m_physSlice.gpuAddress = m_buffer.gpuAddress;
 
       m_lazyAlloc = m_physSliceCount > 1;
+
+      // Allow the memory allocator to move the buffer around in order
+      // to reduce fragmentation. Client APIs may initialize the buffer
+      // on a separate context, so only register the buffer once the
+      // primary context uses it, see enableRelocation.
+      m_canRelocate = canRelocate(device);
     } else {
       m_physSliceLength = createInfo.size;
       m_physSliceStride = createInfo.size;
@@ -54,6 +67,7 @@ namespace dxvk {
       m_physSlice.offset = 0;
       m_physSlice.length = createInfo.size;
       m_physSlice.mapPtr = nullptr;
+      m_physSlice.gpuAddress = m_buffer.gpuAddress;
 
       m_lazyAlloc = false;
 
@@ -82,12 +96,25 @@ namespace dxvk {
     m_physSlice.offset = importInfo.offset;
     m_physSlice.length = createInfo.size;
     m_physSlice.mapPtr = importInfo.mapPtr;
+    m_physSlice.gpuAddress = 0;
 
     m_lazyAlloc = false;
+
+    // We cannot add usage flags to an imported buffer, so
+    // rely on the caller to declare device address usage
+    if (needsDeviceAddress(device, m_info.usage)) {
+      if (m_info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+        m_physSlice.gpuAddress = getBufferAddress(importInfo.buffer) + importInfo.offset;
+      else
+        Logger::warn("DxvkBuffer: Imported buffer has no device address, descriptors will be invalid");
+    }
   }
 
 
   DxvkBuffer::~DxvkBuffer() {
+    if (m_relocatable)
+      m_memAlloc->setRelocationOwner(m_buffer.memory, nullptr);
+
     for (const auto& buffer : m_buffers)
       m_vkd->vkDestroyBuffer(m_vkd->device(), buffer.buffer, nullptr);
 
@@ -95,12 +122,50 @@ namespace dxvk {
   }
   
   
+  void DxvkBuffer::enableRelocation() {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+
+    if (!m_canRelocate.exchange(false, std::memory_order_relaxed) || !m_buffers.empty())
+      return;
+
+    m_memAlloc->setRelocationOwner(m_buffer.memory, this);
+    m_relocatable = true;
+  }
+
+
+  Rc<DxvkBufferStorage> DxvkBuffer::relocateStorage() {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+
+    if (!m_relocatable || !m_buffers.empty())
+      return nullptr;
+
+    // Pending writes may have been recorded on another
+    // context with the current storage, skip the buffer
+    if (isInUse(DxvkAccess::Write))
+      return nullptr;
+
+    DxvkBufferHandle handle = allocBuffer(1, false);
+
+    m_memAlloc->setRelocationOwner(m_buffer.memory, nullptr);
+    m_memAlloc->setRelocationOwner(handle.memory, this);
+
+    m_physSlice.handle = handle.buffer;
+    m_physSlice.offset = 0;
+    m_physSlice.mapPtr = handle.memory.mapPtr(0);
+    m_physSlice.gpuAddress = handle.gpuAddress;
+
+    return new DxvkBufferStorage(m_vkd,
+      std::exchange(m_buffer, std::move(handle)));
+  }
+
+
   DxvkBufferHandle DxvkBuffer::allocBuffer(VkDeviceSize sliceCount, bool clear) const {
     VkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
     info.flags = m_info.flags;
     info.size = m_physSliceStride * sliceCount;
     info.usage = m_info.usage;
-    info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    m_sharingMode.fill(info);
     
     DxvkBufferHandle handle;
 
@@ -155,6 +220,9 @@ namespace dxvk {
     if (m_vkd->vkBindBufferMemory(m_vkd->device(), handle.buffer,
         handle.memory.memory(), handle.memory.offset()) != VK_SUCCESS)
       throw DxvkError("DxvkBuffer: Failed to bind device memory");
+
+    if (info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+      handle.gpuAddress = getBufferAddress(handle.buffer);
     
     if (clear && (m_memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
       std::memset(handle.memory.mapPtr(0), 0, info.size);
@@ -181,10 +249,51 @@ namespace dxvk {
         "\n  usage: ", std::hex, info.usage));
     }
 
+    if (info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+      handle.gpuAddress = getBufferAddress(handle.buffer);
+
     return handle;
   }
 
 
+  VkDeviceAddress DxvkBuffer::getBufferAddress(VkBuffer buffer) const {
+    VkBufferDeviceAddressInfo info = { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+    info.buffer = buffer;
+
+    return m_vkd->vkGetBufferDeviceAddress(m_vkd->device(), &info);
+  }
+
+
+  bool DxvkBuffer::canRelocate(DxvkDevice* device) const {
+    if (device->config().defragBudget < 0)
+      return false;
+
+    // Buffers with multiple slices may get renamed frequently,
+    // and host-visible buffers may be persistently mapped
+    if (m_physSliceCount > 1 || (m_memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+      return false;
+
+    // Buffer views and device addresses are tied to the
+    // Vulkan buffer object and cannot be updated easily
+    return !(m_info.usage & (
+      VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT |
+      VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT |
+      VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
+  }
+
+
+  bool DxvkBuffer::needsDeviceAddress(
+          DxvkDevice*           device,
+          VkBufferUsageFlags    usage) {
+    // Descriptor buffers reference shader-visible buffers by address
+    return device->canUseDescriptorBuffer() && (usage & (
+      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+      VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT |
+      VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT));
+  }
+
+
   VkDeviceSize DxvkBuffer::computeSliceAlignment(DxvkDevice* device) const {
     const auto& devInfo = device->properties();
 
@@ -213,6 +322,9 @@ namespace dxvk {
     if (m_info.usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
       result = std::max(result, VkDeviceSize(256));
 
+    if (m_info.usage & (VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT))
+      result = std::max(result, devInfo.extDescriptorBuffer.descriptorBufferOffsetAlignment);
+
     if (m_memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
       result = std::max(result, devInfo.core.properties.limits.nonCoherentAtomSize);
       result = std::max(result, VkDeviceSize(64));
@@ -224,6 +336,20 @@ namespace dxvk {
 
 
   
+  DxvkBufferStorage::DxvkBufferStorage(
+    const Rc<vk::DeviceFn>&     vkd,
+          DxvkBufferHandle&&    handle)
+  : m_vkd(vkd), m_handle(std::move(handle)) {
+
+  }
+
+
+  DxvkBufferStorage::~DxvkBufferStorage() {
+    m_vkd->vkDestroyBuffer(m_vkd->device(), m_handle.buffer, nullptr);
+  }
+
+
+
   DxvkBufferView::DxvkBufferView(
     const Rc<vk::DeviceFn>&         vkd,
     const Rc<DxvkBuffer>&           buffer,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <unordered_map>
 #include <vector>
 
@@ -76,10 +77,13 @@ namespace dxvk {
    * 
    * Stores a Vulkan buffer handle and the
    * memory object that is bound to the buffer.
+   * The device address is only valid if the
+   * buffer was created with device address usage.
    */
   struct DxvkBufferHandle {
-    VkBuffer      buffer = VK_NULL_HANDLE;
-    DxvkMemory    memory;
+    VkBuffer        buffer = VK_NULL_HANDLE;
+    VkDeviceAddress gpuAddress = 0;
+    DxvkMemory      memory;
   };
   
 
@@ -88,13 +92,16 @@ namespace dxvk {
    * 
    * Stores the Vulkan buffer handle, offset
    * and length of the slice, and a pointer
-   * to the mapped region..
+   * to the mapped region. The device address
+   * is only meaningful for buffers created
+   * with device address usage.
    */
   struct DxvkBufferSliceHandle {
-    VkBuffer      handle;
-    VkDeviceSize  offset;
-    VkDeviceSize  length;
-    void*         mapPtr;
+    VkBuffer        handle;
+    VkDeviceSize    offset;
+    VkDeviceSize    length;
+    void*           mapPtr;
+    VkDeviceAddress gpuAddress;
 
     bool eq(const DxvkBufferSliceHandle& other) const {
       return handle == other.handle
@@ -112,6 +119,57 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Retired buffer storage
+   *
+   * Owns the previous backing storage of a buffer that
+   * has been relocated, so that it can be kept alive
+   * until the GPU no longer accesses it.
+   */
+  class DxvkBufferStorage : public DxvkResource {
+
+  public:
+
+    DxvkBufferStorage(
+      const Rc<vk::DeviceFn>&     vkd,
+            DxvkBufferHandle&&    handle);
+
+    ~DxvkBufferStorage();
+
+  private:
+
+    Rc<vk::DeviceFn>  m_vkd;
+    DxvkBufferHandle  m_handle;
+
+  };
+
+
+  /**
+   * \brief Buffer sharing mode info
+   *
+   * Stores the sharing mode and the set of queue
+   * families that a buffer can be accessed from.
+   */
+  struct DxvkSharingModeInfo {
+    VkSharingMode           sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+    uint32_t                queueFamilyCount  = 0;
+    std::array<uint32_t, 3> queueFamilies     = { };
+
+    /**
+     * \brief Writes sharing mode to buffer create info
+     * \param [out] info Buffer create info
+     */
+    void fill(VkBufferCreateInfo& info) const {
+      info.sharingMode = sharingMode;
+
+      if (sharingMode == VK_SHARING_MODE_CONCURRENT) {
+        info.queueFamilyIndexCount = queueFamilyCount;
+        info.pQueueFamilyIndices = queueFamilies.data();
+      }
+    }
+  };
+
+
   /**
    * \brief Virtual buffer resource
    * 
@@ -144,6 +202,17 @@ namespace dxvk {
     const DxvkBufferCreateInfo& info() const {
       return m_info;
     }
+
+    /**
+     * \brief Checks whether the buffer uses concurrent sharing
+     *
+     * Concurrent buffers can be accessed from the async compute
+     * queue without explicit queue family ownership transfers.
+     * \returns \c true if the buffer is shared between queues
+     */
+    bool isConcurrent() const {
+      return m_sharingMode.sharingMode == VK_SHARING_MODE_CONCURRENT;
+    }
     
     /**
      * \brief Memory type flags
@@ -200,6 +269,7 @@ namespace dxvk {
       result.offset = m_physSlice.offset + offset;
       result.length = length;
       result.mapPtr = mapPtr(offset);
+      result.gpuAddress = m_physSlice.gpuAddress + offset;
       return result;
     }
 
@@ -227,6 +297,18 @@ namespace dxvk {
     VkDeviceSize getDynamicOffset(VkDeviceSize offset) const {
       return m_physSlice.offset + offset;
     }
+
+    /**
+     * \brief Retrieves device address
+     *
+     * Only valid if the buffer was created
+     * with device address usage.
+     * \param [in] offset Offset into the buffer
+     * \returns Device address of the given offset
+     */
+    VkDeviceAddress getDeviceAddress(VkDeviceSize offset) const {
+      return m_physSlice.gpuAddress + offset;
+    }
     
     /**
      * \brief Replaces backing resource
@@ -286,6 +368,14 @@ namespace dxvk {
           for (uint32_t i = 0; i < m_physSliceCount; i++)
             pushSlice(handle, i);
 
+          // Buffers with multiple backing buffers cannot be relocated
+          m_canRelocate.store(false, std::memory_order_relaxed);
+
+          if (unlikely(m_relocatable)) {
+            m_memAlloc->setRelocationOwner(m_buffer.memory, nullptr);
+            m_relocatable = false;
+          }
+
           m_buffers.push_back(std::move(handle));
           m_physSliceCount = std::min(m_physSliceCount * 2, m_physSliceMaxCount);
         } else {
@@ -324,6 +414,39 @@ namespace dxvk {
       return m_import.buffer != VK_NULL_HANDLE;
     }
 
+    /**
+     * \brief Checks whether the buffer awaits relocation registration
+     * \returns \c true if \ref enableRelocation needs to be called
+     */
+    bool isRelocationPending() const {
+      return m_canRelocate.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Registers buffer for relocation
+     *
+     * Called when the buffer is first used on the primary
+     * context. Any initialization done through other contexts
+     * must have been recorded at this point, so that relocating
+     * the buffer afterwards preserves its contents.
+     */
+    void enableRelocation();
+
+    /**
+     * \brief Moves buffer to new backing storage
+     *
+     * Allocates new memory for the buffer and replaces the
+     * current backing storage. The caller is responsible for
+     * copying the buffer contents, updating bindings, and
+     * keeping the returned storage object alive until the
+     * GPU has finished using it. Only supported for buffers
+     * that have been registered for relocation, and that do
+     * not have any pending writes.
+     * \returns Previous storage, or \c nullptr if the
+     *    buffer can currently not be relocated.
+     */
+    Rc<DxvkBufferStorage> relocateStorage();
+
   private:
 
     Rc<vk::DeviceFn>        m_vkd;
@@ -332,10 +455,13 @@ namespace dxvk {
     DxvkMemoryAllocator*    m_memAlloc;
     VkMemoryPropertyFlags   m_memFlags;
     VkShaderStageFlags      m_shaderStages;
+    DxvkSharingModeInfo     m_sharingMode;
     
     DxvkBufferHandle        m_buffer;
     DxvkBufferSliceHandle   m_physSlice;
     uint32_t                m_vertexStride = 0;
+    bool                    m_relocatable = false;
+    std::atomic<bool>       m_canRelocate = { false };
 
     alignas(CACHE_LINE_SIZE)
     sync::Spinlock          m_freeMutex;
@@ -359,6 +485,7 @@ namespace dxvk {
       slice.length = m_physSliceLength;
       slice.offset = m_physSliceStride * index;
       slice.mapPtr = handle.memory.mapPtr(slice.offset);
+      slice.gpuAddress = handle.gpuAddress + slice.offset;
       m_freeSlices.push_back(slice);
     }
 
@@ -368,8 +495,18 @@ namespace dxvk {
 
     DxvkBufferHandle createSparseBuffer() const;
 
+    VkDeviceAddress getBufferAddress(
+            VkBuffer              buffer) const;
+
     VkDeviceSize computeSliceAlignment(
             DxvkDevice*           device) const;
+
+    bool canRelocate(
+            DxvkDevice*           device) const;
+
+    static bool needsDeviceAddress(
+            DxvkDevice*           device,
+            VkBufferUsageFlags    usage);
     
   };
   
@@ -504,6 +641,16 @@ namespace dxvk {
     VkDeviceSize getDynamicOffset() const {
       return m_buffer->getDynamicOffset(m_offset);
     }
+
+    /**
+     * \brief Retrieves device address
+     *
+     * Used for descriptor buffer updates.
+     * \returns Buffer slice device address
+     */
+    VkDeviceAddress getDeviceAddress() const {
+      return m_buffer->getDeviceAddress(m_offset);
+    }
     
     /**
      * \brief Pointer to mapped memory region
@@ -59,6 +59,34 @@ namespace dxvk {
           VkQueue               queue) {
     auto vk = device->vkd();
 
+    VkSubmitInfo2 submitInfo = getSubmitInfo();
+    VkResult vr = VK_SUCCESS;
+
+    if (!this->isEmpty())
+      vr = vk->vkQueueSubmit2(queue, 1, &submitInfo, m_fence);
+
+    this->reset();
+    return vr;
+  }
+
+
+  void DxvkCommandSubmission::reset() {
+    m_fence = VK_NULL_HANDLE;
+    m_semaphoreWaits.clear();
+    m_semaphoreSignals.clear();
+    m_commandBuffers.clear();
+  }
+
+
+  bool DxvkCommandSubmission::isEmpty() const {
+    return m_fence == VK_NULL_HANDLE
+        && m_semaphoreWaits.empty()
+        && m_semaphoreSignals.empty()
+        && m_commandBuffers.empty();
+  }
+
+
+  VkSubmitInfo2 DxvkCommandSubmission::getSubmitInfo() const {
     VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
 
     if (!m_semaphoreWaits.empty()) {
@@ -76,29 +104,54 @@ namespace dxvk {
       submitInfo.pSignalSemaphoreInfos = m_semaphoreSignals.data();
     }
 
-    VkResult vr = VK_SUCCESS;
+    return submitInfo;
+  }
 
-    if (!this->isEmpty())
-      vr = vk->vkQueueSubmit2(queue, 1, &submitInfo, m_fence);
 
-    this->reset();
-    return vr;
+  DxvkSubmissionBatch::DxvkSubmissionBatch() {
+
   }
 
 
-  void DxvkCommandSubmission::reset() {
-    m_fence = VK_NULL_HANDLE;
-    m_semaphoreWaits.clear();
-    m_semaphoreSignals.clear();
-    m_commandBuffers.clear();
+  DxvkSubmissionBatch::~DxvkSubmissionBatch() {
+
   }
 
 
-  bool DxvkCommandSubmission::isEmpty() const {
-    return m_fence == VK_NULL_HANDLE
-        && m_semaphoreWaits.empty()
-        && m_semaphoreSignals.empty()
-        && m_commandBuffers.empty();
+  void DxvkSubmissionBatch::addSubmission(
+          DxvkCommandList*      cmdList,
+    const DxvkCommandSubmission& submission) {
+    m_cmdLists.push_back(cmdList);
+    m_submitInfos.push_back(submission.getSubmitInfo());
+    m_fence = submission.getFence();
+  }
+
+
+  VkResult DxvkSubmissionBatch::submit(
+          DxvkDevice*           device,
+          VkQueue               queue) {
+    if (this->isEmpty())
+      return VK_SUCCESS;
+
+    auto vk = device->vkd();
+
+    // Work in the batch completes in submission order, so
+    // waiting for the last fence is sufficient for all lists
+    for (size_t i = 0; i + 1 < m_cmdLists.size(); i++)
+      m_cmdLists[i]->setSyncFence(m_fence);
+
+    VkResult vr = vk->vkQueueSubmit2(queue,
+      m_submitInfos.size(), m_submitInfos.data(), m_fence);
+
+    this->reset();
+    return vr;
+  }
+
+
+  void DxvkSubmissionBatch::reset() {
+    m_cmdLists.clear();
+    m_submitInfos.clear();
+    m_fence = VK_NULL_HANDLE;
   }
 
 
@@ -172,6 +225,7 @@ namespace dxvk {
     m_vkd           (device->vkd()),
     m_vki           (device->instance()->vki()) {
     const auto& graphicsQueue = m_device->queues().graphics;
+    const auto& computeQueue = m_device->queues().compute;
     const auto& transferQueue = m_device->queues().transfer;
 
     VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
@@ -192,6 +246,19 @@ namespace dxvk {
       m_transferPool = new DxvkCommandPool(device, transferQueue.queueFamily);
     else
       m_transferPool = m_graphicsPool;
+
+    if (m_device->canUseAsyncCompute()) {
+      VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+      typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+
+      VkSemaphoreCreateInfo timelineInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &typeInfo };
+
+      if (m_vkd->vkCreateSemaphore(m_vkd->device(), &timelineInfo, nullptr, &m_asyncGraphicsSemaphore)
+       || m_vkd->vkCreateSemaphore(m_vkd->device(), &timelineInfo, nullptr, &m_asyncComputeSemaphore))
+        throw DxvkError("DxvkCommandList: Failed to create semaphore");
+
+      m_computePool = new DxvkCommandPool(device, computeQueue.queueFamily);
+    }
   }
   
   
@@ -202,18 +269,36 @@ namespace dxvk {
     m_vkd->vkDestroySemaphore(m_vkd->device(), m_postSemaphore, nullptr);
     m_vkd->vkDestroySemaphore(m_vkd->device(), m_sdmaSemaphore, nullptr);
 
+    m_vkd->vkDestroySemaphore(m_vkd->device(), m_asyncGraphicsSemaphore, nullptr);
+    m_vkd->vkDestroySemaphore(m_vkd->device(), m_asyncComputeSemaphore, nullptr);
+
     m_vkd->vkDestroyFence(m_vkd->device(), m_fence, nullptr);
   }
   
   
-  VkResult DxvkCommandList::submit() {
+  VkResult DxvkCommandList::submit(
+          DxvkSubmissionBatch&  batch) {
     VkResult status = VK_SUCCESS;
 
     const auto& graphics = m_device->queues().graphics;
+    const auto& compute = m_device->queues().compute;
     const auto& transfer = m_device->queues().transfer;
     const auto& sparse = m_device->queues().sparse;
 
     m_commandSubmission.reset();
+    m_asyncSubmission.reset();
+
+    // Timeline values of the last submitted async compute
+    // work, and of the last async work joined on graphics
+    uint64_t asyncSubmitted = m_asyncTimeline;
+    uint64_t asyncJoined = m_asyncTimeline;
+
+    // Submissions must reach the queue in order, so any batched
+    // work needs to be flushed if we cannot add to the batch.
+    bool batchable = isBatchable();
+
+    if (!batchable && (status = batch.submit(m_device, graphics.queueHandle)))
+      return status;
 
     for (size_t i = 0; i < m_cmdSubmissions.size(); i++) {
       bool isFirst = i == 0;
@@ -233,6 +318,46 @@ namespace dxvk {
         }
       }
 
+      if (cmd.usedFlags.test(DxvkCmdBuffer::AsyncBuffer)) {
+        // Async compute work must observe all prior graphics work. For
+        // any but the first submission, the previous graphics submission
+        // signals the semaphore, otherwise we need to do that here.
+        asyncSubmitted += 1;
+
+        if (isFirst) {
+          m_commandSubmission.signalSemaphore(m_asyncGraphicsSemaphore,
+            asyncSubmitted, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+          if ((status = m_commandSubmission.submit(m_device, graphics.queueHandle)))
+            return status;
+        }
+
+        m_asyncSubmission.waitSemaphore(m_asyncGraphicsSemaphore,
+          asyncSubmitted, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+        // Submissions on the same queue are not implicitly ordered,
+        // so serialize with previous async work of this command list
+        if (asyncSubmitted > m_asyncTimeline + 1) {
+          m_asyncSubmission.waitSemaphore(m_asyncComputeSemaphore,
+            asyncSubmitted - 1, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+        }
+
+        m_asyncSubmission.executeCommandBuffer(cmd.asyncBuffer);
+        m_asyncSubmission.signalSemaphore(m_asyncComputeSemaphore,
+          asyncSubmitted, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+        if ((status = m_asyncSubmission.submit(m_device, compute.queueHandle)))
+          return status;
+      }
+
+      if (cmd.asyncJoin && asyncSubmitted > asyncJoined) {
+        // Commands in this submission access resources that are used by
+        // pending async compute work, so wait for all of it to complete
+        m_commandSubmission.waitSemaphore(m_asyncComputeSemaphore,
+          asyncSubmitted, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+        asyncJoined = asyncSubmitted;
+      }
+
       if (sparseBind) {
         // Sparse binding needs to serialize command execution, so wait
         // for any prior submissions, then block any subsequent ones
@@ -279,6 +404,24 @@ namespace dxvk {
       if (cmd.usedFlags.test(DxvkCmdBuffer::ExecBuffer))
         m_commandSubmission.executeCommandBuffer(cmd.execBuffer);
 
+      if (!isLast && m_cmdSubmissions[i + 1].usedFlags.test(DxvkCmdBuffer::AsyncBuffer)) {
+        // Allow async compute work of the next submission to start
+        m_commandSubmission.signalSemaphore(m_asyncGraphicsSemaphore,
+          asyncSubmitted + 1, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+      }
+
+      if (isLast && asyncSubmitted > asyncJoined) {
+        // Submit the graphics commands on their own so that they can still
+        // overlap with async work, and make the final signal operations
+        // wait for all remaining async compute work to complete.
+        if ((status = m_commandSubmission.submit(m_device, graphics.queueHandle)))
+          return status;
+
+        m_commandSubmission.waitSemaphore(m_asyncComputeSemaphore,
+          asyncSubmitted, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+        asyncJoined = asyncSubmitted;
+      }
+
       if (isLast) {
         // Signal per-command list semaphores on the final submission
         for (const auto& entry : m_signalSemaphores) {
@@ -296,13 +439,37 @@ namespace dxvk {
         m_commandSubmission.signalFence(m_fence);
       }
 
-      // Finally, submit all graphics commands of the current submission
-      if ((status = m_commandSubmission.submit(m_device, graphics.queueHandle)))
+      // Finally, submit all graphics commands of the current submission.
+      // For batchable command lists, this is the only submission, so we
+      // can defer it and pass it to the driver along with other lists.
+      if (isLast && batchable)
+        batch.addSubmission(this, m_commandSubmission);
+      else if ((status = m_commandSubmission.submit(m_device, graphics.queueHandle)))
         return status;
     }
 
+    m_asyncTimeline = asyncSubmitted;
     return VK_SUCCESS;
   }
+
+
+  bool DxvkCommandList::isBatchable() const {
+    if (m_cmdSubmissions.size() != 1)
+      return false;
+
+    const auto& cmd = m_cmdSubmissions[0];
+
+    if (cmd.sparseBind || cmd.usedFlags.test(DxvkCmdBuffer::AsyncBuffer))
+      return false;
+
+    // Transfer commands and semaphore waits are submitted to
+    // the transfer queue separately if it is a dedicated one
+    if (m_device->hasDedicatedTransferQueue()
+     && (cmd.usedFlags.test(DxvkCmdBuffer::SdmaBuffer) || !m_waitSemaphores.empty()))
+      return false;
+
+    return true;
+  }
   
   
   void DxvkCommandList::init() {
@@ -312,6 +479,9 @@ namespace dxvk {
     m_cmd.execBuffer = m_graphicsPool->getCommandBuffer();
     m_cmd.initBuffer = m_graphicsPool->getCommandBuffer();
     m_cmd.sdmaBuffer = m_transferPool->getCommandBuffer();
+
+    if (m_computePool != nullptr)
+      m_cmd.asyncBuffer = m_computePool->getCommandBuffer();
   }
   
   
@@ -325,12 +495,24 @@ namespace dxvk {
     this->endCommandBuffer(m_cmd.initBuffer);
     this->endCommandBuffer(m_cmd.sdmaBuffer);
 
+    if (m_cmd.asyncBuffer)
+      this->endCommandBuffer(m_cmd.asyncBuffer);
+
     // Reset all command buffer handles
     m_cmd = DxvkCommandSubmissionInfo();
 
     // Increment queue submission count
     uint64_t submissionCount = m_cmdSubmissions.size();
     m_statCounters.addCtr(DxvkStatCounter::QueueSubmitCount, submissionCount);
+
+    uint64_t asyncSubmissionCount = 0;
+
+    for (const auto& cmd : m_cmdSubmissions) {
+      if (cmd.usedFlags.test(DxvkCmdBuffer::AsyncBuffer))
+        asyncSubmissionCount += 1;
+    }
+
+    m_statCounters.addCtr(DxvkStatCounter::QueueAsyncSubmitCount, asyncSubmissionCount);
   }
 
 
@@ -354,12 +536,19 @@ namespace dxvk {
       m_cmd.sdmaBuffer = m_transferPool->getCommandBuffer();
     }
 
+    if (m_cmd.usedFlags.test(DxvkCmdBuffer::AsyncBuffer)) {
+      this->endCommandBuffer(m_cmd.asyncBuffer);
+      m_cmd.asyncBuffer = m_computePool->getCommandBuffer();
+    }
+
     m_cmd.usedFlags = 0;
+    m_cmd.asyncJoin = VK_FALSE;
   }
 
   
   VkResult DxvkCommandList::synchronizeFence() {
-    return m_vkd->vkWaitForFences(m_vkd->device(), 1, &m_fence, VK_TRUE, ~0ull);
+    VkFence fence = m_syncFence ? m_syncFence : m_fence;
+    return m_vkd->vkWaitForFences(m_vkd->device(), 1, &fence, VK_TRUE, ~0ull);
   }
 
 
@@ -397,18 +586,39 @@ namespace dxvk {
     m_cmdSubmissions.clear();
     m_cmdSparseBinds.clear();
 
+    m_asyncTracker.reset();
+
     m_wsiSemaphores = PresenterSync();
 
     // Reset actual command buffers and pools
     m_graphicsPool->reset();
     m_transferPool->reset();
 
-    // Reset fence
+    if (m_computePool != nullptr)
+      m_computePool->reset();
+
+    // Reset fence. If the command list was part of a batch, our own
+    // fence was never submitted, but resetting it is still valid.
+    m_syncFence = VK_NULL_HANDLE;
+
     if (m_vkd->vkResetFences(m_vkd->device(), 1, &m_fence))
       Logger::err("DxvkCommandList: Failed to reset fence");
   }
 
 
+  void DxvkCommandList::trackAsyncAccess(DxvkResource* rc, DxvkAccess access) {
+    if (m_asyncCompute) {
+      m_asyncTracker.trackAccess(rc, access);
+    } else if (m_asyncTracker.isHazard(rc, access)) {
+      // Make the current submission wait for all pending async
+      // compute work. This is conservative since it also covers
+      // commands recorded before the conflicting one.
+      m_cmd.asyncJoin = VK_TRUE;
+      m_asyncTracker.reset();
+    }
+  }
+
+
   void DxvkCommandList::endCommandBuffer(VkCommandBuffer cmdBuffer) {
     auto vk = m_device->vkd();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <limits>
+#include <unordered_map>
 
 #include "dxvk_bind_mask.h"
 #include "dxvk_buffer.h"
@@ -30,6 +31,7 @@ namespace dxvk {
     InitBuffer = 0,
     ExecBuffer = 1,
     SdmaBuffer = 2,
+    AsyncBuffer = 3,
   };
   
   using DxvkCmdBufferFlags = Flags<DxvkCmdBuffer>;
@@ -109,6 +111,24 @@ namespace dxvk {
      */
     bool isEmpty() const;
 
+    /**
+     * \brief Queries fence to signal
+     * \returns Fence handle, may be \c VK_NULL_HANDLE
+     */
+    VkFence getFence() const {
+      return m_fence;
+    }
+
+    /**
+     * \brief Builds submit info
+     *
+     * The returned structure points to arrays owned by
+     * this object, and is only valid until the object
+     * gets modified or reset.
+     * \returns Submit info for \c vkQueueSubmit2
+     */
+    VkSubmitInfo2 getSubmitInfo() const;
+
   private:
 
     VkFence                                m_fence = VK_NULL_HANDLE;
@@ -119,6 +139,72 @@ namespace dxvk {
   };
 
 
+  class DxvkCommandList;
+
+  /**
+   * \brief Command list submission batch
+   *
+   * Collects the final graphics queue submissions of multiple
+   * command lists so that they can be passed to the driver in a
+   * single \c vkQueueSubmit2 call. Only the fence of the last
+   * command list in the batch gets signaled, all other command
+   * lists in the batch will wait for that fence instead of their
+   * own. This retains completion semantics since a fence is only
+   * signaled once all prior submissions have completed as well.
+   */
+  class DxvkSubmissionBatch {
+
+  public:
+
+    DxvkSubmissionBatch();
+    ~DxvkSubmissionBatch();
+
+    /**
+     * \brief Adds a command list submission
+     *
+     * The submission object must not be modified
+     * or reset until the batch has been submitted.
+     * \param [in] cmdList The command list
+     * \param [in] submission Final submission of the command list
+     */
+    void addSubmission(
+            DxvkCommandList*      cmdList,
+      const DxvkCommandSubmission& submission);
+
+    /**
+     * \brief Executes all batched submissions and resets object
+     *
+     * Does nothing if the batch is empty.
+     * \param [in] device DXVK device
+     * \param [in] queue Queue to submit to
+     * \returns Submission return value
+     */
+    VkResult submit(
+            DxvkDevice*           device,
+            VkQueue               queue);
+
+    /**
+     * \brief Resets object
+     */
+    void reset();
+
+    /**
+     * \brief Checks whether the batch is empty
+     * \returns \c true if no submissions are pending
+     */
+    bool isEmpty() const {
+      return m_submitInfos.empty();
+    }
+
+  private:
+
+    std::vector<DxvkCommandList*>          m_cmdLists;
+    std::vector<VkSubmitInfo2>             m_submitInfos;
+    VkFence                                m_fence = VK_NULL_HANDLE;
+
+  };
+
+
   /**
    * \brief Command submission info
    *
@@ -130,11 +216,78 @@ namespace dxvk {
     VkCommandBuffer     execBuffer  = VK_NULL_HANDLE;
     VkCommandBuffer     initBuffer  = VK_NULL_HANDLE;
     VkCommandBuffer     sdmaBuffer  = VK_NULL_HANDLE;
+    VkCommandBuffer     asyncBuffer = VK_NULL_HANDLE;
+    VkBool32            asyncJoin   = VK_FALSE;
     VkBool32            sparseBind  = VK_FALSE;
     uint32_t            sparseCmd   = 0;
   };
 
 
+  /**
+   * \brief Async compute dependency tracker
+   *
+   * Keeps track of resources accessed by async compute work
+   * that has not yet been joined with the graphics queue.
+   * Tracking happens at resource granularity, which is
+   * conservative but cheap enough to do for every access.
+   */
+  class DxvkAsyncComputeTracker {
+
+  public:
+
+    /**
+     * \brief Checks whether any resources are tracked
+     * \returns \c true if there is no pending async work
+     */
+    bool empty() const {
+      return m_resources.empty();
+    }
+
+    /**
+     * \brief Registers access from async compute work
+     *
+     * \param [in] rc Accessed resource
+     * \param [in] access Access type
+     */
+    void trackAccess(DxvkResource* rc, DxvkAccess access) {
+      m_resources[rc].set(access);
+    }
+
+    /**
+     * \brief Checks whether an access conflicts with async work
+     *
+     * Concurrent reads are fine, any other combination
+     * of accesses to the same resource is a hazard.
+     * \param [in] rc Accessed resource
+     * \param [in] access Access type
+     * \returns \c true if the access must wait for async work
+     */
+    bool isHazard(DxvkResource* rc, DxvkAccess access) const {
+      auto entry = m_resources.find(rc);
+
+      if (entry == m_resources.end())
+        return false;
+
+      return access == DxvkAccess::Write
+          || entry->second.test(DxvkAccess::Write);
+    }
+
+    /**
+     * \brief Resets tracker
+     *
+     * Called when all pending async work has been joined.
+     */
+    void reset() {
+      m_resources.clear();
+    }
+
+  private:
+
+    std::unordered_map<DxvkResource*, DxvkAccessFlags> m_resources;
+
+  };
+
+
   /**
    * \brief Command pool
    *
@@ -197,9 +350,26 @@ namespace dxvk {
     
     /**
      * \brief Submits command list
+     *
+     * If the command list is batchable, its final graphics
+     * submission is appended to the given batch instead of
+     * being submitted immediately, and the caller is then
+     * responsible for submitting the batch. Otherwise, any
+     * pending batched submissions must be submitted first.
+     * \param [in,out] batch Submission batch
      * \returns Submission status
      */
-    VkResult submit();
+    VkResult submit(
+            DxvkSubmissionBatch&  batch);
+
+    /**
+     * \brief Checks whether the command list can be batched
+     *
+     * This is the case if all work in the command list can be
+     * submitted to the graphics queue in one single submission.
+     * \returns \c true if the command list can be batched
+     */
+    bool isBatchable() const;
     
     /**
      * \brief Stat counters
@@ -247,6 +417,53 @@ namespace dxvk {
      * to split the command list into multiple submissions.
      */
     void next();
+
+    /**
+     * \brief Checks whether async compute work can be appended
+     *
+     * Async compute work is submitted before the graphics work
+     * of the same submission and only waits for prior submissions,
+     * so it can only be recorded as long as no other commands have
+     * been recorded into the current set of command buffers.
+     * \returns \c true if async compute commands can be recorded
+     */
+    bool canRecordAsyncCompute() const {
+      return m_cmd.asyncBuffer != VK_NULL_HANDLE && !m_cmd.sparseBind
+          && !m_cmd.usedFlags.any(
+            DxvkCmdBuffer::InitBuffer,
+            DxvkCmdBuffer::ExecBuffer,
+            DxvkCmdBuffer::SdmaBuffer);
+    }
+
+    /**
+     * \brief Begins recording async compute commands
+     *
+     * Until \ref endAsyncCompute is called, compute pipeline
+     * binds, descriptor binds, push constants and dispatches
+     * are recorded into the async compute command buffer, and
+     * all tracked resources are registered as async accesses.
+     */
+    void beginAsyncCompute() {
+      m_asyncCompute = true;
+    }
+
+    /**
+     * \brief Ends recording async compute commands
+     */
+    void endAsyncCompute() {
+      m_asyncCompute = false;
+    }
+
+    /**
+     * \brief Enables relocation tracking
+     *
+     * Set for command lists recorded by the primary context. Buffers
+     * tracked by such command lists become eligible for relocation.
+     * \param [in] enable Whether to register tracked buffers
+     */
+    void setRelocationTracking(bool enable) {
+      m_trackRelocation = enable;
+    }
     
     /**
      * \brief Frees buffer slice
@@ -274,6 +491,14 @@ namespace dxvk {
     template<DxvkAccess Access, typename T>
     void trackResource(const Rc<T>& rc) {
       m_resources.trackResource<Access>(rc.ptr());
+
+      if constexpr (std::is_same_v<T, DxvkBuffer>) {
+        if (unlikely(m_trackRelocation && rc->isRelocationPending()))
+          rc->enableRelocation();
+      }
+
+      if (Access != DxvkAccess::None && unlikely(m_asyncCompute || !m_asyncTracker.empty()))
+        trackAsyncAccess(rc.ptr(), Access);
     }
     
     /**
@@ -363,6 +588,18 @@ namespace dxvk {
      */
     VkResult synchronizeFence();
 
+    /**
+     * \brief Sets fence to synchronize with
+     *
+     * Used when the command list got submitted as part of
+     * a batch whose fence is owned by a later command list.
+     * That command list must not be reset before this one.
+     * \param [in] fence Fence to wait on
+     */
+    void setSyncFence(VkFence fence) {
+      m_syncFence = fence;
+    }
+
     /**
      * \brief Resets the command list
      * 
@@ -438,7 +675,7 @@ namespace dxvk {
             VkDescriptorSet           descriptorSet,
             uint32_t                  dynamicOffsetCount,
       const uint32_t*                 pDynamicOffsets) {
-      m_vkd->vkCmdBindDescriptorSets(m_cmd.execBuffer,
+      m_vkd->vkCmdBindDescriptorSets(getComputeCmdBuffer(),
         pipeline, pipelineLayout, 0, 1,
         &descriptorSet, dynamicOffsetCount, pDynamicOffsets);
     }
@@ -452,12 +689,33 @@ namespace dxvk {
       const VkDescriptorSet*          descriptorSets,
             uint32_t                  dynamicOffsetCount,
       const uint32_t*                 pDynamicOffsets) {
-      m_vkd->vkCmdBindDescriptorSets(m_cmd.execBuffer,
+      m_vkd->vkCmdBindDescriptorSets(getComputeCmdBuffer(),
         pipeline, pipelineLayout, firstSet, descriptorSetCount,
         descriptorSets, dynamicOffsetCount, pDynamicOffsets);
     }
 
 
+    void cmdBindDescriptorBuffers(
+            uint32_t                  bufferCount,
+      const VkDescriptorBufferBindingInfoEXT* pBindingInfos) {
+      m_vkd->vkCmdBindDescriptorBuffersEXT(getComputeCmdBuffer(),
+        bufferCount, pBindingInfos);
+    }
+
+
+    void cmdSetDescriptorBufferOffsets(
+            VkPipelineBindPoint       pipeline,
+            VkPipelineLayout          pipelineLayout,
+            uint32_t                  firstSet,
+            uint32_t                  setCount,
+      const uint32_t*                 pBufferIndices,
+      const VkDeviceSize*             pOffsets) {
+      m_vkd->vkCmdSetDescriptorBufferOffsetsEXT(getComputeCmdBuffer(),
+        pipeline, pipelineLayout, firstSet, setCount,
+        pBufferIndices, pOffsets);
+    }
+
+
     void cmdBindIndexBuffer(
             VkBuffer                buffer,
             VkDeviceSize            offset,
@@ -480,7 +738,7 @@ namespace dxvk {
     void cmdBindPipeline(
             VkPipelineBindPoint     pipelineBindPoint,
             VkPipeline              pipeline) {
-      m_vkd->vkCmdBindPipeline(m_cmd.execBuffer,
+      m_vkd->vkCmdBindPipeline(getComputeCmdBuffer(),
         pipelineBindPoint, pipeline);
     }
 
@@ -618,9 +876,13 @@ namespace dxvk {
             uint32_t                x,
             uint32_t                y,
             uint32_t                z) {
-      m_cmd.usedFlags.set(DxvkCmdBuffer::ExecBuffer);
+      DxvkCmdBuffer cmdBuffer = m_asyncCompute
+        ? DxvkCmdBuffer::AsyncBuffer
+        : DxvkCmdBuffer::ExecBuffer;
+
+      m_cmd.usedFlags.set(cmdBuffer);
 
-      m_vkd->vkCmdDispatch(m_cmd.execBuffer, x, y, z);
+      m_vkd->vkCmdDispatch(getCmdBuffer(cmdBuffer), x, y, z);
     }
     
     
@@ -774,7 +1036,7 @@ namespace dxvk {
             uint32_t                offset,
             uint32_t                size,
       const void*                   pValues) {
-      m_vkd->vkCmdPushConstants(m_cmd.execBuffer,
+      m_vkd->vkCmdPushConstants(getComputeCmdBuffer(),
         layout, stageFlags, offset, size, pValues);
     }
 
@@ -1034,14 +1296,24 @@ namespace dxvk {
     
     Rc<DxvkCommandPool>       m_graphicsPool;
     Rc<DxvkCommandPool>       m_transferPool;
+    Rc<DxvkCommandPool>       m_computePool;
 
     VkSemaphore               m_bindSemaphore = VK_NULL_HANDLE;
     VkSemaphore               m_postSemaphore = VK_NULL_HANDLE;
     VkSemaphore               m_sdmaSemaphore = VK_NULL_HANDLE;
     VkFence                   m_fence         = VK_NULL_HANDLE;
+    VkFence                   m_syncFence     = VK_NULL_HANDLE;
+
+    VkSemaphore               m_asyncGraphicsSemaphore = VK_NULL_HANDLE;
+    VkSemaphore               m_asyncComputeSemaphore  = VK_NULL_HANDLE;
+    uint64_t                  m_asyncTimeline          = 0;
 
     DxvkCommandSubmissionInfo m_cmd;
 
+    bool                      m_asyncCompute = false;
+    bool                      m_trackRelocation = false;
+    DxvkAsyncComputeTracker   m_asyncTracker;
+
     PresenterSync             m_wsiSemaphores = { };
 
     DxvkLifetimeTracker       m_resources;
@@ -1052,6 +1324,7 @@ namespace dxvk {
     DxvkStatCounters          m_statCounters;
 
     DxvkCommandSubmission     m_commandSubmission;
+    DxvkCommandSubmission     m_asyncSubmission;
 
     std::vector<DxvkFenceValuePair> m_waitSemaphores;
     std::vector<DxvkFenceValuePair> m_signalSemaphores;
@@ -1069,9 +1342,16 @@ namespace dxvk {
       if (cmdBuffer == DxvkCmdBuffer::ExecBuffer) return m_cmd.execBuffer;
       if (cmdBuffer == DxvkCmdBuffer::InitBuffer) return m_cmd.initBuffer;
       if (cmdBuffer == DxvkCmdBuffer::SdmaBuffer) return m_cmd.sdmaBuffer;
+      if (cmdBuffer == DxvkCmdBuffer::AsyncBuffer) return m_cmd.asyncBuffer;
       return VK_NULL_HANDLE;
     }
 
+    VkCommandBuffer getComputeCmdBuffer() const {
+      return unlikely(m_asyncCompute)
+        ? m_cmd.asyncBuffer
+        : m_cmd.execBuffer;
+    }
+
     DxvkSparseBindSubmission& getSparseBindSubmission() {
       if (likely(m_cmd.sparseBind))
         return m_cmdSparseBinds[m_cmd.sparseCmd];
@@ -1084,6 +1364,8 @@ namespace dxvk {
 
     void endCommandBuffer(VkCommandBuffer cmdBuffer);
 
+    void trackAsyncAccess(DxvkResource* rc, DxvkAccess access);
+
   };
   
 }
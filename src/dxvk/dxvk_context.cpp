@@ -16,8 +16,9 @@ namespace dxvk {
     m_initBarriers(DxvkCmdBuffer::InitBuffer),
     m_execAcquires(DxvkCmdBuffer::ExecBuffer),
     m_execBarriers(DxvkCmdBuffer::ExecBuffer),
+    m_asyncBarriers(DxvkCmdBuffer::AsyncBuffer),
     m_queryManager(m_common->queryPool()),
-    m_staging     (device, StagingBufferSize) {
+    m_staging     (device) {
     // Init framebuffer info with default render pass in case
     // the app does not explicitly bind any render targets
     m_state.om.framebufferInfo = makeFramebufferInfo(m_state.om.renderTargets);
@@ -65,6 +66,16 @@ namespace dxvk {
     // Maintenance5 introduced a bounded BindIndexBuffer function
     if (m_device->features().khrMaintenance5.maintenance5)
       m_features.set(DxvkContextFeature::IndexBufferRobustness);
+
+    // Dispatches that only access buffers may run on a dedicated compute queue
+    if (m_device->canUseAsyncCompute())
+      m_features.set(DxvkContextFeature::AsyncCompute);
+
+    // Write descriptors directly to memory instead of using descriptor pools
+    if (m_device->canUseDescriptorBuffer()) {
+      m_features.set(DxvkContextFeature::DescriptorBuffer);
+      m_descriptorBuffer = new DxvkDescriptorBuffer(m_device.ptr());
+    }
   }
   
   
@@ -76,6 +87,7 @@ namespace dxvk {
   void DxvkContext::beginRecording(const Rc<DxvkCommandList>& cmdList) {
     m_cmd = cmdList;
     m_cmd->init();
+    m_cmd->setRelocationTracking(m_type == DxvkContextType::Primary);
 
     if (m_descriptorPool == nullptr)
       m_descriptorPool = m_descriptorManager->getDescriptorPool();
@@ -87,6 +99,12 @@ namespace dxvk {
   Rc<DxvkCommandList> DxvkContext::endRecording() {
     this->endCurrentCommands();
 
+    m_queryManager.signalQueryResults(m_cmd);
+
+    // Cached descriptor sets may reference resources that
+    // are only kept alive by the current command list
+    m_descriptorPool->clearSetCache();
+
     if (m_descriptorPool->shouldSubmit(false)) {
       m_cmd->trackDescriptorPool(m_descriptorPool, m_descriptorManager);
       m_descriptorPool = m_descriptorManager->getDescriptorPool();
@@ -98,6 +116,8 @@ namespace dxvk {
 
 
   void DxvkContext::endFrame() {
+    this->relocateResources();
+
     if (m_descriptorPool->shouldSubmit(true)) {
       m_cmd->trackDescriptorPool(m_descriptorPool, m_descriptorManager);
       m_descriptorPool = m_descriptorManager->getDescriptorPool();
@@ -1245,6 +1265,12 @@ namespace dxvk {
           uint32_t x,
           uint32_t y,
           uint32_t z) {
+    if (m_features.test(DxvkContextFeature::AsyncCompute)
+     && this->dispatchAsync(x, y, z)) {
+      m_cmd->addStatCtr(DxvkStatCounter::CmdDispatchCalls, 1);
+      return;
+    }
+
     if (this->commitComputeState()) {
       this->commitComputeBarriers<false>();
       this->commitComputeBarriers<true>();
@@ -1839,12 +1865,19 @@ namespace dxvk {
     // Allocate new backing resource
     DxvkBufferSliceHandle prevSlice = buffer->rename(slice);
     m_cmd->freeBufferSlice(buffer, prevSlice);
-    
+
+    this->dirtyBufferBindings(buffer);
+  }
+
+
+  void DxvkContext::dirtyBufferBindings(
+    const Rc<DxvkBuffer>&           buffer) {
     // We also need to update all bindings that the buffer
     // may be bound to either directly or through views.
     VkBufferUsageFlags usage = buffer->info().usage &
       ~(VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
 
     // Fast early-out for plain uniform buffers, very common
     if (likely(usage == VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)) {
@@ -5168,25 +5201,27 @@ namespace dxvk {
     dirtySetMask &= layoutSetMask;
 
     std::array<VkDescriptorSet, DxvkDescriptorSets::SetCount> sets;
-    m_descriptorPool->alloc(layout, dirtySetMask, sets.data());
 
     uint32_t descriptorCount = 0;
+    uint32_t writtenSetCount = 0;
 
     for (auto setIndex : bit::BitMask(dirtySetMask)) {
       uint32_t bindingCount = bindings.getBindingCount(setIndex);
-      VkDescriptorSet set = sets[setIndex];
+      uint32_t setDescriptorIndex = descriptorCount;
 
       for (uint32_t j = 0; j < bindingCount; j++) {
         const auto& binding = bindings.getBinding(setIndex, j);
 
         if (!useDescriptorTemplates) {
           auto& descriptorWrite = m_descriptorWrites[descriptorCount];
-          descriptorWrite.dstSet = set;
           descriptorWrite.dstBinding = j;
           descriptorWrite.descriptorType = binding.descriptorType;
         }
 
+        // Clear padding bytes so that the set cache can
+        // hash and compare descriptor infos directly
         auto& descriptorInfo = m_descriptors[descriptorCount++];
+        descriptorInfo = DxvkDescriptorInfo();
 
         switch (binding.descriptorType) {
           case VK_DESCRIPTOR_TYPE_SAMPLER: {
@@ -5332,20 +5367,61 @@ namespace dxvk {
         }
       }
 
-      if (useDescriptorTemplates) {
-        m_cmd->updateDescriptorSetWithTemplate(set,
-          layout->getSetUpdateTemplate(setIndex),
-          &m_descriptors[0]);
-        descriptorCount = 0;
+      // Reuse a set that has already been written with the exact same
+      // descriptors within the current command list, if there is one.
+      VkDescriptorSetLayout setLayout = layout->getSetLayout(setIndex);
+
+      size_t setHash = DxvkDescriptorPool::hashDescriptors(setLayout,
+        bindingCount, &m_descriptors[setDescriptorIndex]);
+
+      VkDescriptorSet set = m_descriptorPool->lookupSet(setLayout,
+        setHash, bindingCount, &m_descriptors[setDescriptorIndex]);
+
+      if (set) {
+        m_cmd->addStatCtr(DxvkStatCounter::DescriptorCacheHits, 1);
+        descriptorCount = setDescriptorIndex;
+
+        if (useDescriptorTemplates)
+          m_cmd->addStatCtr(DxvkStatCounter::DescriptorUpdatesSaved, 1);
+      } else {
+        m_descriptorPool->alloc(layout, 1u << setIndex, sets.data());
+        set = sets[setIndex];
+
+        m_descriptorPool->insertSet(setLayout, set,
+          setHash, bindingCount, &m_descriptors[setDescriptorIndex]);
+
+        m_cmd->addStatCtr(DxvkStatCounter::DescriptorCacheMisses, 1);
+
+        if (useDescriptorTemplates) {
+          m_cmd->updateDescriptorSetWithTemplate(set,
+            layout->getSetUpdateTemplate(setIndex),
+            &m_descriptors[0]);
+        } else {
+          for (uint32_t j = setDescriptorIndex; j < descriptorCount; j++)
+            m_descriptorWrites[j].dstSet = set;
+
+          writtenSetCount += 1;
+        }
       }
 
+      sets[setIndex] = set;
+
+      if (useDescriptorTemplates)
+        descriptorCount = 0;
+
       // If the next set is not dirty, update and bind all previously
       // updated sets in one go in order to reduce api call overhead.
       if (!(((dirtySetMask >> 1) >> setIndex) & 1u)) {
         if (!useDescriptorTemplates) {
-          m_cmd->updateDescriptorSets(descriptorCount,
-            m_descriptorWrites.data());
+          if (writtenSetCount) {
+            m_cmd->updateDescriptorSets(descriptorCount,
+              m_descriptorWrites.data());
+          } else {
+            m_cmd->addStatCtr(DxvkStatCounter::DescriptorUpdatesSaved, 1);
+          }
+
           descriptorCount = 0;
+          writtenSetCount = 0;
         }
 
         // Find first dirty set in the mask and clear bits
@@ -5362,15 +5438,246 @@ namespace dxvk {
   }
 
 
+  template<VkPipelineBindPoint BindPoint>
+  void DxvkContext::updateDescriptorBufferBindings(const DxvkBindingLayoutObjects* layout) {
+    const auto& bindings = layout->layout();
+    auto vk = m_device->vkd();
+
+    bool independentSets = BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+                        && m_flags.test(DxvkContextFlag::GpIndependentSets);
+
+    uint32_t layoutSetMask = layout->getSetMask();
+    uint32_t dirtySetMask = BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+      ? m_descriptorState.getDirtyGraphicsSets()
+      : m_descriptorState.getDirtyComputeSets();
+    dirtySetMask &= layoutSetMask;
+
+    // Rebinding the descriptor buffer invalidates all set offsets,
+    // so we need to write all sets used by the pipeline in that case
+    bool rebind = m_flags.test(DxvkContextFlag::DirtyDescriptorBuffer);
+
+    if (rebind)
+      dirtySetMask = layoutSetMask;
+
+    // Allocate memory for all dirty sets in one go so that
+    // they are guaranteed to end up in the same buffer slice
+    auto computeSize = [layout] (uint32_t setMask) {
+      VkDeviceSize size = 0;
+
+      for (auto setIndex : bit::BitMask(setMask))
+        size += layout->getSetObjects(setIndex)->getSetLayoutSize();
+
+      return size;
+    };
+
+    VkDeviceSize baseOffset = 0;
+
+    if (!m_descriptorBuffer->alloc(computeSize(dirtySetMask), baseOffset)) {
+      this->renameDescriptorBuffer();
+
+      rebind = true;
+      dirtySetMask = layoutSetMask;
+
+      if (!m_descriptorBuffer->alloc(computeSize(dirtySetMask), baseOffset))
+        throw DxvkError("DxvkContext: Descriptor sets exceed descriptor buffer size");
+    }
+
+    if (rebind) {
+      VkDescriptorBufferBindingInfoEXT bindingInfo = m_descriptorBuffer->getBindingInfo();
+      m_cmd->cmdBindDescriptorBuffers(1, &bindingInfo);
+      m_cmd->trackResource<DxvkAccess::Read>(m_descriptorBuffer->buffer());
+
+      // Sets for the other bind point need to be rewritten as well
+      m_descriptorState.dirtyStages(
+        VK_SHADER_STAGE_ALL_GRAPHICS |
+        VK_SHADER_STAGE_COMPUTE_BIT);
+
+      m_flags.clr(DxvkContextFlag::DirtyDescriptorBuffer);
+    }
+
+    std::array<uint32_t, DxvkDescriptorSets::SetCount> bufferIndices = { };
+    std::array<VkDeviceSize, DxvkDescriptorSets::SetCount> setOffsets = { };
+
+    VkDeviceSize setOffset = baseOffset;
+
+    for (auto setIndex : bit::BitMask(dirtySetMask)) {
+      const DxvkBindingSetLayout* setObjects = layout->getSetObjects(setIndex);
+      uint32_t bindingCount = bindings.getBindingCount(setIndex);
+
+      auto setData = reinterpret_cast<char*>(m_descriptorBuffer->mapPtr(setOffset));
+
+      for (uint32_t j = 0; j < bindingCount; j++) {
+        const auto& binding = bindings.getBinding(setIndex, j);
+        const auto& res = m_rc[binding.resourceBinding];
+
+        VkDescriptorGetInfoEXT descriptorInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT };
+        descriptorInfo.type = binding.descriptorType;
+
+        VkDescriptorImageInfo imageInfo = { };
+        VkDescriptorAddressInfoEXT addressInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT };
+        VkSampler sampler = VK_NULL_HANDLE;
+
+        switch (binding.descriptorType) {
+          case VK_DESCRIPTOR_TYPE_SAMPLER: {
+            if (res.sampler != nullptr) {
+              sampler = res.sampler->handle();
+
+              if (m_rcTracked.set(binding.resourceBinding))
+                m_cmd->trackResource<DxvkAccess::None>(res.sampler);
+            } else {
+              sampler = m_common->dummyResources().samplerHandle();
+            }
+
+            descriptorInfo.data.pSampler = &sampler;
+          } break;
+
+          case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: {
+            if (res.imageView != nullptr && res.imageView->handle(binding.viewType) != VK_NULL_HANDLE) {
+              imageInfo.imageView = res.imageView->handle(binding.viewType);
+              imageInfo.imageLayout = res.imageView->imageInfo().layout;
+
+              if (m_rcTracked.set(binding.resourceBinding)) {
+                m_cmd->trackResource<DxvkAccess::None>(res.imageView);
+                m_cmd->trackResource<DxvkAccess::Read>(res.imageView->image());
+              }
+            }
+
+            descriptorInfo.data.pSampledImage = &imageInfo;
+          } break;
+
+          case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: {
+            if (res.imageView != nullptr && res.imageView->handle(binding.viewType) != VK_NULL_HANDLE) {
+              imageInfo.imageView = res.imageView->handle(binding.viewType);
+              imageInfo.imageLayout = res.imageView->imageInfo().layout;
+
+              if (m_rcTracked.set(binding.resourceBinding)) {
+                m_cmd->trackResource<DxvkAccess::None>(res.imageView);
+                m_cmd->trackResource<DxvkAccess::Write>(res.imageView->image());
+              }
+            }
+
+            descriptorInfo.data.pStorageImage = &imageInfo;
+          } break;
+
+          case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: {
+            if (res.sampler != nullptr && res.imageView != nullptr
+             && res.imageView->handle(binding.viewType) != VK_NULL_HANDLE) {
+              imageInfo.sampler = res.sampler->handle();
+              imageInfo.imageView = res.imageView->handle(binding.viewType);
+              imageInfo.imageLayout = res.imageView->imageInfo().layout;
+
+              if (m_rcTracked.set(binding.resourceBinding)) {
+                m_cmd->trackResource<DxvkAccess::None>(res.sampler);
+                m_cmd->trackResource<DxvkAccess::None>(res.imageView);
+                m_cmd->trackResource<DxvkAccess::Read>(res.imageView->image());
+              }
+            } else {
+              imageInfo.sampler = m_common->dummyResources().samplerHandle();
+            }
+
+            descriptorInfo.data.pCombinedImageSampler = &imageInfo;
+          } break;
+
+          case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+          case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: {
+            // Texel buffer descriptors reference memory directly, so
+            // there is no need to create or update the buffer view
+            if (res.bufferView != nullptr) {
+              DxvkBufferSliceHandle slice = res.bufferView->getSliceHandle();
+              addressInfo.address = slice.gpuAddress;
+              addressInfo.range = slice.length;
+              addressInfo.format = res.bufferView->info().format;
+
+              if (m_rcTracked.set(binding.resourceBinding)) {
+                m_cmd->trackResource<DxvkAccess::None>(res.bufferView);
+
+                if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+                  m_cmd->trackResource<DxvkAccess::Write>(res.bufferView->buffer());
+                else
+                  m_cmd->trackResource<DxvkAccess::Read>(res.bufferView->buffer());
+              }
+
+              if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+                descriptorInfo.data.pStorageTexelBuffer = &addressInfo;
+              else
+                descriptorInfo.data.pUniformTexelBuffer = &addressInfo;
+            }
+          } break;
+
+          case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+          case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: {
+            if (res.bufferSlice.length()) {
+              addressInfo.address = res.bufferSlice.getDeviceAddress();
+              addressInfo.range = res.bufferSlice.length();
+
+              if (m_rcTracked.set(binding.resourceBinding)) {
+                if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                  m_cmd->trackResource<DxvkAccess::Write>(res.bufferSlice.buffer());
+                else
+                  m_cmd->trackResource<DxvkAccess::Read>(res.bufferSlice.buffer());
+              }
+
+              if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+                descriptorInfo.data.pStorageBuffer = &addressInfo;
+              else
+                descriptorInfo.data.pUniformBuffer = &addressInfo;
+            }
+          } break;
+
+          default:
+            break;
+        }
+
+        vk->vkGetDescriptorEXT(vk->device(), &descriptorInfo,
+          m_descriptorBuffer->getDescriptorSize(binding.descriptorType),
+          setData + setObjects->getBindingOffset(j));
+      }
+
+      setOffsets[setIndex] = setOffset;
+      setOffset += setObjects->getSetLayoutSize();
+
+      // If the next set is not dirty, set the offsets for all
+      // previously written sets in one go, same as above.
+      if (!(((dirtySetMask >> 1) >> setIndex) & 1u)) {
+        uint32_t firstSet = bit::tzcnt(dirtySetMask);
+        dirtySetMask &= (~1u) << setIndex;
+
+        m_cmd->cmdSetDescriptorBufferOffsets(BindPoint,
+          layout->getPipelineLayout(independentSets),
+          firstSet, setIndex - firstSet + 1,
+          &bufferIndices[firstSet], &setOffsets[firstSet]);
+      }
+    }
+  }
+
+
+  void DxvkContext::renameDescriptorBuffer() {
+    // The previous slice will be released once the current
+    // command list has completed execution on the GPU
+    const Rc<DxvkBuffer>& buffer = m_descriptorBuffer->buffer();
+    this->invalidateBuffer(buffer, buffer->allocSlice());
+
+    m_descriptorBuffer->reset();
+
+    m_flags.set(DxvkContextFlag::DirtyDescriptorBuffer);
+  }
+
+
   void DxvkContext::updateComputeShaderResources() {
-    this->updateResourceBindings<VK_PIPELINE_BIND_POINT_COMPUTE>(m_state.cp.pipeline->getBindings());
+    if (m_features.test(DxvkContextFeature::DescriptorBuffer))
+      this->updateDescriptorBufferBindings<VK_PIPELINE_BIND_POINT_COMPUTE>(m_state.cp.pipeline->getBindings());
+    else
+      this->updateResourceBindings<VK_PIPELINE_BIND_POINT_COMPUTE>(m_state.cp.pipeline->getBindings());
 
     m_descriptorState.clearStages(VK_SHADER_STAGE_COMPUTE_BIT);
   }
   
   
   void DxvkContext::updateGraphicsShaderResources() {
-    this->updateResourceBindings<VK_PIPELINE_BIND_POINT_GRAPHICS>(m_state.gp.pipeline->getBindings());
+    if (m_features.test(DxvkContextFeature::DescriptorBuffer))
+      this->updateDescriptorBufferBindings<VK_PIPELINE_BIND_POINT_GRAPHICS>(m_state.gp.pipeline->getBindings());
+    else
+      this->updateResourceBindings<VK_PIPELINE_BIND_POINT_GRAPHICS>(m_state.gp.pipeline->getBindings());
 
     m_descriptorState.clearStages(VK_SHADER_STAGE_ALL_GRAPHICS);
   }
@@ -6025,6 +6332,62 @@ namespace dxvk {
   }
   
 
+  template<bool DoEmit>
+  void DxvkContext::commitAsyncComputeBarriers() {
+    const auto& layout = m_state.cp.pipeline->getBindings()->layout();
+
+    // Barriers are only needed between dispatches recorded into the
+    // same async command buffer, everything else is synchronized
+    // with semaphores when submitting the command list.
+    if (!DoEmit && !m_asyncBarriers.hasResourceBarriers())
+      return;
+
+    for (uint32_t i = 0; i < DxvkDescriptorSets::CsSetCount; i++) {
+      uint32_t bindingCount = layout.getBindingCount(i);
+
+      for (uint32_t j = 0; j < bindingCount; j++) {
+        const DxvkBindingInfo& binding = layout.getBinding(i, j);
+        const DxvkShaderResourceSlot& slot = m_rc[binding.resourceBinding];
+
+        DxvkBufferSliceHandle bufferSlice = { };
+
+        switch (binding.descriptorType) {
+          case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+          case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            if (likely(slot.bufferSlice.length()))
+              bufferSlice = slot.bufferSlice.getSliceHandle();
+            break;
+
+          case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            if (likely(slot.bufferView != nullptr))
+              bufferSlice = slot.bufferView->getSliceHandle();
+            break;
+
+          default:
+            /* nothing to do */;
+        }
+
+        if (!bufferSlice.handle)
+          continue;
+
+        if constexpr (DoEmit) {
+          // Resource stages may include graphics stages, which
+          // are not supported on the compute queue
+          m_asyncBarriers.accessBuffer(bufferSlice,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, binding.access,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        } else if (m_asyncBarriers.isBufferDirty(bufferSlice,
+            DxvkBarrierSet::getAccessTypes(binding.access))) {
+          m_asyncBarriers.recordCommands(m_cmd);
+          return;
+        }
+      }
+    }
+  }
+
+
   template<bool Indexed, bool Indirect, bool DoEmit>
   void DxvkContext::commitGraphicsBarriers() {
     if (m_barrierControl.test(DxvkBarrierControl::IgnoreGraphicsBarriers))
@@ -6322,6 +6685,80 @@ namespace dxvk {
     this->invalidateBuffer(buffer, buffer->allocSlice());
     return true;
   }
+
+
+  void DxvkContext::relocateResources() {
+    int32_t budget = m_device->config().defragBudget;
+
+    if (budget < 0)
+      return;
+
+    if (!budget)
+      budget = 4;
+
+    auto buffers = m_common->memoryManager().getRelocationCandidates(VkDeviceSize(budget) << 20);
+
+    if (buffers.empty())
+      return;
+
+    this->spillRenderPass(true);
+
+    for (const auto& buffer : buffers)
+      this->relocateBuffer(buffer);
+  }
+
+
+  void DxvkContext::relocateBuffer(
+    const Rc<DxvkBuffer>&           buffer) {
+    DxvkBufferSliceHandle srcSlice = buffer->getSliceHandle();
+    Rc<DxvkBufferStorage> storage;
+
+    // Relocation is purely opportunistic, so don't
+    // treat running out of memory as a fatal error
+    try {
+      storage = buffer->relocateStorage();
+    } catch (const DxvkError&) {
+      return;
+    }
+
+    if (storage == nullptr)
+      return;
+
+    DxvkBufferSliceHandle dstSlice = buffer->getSliceHandle();
+
+    if (m_execBarriers.isBufferDirty(srcSlice, DxvkAccess::Read))
+      m_execBarriers.recordCommands(m_cmd);
+
+    VkBufferCopy2 copyRegion = { VK_STRUCTURE_TYPE_BUFFER_COPY_2 };
+    copyRegion.srcOffset = srcSlice.offset;
+    copyRegion.dstOffset = dstSlice.offset;
+    copyRegion.size      = dstSlice.length;
+
+    VkCopyBufferInfo2 copyInfo = { VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2 };
+    copyInfo.srcBuffer = srcSlice.handle;
+    copyInfo.dstBuffer = dstSlice.handle;
+    copyInfo.regionCount = 1;
+    copyInfo.pRegions = &copyRegion;
+
+    m_cmd->cmdCopyBuffer(DxvkCmdBuffer::ExecBuffer, &copyInfo);
+
+    m_execBarriers.accessBuffer(srcSlice,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_READ_BIT,
+      buffer->info().stages,
+      buffer->info().access);
+
+    m_execBarriers.accessBuffer(dstSlice,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      buffer->info().stages,
+      buffer->info().access);
+
+    m_cmd->trackResource<DxvkAccess::Write>(buffer);
+    m_cmd->trackResource<DxvkAccess::Read>(storage);
+
+    this->dirtyBufferBindings(buffer);
+  }
   
 
   DxvkGraphicsPipeline* DxvkContext::lookupGraphicsPipeline(
@@ -6346,6 +6783,103 @@ namespace dxvk {
   }
 
 
+  bool DxvkContext::canDispatchAsync(
+    const DxvkComputePipeline*          pipeline) const {
+    const auto& layout = pipeline->getBindings()->layout();
+
+    // Only allow dispatches that exclusively access regular buffers.
+    // Images would require layout transitions and ownership transfers,
+    // and buffers that are not shared with the compute queue can only
+    // be accessed on the graphics queue.
+    for (uint32_t i = 0; i < DxvkDescriptorSets::CsSetCount; i++) {
+      uint32_t bindingCount = layout.getBindingCount(i);
+
+      for (uint32_t j = 0; j < bindingCount; j++) {
+        const DxvkBindingInfo& binding = layout.getBinding(i, j);
+        const DxvkShaderResourceSlot& slot = m_rc[binding.resourceBinding];
+
+        switch (binding.descriptorType) {
+          case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+          case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            if (slot.bufferSlice.length() && !slot.bufferSlice.buffer()->isConcurrent())
+              return false;
+            break;
+
+          case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            if (slot.bufferView != nullptr && !slot.bufferView->buffer()->isConcurrent())
+              return false;
+            break;
+
+          default:
+            return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+
+  bool DxvkContext::dispatchAsync(
+          uint32_t                      x,
+          uint32_t                      y,
+          uint32_t                      z) {
+    // Queries cannot span multiple queues
+    if (m_queryManager.hasEnabledQueries())
+      return false;
+
+    DxvkComputePipeline* pipeline = lookupComputePipeline(m_state.cp.shaders);
+
+    if (!pipeline || !this->canDispatchAsync(pipeline))
+      return false;
+
+    // Async commands get submitted before any other commands of the
+    // same submission, so we need to start a new one if any commands
+    // were already recorded. Barriers from previous async command
+    // buffers are irrelevant since submissions use semaphores.
+    if (!m_cmd->canRecordAsyncCompute()) {
+      this->splitCommands();
+      m_asyncBarriers.reset();
+    }
+
+    // Bind all compute state to the async command buffer, and make
+    // sure that all accessed resources are tracked as async accesses.
+    m_flags.set(DxvkContextFlag::CpDirtyPipelineState,
+                DxvkContextFlag::DirtyDescriptorBuffer);
+    m_descriptorState.dirtyStages(VK_SHADER_STAGE_COMPUTE_BIT);
+    m_rcTracked.clear();
+
+    m_cmd->beginAsyncCompute();
+
+    if (this->commitComputeState()) {
+      this->commitAsyncComputeBarriers<false>();
+      this->commitAsyncComputeBarriers<true>();
+
+      m_cmd->cmdDispatch(x, y, z);
+    }
+
+    m_cmd->endAsyncCompute();
+
+    // Subsequent commands on the graphics queue need to re-bind compute
+    // state, and need to track resources again so that hazards with the
+    // pending async work are detected. This includes graphics resources
+    // that remain bound, such as vertex, index and indirect buffers.
+    m_flags.set(DxvkContextFlag::CpDirtyPipelineState,
+                DxvkContextFlag::GpDirtyVertexBuffers,
+                DxvkContextFlag::GpDirtyIndexBuffer,
+                DxvkContextFlag::GpDirtyXfbBuffers,
+                DxvkContextFlag::DirtyDrawBuffer,
+                DxvkContextFlag::DirtyDescriptorBuffer);
+    m_descriptorState.dirtyStages(
+      VK_SHADER_STAGE_ALL_GRAPHICS |
+      VK_SHADER_STAGE_COMPUTE_BIT);
+    m_vbTracked.clear();
+    m_rcTracked.clear();
+    return true;
+  }
+
+
   Rc<DxvkBuffer> DxvkContext::createZeroBuffer(
           VkDeviceSize              size) {
     if (m_zeroBuffer != nullptr && m_zeroBuffer->info().size >= size)
@@ -6412,7 +6946,8 @@ namespace dxvk {
       DxvkContextFlag::GpDirtyDepthBounds,
       DxvkContextFlag::GpDirtyDepthStencilState,
       DxvkContextFlag::CpDirtyPipelineState,
-      DxvkContextFlag::DirtyDrawBuffer);
+      DxvkContextFlag::DirtyDrawBuffer,
+      DxvkContextFlag::DirtyDescriptorBuffer);
 
     m_descriptorState.dirtyStages(
       VK_SHADER_STAGE_ALL_GRAPHICS |
@@ -6427,6 +6962,16 @@ namespace dxvk {
     this->spillRenderPass(true);
     this->flushSharedImages();
 
+    // Copy results of all queries that ended in this
+    // submission so that the app can read them directly
+    if (m_queryManager.copyQueryResults(m_cmd)) {
+      m_execBarriers.accessMemory(
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        VK_ACCESS_HOST_READ_BIT);
+    }
+
     m_sdmaBarriers.finalize(m_cmd);
     m_initBarriers.finalize(m_cmd);
     m_execBarriers.finalize(m_cmd);
@@ -5,6 +5,7 @@
 #include "dxvk_cmdlist.h"
 #include "dxvk_context_state.h"
 #include "dxvk_data.h"
+#include "dxvk_descriptor_buffer.h"
 #include "dxvk_objects.h"
 #include "dxvk_queue.h"
 #include "dxvk_resource.h"
@@ -21,7 +22,7 @@ namespace dxvk {
    * recorded.
    */
   class DxvkContext : public RcObject {
-    constexpr static VkDeviceSize StagingBufferSize = 4ull << 20;
+
   public:
     
     DxvkContext(const Rc<DxvkDevice>& device, DxvkContextType type);
@@ -1404,12 +1405,14 @@ namespace dxvk {
 
     Rc<DxvkDescriptorPool>  m_descriptorPool;
     Rc<DxvkDescriptorManager> m_descriptorManager;
+    Rc<DxvkDescriptorBuffer>  m_descriptorBuffer;
 
     DxvkBarrierSet          m_sdmaAcquires;
     DxvkBarrierSet          m_sdmaBarriers;
     DxvkBarrierSet          m_initBarriers;
     DxvkBarrierSet          m_execAcquires;
     DxvkBarrierSet          m_execBarriers;
+    DxvkBarrierSet          m_asyncBarriers;
     DxvkBarrierControlFlags m_barrierControl;
 
     DxvkGpuQueryManager     m_queryManager;
@@ -1632,6 +1635,11 @@ namespace dxvk {
     template<VkPipelineBindPoint BindPoint>
     void updateResourceBindings(const DxvkBindingLayoutObjects* layout);
 
+    template<VkPipelineBindPoint BindPoint>
+    void updateDescriptorBufferBindings(const DxvkBindingLayoutObjects* layout);
+
+    void renameDescriptorBuffer();
+
     void updateComputeShaderResources();
     void updateGraphicsShaderResources();
 
@@ -1683,6 +1691,9 @@ namespace dxvk {
     template<bool DoEmit>
     void commitComputeBarriers();
 
+    template<bool DoEmit>
+    void commitAsyncComputeBarriers();
+
     void commitComputePostBarriers();
     
     template<bool Indexed, bool Indirect, bool DoEmit>
@@ -1721,11 +1732,27 @@ namespace dxvk {
       const Rc<DxvkBuffer>&           buffer,
             VkDeviceSize              copySize);
 
+    void dirtyBufferBindings(
+      const Rc<DxvkBuffer>&           buffer);
+
+    void relocateResources();
+
+    void relocateBuffer(
+      const Rc<DxvkBuffer>&           buffer);
+
     DxvkGraphicsPipeline* lookupGraphicsPipeline(
       const DxvkGraphicsPipelineShaders&  shaders);
 
     DxvkComputePipeline* lookupComputePipeline(
       const DxvkComputePipelineShaders&   shaders);
+
+    bool canDispatchAsync(
+      const DxvkComputePipeline*          pipeline) const;
+
+    bool dispatchAsync(
+            uint32_t                      x,
+            uint32_t                      y,
+            uint32_t                      z);
     
     Rc<DxvkBuffer> createZeroBuffer(
             VkDeviceSize              size);
@@ -54,6 +54,7 @@ namespace dxvk {
     
     DirtyDrawBuffer,            ///< Indirect argument buffer is dirty
     DirtyPushConstants,         ///< Push constant data has changed
+    DirtyDescriptorBuffer,      ///< Descriptor buffer binding is out of date
   };
   
   using DxvkContextFlags = Flags<DxvkContextFlag>;
@@ -66,6 +67,8 @@ namespace dxvk {
     TrackGraphicsPipeline,
     VariableMultisampleRate,
     IndexBufferRobustness,
+    AsyncCompute,
+    DescriptorBuffer,
     FeatureCount
   };
 
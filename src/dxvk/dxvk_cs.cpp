@@ -63,20 +63,31 @@ namespace dxvk {
   
   
   DxvkCsChunkPool::~DxvkCsChunkPool() {
-    for (DxvkCsChunk* chunk : m_chunks)
+    DxvkCsChunk* chunk = unpackChunk(m_freeList.load());
+
+    while (chunk) {
+      DxvkCsChunk* next = chunk->m_nextFree.load();
       delete chunk;
+      chunk = next;
+    }
   }
   
   
   DxvkCsChunk* DxvkCsChunkPool::allocChunk(DxvkCsChunkFlags flags) {
-    DxvkCsChunk* chunk = nullptr;
+    uint64_t head = m_freeList.load(std::memory_order_acquire);
+    DxvkCsChunk* chunk = unpackChunk(head);
 
-    { std::lock_guard<dxvk::mutex> lock(m_mutex);
-      
-      if (m_chunks.size() != 0) {
-        chunk = m_chunks.back();
-        m_chunks.pop_back();
-      }
+    // Chunks are never deleted while the pool is alive, so reading
+    // the next pointer is safe even if another thread popped the
+    // chunk in the meantime. The tag makes the exchange fail then.
+    while (chunk) {
+      uint64_t next = packChunk(chunk->m_nextFree.load(std::memory_order_relaxed), head);
+
+      if (m_freeList.compare_exchange_weak(head, next,
+          std::memory_order_acquire, std::memory_order_acquire))
+        break;
+
+      chunk = unpackChunk(head);
     }
     
     if (!chunk)
@@ -89,12 +100,78 @@ namespace dxvk {
   
   void DxvkCsChunkPool::freeChunk(DxvkCsChunk* chunk) {
     chunk->reset();
-    
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
-    m_chunks.push_back(chunk);
+
+    // Chunks whose address does not leave room for the tag
+    // cannot be put on the free list, so just delete them
+    if (unlikely(uint64_t(reinterpret_cast<uintptr_t>(chunk)) & ~PtrMask)) {
+      delete chunk;
+      return;
+    }
+
+    uint64_t head = m_freeList.load(std::memory_order_relaxed);
+    uint64_t next;
+
+    do {
+      chunk->m_nextFree.store(unpackChunk(head), std::memory_order_relaxed);
+      next = packChunk(chunk, head);
+    } while (!m_freeList.compare_exchange_weak(head, next,
+      std::memory_order_release, std::memory_order_relaxed));
   }
   
   
+  DxvkCsChunkQueue::DxvkCsChunkQueue() {
+    for (uint64_t i = 0; i < Capacity; i++)
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+
+  DxvkCsChunkQueue::~DxvkCsChunkQueue() {
+
+  }
+
+
+  uint64_t DxvkCsChunkQueue::tryPush(DxvkCsChunkRef& chunk) {
+    uint64_t pos = m_tail.load(std::memory_order_relaxed);
+
+    while (true) {
+      Slot& slot = m_slots[pos % Capacity];
+
+      uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      int64_t diff = int64_t(seq - pos);
+
+      if (!diff) {
+        // Slot is free, try to claim it for this chunk
+        if (m_tail.compare_exchange_weak(pos, pos + 1,
+            std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          slot.chunk = std::move(chunk);
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return pos + 1;
+        }
+      } else if (diff < 0) {
+        // Slot still holds a chunk from the
+        // previous iteration, the queue is full
+        return 0;
+      } else {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+
+  bool DxvkCsChunkQueue::tryPop(DxvkCsChunkRef& chunk) {
+    Slot& slot = m_slots[m_head % Capacity];
+
+    if (slot.seq.load(std::memory_order_acquire) != m_head + 1)
+      return false;
+
+    chunk = std::move(slot.chunk);
+    slot.seq.store(m_head + Capacity, std::memory_order_release);
+
+    m_head += 1;
+    return true;
+  }
+
+
   DxvkCsThread::DxvkCsThread(
     const Rc<DxvkDevice>&   device,
     const Rc<DxvkContext>&  context)
@@ -105,24 +182,41 @@ namespace dxvk {
   
   
   DxvkCsThread::~DxvkCsThread() {
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      m_stopped.store(true);
-    }
-    
-    m_condOnAdd.notify_one();
+    m_stopped.store(true);
+    wakeUp();
+
     m_thread.join();
+
+    // Release any chunks that were not executed
+    DxvkCsChunkRef chunk;
+
+    while (m_queue.tryPop(chunk))
+      chunk = DxvkCsChunkRef();
   }
   
   
   uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
-    uint64_t seq;
+    uint64_t seq = m_queue.tryPush(chunk);
 
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      seq = ++m_chunksDispatched;
-      m_chunksQueued.push_back(std::move(chunk));
+    if (unlikely(!seq)) {
+      // The queue is full, which means that the CS thread is busy
+      // anyway. Make sure it is awake and wait for it to catch up.
+      wakeUp();
+
+      sync::spin(200, [this, &chunk, &seq] {
+        seq = m_queue.tryPush(chunk);
+        return seq != 0;
+      });
     }
-    
-    m_condOnAdd.notify_one();
+
+    // Only wake up the worker if it is actually sleeping. This pairs
+    // with the fence in waitForChunk, so that either the worker sees
+    // the chunk we just added, or we see that it is parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_parked.load(std::memory_order_relaxed))
+      wakeUp();
+
     return seq;
   }
   
@@ -135,14 +229,18 @@ namespace dxvk {
       // happens while another thread is submitting then there is
       // an inherent race anyway
       if (seq == SynchronizeAll)
-        seq = m_chunksDispatched.load();
+        seq = m_queue.lastSequenceNumber();
 
       auto t0 = dxvk::high_resolution_clock::now();
 
       { std::unique_lock<dxvk::mutex> lock(m_counterMutex);
+        m_syncWaiters += 1;
+
         m_condOnSync.wait(lock, [this, seq] {
           return m_chunksExecuted.load() >= seq;
         });
+
+        m_syncWaiters -= 1;
       }
 
       auto t1 = dxvk::high_resolution_clock::now();
@@ -154,44 +252,80 @@ namespace dxvk {
   }
   
   
+  void DxvkCsThread::wakeUp() {
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_parked.store(false);
+    }
+
+    m_condOnAdd.notify_one();
+  }
+
+
+  bool DxvkCsThread::waitForChunk(DxvkCsChunkRef& chunk) {
+    if (m_queue.tryPop(chunk))
+      return true;
+
+    // Spin for a short while before going to sleep, since applications
+    // tend to submit chunks in quick succession. Unlike sync::spin, this
+    // must not spin indefinitely, so that the thread can park itself.
+    for (uint32_t i = 0; i < 256 && !m_stopped.load(std::memory_order_relaxed); i++) {
+      sync::pause();
+
+      if (m_queue.tryPop(chunk))
+        return true;
+    }
+
+    while (!m_stopped.load()) {
+      m_parked.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      // Re-check the queue after announcing that we are about to
+      // sleep, a producer may have added a chunk in the meantime
+      if (m_queue.tryPop(chunk)) {
+        m_parked.store(false);
+        return true;
+      }
+
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      m_condOnAdd.wait(lock, [this] {
+        return !m_parked.load() || m_stopped.load();
+      });
+
+      if (m_queue.tryPop(chunk))
+        return true;
+    }
+
+    return false;
+  }
+
+
   void DxvkCsThread::threadFunc() {
     env::setThreadName("dxvk-cs");
 
-    // Local chunk queue, we use two queues and swap between
-    // them in order to potentially reduce lock contention.
-    std::vector<DxvkCsChunkRef> chunks;
+    DxvkCsChunkRef chunk;
 
     try {
-      while (!m_stopped.load()) {
-        { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      while (waitForChunk(chunk)) {
+        m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
 
-          m_condOnAdd.wait(lock, [this] {
-            return (!m_chunksQueued.empty())
-                || (m_stopped.load());
-          });
+        chunk->executeAll(m_context.ptr());
 
-          std::swap(chunks, m_chunksQueued);
-        }
-
-        for (auto& chunk : chunks) {
-          m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+        // Explicitly free chunk here to release
+        // references to any resources held by it
+        chunk = DxvkCsChunkRef();
 
-          chunk->executeAll(m_context.ptr());
+        // Only take the counter lock if another thread is actually
+        // waiting for chunks to complete. This pairs with the lock
+        // in synchronize, so that the waiter either sees the updated
+        // counter when checking the condition, or gets notified.
+        m_chunksExecuted.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
 
-          // Use a separate mutex for the chunk counter, this
-          // will only ever be contested if synchronization is
-          // actually necessary.
-          { std::unique_lock<dxvk::mutex> lock(m_counterMutex);
-            m_chunksExecuted += 1;
-            m_condOnSync.notify_one();
-          }
-
-          // Explicitly free chunk here to release
-          // references to any resources held by it
-          chunk = DxvkCsChunkRef();
+        if (m_syncWaiters.load(std::memory_order_relaxed)) {
+          std::unique_lock<dxvk::mutex> lock(m_counterMutex);
+          m_condOnSync.notify_all();
         }
-
-        chunks.clear();
       }
     } catch (const DxvkError& e) {
       Logger::err("Exception on CS thread!");
@@ -199,4 +333,4 @@ namespace dxvk {
     }
   }
   
-}
\ No newline at end of file
+}
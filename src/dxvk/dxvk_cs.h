@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
@@ -138,6 +139,7 @@ namespace dxvk {
    * Stores a list of commands.
    */
   class DxvkCsChunk : public RcObject {
+    friend class DxvkCsChunkPool;
     constexpr static size_t MaxBlockSize = 16384;
   public:
     
@@ -242,6 +244,8 @@ namespace dxvk {
     DxvkCsCmd* m_tail = nullptr;
 
     DxvkCsChunkFlags m_flags;
+
+    std::atomic<DxvkCsChunk*> m_nextFree = { nullptr };
     
     alignas(64)
     char m_data[MaxBlockSize];
@@ -255,9 +259,24 @@ namespace dxvk {
    * Implements a pool of CS chunks which can be
    * recycled. The goal is to reduce the number
    * of dynamic memory allocations.
+   *
+   * Free chunks are stored in a lock-free stack.
+   * The head pointer is tagged with a counter in
+   * its unused upper bits in order to avoid ABA
+   * problems, which is safe since chunks are only
+   * ever deleted when the pool itself is destroyed.
+   *
+   * On 64-bit platforms, this assumes that user-space
+   * addresses fit into 48 bits, which holds for x86-64
+   * with 4-level paging and for arm64 with 48-bit virtual
+   * addresses. Chunks allocated above that range are not
+   * pooled and are deleted when freed instead.
    */
   class DxvkCsChunkPool {
-    
+    static_assert(sizeof(uintptr_t) <= sizeof(uint64_t));
+
+    constexpr static uint32_t TagShift = sizeof(uintptr_t) == 8 ? 48 : 32;
+    constexpr static uint64_t PtrMask  = (uint64_t(1) << TagShift) - 1;
   public:
     
     DxvkCsChunkPool();
@@ -286,8 +305,16 @@ namespace dxvk {
     
   private:
     
-    dxvk::mutex               m_mutex;
-    std::vector<DxvkCsChunk*> m_chunks;
+    std::atomic<uint64_t>     m_freeList = { 0ull };
+
+    static DxvkCsChunk* unpackChunk(uint64_t value) {
+      return reinterpret_cast<DxvkCsChunk*>(uintptr_t(value & PtrMask));
+    }
+
+    static uint64_t packChunk(DxvkCsChunk* chunk, uint64_t prev) {
+      uint64_t tag = (prev >> TagShift) + 1;
+      return uint64_t(reinterpret_cast<uintptr_t>(chunk)) | (tag << TagShift);
+    }
     
   };
   
@@ -372,11 +399,79 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Chunk queue
+   *
+   * Bounded lock-free multi-producer, single-consumer
+   * ring buffer used to pass chunks to the CS thread.
+   * Each slot stores a sequence number which tells
+   * producers and the consumer whether the slot is
+   * ready to be written or read, respectively.
+   */
+  class DxvkCsChunkQueue {
+    constexpr static uint64_t Capacity = 1024;
+  public:
+
+    DxvkCsChunkQueue();
+    ~DxvkCsChunkQueue();
+
+    DxvkCsChunkQueue             (const DxvkCsChunkQueue&) = delete;
+    DxvkCsChunkQueue& operator = (const DxvkCsChunkQueue&) = delete;
+
+    /**
+     * \brief Number of chunks pushed so far
+     * \returns Sequence number of the last queued chunk
+     */
+    uint64_t lastSequenceNumber() const {
+      return m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Tries to add a chunk to the queue
+     *
+     * Only consumes the chunk on success. Safe
+     * to call from multiple threads at once.
+     * \param [in] chunk The chunk to add
+     * \returns Sequence number of the chunk, or
+     *    zero if the queue is currently full.
+     */
+    uint64_t tryPush(DxvkCsChunkRef& chunk);
+
+    /**
+     * \brief Tries to take a chunk from the queue
+     *
+     * Must only be called from the consumer thread.
+     * \param [out] chunk The chunk
+     * \returns \c true if a chunk was available
+     */
+    bool tryPop(DxvkCsChunkRef& chunk);
+
+  private:
+
+    struct Slot {
+      std::atomic<uint64_t> seq = { 0ull };
+      DxvkCsChunkRef        chunk;
+    };
+
+    std::array<Slot, Capacity> m_slots;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t> m_tail = { 0ull };
+
+    alignas(CACHE_LINE_SIZE)
+    uint64_t              m_head = 0ull;
+
+  };
+
+
   /**
    * \brief Command stream thread
    * 
    * Spawns a thread that will execute
-   * commands on a DXVK context. 
+   * commands on a DXVK context. Chunks are passed
+   * to the thread through a lock-free queue, and
+   * producers only need to take a lock in order
+   * to wake up the thread if it is sleeping.
    */
   class DxvkCsThread {
     
@@ -425,18 +520,28 @@ namespace dxvk {
     Rc<DxvkDevice>              m_device;
     Rc<DxvkContext>             m_context;
 
+    DxvkCsChunkQueue            m_queue;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<uint64_t>       m_chunksExecuted  = { 0ull };
+    std::atomic<uint32_t>       m_syncWaiters     = { 0u };
     dxvk::mutex                 m_counterMutex;
-    std::atomic<uint64_t>       m_chunksDispatched = { 0ull };
-    std::atomic<uint64_t>       m_chunksExecuted   = { 0ull };
-    
+    dxvk::condition_variable    m_condOnSync;
+
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<bool>           m_parked  = { false };
     std::atomic<bool>           m_stopped = { false };
     dxvk::mutex                 m_mutex;
     dxvk::condition_variable    m_condOnAdd;
-    dxvk::condition_variable    m_condOnSync;
-    std::vector<DxvkCsChunkRef> m_chunksQueued;
+
     dxvk::thread                m_thread;
     
     void threadFunc();
+
+    void wakeUp();
+
+    bool waitForChunk(
+            DxvkCsChunkRef&     chunk);
     
   };
   
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "dxvk_descriptor.h"
 #include "dxvk_device.h"
 
@@ -99,6 +101,75 @@ namespace dxvk {
   }
 
 
+  VkDescriptorSet DxvkDescriptorPool::lookupSet(
+          VkDescriptorSetLayout     layout,
+          size_t                    hash,
+          uint32_t                  count,
+    const DxvkDescriptorInfo*       infos) {
+    auto entry = m_setCache.find(hash);
+
+    if (entry == m_setCache.end())
+      return VK_NULL_HANDLE;
+
+    const auto& cached = entry->second;
+
+    if (cached.layout != layout || cached.infoCount != count
+     || std::memcmp(&m_setCacheInfos[cached.infoIndex], infos, sizeof(*infos) * count))
+      return VK_NULL_HANDLE;
+
+    return cached.set;
+  }
+
+
+  void DxvkDescriptorPool::insertSet(
+          VkDescriptorSetLayout     layout,
+          VkDescriptorSet           set,
+          size_t                    hash,
+          uint32_t                  count,
+    const DxvkDescriptorInfo*       infos) {
+    // Keep the cache small so that lookups remain cheap and the
+    // info array does not grow indefinitely within a submission
+    if (unlikely(m_setCache.size() >= MaxCachedSets))
+      clearSetCache();
+
+    DxvkCachedDescriptorSet cached;
+    cached.layout    = layout;
+    cached.set       = set;
+    cached.infoIndex = uint32_t(m_setCacheInfos.size());
+    cached.infoCount = count;
+
+    m_setCacheInfos.insert(m_setCacheInfos.end(), infos, infos + count);
+
+    // On hash collisions, simply replace the existing entry
+    m_setCache.insert_or_assign(hash, cached);
+  }
+
+
+  void DxvkDescriptorPool::clearSetCache() {
+    m_setCache.clear();
+    m_setCacheInfos.clear();
+  }
+
+
+  size_t DxvkDescriptorPool::hashDescriptors(
+          VkDescriptorSetLayout     layout,
+          uint32_t                  count,
+    const DxvkDescriptorInfo*       infos) {
+    DxvkHashState hash;
+    hash.add(size_t(uint64_t(layout)));
+
+    for (uint32_t i = 0; i < count; i++) {
+      std::array<uint64_t, sizeof(DxvkDescriptorInfo) / sizeof(uint64_t)> data;
+      std::memcpy(data.data(), &infos[i], sizeof(data));
+
+      for (uint64_t dword : data)
+        hash.add(size_t(dword ^ (dword >> 32)));
+    }
+
+    return hash;
+  }
+
+
   void DxvkDescriptorPool::reset() {
     // As a heuristic to save memory, check how many descriptors
     // have actively been used in the past couple of submissions.
@@ -135,6 +206,8 @@ namespace dxvk {
     }
 
     m_cachedEntry = { nullptr, nullptr };
+
+    clearSetCache();
   }
 
 
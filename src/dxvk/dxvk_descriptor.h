@@ -59,6 +59,21 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Cached descriptor set
+   *
+   * Stores a descriptor set that has already been
+   * written, along with the layout and the location
+   * of the descriptor infos it was written with.
+   */
+  struct DxvkCachedDescriptorSet {
+    VkDescriptorSetLayout layout;
+    VkDescriptorSet       set;
+    uint32_t              infoIndex;
+    uint32_t              infoCount;
+  };
+
+
   /**
    * \brief Persistent descriptor set map
    *
@@ -77,10 +92,11 @@ namespace dxvk {
    * intended to be reused as much as possible in order to reduce
    * overhead in the driver from descriptor set initialization,
    * but allocated sets will have unspecified contents and need
-   * to be updated.
+   * to be updated. Sets that have been written can be looked up
+   * by their contents until the set cache gets cleared.
    */
   class DxvkDescriptorPool : public RcObject {
-
+    constexpr static size_t MaxCachedSets = 4096;
   public:
 
     DxvkDescriptorPool(
@@ -119,6 +135,64 @@ namespace dxvk {
     VkDescriptorSet alloc(
             VkDescriptorSetLayout     layout);
 
+    /**
+     * \brief Looks up a previously written descriptor set
+     *
+     * \param [in] layout Descriptor set layout
+     * \param [in] hash Hash of the layout and descriptors
+     * \param [in] count Number of descriptor infos
+     * \param [in] infos Descriptor infos for the set
+     * \returns Descriptor set with identical contents, or
+     *    \c VK_NULL_HANDLE if no such set is cached
+     */
+    VkDescriptorSet lookupSet(
+            VkDescriptorSetLayout     layout,
+            size_t                    hash,
+            uint32_t                  count,
+      const DxvkDescriptorInfo*       infos);
+
+    /**
+     * \brief Adds a written descriptor set to the cache
+     *
+     * The set must not be updated again for as
+     * long as it is present in the cache.
+     * \param [in] layout Descriptor set layout
+     * \param [in] set Descriptor set
+     * \param [in] hash Hash of the layout and descriptors
+     * \param [in] count Number of descriptor infos
+     * \param [in] infos Descriptor infos the set was written with
+     */
+    void insertSet(
+            VkDescriptorSetLayout     layout,
+            VkDescriptorSet           set,
+            size_t                    hash,
+            uint32_t                  count,
+      const DxvkDescriptorInfo*       infos);
+
+    /**
+     * \brief Clears descriptor set cache
+     *
+     * Cached sets may reference resources that are only kept
+     * alive by the command list that wrote them, so this must
+     * be called whenever a command list gets submitted.
+     */
+    void clearSetCache();
+
+    /**
+     * \brief Computes hash of a set of descriptors
+     *
+     * All unused bytes of the descriptor infos must be
+     * zero-initialized in order to produce stable results.
+     * \param [in] layout Descriptor set layout
+     * \param [in] count Number of descriptor infos
+     * \param [in] infos Descriptor infos
+     * \returns Hash of the layout and descriptors
+     */
+    static size_t hashDescriptors(
+            VkDescriptorSetLayout     layout,
+            uint32_t                  count,
+      const DxvkDescriptorInfo*       infos);
+
     /**
      * \brief Resets pool
      */
@@ -150,6 +224,10 @@ namespace dxvk {
       const DxvkBindingLayoutObjects*,
       DxvkDescriptorSetMap*>  m_cachedEntry;
 
+    std::unordered_map<size_t,
+      DxvkCachedDescriptorSet>  m_setCache;
+    std::vector<DxvkDescriptorInfo> m_setCacheInfos;
+
     uint32_t m_setsAllocated  = 0;
     uint32_t m_setsUsed       = 0;
 
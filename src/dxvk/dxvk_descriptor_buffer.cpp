@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "dxvk_descriptor_buffer.h"
+#include "dxvk_device.h"
+
+namespace dxvk {
+
+  DxvkDescriptorBuffer::DxvkDescriptorBuffer(
+          DxvkDevice*           device)
+  : m_properties(&device->properties().extDescriptorBuffer) {
+    const auto& properties = *m_properties;
+
+    // Keep slices reasonably small since the sampler address
+    // space may be very limited on some implementations
+    constexpr VkDeviceSize MaxSliceSize = 1ull << 20;
+
+    m_sliceSize = std::min({ MaxSliceSize,
+      properties.maxResourceDescriptorBufferRange,
+      properties.maxSamplerDescriptorBufferRange });
+    m_alignment = properties.descriptorBufferOffsetAlignment;
+
+    DxvkBufferCreateInfo info;
+    info.size   = m_sliceSize;
+    info.usage  = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT
+                | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT
+                | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    info.stages = device->getShaderPipelineStages();
+    info.access = VK_ACCESS_SHADER_READ_BIT;
+
+    m_buffer = device->createBuffer(info,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+
+
+  DxvkDescriptorBuffer::~DxvkDescriptorBuffer() {
+
+  }
+
+
+  VkDescriptorBufferBindingInfoEXT DxvkDescriptorBuffer::getBindingInfo() const {
+    VkDescriptorBufferBindingInfoEXT result = { VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT };
+    result.address = m_buffer->getDeviceAddress(0);
+    result.usage = m_buffer->info().usage;
+    return result;
+  }
+
+
+  size_t DxvkDescriptorBuffer::getDescriptorSize(
+          VkDescriptorType      type) const {
+    // Robust buffer access is always enabled, so we
+    // need to use the robust buffer descriptor sizes
+    switch (type) {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+        return m_properties->samplerDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        return m_properties->combinedImageSamplerDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        return m_properties->sampledImageDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        return m_properties->storageImageDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        return m_properties->robustUniformTexelBufferDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        return m_properties->robustStorageTexelBufferDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        return m_properties->robustUniformBufferDescriptorSize;
+      case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        return m_properties->robustStorageBufferDescriptorSize;
+      default:
+        return 0;
+    }
+  }
+
+}
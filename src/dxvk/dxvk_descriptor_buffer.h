@@ -0,0 +1,104 @@
+#pragma once
+
+#include "dxvk_buffer.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Descriptor buffer
+   *
+   * Host-visible descriptor memory that descriptor sets are
+   * written to directly if \c VK_EXT_descriptor_buffer is used.
+   * Memory is allocated linearly from the current buffer slice.
+   * Once a slice is exhausted, the owner must rename the buffer
+   * so that slices still in use by the GPU are kept alive until
+   * the command list referencing them has completed.
+   */
+  class DxvkDescriptorBuffer : public RcObject {
+
+  public:
+
+    DxvkDescriptorBuffer(
+            DxvkDevice*           device);
+
+    ~DxvkDescriptorBuffer();
+
+    /**
+     * \brief Backing buffer
+     *
+     * Needs to be tracked by any command
+     * list that binds the descriptor buffer.
+     * \returns Descriptor buffer
+     */
+    const Rc<DxvkBuffer>& buffer() const {
+      return m_buffer;
+    }
+
+    /**
+     * \brief Allocates descriptor memory
+     *
+     * \param [in] size Number of bytes to allocate
+     * \param [out] offset Offset relative to the slice
+     * \returns \c false if the slice is exhausted
+     */
+    bool alloc(
+            VkDeviceSize          size,
+            VkDeviceSize&         offset) {
+      if (unlikely(m_offset + size > m_sliceSize))
+        return false;
+
+      offset = m_offset;
+      m_offset += align(size, m_alignment);
+      return true;
+    }
+
+    /**
+     * \brief Retrieves pointer to descriptor memory
+     *
+     * \param [in] offset Offset relative to the slice
+     * \returns Pointer to mapped descriptor memory
+     */
+    void* mapPtr(VkDeviceSize offset) const {
+      return m_buffer->mapPtr(offset);
+    }
+
+    /**
+     * \brief Resets allocator
+     *
+     * Must be called after the buffer has been
+     * renamed in order to reuse the new slice.
+     */
+    void reset() {
+      m_offset = 0;
+    }
+
+    /**
+     * \brief Queries binding info for the current slice
+     * \returns Descriptor buffer binding info
+     */
+    VkDescriptorBufferBindingInfoEXT getBindingInfo() const;
+
+    /**
+     * \brief Queries size of a single descriptor
+     *
+     * \param [in] type Descriptor type
+     * \returns Descriptor size, in bytes
+     */
+    size_t getDescriptorSize(
+            VkDescriptorType      type) const;
+
+  private:
+
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT* m_properties;
+
+    Rc<DxvkBuffer>  m_buffer;
+
+    VkDeviceSize    m_sliceSize = 0;
+    VkDeviceSize    m_alignment = 0;
+    VkDeviceSize    m_offset    = 0;
+
+  };
+
+}
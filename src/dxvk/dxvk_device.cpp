@@ -16,9 +16,10 @@ namespace dxvk {
     m_vkd               (vkd),
     m_features          (features),
     m_properties        (adapter->devicePropertiesExt()),
+    m_queues            (queues),
+    m_sharingMode       (getSharingMode()),
     m_perfHints         (getPerfHints()),
     m_objects           (this),
-    m_queues            (queues),
     m_submissionQueue   (this, queueCallback) {
 
   }
@@ -67,6 +68,28 @@ namespace dxvk {
   }
 
 
+  bool DxvkDevice::canUseAsyncCompute() const {
+    return m_options.enableAsyncCompute
+        && hasDedicatedComputeQueue();
+  }
+
+
+  bool DxvkDevice::canUseDescriptorBuffer() const {
+    // Imported devices may have the feature enabled
+    // regardless of what the config file says
+    return m_features.extDescriptorBuffer.descriptorBuffer
+        && m_features.vk12.bufferDeviceAddress
+        && m_options.enableDescriptorBuffer;
+  }
+
+
+  VkPipelineCreateFlags DxvkDevice::getShaderPipelineCreateFlags() const {
+    return canUseDescriptorBuffer()
+      ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+      : VkPipelineCreateFlags(0);
+  }
+
+
   bool DxvkDevice::mustTrackPipelineLifetime() const {
     switch (m_options.trackPipelineLifetime) {
       case Tristate::True:
@@ -212,6 +235,17 @@ namespace dxvk {
     result.merge(m_statCounters);
     return result;
   }
+
+
+  GpuFlushStats DxvkDevice::getGpuFlushStats() {
+    auto now = dxvk::high_resolution_clock::now();
+
+    GpuFlushStats result;
+    result.time = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    result.idleTicks = m_submissionQueue.gpuIdleTicks();
+    result.syncTicks = m_gpuSyncTicks.load(std::memory_order_relaxed);
+    return result;
+  }
   
   
   Rc<DxvkBuffer> DxvkDevice::importBuffer(
@@ -304,6 +338,8 @@ namespace dxvk {
       auto t1 = dxvk::high_resolution_clock::now();
       auto us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
 
+      m_gpuSyncTicks.fetch_add(us.count(), std::memory_order_relaxed);
+
       std::lock_guard<sync::Spinlock> lock(m_statLock);
       m_statCounters.addCtr(DxvkStatCounter::GpuSyncCount, 1);
       m_statCounters.addCtr(DxvkStatCounter::GpuSyncTicks, us.count());
@@ -335,6 +371,33 @@ namespace dxvk {
   }
 
 
+  DxvkSharingModeInfo DxvkDevice::getSharingMode() const {
+    DxvkSharingModeInfo result = { };
+
+    if (!canUseAsyncCompute())
+      return result;
+
+    // Buffers accessed on the async compute queue must be shared with
+    // the graphics queue, as well as with the transfer queue since it
+    // is used for resource uploads.
+    std::array<uint32_t, 3> families = {
+      m_queues.graphics.queueFamily,
+      m_queues.compute.queueFamily,
+      m_queues.transfer.queueFamily };
+
+    result.sharingMode = VK_SHARING_MODE_CONCURRENT;
+
+    for (uint32_t family : families) {
+      auto end = result.queueFamilies.begin() + result.queueFamilyCount;
+
+      if (std::find(result.queueFamilies.begin(), end, family) == end)
+        result.queueFamilies[result.queueFamilyCount++] = family;
+    }
+
+    return result;
+  }
+
+
   void DxvkDevice::recycleCommandList(const Rc<DxvkCommandList>& cmdList) {
     m_recycledCommandLists.returnObject(cmdList);
   }
@@ -26,6 +26,8 @@
 #include "dxvk_unbound.h"
 #include "dxvk_marker.h"
 
+#include "../util/util_flush.h"
+
 namespace dxvk {
   
   class DxvkInstance;
@@ -63,6 +65,7 @@ namespace dxvk {
    */
   struct DxvkDeviceQueueSet {
     DxvkDeviceQueue graphics;
+    DxvkDeviceQueue compute;
     DxvkDeviceQueue transfer;
     DxvkDeviceQueue sparse;
   };
@@ -134,6 +137,26 @@ namespace dxvk {
       return m_queues.transfer.queueHandle
           != m_queues.graphics.queueHandle;
     }
+
+    /**
+     * \brief Tests whether a dedicated compute queue is available
+     * \returns \c true if the device has a compute-only queue
+     */
+    bool hasDedicatedComputeQueue() const {
+      return m_queues.compute.queueFamily
+          != m_queues.graphics.queueFamily;
+    }
+
+    /**
+     * \brief Queries sharing mode for regular buffers
+     *
+     * Buffers are shared between the graphics, compute
+     * and transfer queues if async compute is enabled.
+     * \returns Buffer sharing mode info
+     */
+    const DxvkSharingModeInfo& getBufferSharingMode() const {
+      return m_sharingMode;
+    }
     
     /**
      * \brief The instance
@@ -231,6 +254,29 @@ namespace dxvk {
      */
     bool mustTrackPipelineLifetime() const;
 
+    /**
+     * \brief Checks whether async compute can be used
+     * \returns \c true if async compute is enabled and
+     *    a dedicated compute queue is available.
+     */
+    bool canUseAsyncCompute() const;
+
+    /**
+     * \brief Checks whether descriptor buffers can be used
+     * \returns \c true if descriptor buffers are enabled
+     *    and all required features are supported.
+     */
+    bool canUseDescriptorBuffer() const;
+
+    /**
+     * \brief Queries additional shader pipeline flags
+     *
+     * Pipelines using binding layouts created by the
+     * device need to be created with these flags.
+     * \returns Pipeline create flags
+     */
+    VkPipelineCreateFlags getShaderPipelineCreateFlags() const;
+
     /**
      * \brief Queries default framebuffer size
      * \returns Default framebuffer size
@@ -395,6 +441,15 @@ namespace dxvk {
      */
     DxvkStatCounters getStatCounters();
 
+    /**
+     * \brief Retrieves GPU load statistics
+     *
+     * Cheaper than querying all stat counters, and
+     * used by front-ends to drive flush heuristics.
+     * \returns Current GPU idle and sync times
+     */
+    GpuFlushStats getGpuFlushStats();
+
     /**
      * \brief Retrieves memors statistics
      *
@@ -447,6 +502,28 @@ namespace dxvk {
     void requestCompileShader(
       const Rc<DxvkShader>&         shader);
 
+    /**
+     * \brief Retrieves shader translation cache
+     *
+     * The cache is created on first use. Frontends
+     * must check whether it is enabled before use.
+     * \returns Shader cache
+     */
+    DxvkShaderCache& shaderCache() {
+      return m_objects.shaderCache();
+    }
+
+    /**
+     * \brief Retrieves staging ring
+     *
+     * Device-wide pool of upload buffers
+     * shared by all staging allocators.
+     * \returns Staging ring
+     */
+    DxvkStagingRing& stagingRing() {
+      return m_objects.stagingRing();
+    }
+
     /**
      * \brief Presents a swap chain image
      * 
@@ -545,20 +622,27 @@ namespace dxvk {
 
     DxvkDeviceFeatures          m_features;
     DxvkDeviceInfo              m_properties;
+
+    DxvkDeviceQueueSet          m_queues;
+    DxvkSharingModeInfo         m_sharingMode;
     
     DxvkDevicePerfHints         m_perfHints;
     DxvkObjects                 m_objects;
 
     sync::Spinlock              m_statLock;
     DxvkStatCounters            m_statCounters;
-    
-    DxvkDeviceQueueSet          m_queues;
+
+    // Mirrors the sync tick counter so that flush
+    // heuristics can query it without taking the lock
+    std::atomic<uint64_t>       m_gpuSyncTicks = { 0ull };
     
     DxvkRecycler<DxvkCommandList, 16> m_recycledCommandLists;
     
     DxvkSubmissionQueue         m_submissionQueue;
 
     DxvkDevicePerfHints getPerfHints();
+
+    DxvkSharingModeInfo getSharingMode() const;
     
     void recycleCommandList(
       const Rc<DxvkCommandList>& cmdList);
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 
 #include "dxvk_cmdlist.h"
 #include "dxvk_device.h"
@@ -89,20 +90,40 @@ namespace dxvk {
   }
 
 
+  void DxvkGpuQuery::setReadback(
+    const Rc<sync::Signal>&   signal,
+          uint64_t            sequence) {
+    m_readbackSignal = signal;
+
+    if (!m_handles.empty())
+      m_handles.back().readbackSeq = sequence;
+  }
+
+
   DxvkGpuQueryStatus DxvkGpuQuery::accumulateQueryDataForHandle(
     const DxvkGpuQueryHandle& handle) {
     DxvkQueryData tmpData = { };
 
-    // Try to copy query data to temporary structure
-    VkResult result = m_vkd->vkGetQueryPoolResults(m_vkd->device(),
-      handle.queryPool, handle.queryId, 1,
-      sizeof(DxvkQueryData), &tmpData,
-      sizeof(DxvkQueryData), VK_QUERY_RESULT_64_BIT);
-    
-    if (result == VK_NOT_READY)
-      return DxvkGpuQueryStatus::Pending;
-    else if (result != VK_SUCCESS)
-      return DxvkGpuQueryStatus::Failed;
+    if (handle.resultData && handle.readbackSeq) {
+      // Results get copied to host memory at the end of the command
+      // list, so all we need to do is to check whether it completed.
+      if (m_readbackSignal->value() < handle.readbackSeq)
+        return DxvkGpuQueryStatus::Pending;
+
+      std::memcpy(&tmpData, handle.resultData,
+        handle.allocator->getResultSize());
+    } else {
+      // Try to copy query data to temporary structure
+      VkResult result = m_vkd->vkGetQueryPoolResults(m_vkd->device(),
+        handle.queryPool, handle.queryId, 1,
+        sizeof(DxvkQueryData), &tmpData,
+        sizeof(DxvkQueryData), VK_QUERY_RESULT_64_BIT);
+
+      if (result == VK_NOT_READY)
+        return DxvkGpuQueryStatus::Pending;
+      else if (result != VK_SUCCESS)
+        return DxvkGpuQueryStatus::Failed;
+    }
     
     // Add numbers to the destination structure
     switch (m_type) {
@@ -182,7 +203,8 @@ namespace dxvk {
   : m_device        (device),
     m_vkd           (device->vkd()),
     m_queryType     (queryType),
-    m_queryPoolSize (queryPoolSize) {
+    m_queryPoolSize (queryPoolSize),
+    m_resultSize    (getResultSize(queryType)) {
 
   }
 
@@ -212,6 +234,8 @@ namespace dxvk {
 
   void DxvkGpuQueryAllocator::freeQuery(DxvkGpuQueryHandle handle) {
     std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    handle.readbackSeq = 0;
     m_handles.push_back(handle);
   }
 
@@ -245,8 +269,55 @@ namespace dxvk {
 
     m_pools.push_back(queryPool);
 
-    for (uint32_t i = 0; i < m_queryPoolSize; i++)
-      m_handles.push_back({ this, queryPool, i });
+    // Create a host-visible buffer that query results get copied
+    // to. If this fails, fall back to reading results directly.
+    DxvkBufferCreateInfo bufferInfo;
+    bufferInfo.size   = m_resultSize * m_queryPoolSize;
+    bufferInfo.usage  = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    bufferInfo.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    Rc<DxvkBuffer> buffer;
+
+    try {
+      buffer = m_device->createBuffer(bufferInfo,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+        VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+      m_buffers.push_back(buffer);
+    } catch (const DxvkError& e) {
+      Logger::warn(str::format("DXVK: Failed to create query result buffer: ", e.message()));
+    }
+
+    for (uint32_t i = 0; i < m_queryPoolSize; i++) {
+      DxvkGpuQueryHandle handle = { this, queryPool, i };
+
+      if (buffer != nullptr) {
+        auto slice = buffer->getSliceHandle(m_resultSize * i, m_resultSize);
+        handle.resultBuffer = slice.handle;
+        handle.resultOffset = slice.offset;
+        handle.resultData   = slice.mapPtr;
+      }
+
+      m_handles.push_back(handle);
+    }
+  }
+
+
+  VkDeviceSize DxvkGpuQueryAllocator::getResultSize(
+          VkQueryType         queryType) {
+    switch (queryType) {
+      case VK_QUERY_TYPE_OCCLUSION:
+        return sizeof(DxvkQueryOcclusionData);
+      case VK_QUERY_TYPE_PIPELINE_STATISTICS:
+        return sizeof(DxvkQueryStatisticData);
+      case VK_QUERY_TYPE_TIMESTAMP:
+        return sizeof(DxvkQueryTimestampData);
+      case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT:
+        return sizeof(DxvkQueryXfbStreamData);
+      default:
+        return sizeof(DxvkQueryData);
+    }
   }
 
 
@@ -286,7 +357,8 @@ namespace dxvk {
 
 
   DxvkGpuQueryManager::DxvkGpuQueryManager(DxvkGpuQueryPool& pool)
-  : m_pool(&pool), m_activeTypes(0) {
+  : m_pool(&pool), m_activeTypes(0),
+    m_readbackSignal(new sync::Fence()) {
 
   }
 
@@ -333,6 +405,9 @@ namespace dxvk {
     
     query->begin(cmd);
     query->addQueryHandle(handle);
+
+    this->trackReadback(query);
+
     query->end();
 
     cmd->resetQuery(
@@ -414,8 +489,74 @@ namespace dxvk {
         handle.queryId);
     }
 
+    this->trackReadback(query);
+
     cmd->trackResource<DxvkAccess::None>(query);
   }
+
+
+  bool DxvkGpuQueryManager::copyQueryResults(
+    const Rc<DxvkCommandList>&  cmd) {
+    if (m_readbackHandles.empty())
+      return false;
+
+    // Sort handles so that we can copy results of adjacent
+    // queries from the same pool with a single command
+    std::sort(m_readbackHandles.begin(), m_readbackHandles.end(),
+      [] (const DxvkGpuQueryHandle& a, const DxvkGpuQueryHandle& b) {
+        if (a.queryPool != b.queryPool)
+          return a.queryPool < b.queryPool;
+        return a.queryId < b.queryId;
+      });
+
+    size_t first = 0;
+
+    for (size_t i = 1; i <= m_readbackHandles.size(); i++) {
+      const auto& handle = m_readbackHandles[first];
+
+      if (i < m_readbackHandles.size()
+       && m_readbackHandles[i].queryPool == handle.queryPool
+       && m_readbackHandles[i].queryId == handle.queryId + uint32_t(i - first))
+        continue;
+
+      VkDeviceSize stride = handle.allocator->getResultSize();
+
+      cmd->cmdCopyQueryPoolResults(handle.queryPool,
+        handle.queryId, uint32_t(i - first),
+        handle.resultBuffer, handle.resultOffset, stride,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+      first = i;
+    }
+
+    m_readbackHandles.clear();
+    m_readbackPending = true;
+    return true;
+  }
+
+
+  void DxvkGpuQueryManager::signalQueryResults(
+    const Rc<DxvkCommandList>&  cmd) {
+    if (!m_readbackPending)
+      return;
+
+    // Command lists of the same context complete in order,
+    // so a single monotonic signal is sufficient
+    cmd->queueSignal(m_readbackSignal, m_readbackSeq++);
+    m_readbackPending = false;
+  }
+
+
+  void DxvkGpuQueryManager::trackReadback(
+    const Rc<DxvkGpuQuery>&     query) {
+    DxvkGpuQueryHandle handle = query->handle();
+
+    if (!handle.resultBuffer)
+      return;
+
+    query->setReadback(m_readbackSignal, m_readbackSeq);
+    m_readbackHandles.push_back(handle);
+  }
   
   
   uint32_t DxvkGpuQueryManager::getQueryTypeBit(
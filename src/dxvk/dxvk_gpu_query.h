@@ -6,6 +6,9 @@
 
 #include "../util/util_small_vector.h"
 
+#include "../util/sync/sync_signal.h"
+
+#include "dxvk_buffer.h"
 #include "dxvk_resource.h"
 
 namespace dxvk {
@@ -99,14 +102,20 @@ namespace dxvk {
    * \brief Query handle
    * 
    * Stores the query allocator, as well as
-   * the actual pool and query index. Since
-   * query pools have to be reset on the GPU,
-   * this also comes with a reset event.
+   * the actual pool and query index. Each query
+   * also has a slot in a host-visible buffer that
+   * results get copied to once the query has ended,
+   * and which becomes readable once the readback
+   * sequence number of the handle is signaled.
    */
   struct DxvkGpuQueryHandle {
-    DxvkGpuQueryAllocator* allocator  = nullptr;
-    VkQueryPool            queryPool  = VK_NULL_HANDLE;
-    uint32_t               queryId    = 0;
+    DxvkGpuQueryAllocator* allocator    = nullptr;
+    VkQueryPool            queryPool    = VK_NULL_HANDLE;
+    uint32_t               queryId      = 0;
+    VkBuffer               resultBuffer = VK_NULL_HANDLE;
+    VkDeviceSize           resultOffset = 0;
+    const void*            resultData   = nullptr;
+    uint64_t               readbackSeq  = 0;
   };
 
 
@@ -221,9 +230,23 @@ namespace dxvk {
     void addQueryHandle(
       const DxvkGpuQueryHandle& handle);
 
+    /**
+     * \brief Sets readback info for the current handle
+     *
+     * Must be called when the current query handle gets
+     * ended. Results of the handle can be read from host
+     * memory once the signal reaches the given value.
+     * \param [in] signal Readback signal
+     * \param [in] sequence Readback sequence number
+     */
+    void setReadback(
+      const Rc<sync::Signal>&   signal,
+            uint64_t            sequence);
+
   private:
 
     Rc<vk::DeviceFn>    m_vkd;
+    Rc<sync::Signal>    m_readbackSignal;
 
     VkQueryType         m_type;
     VkQueryControlFlags m_flags;
@@ -279,16 +302,32 @@ namespace dxvk {
      */
     void freeQuery(DxvkGpuQueryHandle handle);
 
+    /**
+     * \brief Queries size of a single query result
+     *
+     * Also used as the stride when copying
+     * query results to the result buffer.
+     * \returns Result size, in bytes
+     */
+    VkDeviceSize getResultSize() const {
+      return m_resultSize;
+    }
+
   private:
 
     DxvkDevice*       m_device;
     Rc<vk::DeviceFn>  m_vkd;
     VkQueryType       m_queryType;
     uint32_t          m_queryPoolSize;
+    VkDeviceSize      m_resultSize;
     
     dxvk::mutex                     m_mutex;
     std::vector<DxvkGpuQueryHandle> m_handles;
     std::vector<VkQueryPool>        m_pools;
+    std::vector<Rc<DxvkBuffer>>     m_buffers;
+
+    static VkDeviceSize getResultSize(
+            VkQueryType         queryType);
 
     void createQueryPool();
 
@@ -400,12 +439,52 @@ namespace dxvk {
       const Rc<DxvkCommandList>&  cmd,
             VkQueryType           type);
 
+    /**
+     * \brief Checks whether any queries are enabled
+     * \returns \c true if there are enabled queries
+     */
+    bool hasEnabledQueries() const {
+      return !m_activeQueries.empty();
+    }
+
+    /**
+     * \brief Copies query results to host memory
+     *
+     * Records copy commands for all query handles that have
+     * been ended since the last call, merging copies for
+     * adjacent queries. Must not be called inside a render
+     * pass or while any query is active.
+     * \param [in] cmd Command list
+     * \returns \c true if any copies have been recorded
+     */
+    bool copyQueryResults(
+      const Rc<DxvkCommandList>&  cmd);
+
+    /**
+     * \brief Signals query results on command list completion
+     *
+     * Must be called once per command list, after the final
+     * call to \ref copyQueryResults. Makes copied results
+     * available once the command list has completed.
+     * \param [in] cmd Command list
+     */
+    void signalQueryResults(
+      const Rc<DxvkCommandList>&  cmd);
+
   private:
 
     DxvkGpuQueryPool*             m_pool;
     uint32_t                      m_activeTypes;
     std::vector<Rc<DxvkGpuQuery>> m_activeQueries;
 
+    Rc<sync::Fence>                 m_readbackSignal;
+    uint64_t                        m_readbackSeq     = 1ull;
+    bool                            m_readbackPending = false;
+    std::vector<DxvkGpuQueryHandle> m_readbackHandles;
+
+    void trackReadback(
+      const Rc<DxvkGpuQuery>&     query);
+
     void beginSingleQuery(
       const Rc<DxvkCommandList>&  cmd,
       const Rc<DxvkGpuQuery>&     query);
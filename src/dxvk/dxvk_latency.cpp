@@ -0,0 +1,212 @@
+#include <algorithm>
+
+#include "dxvk_device.h"
+#include "dxvk_latency.h"
+
+#include "../util/util_sleep.h"
+
+namespace dxvk {
+
+  DxvkLatencyTracker::DxvkLatencyTracker(
+          DxvkDevice*               device)
+  : m_device      (device),
+    m_sleepEnabled(device->config().latencySleep),
+    m_startTime   (dxvk::high_resolution_clock::now()) {
+    std::string fileName = getLogFileName();
+
+    if (!fileName.empty()) {
+      m_logStream = std::ofstream(str::topath(fileName.c_str()).c_str(), std::ios_base::app | std::ios_base::ate);
+
+      if (m_logStream && m_logStream.tellp() == 0)
+        m_logStream << "frame,start,submit,gpu_done,present_done,sleep,latency" << std::endl;
+    }
+  }
+
+
+  DxvkLatencyTracker::~DxvkLatencyTracker() {
+
+  }
+
+
+  void DxvkLatencyTracker::sleepAndBeginFrame(
+          uint64_t                  frameId) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    auto t0 = dxvk::high_resolution_clock::now();
+    auto t1 = t0;
+
+    // Only sleep once we have valid estimates for both the CPU and
+    // the GPU portion of a frame, and never for more than a short
+    // amount of time in order to not stall the app indefinitely if
+    // our prediction is way off for whatever reason.
+    if (m_sleepEnabled && m_lastGpuDoneId && m_cpuTime != TimerDuration::zero()) {
+      TimePoint gpuDone = predictGpuDone(frameId - 1);
+
+      if (gpuDone != TimePoint()) {
+        TimerDuration margin = TimerDuration(500'000) + m_cpuTime / 8;
+        TimePoint target = gpuDone - m_cpuTime - margin;
+
+        TimerDuration sleepDuration = std::min(
+          std::chrono::duration_cast<TimerDuration>(target - t0),
+          TimerDuration(50'000'000));
+
+        if (sleepDuration > TimerDuration::zero()) {
+          lock.unlock();
+          t1 = Sleep::sleepFor(t0, sleepDuration);
+          lock.lock();
+        }
+      }
+    }
+
+    DxvkLatencyFrame& frame = m_frames[frameId % FrameCount];
+    frame = DxvkLatencyFrame();
+    frame.frameId = frameId;
+    frame.frameStart = t1;
+    frame.sleepDuration = std::chrono::duration_cast<TimerDuration>(t1 - t0);
+  }
+
+
+  void DxvkLatencyTracker::notifyPresentSubmit(
+          uint64_t                  frameId) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    DxvkLatencyFrame* frame = findFrame(frameId);
+
+    if (frame)
+      frame->presentSubmit = dxvk::high_resolution_clock::now();
+  }
+
+
+  void DxvkLatencyTracker::notifyGpuDone(
+          uint64_t                  frameId) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    DxvkLatencyFrame* frame = findFrame(frameId);
+
+    if (!frame)
+      return;
+
+    frame->gpuDone = dxvk::high_resolution_clock::now();
+
+    if (frame->presentSubmit == TimePoint())
+      return;
+
+    // The GPU cannot start working on a frame before the application
+    // does, nor before it is done with the previous frame, so use the
+    // later of the two as the start of GPU work for this frame.
+    DxvkLatencyFrame* prev = findFrame(frameId - 1);
+
+    TimePoint gpuStart = frame->frameStart;
+
+    if (prev && prev->gpuDone != TimePoint())
+      gpuStart = std::max(gpuStart, prev->gpuDone);
+
+    auto cpuTime = std::chrono::duration_cast<TimerDuration>(frame->presentSubmit - frame->frameStart);
+    auto gpuTime = std::chrono::duration_cast<TimerDuration>(frame->gpuDone - gpuStart);
+
+    // Use a moving average to smooth out individual outliers
+    if (m_cpuTime == TimerDuration::zero()) {
+      m_cpuTime = cpuTime;
+      m_gpuTime = gpuTime;
+    } else {
+      m_cpuTime = (m_cpuTime * 7 + cpuTime) / 8;
+      m_gpuTime = (m_gpuTime * 7 + gpuTime) / 8;
+    }
+
+    m_lastGpuDoneId = std::max(m_lastGpuDoneId, frameId);
+  }
+
+
+  void DxvkLatencyTracker::notifyPresentDone(
+          uint64_t                  frameId) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    DxvkLatencyFrame* frame = findFrame(frameId);
+
+    if (!frame)
+      return;
+
+    frame->presentDone = dxvk::high_resolution_clock::now();
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(frame->presentDone - frame->frameStart);
+    auto sleep = std::chrono::duration_cast<std::chrono::microseconds>(frame->sleepDuration);
+
+    m_device->addStatCtr(DxvkStatCounter::FrameLatencyCount, 1);
+    m_device->addStatCtr(DxvkStatCounter::FrameLatencyTicks, latency.count());
+    m_device->addStatCtr(DxvkStatCounter::FrameSleepTicks, sleep.count());
+
+    if (m_logStream)
+      writeLogEntry(*frame);
+  }
+
+
+  DxvkLatencyFrame* DxvkLatencyTracker::findFrame(
+          uint64_t                  frameId) {
+    DxvkLatencyFrame& frame = m_frames[frameId % FrameCount];
+
+    return frameId && frame.frameId == frameId
+      ? &frame
+      : nullptr;
+  }
+
+
+  DxvkLatencyTracker::TimePoint DxvkLatencyTracker::predictGpuDone(
+          uint64_t                  frameId) {
+    DxvkLatencyFrame* frame = findFrame(m_lastGpuDoneId);
+
+    if (!frame || frameId < m_lastGpuDoneId || frameId - m_lastGpuDoneId >= FrameCount)
+      return TimePoint();
+
+    // Starting at the last frame known to have completed on the GPU,
+    // assume that each subsequent frame takes the estimated GPU time
+    // to complete once both the application has started working on
+    // it and the GPU is done with the previous frame.
+    TimePoint gpuDone = frame->gpuDone;
+
+    for (uint64_t i = m_lastGpuDoneId + 1; i <= frameId; i++) {
+      frame = findFrame(i);
+
+      if (!frame)
+        return TimePoint();
+
+      gpuDone = frame->gpuDone != TimePoint()
+        ? frame->gpuDone
+        : std::max(gpuDone, frame->frameStart) + m_gpuTime;
+    }
+
+    return gpuDone;
+  }
+
+
+  void DxvkLatencyTracker::writeLogEntry(
+    const DxvkLatencyFrame&         frame) {
+    auto us = [this] (TimePoint t) {
+      return t != TimePoint()
+        ? std::chrono::duration_cast<std::chrono::microseconds>(t - m_startTime).count()
+        : int64_t(0);
+    };
+
+    m_logStream << frame.frameId << ","
+                << us(frame.frameStart) << ","
+                << us(frame.presentSubmit) << ","
+                << us(frame.gpuDone) << ","
+                << us(frame.presentDone) << ","
+                << std::chrono::duration_cast<std::chrono::microseconds>(frame.sleepDuration).count() << ","
+                << std::chrono::duration_cast<std::chrono::microseconds>(frame.presentDone - frame.frameStart).count()
+                << "\n";
+  }
+
+
+  std::string DxvkLatencyTracker::getLogFileName() {
+    std::string path = env::getEnvVar("DXVK_LATENCY_LOG");
+
+    if (path.empty())
+      return std::string();
+
+    if (*path.rbegin() != '/')
+      path += '/';
+
+    return path + env::getExeBaseName() + "_latency.csv";
+  }
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <fstream>
+
+#include "../util/thread.h"
+#include "../util/util_time.h"
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Frame timings
+   *
+   * Stores time stamps for a single frame. Time stamps
+   * that have not been recorded yet are zero.
+   */
+  struct DxvkLatencyFrame {
+    using TimePoint = dxvk::high_resolution_clock::time_point;
+
+    uint64_t  frameId = 0;
+    TimePoint frameStart;     ///< Application starts processing the frame
+    TimePoint presentSubmit;  ///< Present operation got submitted to the device
+    TimePoint gpuDone;        ///< GPU work prior to the present has completed
+    TimePoint presentDone;    ///< Image has been presented to the display
+    std::chrono::nanoseconds sleepDuration = std::chrono::nanoseconds(0);
+  };
+
+
+  /**
+   * \brief Frame latency tracker
+   *
+   * Measures how long it takes for a frame to be processed by
+   * the application, the CS thread and the GPU, and how long it
+   * takes until the image is actually presented. Optionally uses
+   * these measurements to delay the start of the next frame, so
+   * that the application's CPU work finishes just in time for the
+   * GPU to pick it up, rather than queueing up behind frames that
+   * are still in flight.
+   *
+   * Results are reported through device stat counters, and can
+   * be written to a CSV file if \c DXVK_LATENCY_LOG is set.
+   */
+  class DxvkLatencyTracker {
+    using TimePoint = dxvk::high_resolution_clock::time_point;
+    using TimerDuration = std::chrono::nanoseconds;
+
+    constexpr static uint32_t FrameCount = 32;
+  public:
+
+    DxvkLatencyTracker(
+            DxvkDevice*               device);
+
+    ~DxvkLatencyTracker();
+
+    /**
+     * \brief Checks whether latency sleep is enabled
+     * \returns \c true if frames may get delayed
+     */
+    bool isSleepEnabled() const {
+      return m_sleepEnabled;
+    }
+
+    /**
+     * \brief Delays and begins a frame
+     *
+     * Must be called from the application thread once the
+     * previous frame has been presented. If latency sleep is
+     * enabled, this blocks the calling thread until the GPU is
+     * expected to become ready for the next frame, and then
+     * records the start time of the given frame.
+     * \param [in] frameId ID of the frame to begin
+     */
+    void sleepAndBeginFrame(
+            uint64_t                  frameId);
+
+    /**
+     * \brief Records present submission
+     *
+     * Called from the submission thread when the
+     * present operation is submitted to the device.
+     * \param [in] frameId Frame ID
+     */
+    void notifyPresentSubmit(
+            uint64_t                  frameId);
+
+    /**
+     * \brief Records GPU completion
+     *
+     * Called from the queue thread once all GPU work
+     * submitted prior to the present has completed.
+     * \param [in] frameId Frame ID
+     */
+    void notifyGpuDone(
+            uint64_t                  frameId);
+
+    /**
+     * \brief Records present completion
+     *
+     * Called once the image has been presented, or as
+     * soon as the GPU work has completed if the present
+     * operation cannot be waited on. Finalizes the frame.
+     * \param [in] frameId Frame ID
+     */
+    void notifyPresentDone(
+            uint64_t                  frameId);
+
+  private:
+
+    DxvkDevice*     m_device;
+    bool            m_sleepEnabled;
+
+    dxvk::mutex     m_mutex;
+
+    std::array<DxvkLatencyFrame, FrameCount> m_frames = { };
+
+    uint64_t        m_lastGpuDoneId = 0;
+
+    TimerDuration   m_cpuTime = TimerDuration::zero();
+    TimerDuration   m_gpuTime = TimerDuration::zero();
+
+    TimePoint       m_startTime;
+    std::ofstream   m_logStream;
+
+    DxvkLatencyFrame* findFrame(
+            uint64_t                  frameId);
+
+    TimePoint predictGpuDone(
+            uint64_t                  frameId);
+
+    void writeLogEntry(
+      const DxvkLatencyFrame&         frame);
+
+    static std::string getLogFileName();
+
+  };
+
+}
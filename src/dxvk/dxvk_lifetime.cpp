@@ -2,7 +2,12 @@
 
 namespace dxvk {
   
-  DxvkLifetimeTracker:: DxvkLifetimeTracker() { }
+  std::atomic<uint64_t> DxvkLifetimeTracker::s_trackingId = { 0ull };
+
+
+  DxvkLifetimeTracker:: DxvkLifetimeTracker()
+  : m_trackingId(++s_trackingId) { }
+
   DxvkLifetimeTracker::~DxvkLifetimeTracker() { }
   
   
@@ -13,6 +18,10 @@ namespace dxvk {
 
   void DxvkLifetimeTracker::reset() {
     m_resources.clear();
+
+    // Resources tracked from now on belong to a new
+    // submission, so they must not be skipped anymore
+    m_trackingId = ++s_trackingId;
   }
   
 }
\ No newline at end of file
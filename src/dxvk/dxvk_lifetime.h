@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "dxvk_resource.h"
@@ -97,11 +98,17 @@ namespace dxvk {
     
     /**
      * \brief Adds a resource to track
+     *
+     * Resources that are already tracked with the same
+     * or a stronger access type are skipped, so that each
+     * resource only gets acquired and released once or
+     * twice per submission.
      * \param [in] rc The resource to track
      */
     template<DxvkAccess Access>
     void trackResource(DxvkResource* rc) {
-      m_resources.emplace_back(rc, Access);
+      if (rc->markTracked(m_trackingId, Access))
+        m_resources.emplace_back(rc, Access);
     }
 
     /**
@@ -121,7 +128,10 @@ namespace dxvk {
     
   private:
     
+    uint64_t                  m_trackingId;
     std::vector<DxvkLifetime> m_resources;
+
+    static std::atomic<uint64_t> s_trackingId;
     
   };
   
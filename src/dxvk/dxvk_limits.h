@@ -13,6 +13,7 @@ namespace dxvk {
     MaxNumViewports             =    16,
     MaxNumResourceSlots         =  1216,
     MaxNumQueuedCommandBuffers  =    32,
+    MaxNumBatchedCommandLists   =     8,
     MaxNumQueryCountPerPool     =   128,
     MaxNumSpecConstants         =    12,
     MaxUniformBufferSize        = 65536,
@@ -11,6 +11,7 @@ namespace dxvk {
   DxvkMemory::DxvkMemory(
           DxvkMemoryAllocator*  alloc,
           DxvkMemoryChunk*      chunk,
+          uint32_t              block,
           DxvkMemoryType*       type,
           VkDeviceMemory        memory,
           VkDeviceSize          offset,
@@ -18,6 +19,7 @@ namespace dxvk {
           void*                 mapPtr)
   : m_alloc   (alloc),
     m_chunk   (chunk),
+    m_block   (block),
     m_type    (type),
     m_memory  (memory),
     m_offset  (offset),
@@ -28,6 +30,7 @@ namespace dxvk {
   DxvkMemory::DxvkMemory(DxvkMemory&& other)
   : m_alloc   (std::exchange(other.m_alloc,  nullptr)),
     m_chunk   (std::exchange(other.m_chunk,  nullptr)),
+    m_block   (std::exchange(other.m_block,  DxvkTlsfAllocator::InvalidBlock)),
     m_type    (std::exchange(other.m_type,   nullptr)),
     m_memory  (std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE))),
     m_offset  (std::exchange(other.m_offset, 0)),
@@ -39,6 +42,7 @@ namespace dxvk {
     this->free();
     m_alloc   = std::exchange(other.m_alloc,  nullptr);
     m_chunk   = std::exchange(other.m_chunk,  nullptr);
+    m_block   = std::exchange(other.m_block,  DxvkTlsfAllocator::InvalidBlock);
     m_type    = std::exchange(other.m_type,   nullptr);
     m_memory  = std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE));
     m_offset  = std::exchange(other.m_offset, 0);
@@ -64,9 +68,9 @@ namespace dxvk {
           DxvkMemoryType*       type,
           DxvkDeviceMemory      memory,
           DxvkMemoryFlags       hints)
-  : m_alloc(alloc), m_type(type), m_memory(memory), m_hints(hints) {
-    // Mark the entire chunk as free
-    m_freeList.push_back(FreeSlice { 0, memory.memSize });
+  : m_alloc(alloc), m_type(type), m_memory(memory), m_hints(hints),
+    m_allocator(memory.memSize) {
+
   }
   
   
@@ -82,83 +86,60 @@ namespace dxvk {
           VkDeviceSize          size,
           VkDeviceSize          align,
           DxvkMemoryFlags       hints) {
-    // Property flags must be compatible. This could
-    // be refined a bit in the future if necessary.
-    if (m_memory.memFlags != flags || !checkHints(hints))
+    if (!canAllocate(flags, hints))
       return DxvkMemory();
     
-    // If the chunk is full, return
-    if (m_freeList.size() == 0)
-      return DxvkMemory();
-    
-    // Select the slice to allocate from in a worst-fit
-    // manner. This may help keep fragmentation low.
-    auto bestSlice = m_freeList.begin();
-    
-    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
-      if (slice->length == size) {
-        bestSlice = slice;
-        break;
-      } else if (slice->length > bestSlice->length) {
-        bestSlice = slice;
-      }
-    }
-    
-    // We need to align the allocation to the requested alignment
-    const VkDeviceSize sliceStart = bestSlice->offset;
-    const VkDeviceSize sliceEnd   = bestSlice->offset + bestSlice->length;
-    
-    const VkDeviceSize allocStart = dxvk::align(sliceStart,        align);
-    const VkDeviceSize allocEnd   = dxvk::align(allocStart + size, align);
-    
-    if (allocEnd > sliceEnd)
+    // The allocator aligns both the offset and size of the
+    // returned range, so we don't need to do anything here
+    DxvkTlsfAllocator::Range range = m_allocator.alloc(size, align);
+
+    if (!range)
       return DxvkMemory();
-    
-    // We can use this slice, but we'll have to add
-    // the unused parts of it back to the free list.
-    m_freeList.erase(bestSlice);
-    
-    if (allocStart != sliceStart)
-      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
-    
-    if (allocEnd != sliceEnd)
-      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
-    
+
     // Create the memory object with the aligned slice
-    return DxvkMemory(m_alloc, this, m_type,
-      m_memory.memHandle, allocStart, allocEnd - allocStart,
-      reinterpret_cast<char*>(m_memory.memPointer) + allocStart);
+    return DxvkMemory(m_alloc, this, range.block, m_type,
+      m_memory.memHandle, range.offset, range.length,
+      reinterpret_cast<char*>(m_memory.memPointer) + range.offset);
   }
   
   
   void DxvkMemoryChunk::free(
-          VkDeviceSize  offset,
-          VkDeviceSize  length) {
-    // Remove adjacent entries from the free list and then add
-    // a new slice that covers all those entries. Without doing
-    // so, the slice could not be reused for larger allocations.
-    auto curr = m_freeList.begin();
-    
-    while (curr != m_freeList.end()) {
-      if (curr->offset == offset + length) {
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else if (curr->offset + curr->length == offset) {
-        offset -= curr->length;
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else {
-        curr++;
-      }
-    }
-    
-    m_freeList.push_back({ offset, length });
+          uint32_t      block) {
+    if (block < m_owners.size() && m_owners[block])
+      setOwner(block, 0, nullptr);
+
+    m_allocator.free(block);
   }
   
   
   bool DxvkMemoryChunk::isEmpty() const {
-    return m_freeList.size() == 1
-        && m_freeList[0].length == m_memory.memSize;
+    return m_allocator.isEmpty();
+  }
+
+
+  bool DxvkMemoryChunk::canAllocate(
+          VkMemoryPropertyFlags flags,
+          DxvkMemoryFlags       hints) const {
+    // Property flags must be compatible. This could
+    // be refined a bit in the future if necessary.
+    return m_memory.memFlags == flags && checkHints(hints) && !m_evacuate;
+  }
+
+
+  void DxvkMemoryChunk::setOwner(
+          uint32_t              block,
+          VkDeviceSize          length,
+          DxvkBuffer*           owner) {
+    if (block >= m_owners.size())
+      m_owners.resize(block + 1);
+
+    if (m_owners[block])
+      m_ownedSize -= m_allocator.getLength(block);
+
+    if (owner)
+      m_ownedSize += length;
+
+    m_owners[block] = owner;
   }
 
 
@@ -200,6 +181,9 @@ namespace dxvk {
 
     if (device->features().core.features.sparseBinding)
       m_sparseMemoryTypes = determineSparseMemoryTypes(device);
+
+    for (auto& cache : m_caches)
+      cache.bins.resize(m_memProps.memoryTypeCount * CacheSizeClassCount);
   }
   
   
@@ -212,8 +196,6 @@ namespace dxvk {
           DxvkMemoryRequirements            req,
           DxvkMemoryProperties              info,
           DxvkMemoryFlags                   hints) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
-
     // Keep small allocations together to avoid fragmenting
     // chunks for larger resources with lots of small gaps,
     // as well as resources with potentially weird lifetimes
@@ -227,6 +209,15 @@ namespace dxvk {
     if (info.flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
       hints = hints & DxvkMemoryFlag::Transient;
 
+    // Try to serve small allocations from the calling
+    // thread's cache without taking the allocator lock
+    DxvkMemory cached = this->tryAllocCached(req, info, hints);
+
+    if (cached)
+      return cached;
+
+    std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
+
     // If requested, try with a dedicated allocation first.
     if (info.dedicated.image || info.dedicated.buffer) {
       DxvkMemory result = this->tryAlloc(req, info, hints);
@@ -286,6 +277,357 @@ namespace dxvk {
   }
   
   
+  DxvkMemoryStats DxvkMemoryAllocator::getMemoryStats(uint32_t heap) {
+    DxvkMemoryStats result = m_memHeaps[heap].stats;
+
+    for (auto& cache : m_caches) {
+      std::lock_guard<sync::Spinlock> lock(cache.mutex);
+      result.memoryCached += cache.cachedBytes[heap];
+    }
+
+    // Memory held by the caches is still allocated from the
+    // chunks' point of view, but it is not in use by the app
+    result.memoryUsed -= std::min(result.memoryUsed, result.memoryCached);
+
+    result.lockCount      = m_mutex.getLockCount();
+    result.lockContention = m_mutex.getContentionCount();
+    result.lockHoldTimeUs = m_mutex.getHoldTimeUs();
+    return result;
+  }
+
+
+  void DxvkMemoryAllocator::setRelocationOwner(
+    const DxvkMemory&                       memory,
+          DxvkBuffer*                       owner) {
+    if (!memory.m_chunk)
+      return;
+
+    std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
+    memory.m_chunk->setOwner(memory.m_block, memory.m_length, owner);
+  }
+
+
+  std::vector<Rc<DxvkBuffer>> DxvkMemoryAllocator::getRelocationCandidates(
+          VkDeviceSize                      budget) {
+    std::vector<Rc<DxvkBuffer>> result;
+
+    std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
+
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount && budget; i++) {
+      DxvkMemoryType* type = &m_memTypes[i];
+      this->updateEvacuationState(type);
+
+      for (const auto& chunk : type->chunks) {
+        if (!chunk->m_evacuate)
+          continue;
+
+        for (uint32_t j = 0; j < chunk->m_owners.size() && budget; j++) {
+          DxvkBuffer* owner = chunk->m_owners[j];
+
+          // Skip buffers that are currently being destroyed. Buffers
+          // unregister themselves while freeing their memory, which
+          // requires the allocator lock, so the pointer stays valid.
+          if (!owner || !owner->tryIncRef())
+            continue;
+
+          result.emplace_back(owner);
+          owner->decRef();
+
+          budget -= std::min(budget, chunk->m_allocator.getLength(j));
+        }
+      }
+    }
+
+    return result;
+  }
+
+
+  void DxvkMemoryAllocator::updateEvacuationState(
+          DxvkMemoryType*                   type) {
+    // Only defragment memory that is exclusively device-local,
+    // host-visible buffers may be persistently mapped by the app
+    if (!(type->memType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+     || (type->memType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+      return;
+
+    // Slices freed into the allocation caches keep the chunk alive
+    // even though they have no owner, so return them if necessary
+    auto isStalled = [] (const Rc<DxvkMemoryChunk>& chunk) {
+      VkDeviceSize usedSize = chunk->m_allocator.capacity() - chunk->m_allocator.freeSize();
+      return chunk->m_evacuate && usedSize != chunk->m_ownedSize;
+    };
+
+    if (std::any_of(type->chunks.begin(), type->chunks.end(), isStalled))
+      this->flushCaches(type->heap);
+
+    // Chunks that become empty stop being evacuated once freed, and
+    // chunks with allocations that cannot be relocated never will be.
+    bool isEvacuating = false;
+
+    for (const auto& chunk : type->chunks) {
+      if (isStalled(chunk))
+        chunk->m_evacuate = false;
+
+      isEvacuating |= chunk->m_evacuate;
+    }
+
+    // Evacuate at most one chunk per memory type at a time
+    if (isEvacuating)
+      return;
+
+    DxvkMemoryChunk* candidate = nullptr;
+    VkDeviceSize candidateSize = 0;
+
+    for (const auto& chunk : type->chunks) {
+      VkDeviceSize capacity = chunk->m_allocator.capacity();
+      VkDeviceSize usedSize = capacity - chunk->m_allocator.freeSize();
+
+      // Only consider sparsely used chunks where all allocations
+      // can be relocated, otherwise the chunk never becomes empty
+      if (!usedSize || 4 * usedSize > capacity || usedSize != chunk->m_ownedSize)
+        continue;
+
+      if (candidate && usedSize >= candidateSize)
+        continue;
+
+      // Make sure that other chunks can absorb the allocations
+      VkDeviceSize freeSize = 0;
+
+      for (const auto& other : type->chunks) {
+        if (other != chunk && other->isCompatible(chunk))
+          freeSize += other->m_allocator.freeSize();
+      }
+
+      if (freeSize < 2 * usedSize)
+        continue;
+
+      candidate = chunk.ptr();
+      candidateSize = usedSize;
+    }
+
+    if (candidate)
+      candidate->m_evacuate = true;
+  }
+
+
+  DxvkMemory DxvkMemoryAllocator::tryAllocCached(
+          DxvkMemoryRequirements            req,
+    const DxvkMemoryProperties&             info,
+          DxvkMemoryFlags                   hints) {
+    if (info.dedicated.image || info.dedicated.buffer || req.dedicated.requiresDedicatedAllocation
+     || info.sharedExport.handleTypes || info.sharedImportWin32.handleType)
+      return DxvkMemory();
+
+    if (req.tiling == VK_IMAGE_TILING_OPTIMAL) {
+      VkDeviceSize granularity = m_device->properties().core.properties.limits.bufferImageGranularity;
+      req.core.memoryRequirements.size      = align(req.core.memoryRequirements.size,       granularity);
+      req.core.memoryRequirements.alignment = align(req.core.memoryRequirements.alignment,  granularity);
+    }
+
+    if (req.core.memoryRequirements.size > CacheAllocationThreshold)
+      return DxvkMemory();
+
+    uint32_t sizeClass = computeSizeClass(req.core.memoryRequirements.size);
+
+    VkDeviceSize size  = getSizeClassSize(sizeClass);
+    VkDeviceSize align = getSizeClassAlignment(sizeClass);
+
+    if (req.core.memoryRequirements.alignment > align)
+      return DxvkMemory();
+
+    // Only consider the memory type that would be picked first
+    // by the regular allocation path in order to keep behaviour
+    // consistent with uncached allocations.
+    DxvkMemoryType* type = nullptr;
+
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount && !type; i++) {
+      const bool supported = (req.core.memoryRequirements.memoryTypeBits & (1u << i)) != 0;
+      const bool adequate  = (m_memTypes[i].memType.propertyFlags & info.flags) == info.flags;
+
+      if (supported && adequate)
+        type = &m_memTypes[i];
+    }
+
+    if (!type)
+      return DxvkMemory();
+
+    Cache& cache = getThreadCache();
+    uint32_t binIndex = type->memTypeId * CacheSizeClassCount + sizeClass;
+
+    { std::lock_guard<sync::Spinlock> lock(cache.mutex);
+      auto& bin = cache.bins[binIndex];
+
+      // Bins are small, so just scan for the most recently
+      // freed slice from a chunk with compatible properties
+      for (size_t i = bin.size(); i; i--) {
+        if (bin[i - 1].chunk->canAllocate(info.flags, hints)) {
+          CachedSlice slice = bin[i - 1];
+          bin.erase(bin.begin() + (i - 1));
+
+          cache.cachedBytes[type->heapId] -= size;
+
+          return DxvkMemory(this, slice.chunk, slice.block, type,
+            slice.memory, slice.offset, size, slice.mapPtr);
+        }
+      }
+    }
+
+    // Refill the cache with a batch of slices so that subsequent
+    // allocations of the same size class can skip the lock
+    std::array<CachedSlice, CacheMaxSlicesPerBin> slices;
+    uint32_t sliceCount = 0;
+
+    uint32_t refillCount = std::max(getSizeClassCapacity(sizeClass) / 2u, 1u);
+
+    { std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
+
+      while (sliceCount < refillCount) {
+        DxvkMemory memory = this->tryAllocFromType(type, size, align, info, hints);
+
+        if (!memory)
+          break;
+
+        // We should never get a dedicated allocation at this
+        // size, but don't try to cache it if we somehow do.
+        if (!memory.m_chunk) {
+          if (sliceCount)
+            this->freeCachedSlices(type, size, sliceCount, slices.data());
+
+          return memory;
+        }
+
+        auto& slice = slices[sliceCount++];
+        slice.chunk   = memory.m_chunk;
+        slice.block   = memory.m_block;
+        slice.memory  = memory.m_memory;
+        slice.offset  = memory.m_offset;
+        slice.mapPtr  = memory.m_mapPtr;
+
+        // Transfer ownership of the slice to the cache
+        memory.m_alloc = nullptr;
+      }
+    }
+
+    if (!sliceCount)
+      return DxvkMemory();
+
+    if (sliceCount > 1) {
+      std::lock_guard<sync::Spinlock> lock(cache.mutex);
+      auto& bin = cache.bins[binIndex];
+
+      for (uint32_t i = 1; i < sliceCount; i++)
+        bin.push_back(slices[i]);
+
+      cache.cachedBytes[type->heapId] += (sliceCount - 1) * size;
+    }
+
+    return DxvkMemory(this, slices[0].chunk, slices[0].block, type,
+      slices[0].memory, slices[0].offset, size, slices[0].mapPtr);
+  }
+
+
+  bool DxvkMemoryAllocator::tryFreeCached(
+    const DxvkMemory&                       memory) {
+    if (!memory.m_chunk || memory.m_length > CacheAllocationThreshold)
+      return false;
+
+    // Only slices that exactly match a size class can be recycled.
+    // This is always the case for slices allocated through the cache.
+    uint32_t sizeClass = computeSizeClass(memory.m_length);
+
+    if (memory.m_length != getSizeClassSize(sizeClass)
+     || memory.m_offset & (getSizeClassAlignment(sizeClass) - 1))
+      return false;
+
+    CachedSlice slice;
+    slice.chunk   = memory.m_chunk;
+    slice.block   = memory.m_block;
+    slice.memory  = memory.m_memory;
+    slice.offset  = memory.m_offset;
+    slice.mapPtr  = memory.m_mapPtr;
+
+    std::array<CachedSlice, CacheMaxSlicesPerBin> drained;
+    uint32_t drainCount = 0;
+
+    Cache& cache = getThreadCache();
+
+    { std::lock_guard<sync::Spinlock> lock(cache.mutex);
+      auto& bin = cache.bins[memory.m_type->memTypeId * CacheSizeClassCount + sizeClass];
+
+      uint32_t capacity = getSizeClassCapacity(sizeClass);
+
+      // If the bin is full, move the least recently freed
+      // half of it back to the chunks in a single batch
+      if (bin.size() >= capacity) {
+        drainCount = capacity / 2u;
+
+        for (uint32_t i = 0; i < drainCount; i++)
+          drained[i] = bin[i];
+
+        bin.erase(bin.begin(), bin.begin() + drainCount);
+        cache.cachedBytes[memory.m_type->heapId] -= drainCount * memory.m_length;
+      }
+
+      bin.push_back(slice);
+      cache.cachedBytes[memory.m_type->heapId] += memory.m_length;
+    }
+
+    if (drainCount) {
+      std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
+      this->freeCachedSlices(memory.m_type, memory.m_length, drainCount, drained.data());
+    }
+
+    return true;
+  }
+
+
+  void DxvkMemoryAllocator::freeCachedSlices(
+          DxvkMemoryType*                   type,
+          VkDeviceSize                      length,
+          size_t                            count,
+    const CachedSlice*                      slices) {
+    for (size_t i = 0; i < count; i++)
+      this->freeChunkMemory(type, slices[i].chunk, slices[i].block);
+
+    type->heap->stats.memoryUsed -= count * length;
+    m_device->notifyMemoryUse(type->heapId, -int64_t(count * length));
+  }
+
+
+  void DxvkMemoryAllocator::flushCaches(
+    const DxvkMemoryHeap*                   heap) {
+    for (auto& cache : m_caches) {
+      std::lock_guard<sync::Spinlock> lock(cache.mutex);
+
+      for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+        DxvkMemoryType* type = &m_memTypes[i];
+
+        if (type->heap != heap)
+          continue;
+
+        for (uint32_t j = 0; j < CacheSizeClassCount; j++) {
+          auto& bin = cache.bins[i * CacheSizeClassCount + j];
+
+          if (bin.empty())
+            continue;
+
+          VkDeviceSize size = getSizeClassSize(j);
+          this->freeCachedSlices(type, size, bin.size(), bin.data());
+
+          cache.cachedBytes[type->heapId] -= bin.size() * size;
+          bin.clear();
+        }
+      }
+    }
+  }
+
+
+  DxvkMemoryAllocator::Cache& DxvkMemoryAllocator::getThreadCache() {
+    uint32_t threadId = uint32_t(dxvk::this_thread::get_id());
+    return m_caches[(threadId * 0x9e3779b1u) >> (32u - CacheCountLog2)];
+  }
+
+
   DxvkMemory DxvkMemoryAllocator::tryAlloc(
     const DxvkMemoryRequirements&           req,
     const DxvkMemoryProperties&             info,
@@ -363,7 +705,7 @@ namespace dxvk {
       DxvkDeviceMemory devMem = this->tryAllocDeviceMemory(type, size, info, hints);
 
       if (devMem.memHandle != VK_NULL_HANDLE)
-        memory = DxvkMemory(this, nullptr, type, devMem.memHandle, 0, size, devMem.memPointer);
+        memory = DxvkMemory(this, nullptr, DxvkTlsfAllocator::InvalidBlock, type, devMem.memHandle, 0, size, devMem.memPointer);
     }
 
     if (memory) {
@@ -403,6 +745,11 @@ namespace dxvk {
     VkMemoryPriorityAllocateInfoEXT priorityInfo = { VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT };
     priorityInfo.priority       = priority;
 
+    // Buffers may be accessed via their device address with descriptor
+    // buffers, so all allocations need to support that
+    VkMemoryAllocateFlagsInfo flagsInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
+    flagsInfo.flags             = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
     VkMemoryAllocateInfo memoryInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
     memoryInfo.allocationSize   = size;
     memoryInfo.memoryTypeIndex  = type->memTypeId;
@@ -419,6 +766,9 @@ namespace dxvk {
     if (useMemoryPriority)
       priorityInfo.pNext = std::exchange(memoryInfo.pNext, &priorityInfo);
 
+    if (m_device->canUseDescriptorBuffer())
+      flagsInfo.pNext = std::exchange(memoryInfo.pNext, &flagsInfo);
+
     if (vk->vkAllocateMemory(vk->device(), &memoryInfo, nullptr, &result.memHandle))
       return DxvkDeviceMemory();
     
@@ -440,15 +790,17 @@ namespace dxvk {
 
   void DxvkMemoryAllocator::free(
     const DxvkMemory&           memory) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    if (this->tryFreeCached(memory))
+      return;
+
+    std::lock_guard<DxvkMemoryMutex> lock(m_mutex);
     memory.m_type->heap->stats.memoryUsed -= memory.m_length;
 
     if (memory.m_chunk != nullptr) {
       this->freeChunkMemory(
         memory.m_type,
         memory.m_chunk,
-        memory.m_offset,
-        memory.m_length);
+        memory.m_block);
     } else {
       DxvkDeviceMemory devMem;
       devMem.memHandle  = memory.m_memory;
@@ -464,13 +816,17 @@ namespace dxvk {
   void DxvkMemoryAllocator::freeChunkMemory(
           DxvkMemoryType*       type,
           DxvkMemoryChunk*      chunk,
-          VkDeviceSize          offset,
-          VkDeviceSize          length) {
-    chunk->free(offset, length);
+          uint32_t              block) {
+    chunk->free(block);
 
     if (chunk->isEmpty()) {
       Rc<DxvkMemoryChunk> chunkRef = chunk;
 
+      if (chunk->m_evacuate) {
+        chunk->m_evacuate = false;
+        type->heap->stats.memoryReclaimed += chunk->m_memory.memSize;
+      }
+
       // Free the chunk if we have to, or at least put it at the end of
       // the list so that chunks that are already in use and cannot be
       // freed are prioritized for allocations to reduce memory pressure.
@@ -558,6 +914,10 @@ namespace dxvk {
 
   void DxvkMemoryAllocator::freeEmptyChunks(
     const DxvkMemoryHeap*       heap) {
+    // Return cached slices to their chunks first
+    // so that more chunks can potentially be freed
+    this->flushCaches(heap);
+
     for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
       DxvkMemoryType* type = &m_memTypes[i];
 
@@ -700,4 +1060,43 @@ namespace dxvk {
     Logger::err(sstr.str());
   }
 
+
+  uint32_t DxvkMemoryAllocator::computeSizeClass(
+          VkDeviceSize          size) {
+    // Size classes are spaced in quarter powers of two, starting at
+    // 256 bytes, so that no more than 25% of memory gets wasted.
+    size = std::max<VkDeviceSize>(size, 256u);
+
+    uint32_t msb = 63u - bit::lzcnt(uint64_t(size));
+    uint32_t step = msb - 2u;
+    uint32_t quarter = uint32_t((size + (VkDeviceSize(1u) << step) - 1u) >> step);
+
+    if (quarter == 8u) {
+      msb += 1u;
+      quarter = 4u;
+    }
+
+    return 4u * (msb - 8u) + (quarter - 4u);
+  }
+
+
+  VkDeviceSize DxvkMemoryAllocator::getSizeClassSize(
+          uint32_t              sizeClass) {
+    return VkDeviceSize(4u + (sizeClass & 3u)) << (6u + sizeClass / 4u);
+  }
+
+
+  VkDeviceSize DxvkMemoryAllocator::getSizeClassAlignment(
+          uint32_t              sizeClass) {
+    VkDeviceSize size = getSizeClassSize(sizeClass);
+    return size & -size;
+  }
+
+
+  uint32_t DxvkMemoryAllocator::getSizeClassCapacity(
+          uint32_t              sizeClass) {
+    VkDeviceSize count = CacheBytesPerBin / getSizeClassSize(sizeClass);
+    return uint32_t(std::clamp<VkDeviceSize>(count, 2u, CacheMaxSlicesPerBin));
+  }
+
 }
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "dxvk_adapter.h"
+#include "dxvk_allocator.h"
+
+#include "../util/util_time.h"
 
 namespace dxvk {
   
+  class DxvkBuffer;
   class DxvkMemoryAllocator;
   class DxvkMemoryChunk;
   
@@ -12,10 +16,74 @@ namespace dxvk {
    * 
    * Reports the amount of device memory
    * allocated and used by the application.
+   * Lock statistics are global to the allocator
+   * and do not depend on the queried heap.
    */
   struct DxvkMemoryStats {
     VkDeviceSize memoryAllocated = 0;
     VkDeviceSize memoryUsed      = 0;
+    VkDeviceSize memoryCached    = 0;
+    VkDeviceSize memoryReclaimed = 0;
+    uint64_t     lockCount       = 0;
+    uint64_t     lockContention  = 0;
+    uint64_t     lockHoldTimeUs  = 0;
+  };
+
+
+  /**
+   * \brief Memory allocator mutex
+   *
+   * Regular mutex that additionally counts how often
+   * it gets contended and how long it is being held.
+   * Counters are only written while the lock is held,
+   * so relaxed atomics are sufficient.
+   */
+  class DxvkMemoryMutex {
+
+  public:
+
+    void lock() {
+      if (unlikely(!m_mutex.try_lock())) {
+        m_mutex.lock();
+        increment(m_contentionCount, 1);
+      }
+
+      increment(m_lockCount, 1);
+      m_lockTime = high_resolution_clock::now();
+    }
+
+    void unlock() {
+      auto holdTime = high_resolution_clock::now() - m_lockTime;
+      increment(m_holdTimeNs, std::chrono::duration_cast<std::chrono::nanoseconds>(holdTime).count());
+
+      m_mutex.unlock();
+    }
+
+    uint64_t getLockCount() const {
+      return m_lockCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getContentionCount() const {
+      return m_contentionCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getHoldTimeUs() const {
+      return m_holdTimeNs.load(std::memory_order_relaxed) / 1000u;
+    }
+
+  private:
+
+    dxvk::mutex                       m_mutex;
+    high_resolution_clock::time_point m_lockTime;
+
+    std::atomic<uint64_t>             m_lockCount       = { 0ull };
+    std::atomic<uint64_t>             m_contentionCount = { 0ull };
+    std::atomic<uint64_t>             m_holdTimeNs      = { 0ull };
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+      counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
   };
 
 
@@ -102,6 +170,7 @@ namespace dxvk {
     DxvkMemory(
       DxvkMemoryAllocator*  alloc,
       DxvkMemoryChunk*      chunk,
+      uint32_t              block,
       DxvkMemoryType*       type,
       VkDeviceMemory        memory,
       VkDeviceSize          offset,
@@ -166,6 +235,7 @@ namespace dxvk {
     
     DxvkMemoryAllocator*  m_alloc  = nullptr;
     DxvkMemoryChunk*      m_chunk  = nullptr;
+    uint32_t              m_block  = DxvkTlsfAllocator::InvalidBlock;
     DxvkMemoryType*       m_type   = nullptr;
     VkDeviceMemory        m_memory = VK_NULL_HANDLE;
     VkDeviceSize          m_offset = 0;
@@ -199,9 +269,12 @@ namespace dxvk {
    * 
    * A single chunk of memory that provides a
    * sub-allocator. This is not thread-safe.
+   * Free ranges are managed by a TLSF allocator
+   * so that both allocating and freeing memory
+   * takes constant time.
    */
   class DxvkMemoryChunk : public RcObject {
-    
+    friend class DxvkMemoryAllocator;
   public:
     
     DxvkMemoryChunk(
@@ -235,12 +308,10 @@ namespace dxvk {
      * Returns a slice back to the chunk.
      * Called automatically when a memory
      * slice runs out of scope.
-     * \param [in] offset Slice offset
-     * \param [in] length Slice length
+     * \param [in] block Allocator block index of the slice
      */
     void free(
-            VkDeviceSize  offset,
-            VkDeviceSize  length);
+            uint32_t      block);
 
     /**
      * \brief Checks whether the chunk is being used
@@ -248,6 +319,29 @@ namespace dxvk {
      */
     bool isEmpty() const;
 
+    /**
+     * \brief Checks whether the chunk can serve an allocation
+     *
+     * \param [in] flags Requested memory type flags
+     * \param [in] hints Memory category
+     * \returns \c true if flags and hints are compatible
+     */
+    bool canAllocate(
+            VkMemoryPropertyFlags flags,
+            DxvkMemoryFlags       hints) const;
+
+    /**
+     * \brief Sets relocation owner of a slice
+     *
+     * \param [in] block Allocator block index of the slice
+     * \param [in] length Slice length
+     * \param [in] owner Owning buffer, or \c nullptr
+     */
+    void setOwner(
+            uint32_t              block,
+            VkDeviceSize          length,
+            DxvkBuffer*           owner);
+
     /**
      * \brief Checks whether hints and flags of another chunk match
      * \param [in] other The chunk to compare to
@@ -256,17 +350,17 @@ namespace dxvk {
 
   private:
     
-    struct FreeSlice {
-      VkDeviceSize offset;
-      VkDeviceSize length;
-    };
-    
     DxvkMemoryAllocator*  m_alloc;
     DxvkMemoryType*       m_type;
     DxvkDeviceMemory      m_memory;
     DxvkMemoryFlags       m_hints;
     
-    std::vector<FreeSlice> m_freeList;
+    DxvkTlsfAllocator     m_allocator;
+
+    bool                  m_evacuate  = false;
+    VkDeviceSize          m_ownedSize = 0;
+
+    std::vector<DxvkBuffer*> m_owners;
 
     bool checkHints(DxvkMemoryFlags hints) const;
     
@@ -299,12 +393,43 @@ namespace dxvk {
    * 
    * Allocates device memory for Vulkan resources.
    * Memory objects will be destroyed automatically.
+   *
+   * Small suballocations are recycled through a set of
+   * per-thread caches, so that the global allocator lock
+   * only needs to be taken when a cache runs empty or
+   * full, at which point slices are moved in batches.
+   *
+   * Device memory can be defragmented incrementally by
+   * evacuating sparsely used chunks. Only buffers that
+   * register themselves as owner of their memory slice
+   * are considered for relocation.
    */
   class DxvkMemoryAllocator {
     friend class DxvkMemory;
     friend class DxvkMemoryChunk;
 
     constexpr static VkDeviceSize SmallAllocationThreshold = 256 << 10;
+
+    constexpr static VkDeviceSize CacheAllocationThreshold = 64 << 10;
+    constexpr static VkDeviceSize CacheBytesPerBin = 128 << 10;
+    constexpr static uint32_t     CacheMaxSlicesPerBin = 32;
+    constexpr static uint32_t     CacheSizeClassCount = 33;
+    constexpr static uint32_t     CacheCountLog2 = 3;
+    constexpr static uint32_t     CacheCount = 1u << CacheCountLog2;
+
+    struct CachedSlice {
+      DxvkMemoryChunk*  chunk;
+      uint32_t          block;
+      VkDeviceMemory    memory;
+      VkDeviceSize      offset;
+      void*             mapPtr;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Cache {
+      sync::Spinlock                                  mutex;
+      std::vector<std::vector<CachedSlice>>           bins;
+      std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>   cachedBytes = { };
+    };
   public:
     
     DxvkMemoryAllocator(DxvkDevice* device);
@@ -339,16 +464,38 @@ namespace dxvk {
      * \param [in] heap Heap index
      * \returns Memory stats for this heap
      */
-    DxvkMemoryStats getMemoryStats(uint32_t heap) const {
-      return m_memHeaps[heap].stats;
-    }
+    DxvkMemoryStats getMemoryStats(uint32_t heap);
+
+    /**
+     * \brief Registers relocation owner of a memory slice
+     *
+     * Buffers registered this way may get relocated in order
+     * to defragment device memory. The owner is unregistered
+     * automatically when the memory slice gets freed.
+     * \param [in] memory Memory slice
+     * \param [in] owner Owning buffer, or \c nullptr
+     */
+    void setRelocationOwner(
+      const DxvkMemory&                       memory,
+            DxvkBuffer*                       owner);
+
+    /**
+     * \brief Picks buffers to relocate
+     *
+     * Updates the set of chunks being evacuated and returns
+     * buffers that currently own memory in those chunks.
+     * \param [in] budget Maximum number of bytes to relocate
+     * \returns Buffers to relocate
+     */
+    std::vector<Rc<DxvkBuffer>> getRelocationCandidates(
+            VkDeviceSize                      budget);
     
   private:
 
     DxvkDevice*                                     m_device;
     VkPhysicalDeviceMemoryProperties                m_memProps;
     
-    dxvk::mutex                                     m_mutex;
+    DxvkMemoryMutex                                 m_mutex;
     std::array<DxvkMemoryHeap, VK_MAX_MEMORY_HEAPS> m_memHeaps;
     std::array<DxvkMemoryType, VK_MAX_MEMORY_TYPES> m_memTypes;
 
@@ -356,6 +503,30 @@ namespace dxvk {
 
     uint32_t m_sparseMemoryTypes = 0u;
 
+    std::array<Cache, CacheCount>                   m_caches;
+
+    DxvkMemory tryAllocCached(
+            DxvkMemoryRequirements            req,
+      const DxvkMemoryProperties&             info,
+            DxvkMemoryFlags                   hints);
+
+    bool tryFreeCached(
+      const DxvkMemory&                       memory);
+
+    void freeCachedSlices(
+            DxvkMemoryType*                   type,
+            VkDeviceSize                      length,
+            size_t                            count,
+      const CachedSlice*                      slices);
+
+    void flushCaches(
+      const DxvkMemoryHeap*                   heap);
+
+    void updateEvacuationState(
+            DxvkMemoryType*                   type);
+
+    Cache& getThreadCache();
+
     DxvkMemory tryAlloc(
       const DxvkMemoryRequirements&           req,
       const DxvkMemoryProperties&             info,
@@ -380,8 +551,7 @@ namespace dxvk {
     void freeChunkMemory(
             DxvkMemoryType*       type,
             DxvkMemoryChunk*      chunk,
-            VkDeviceSize          offset,
-            VkDeviceSize          length);
+            uint32_t              block);
     
     void freeDeviceMemory(
             DxvkMemoryType*       type,
@@ -413,6 +583,18 @@ namespace dxvk {
 
     void logMemoryStats() const;
 
+    static uint32_t computeSizeClass(
+            VkDeviceSize          size);
+
+    static VkDeviceSize getSizeClassSize(
+            uint32_t              sizeClass);
+
+    static VkDeviceSize getSizeClassAlignment(
+            uint32_t              sizeClass);
+
+    static uint32_t getSizeClassCapacity(
+            uint32_t              sizeClass);
+
   };
   
 }
@@ -11,6 +11,8 @@
 #include "dxvk_meta_resolve.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_renderpass.h"
+#include "dxvk_shader_cache.h"
+#include "dxvk_staging.h"
 #include "dxvk_unbound.h"
 
 #include "../util/util_lazy.h"
@@ -71,6 +73,14 @@ namespace dxvk {
       return m_metaPack.get(m_device);
     }
 
+    DxvkShaderCache& shaderCache() {
+      return m_shaderCache.get(m_device);
+    }
+
+    DxvkStagingRing& stagingRing() {
+      return m_stagingRing.get(m_device);
+    }
+
   private:
 
     DxvkDevice*                   m_device;
@@ -89,6 +99,10 @@ namespace dxvk {
     Lazy<DxvkMetaResolveObjects>  m_metaResolve;
     Lazy<DxvkMetaPackObjects>     m_metaPack;
 
+    Lazy<DxvkShaderCache>         m_shaderCache;
+
+    Lazy<DxvkStagingRing>         m_stagingRing;
+
   };
 
 }
\ No newline at end of file
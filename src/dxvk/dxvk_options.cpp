@@ -9,7 +9,12 @@ namespace dxvk {
     enableGraphicsPipelineLibrary = config.getOption<Tristate>("dxvk.enableGraphicsPipelineLibrary", Tristate::Auto);
     trackPipelineLifetime = config.getOption<Tristate>("dxvk.trackPipelineLifetime",  Tristate::Auto);
     useRawSsbo            = config.getOption<Tristate>("dxvk.useRawSsbo",             Tristate::Auto);
+    enableAsyncCompute    = config.getOption<bool>    ("dxvk.enableAsyncCompute",     false);
+    enableDescriptorBuffer = config.getOption<bool>   ("dxvk.enableDescriptorBuffer", false);
+    latencySleep          = config.getOption<bool>    ("dxvk.latencySleep",           false);
     maxChunkSize          = config.getOption<int32_t> ("dxvk.maxChunkSize",           0);
+    defragBudget          = config.getOption<int32_t> ("dxvk.defragBudget",           0);
+    shaderCacheSize       = config.getOption<int32_t> ("dxvk.shaderCacheSize",        0);
     hud                   = config.getOption<std::string>("dxvk.hud", "");
     tearFree              = config.getOption<Tristate>("dxvk.tearFree",               Tristate::Auto);
   }
@@ -27,9 +27,24 @@ namespace dxvk {
     /// Shader-related options
     Tristate useRawSsbo;
 
+    /// Enable async compute queue submissions
+    bool enableAsyncCompute;
+
+    /// Use descriptor buffers instead of descriptor pools
+    bool enableDescriptorBuffer;
+
+    /// Delay frames to reduce input latency
+    bool latencySleep;
+
     /// Maximum memory chunk size in MiB
     int32_t maxChunkSize;
 
+    /// Per-frame memory defragmentation budget in MiB
+    int32_t defragBudget;
+
+    /// Maximum size of the shader cache in MiB
+    int32_t shaderCacheSize;
+
     /// HUD elements
     std::string hud;
 
@@ -180,10 +180,28 @@ namespace dxvk {
     layoutInfo.bindingCount = bindingInfos.size();
     layoutInfo.pBindings = bindingInfos.data();
 
+    bool useDescriptorBuffer = m_device->canUseDescriptorBuffer();
+
+    if (useDescriptorBuffer)
+      layoutInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+
     if (vk->vkCreateDescriptorSetLayout(vk->device(), &layoutInfo, nullptr, &m_layout) != VK_SUCCESS)
       throw DxvkError("DxvkBindingSetLayoutKey: Failed to create descriptor set layout");
 
-    if (layoutInfo.bindingCount) {
+    if (useDescriptorBuffer) {
+      // Descriptors are written directly to memory, so we
+      // need the layout of the set instead of a template
+      vk->vkGetDescriptorSetLayoutSizeEXT(vk->device(), m_layout, &m_layoutSize);
+
+      // Pad the set size so that consecutive sets can be bound
+      m_layoutSize = align(m_layoutSize, m_device->properties()
+        .extDescriptorBuffer.descriptorBufferOffsetAlignment);
+
+      m_bindingOffsets.resize(layoutInfo.bindingCount);
+
+      for (uint32_t i = 0; i < layoutInfo.bindingCount; i++)
+        vk->vkGetDescriptorSetLayoutBindingOffsetEXT(vk->device(), m_layout, i, &m_bindingOffsets[i]);
+    } else if (layoutInfo.bindingCount) {
       VkDescriptorUpdateTemplateCreateInfo templateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO };
       templateInfo.descriptorUpdateEntryCount = templateInfos.size();
       templateInfo.pDescriptorUpdateEntries = templateInfos.data();
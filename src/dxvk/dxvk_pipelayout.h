@@ -233,12 +233,39 @@ namespace dxvk {
       return m_template;
     }
 
+    /**
+     * \brief Queries descriptor buffer memory size
+     *
+     * Only valid if the layout was created for use with
+     * descriptor buffers. Padded to the required offset
+     * alignment so that sets can be packed tightly.
+     * \returns Size of the set in descriptor memory
+     */
+    VkDeviceSize getSetLayoutSize() const {
+      return m_layoutSize;
+    }
+
+    /**
+     * \brief Queries descriptor buffer binding offset
+     *
+     * Only valid if the layout was created for use
+     * with descriptor buffers.
+     * \param [in] binding Binding index
+     * \returns Offset of the binding within the set
+     */
+    VkDeviceSize getBindingOffset(uint32_t binding) const {
+      return m_bindingOffsets[binding];
+    }
+
   private:
 
     DxvkDevice*                   m_device;
     VkDescriptorSetLayout         m_layout    = VK_NULL_HANDLE;
     VkDescriptorUpdateTemplate    m_template  = VK_NULL_HANDLE;
 
+    VkDeviceSize                  m_layoutSize = 0;
+    std::vector<VkDeviceSize>     m_bindingOffsets;
+
   };
 
 
@@ -458,6 +485,16 @@ namespace dxvk {
       return m_bindingObjects[set]->getSetUpdateTemplate();
     }
 
+    /**
+     * \brief Retrieves descriptor buffer set objects for a given set
+     *
+     * \param [in] set Descriptor set index
+     * \returns Set layout object
+     */
+    const DxvkBindingSetLayout* getSetObjects(uint32_t set) const {
+      return m_bindingObjects[set];
+    }
+
     /**
      * \brief Retrieves pipeline layout
      *
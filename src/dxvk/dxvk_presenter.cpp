@@ -13,7 +13,8 @@ namespace dxvk {
     const PresenterDesc&    desc)
   : m_device(device), m_signal(signal),
     m_vki(device->instance()->vki()),
-    m_vkd(device->vkd()) {
+    m_vkd(device->vkd()),
+    m_latency(device.ptr()) {
     // If a frame signal was provided, launch thread that synchronizes
     // with present operations and periodically signals the event
     if (m_device->features().khrPresentWait.presentWait && m_signal != nullptr)
@@ -91,6 +92,9 @@ namespace dxvk {
     if (m_device->features().extSwapchainMaintenance1.swapchainMaintenance1)
       modeInfo.pNext = const_cast<void*>(std::exchange(info.pNext, &modeInfo));
 
+    if (frameId)
+      m_latency.notifyPresentSubmit(frameId);
+
     VkResult status = m_vkd->vkQueuePresentKHR(
       m_device->queues().graphics.queueHandle, &info);
 
@@ -119,6 +123,8 @@ namespace dxvk {
     if (m_signal == nullptr || !frameId)
       return;
 
+    m_latency.notifyGpuDone(frameId);
+
     if (m_device->features().khrPresentWait.presentWait) {
       std::lock_guard<dxvk::mutex> lock(m_frameMutex);
 
@@ -130,6 +136,8 @@ namespace dxvk {
       m_frameQueue.push(frame);
       m_frameCond.notify_one();
     } else {
+      m_latency.notifyPresentDone(frameId);
+
       applyFrameRateLimit(mode);
       m_signal->signal(frameId);
     }
@@ -138,6 +146,12 @@ namespace dxvk {
   }
 
 
+  void Presenter::latencySleep(
+          uint64_t          frameId) {
+    m_latency.sleepAndBeginFrame(frameId);
+  }
+
+
   VkResult Presenter::recreateSurface(
     const std::function<VkResult (VkSurfaceKHR*)>& fn) {
     if (m_swapchain)
@@ -672,19 +686,27 @@ namespace dxvk {
       if (!frame.frameId)
         return;
 
+      // If the present operation has succeeded, actually wait for it to complete.
+      // Don't bother with it on MAILBOX / IMMEDIATE modes since doing so would
+      // restrict us to the display refresh rate on some platforms (XWayland).
+      bool waitForPresent = frame.result >= 0
+        && (frame.mode == VK_PRESENT_MODE_FIFO_KHR || frame.mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR);
+
+      if (!waitForPresent)
+        m_latency.notifyPresentDone(frame.frameId);
+
       // Apply the FPS limiter before signaling the frame event in
       // order to reduce latency if the app uses it for frame pacing.
       applyFrameRateLimit(frame.mode);
 
-      // If the present operation has succeeded, actually wait for it to complete.
-      // Don't bother with it on MAILBOX / IMMEDIATE modes since doing so would
-      // restrict us to the display refresh rate on some platforms (XWayland).
-      if (frame.result >= 0 && (frame.mode == VK_PRESENT_MODE_FIFO_KHR || frame.mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR)) {
+      if (waitForPresent) {
         VkResult vr = m_vkd->vkWaitForPresentKHR(m_vkd->device(),
           m_swapchain, frame.frameId, std::numeric_limits<uint64_t>::max());
 
         if (vr < 0 && vr != VK_ERROR_OUT_OF_DATE_KHR && vr != VK_ERROR_SURFACE_LOST_KHR)
           Logger::err(str::format("Presenter: vkWaitForPresentKHR failed: ", vr));
+
+        m_latency.notifyPresentDone(frame.frameId);
       }
 
       // Always signal even on error, since failures here
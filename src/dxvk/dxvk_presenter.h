@@ -15,6 +15,7 @@
 #include "../vulkan/vulkan_loader.h"
 
 #include "dxvk_format.h"
+#include "dxvk_latency.h"
 
 namespace dxvk {
 
@@ -159,6 +160,20 @@ namespace dxvk {
             VkPresentModeKHR  mode,
             uint64_t          frameId);
 
+    /**
+     * \brief Delays the start of the next frame
+     *
+     * Must be called by the application thread after presenting
+     * and synchronizing with the frame latency signal, as well as
+     * once after creating the presenter for the first frame. Records
+     * the start time of the given frame, and blocks the calling
+     * thread first if low-latency mode is enabled in order to
+     * avoid queueing up GPU work.
+     * \param [in] frameId ID of the frame that is about to begin
+     */
+    void latencySleep(
+            uint64_t          frameId);
+
     /**
      * \brief Changes and takes ownership of surface
      *
@@ -249,6 +264,8 @@ namespace dxvk {
 
     FpsLimiter        m_fpsLimiter;
 
+    DxvkLatencyTracker m_latency;
+
     dxvk::mutex                 m_frameMutex;
     dxvk::condition_variable    m_frameCond;
     dxvk::thread                m_frameThread;
@@ -37,7 +37,7 @@ namespace dxvk {
     entry.status = status;
     entry.submit = std::move(submitInfo);
 
-    m_submitQueue.push(std::move(entry));
+    m_submitQueue.push_back(std::move(entry));
     m_appendCond.notify_all();
   }
 
@@ -49,7 +49,7 @@ namespace dxvk {
     entry.status  = status;
     entry.present = std::move(presentInfo);
 
-    m_submitQueue.push(std::move(entry));
+    m_submitQueue.push_back(std::move(entry));
     m_appendCond.notify_all();
   }
 
@@ -115,52 +115,109 @@ namespace dxvk {
       if (m_stopped.load())
         return;
       
-      DxvkSubmitEntry entry = std::move(m_submitQueue.front());
+      // Pick up all consecutive command lists that are already queued
+      // so that they can be passed to the driver in one go. Presents
+      // are processed on their own since they must observe all prior
+      // submissions anyway. Entries stay in the queue until they are
+      // processed so that other threads can still synchronize.
+      size_t entryCount = 0;
+
+      do {
+        m_submitEntries.push_back(std::move(m_submitQueue[entryCount++]));
+      } while (entryCount < m_submitQueue.size()
+            && entryCount < MaxNumBatchedCommandLists
+            && m_submitEntries.back().submit.cmdList != nullptr
+            && m_submitQueue[entryCount].submit.cmdList != nullptr);
+
       lock.unlock();
 
-      // Submit command buffer to device
+      // Submit command buffers to device
       if (m_lastError != VK_ERROR_DEVICE_LOST) {
         std::lock_guard<dxvk::mutex> lock(m_mutexQueue);
 
         if (m_callback)
           m_callback(true);
 
-        if (entry.submit.cmdList != nullptr)
-          entry.result = entry.submit.cmdList->submit();
-        else if (entry.present.presenter != nullptr)
-          entry.result = entry.present.presenter->presentImage(entry.present.presentMode, entry.present.frameId);
+        size_t batchStart = 0;
+
+        for (size_t i = 0; i < entryCount; i++) {
+          auto& entry = m_submitEntries[i];
+
+          if (entry.submit.cmdList != nullptr) {
+            // Command lists that require more than one submission
+            // cannot be batched, so submit any pending work first
+            if (!entry.submit.cmdList->isBatchable()) {
+              submitBatch(batchStart, i);
+              batchStart = i + 1;
+            }
+
+            entry.result = entry.submit.cmdList->submit(m_submitBatch);
+          } else if (entry.present.presenter != nullptr) {
+            entry.result = entry.present.presenter->presentImage(entry.present.presentMode, entry.present.frameId);
+          }
+        }
+
+        submitBatch(batchStart, entryCount);
 
         if (m_callback)
           m_callback(false);
       } else {
         // Don't submit anything after device loss
         // so that drivers get a chance to recover
-        entry.result = VK_ERROR_DEVICE_LOST;
+        for (size_t i = 0; i < entryCount; i++)
+          m_submitEntries[i].result = VK_ERROR_DEVICE_LOST;
       }
 
-      if (entry.status)
-        entry.status->result = entry.result;
-      
-      // On success, pass it on to the queue thread
+      // On success, pass entries on to the queue thread
       lock = std::unique_lock<dxvk::mutex>(m_mutex);
 
-      bool doForward = (entry.result == VK_SUCCESS) ||
-        (entry.present.presenter != nullptr && entry.result != VK_ERROR_DEVICE_LOST);
+      for (size_t i = 0; i < entryCount; i++) {
+        auto& entry = m_submitEntries[i];
 
-      if (doForward) {
-        m_finishQueue.push(std::move(entry));
-      } else {
-        Logger::err(str::format("DxvkSubmissionQueue: Command submission failed: ", entry.result));
-        m_lastError = entry.result;
+        if (entry.status)
+          entry.status->result = entry.result;
+
+        bool doForward = (entry.result == VK_SUCCESS) ||
+          (entry.present.presenter != nullptr && entry.result != VK_ERROR_DEVICE_LOST);
+
+        if (doForward) {
+          m_finishQueue.push(std::move(entry));
+        } else {
+          Logger::err(str::format("DxvkSubmissionQueue: Command submission failed: ", entry.result));
+          m_lastError = entry.result;
 
-        if (m_lastError != VK_ERROR_DEVICE_LOST)
-          m_device->waitForIdle();
+          if (m_lastError != VK_ERROR_DEVICE_LOST)
+            m_device->waitForIdle();
+        }
+
+        m_submitQueue.pop_front();
       }
 
-      m_submitQueue.pop();
+      m_submitEntries.clear();
       m_submitCond.notify_all();
     }
   }
+
+
+  void DxvkSubmissionQueue::submitBatch(
+          size_t              first,
+          size_t              last) {
+    if (m_submitBatch.isEmpty())
+      return;
+
+    VkResult vr = m_submitBatch.submit(m_device,
+      m_device->queues().graphics.queueHandle);
+
+    // If the batched submission failed, it failed for every
+    // command list that was part of it. Lists that have not
+    // been added to the batch already have an error code.
+    if (vr != VK_SUCCESS) {
+      for (size_t i = first; i < last; i++) {
+        if (m_submitEntries[i].result == VK_SUCCESS)
+          m_submitEntries[i].result = vr;
+      }
+    }
+  }
   
   
   void DxvkSubmissionQueue::finishCmdLists() {
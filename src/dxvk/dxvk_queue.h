@@ -1,8 +1,10 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "../util/thread.h"
 
@@ -191,15 +193,22 @@ namespace dxvk {
     dxvk::condition_variable    m_submitCond;
     dxvk::condition_variable    m_finishCond;
 
-    std::queue<DxvkSubmitEntry> m_submitQueue;
+    std::deque<DxvkSubmitEntry> m_submitQueue;
     std::queue<DxvkSubmitEntry> m_finishQueue;
 
+    std::vector<DxvkSubmitEntry> m_submitEntries;
+    DxvkSubmissionBatch         m_submitBatch;
+
     dxvk::thread                m_submitThread;
     dxvk::thread                m_finishThread;
 
     void submitCmdLists();
 
     void finishCmdLists();
+
+    void submitBatch(
+            size_t              first,
+            size_t              last);
     
   };
   
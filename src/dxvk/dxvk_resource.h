@@ -30,6 +30,11 @@ namespace dxvk {
     static constexpr uint64_t RefcountInc   = 1ull;
     static constexpr uint64_t RdAccessInc   = 1ull << RdAccessShift;
     static constexpr uint64_t WrAccessInc   = 1ull << WrAccessShift;
+
+    static constexpr uint64_t TrackingIdShift     = 2;
+    static constexpr uint64_t TrackingReadBit     = 1ull << 0;
+    static constexpr uint64_t TrackingWriteBit    = 1ull << 1;
+    static constexpr uint64_t TrackingAccessMask  = TrackingReadBit | TrackingWriteBit;
   public:
 
     DxvkResource();
@@ -64,6 +69,37 @@ namespace dxvk {
       return release(DxvkAccess::None);
     }
 
+    /**
+     * \brief Queries reference count
+     *
+     * Includes references held by command lists. The result
+     * is only reliable if no other thread can concurrently
+     * acquire new references to the object.
+     * \returns Current reference count
+     */
+    uint32_t getRefCount() const {
+      return uint32_t(m_useCount.load(std::memory_order_acquire) & RefcountMask);
+    }
+
+    /**
+     * \brief Increments reference count if non-zero
+     *
+     * Fails if the reference count is already zero, which means
+     * that the object is about to be destroyed. Useful when
+     * looking up objects through non-owning pointers.
+     * \returns \c true if a reference was acquired
+     */
+    bool tryIncRef() {
+      uint64_t value = m_useCount.load(std::memory_order_acquire);
+
+      do {
+        if (!(value & RefcountMask))
+          return false;
+      } while (!m_useCount.compare_exchange_weak(value, value + RefcountInc));
+
+      return true;
+    }
+
     /**
      * \brief Acquires resource with given access
      *
@@ -86,6 +122,38 @@ namespace dxvk {
       return uint32_t((m_useCount -= getIncrement(access)) & RefcountMask);
     }
 
+    /**
+     * \brief Marks resource as tracked by a lifetime tracker
+     *
+     * Stores the tracker ID along with the tracked access in
+     * the resource, so that a tracker can skip resources it
+     * already tracks with a compatible access. Concurrent use
+     * from multiple trackers may cause redundant tracking, but
+     * a tracker will never skip a resource it does not track.
+     * \param [in] trackingId Unique ID of the calling tracker
+     * \param [in] access Access to track
+     * \returns \c true if the resource needs to be tracked
+     */
+    bool markTracked(uint64_t trackingId, DxvkAccess access) {
+      uint64_t value = m_tracking.load(std::memory_order_relaxed);
+      uint64_t flags = 0;
+
+      if ((value >> TrackingIdShift) == trackingId) {
+        flags = value & TrackingAccessMask;
+
+        // Write access implies read access for the purpose
+        // of use tracking, and any access keeps it alive.
+        uint64_t needed = getTrackingFlags(access);
+
+        if (!needed || (flags & (needed | TrackingWriteBit)))
+          return false;
+      }
+
+      flags |= getTrackingFlags(access);
+      m_tracking.store((trackingId << TrackingIdShift) | flags, std::memory_order_relaxed);
+      return true;
+    }
+
     /**
      * \brief Checks whether resource is in use
      * 
@@ -106,8 +174,17 @@ namespace dxvk {
   private:
     
     std::atomic<uint64_t> m_useCount;
+    std::atomic<uint64_t> m_tracking = { 0ull };
     uint64_t              m_cookie;
 
+    static constexpr uint64_t getTrackingFlags(DxvkAccess access) {
+      if (access == DxvkAccess::None)
+        return 0;
+
+      return access == DxvkAccess::Read
+        ? TrackingReadBit : TrackingWriteBit;
+    }
+
     static constexpr uint64_t getIncrement(DxvkAccess access) {
       uint64_t increment = RefcountInc;
 
@@ -1168,6 +1168,8 @@ namespace dxvk {
       }
     }
 
+    flags |= m_device->getShaderPipelineCreateFlags();
+
     if (stageMask & VK_SHADER_STAGE_VERTEX_BIT)
       return compileVertexShaderPipeline(args, stageInfo, flags);
 
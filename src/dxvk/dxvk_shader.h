@@ -11,6 +11,8 @@
 #include "../spirv/spirv_compression.h"
 #include "../spirv/spirv_module.h"
 
+#include "../util/util_time.h"
+
 namespace dxvk {
   
   class DxvkShader;
@@ -68,6 +70,25 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Shader compile timings
+   *
+   * Optionally filled in by the shader compilers for
+   * profiling purposes. Decoding happens on the fly, so
+   * the analysis and compile passes include decode time.
+   */
+  struct DxvkShaderCompileTimings {
+    /// Time spent in the analysis pass
+    std::chrono::nanoseconds analyze  = { };
+    /// Time spent translating instructions
+    std::chrono::nanoseconds compile  = { };
+    /// Time spent emitting epilogue code and creating the shader
+    std::chrono::nanoseconds finalize = { };
+    /// Time spent assembling the SPIR-V binary
+    std::chrono::nanoseconds spirv    = { };
+  };
+
+
   /**
    * \brief Shader module create info
    */
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include <version.h>
+
+#include "dxvk_device.h"
+#include "dxvk_shader_cache.h"
+
+namespace dxvk {
+
+  DxvkShaderCache::DxvkShaderCache(DxvkDevice* device) {
+    std::string useShaderCache = env::getEnvVar("DXVK_SHADER_CACHE");
+    int32_t maxSizeMib = device->config().shaderCacheSize;
+
+    m_enable = useShaderCache != "0" && useShaderCache != "disable" && maxSizeMib >= 0;
+
+    if (!m_enable)
+      return;
+
+    m_maxSize = uint64_t(maxSizeMib ? maxSizeMib : 256) << 20;
+    m_cacheDir = getCacheDir();
+
+    // Enforce the size limit in the background,
+    // since this needs to look at every file
+    m_trimThread = dxvk::thread([this] () { trimCache(); });
+  }
+
+
+  DxvkShaderCache::~DxvkShaderCache() {
+    if (m_trimThread.joinable())
+      m_trimThread.join();
+  }
+
+
+  Rc<DxvkShader> DxvkShaderCache::lookupShader(
+    const Sha1Hash&                 key,
+          std::vector<char>&        metadata) {
+    if (!m_enable)
+      return nullptr;
+
+    str::path_string fileName = getFileName(key);
+    std::ifstream file(fileName.c_str(), std::ios_base::binary);
+
+    if (!file)
+      return nullptr;
+
+    FileHeader expected;
+    FileHeader header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+     || std::memcmp(header.magic, expected.magic, sizeof(header.magic))
+     || header.version != expected.version
+     || header.key != key)
+      return nullptr;
+
+    std::vector<char> data(header.dataSize);
+    Sha1Hash hash;
+
+    if (!file.read(data.data(), data.size())
+     || !file.read(reinterpret_cast<char*>(&hash), sizeof(hash))
+     || hash != Sha1Hash::compute(data.data(), data.size()))
+      return nullptr;
+
+    file.close();
+
+    // Decode shader info and binding infos
+    DxvkShaderCacheReader reader(data.data(), data.size());
+    DxvkShaderCreateInfo info;
+
+    std::vector<DxvkBindingInfo> bindings;
+    std::vector<char> uniformData;
+
+    uint32_t metadataSize = 0;
+    uint32_t codeSize = 0;
+
+    if (!reader.read(info.stage)
+     || !reader.read(info.bindingCount)
+     || !reader.read(info.inputMask)
+     || !reader.read(info.outputMask)
+     || !reader.read(info.flatShadingInputs)
+     || !reader.read(info.pushConstOffset)
+     || !reader.read(info.pushConstSize)
+     || !reader.read(info.uniformSize)
+     || !reader.read(info.xfbRasterizedStream)
+     || !reader.read(info.patchVertexCount)
+     || !reader.read(info.xfbStrides)
+     || !reader.read(info.outputTopology))
+      return nullptr;
+
+    bindings.resize(info.bindingCount);
+    uniformData.resize(info.uniformSize);
+
+    if (!reader.read(bindings.data(), bindings.size() * sizeof(DxvkBindingInfo))
+     || !reader.read(uniformData.data(), uniformData.size())
+     || !reader.read(metadataSize))
+      return nullptr;
+
+    metadata.resize(metadataSize);
+
+    if (!reader.read(metadata.data(), metadata.size())
+     || !reader.read(codeSize))
+      return nullptr;
+
+    SpirvCodeBuffer code(codeSize);
+
+    if (!reader.read(code.data(), code.size()))
+      return nullptr;
+
+    info.bindings = bindings.data();
+    info.uniformData = uniformData.data();
+
+    // Mark the file as recently used
+    std::error_code ec;
+    std::filesystem::last_write_time(std::filesystem::path(fileName),
+      std::filesystem::file_time_type::clock::now(), ec);
+
+    return new DxvkShader(info, std::move(code));
+  }
+
+
+  void DxvkShaderCache::storeShader(
+    const Sha1Hash&                 key,
+    const Rc<DxvkShader>&           shader,
+    const std::vector<char>&        metadata) {
+    if (!m_enable)
+      return;
+
+    // Serialize shader info. Bindings are taken from
+    // the shader's binding layout, order does not matter.
+    const DxvkShaderCreateInfo& info = shader->info();
+    const DxvkBindingLayout& layout = shader->getBindings();
+
+    std::vector<DxvkBindingInfo> bindings;
+
+    for (uint32_t i = 0; i < DxvkDescriptorSets::SetCount; i++) {
+      for (uint32_t j = 0; j < layout.getBindingCount(i); j++)
+        bindings.push_back(layout.getBinding(i, j));
+    }
+
+    SpirvCodeBuffer code = shader->getRawCode();
+
+    DxvkShaderCacheWriter writer;
+    writer.write(info.stage);
+    writer.write(uint32_t(bindings.size()));
+    writer.write(info.inputMask);
+    writer.write(info.outputMask);
+    writer.write(info.flatShadingInputs);
+    writer.write(info.pushConstOffset);
+    writer.write(info.pushConstSize);
+    writer.write(info.uniformSize);
+    writer.write(info.xfbRasterizedStream);
+    writer.write(info.patchVertexCount);
+    writer.write(info.xfbStrides);
+    writer.write(info.outputTopology);
+    writer.write(bindings.data(), bindings.size() * sizeof(DxvkBindingInfo));
+    writer.write(info.uniformData, info.uniformSize);
+    writer.write(uint32_t(metadata.size()));
+    writer.write(metadata.data(), metadata.size());
+    writer.write(uint32_t(code.dwords()));
+    writer.write(code.data(), code.size());
+
+    FileHeader header;
+    header.key = key;
+    header.dataSize = uint32_t(writer.data().size());
+
+    Sha1Hash hash = writer.computeHash();
+
+    // Write to a temporary file first, and only rename it once
+    // all data has been written, so that other processes or
+    // future sessions never observe partially written files.
+    str::path_string fileName = getFileName(key);
+    str::path_string tempName = fileName;
+
+    // Use a unique temporary file name in case multiple
+    // threads or processes write the same shader at once
+    static std::atomic<uint32_t> s_tempCounter = { 0u };
+
+    std::string tempSuffix = str::format(".",
+      std::chrono::steady_clock::now().time_since_epoch().count(), "_",
+      s_tempCounter++, ".tmp");
+
+    for (char c : tempSuffix)
+      tempName.push_back(c);
+
+    std::ofstream file(tempName.c_str(), std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file && env::createDirectory(m_cacheDir))
+      file = std::ofstream(tempName.c_str(), std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file)
+      return;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(writer.data().data(), writer.data().size());
+    file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    file.close();
+
+    std::error_code ec;
+
+    if (file)
+      std::filesystem::rename(std::filesystem::path(tempName), std::filesystem::path(fileName), ec);
+
+    if (!file || ec)
+      std::filesystem::remove(std::filesystem::path(tempName), ec);
+  }
+
+
+  str::path_string DxvkShaderCache::getFileName(
+    const Sha1Hash&                 key) const {
+    // Invalidate entries whenever the DXVK version
+    // or the cache format changes
+    DxvkShaderCacheWriter writer;
+    writer.write(key);
+    writer.write(Version);
+    writer.write(DXVK_VERSION, std::strlen(DXVK_VERSION));
+
+    std::string path = m_cacheDir;
+    path += env::PlatformDirSlash;
+    path += writer.computeHash().toString();
+    path += ".dxvk-shader";
+    return str::topath(path.c_str());
+  }
+
+
+  void DxvkShaderCache::trimCache() {
+    env::setThreadName("dxvk-shader-cache");
+
+    namespace fs = std::filesystem;
+
+    struct FileInfo {
+      fs::path            path;
+      uint64_t            size;
+      fs::file_time_type  time;
+    };
+
+    std::vector<FileInfo> files;
+    uint64_t totalSize = 0;
+
+    std::error_code ec;
+    fs::directory_iterator iter(fs::path(str::topath(m_cacheDir.c_str())), ec);
+
+    if (ec)
+      return;
+
+    auto now = fs::file_time_type::clock::now();
+
+    for (const auto& entry : iter) {
+      FileInfo file;
+      file.path = entry.path();
+      file.size = entry.file_size(ec);
+      file.time = entry.last_write_time(ec);
+
+      if (ec)
+        continue;
+
+      // Remove temporary files left behind by crashed processes
+      if (file.path.extension() == ".tmp") {
+        if (now - file.time > std::chrono::hours(1))
+          fs::remove(file.path, ec);
+        continue;
+      }
+
+      if (file.path.extension() != ".dxvk-shader")
+        continue;
+
+      totalSize += file.size;
+      files.push_back(std::move(file));
+    }
+
+    if (totalSize <= m_maxSize)
+      return;
+
+    // Remove least recently used files until we're
+    // comfortably below the limit again
+    std::sort(files.begin(), files.end(), [] (const FileInfo& a, const FileInfo& b) {
+      return a.time < b.time;
+    });
+
+    uint64_t targetSize = m_maxSize - m_maxSize / 8;
+
+    for (const auto& file : files) {
+      if (totalSize <= targetSize)
+        break;
+
+      if (fs::remove(file.path, ec))
+        totalSize -= file.size;
+    }
+
+    Logger::info(str::format("DXVK: Trimmed shader cache to ", totalSize >> 20, " MiB"));
+  }
+
+
+  std::string DxvkShaderCache::getCacheDir() {
+    std::string path = env::getEnvVar("DXVK_SHADER_CACHE_PATH");
+
+    if (path.empty())
+      path = env::getEnvVar("DXVK_STATE_CACHE_PATH");
+
+    if (path.empty())
+      path = ".";
+
+    if (*path.rbegin() != '/' && *path.rbegin() != env::PlatformDirSlash)
+      path += env::PlatformDirSlash;
+
+    return path + env::getExeBaseName() + ".dxvk-shaders";
+  }
+
+}
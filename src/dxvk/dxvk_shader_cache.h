@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+
+#include "dxvk_shader.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Shader cache data writer
+   *
+   * Simple binary serializer used to build shader cache
+   * keys, as well as frontend-specific shader metadata.
+   * Data is written as-is without any padding.
+   */
+  class DxvkShaderCacheWriter {
+
+  public:
+
+    template<typename T>
+    void write(const T& data) {
+      write(&data, sizeof(data));
+    }
+
+    void write(const void* data, size_t size) {
+      const char* bytes = reinterpret_cast<const char*>(data);
+      m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    const std::vector<char>& data() const {
+      return m_data;
+    }
+
+    Sha1Hash computeHash() const {
+      return Sha1Hash::compute(m_data.data(), m_data.size());
+    }
+
+  private:
+
+    std::vector<char> m_data;
+
+  };
+
+
+  /**
+   * \brief Shader cache data reader
+   *
+   * Counterpart to \ref DxvkShaderCacheWriter. All read
+   * methods return \c false if not enough data is left.
+   */
+  class DxvkShaderCacheReader {
+
+  public:
+
+    DxvkShaderCacheReader(const char* data, size_t size)
+    : m_data(data), m_size(size) { }
+
+    template<typename T>
+    bool read(T& data) {
+      return read(&data, sizeof(data));
+    }
+
+    bool read(void* data, size_t size) {
+      if (m_offset + size > m_size)
+        return false;
+
+      std::memcpy(data, m_data + m_offset, size);
+      m_offset += size;
+      return true;
+    }
+
+  private:
+
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_offset = 0;
+
+  };
+
+
+  /**
+   * \brief Shader translation cache
+   *
+   * Stores translated SPIR-V shaders along with their create
+   * info and frontend-specific metadata on disk, so that the
+   * frontends can skip shader compilation entirely when the
+   * same shader gets created again in a later session.
+   *
+   * Each shader is stored in its own file, which is written
+   * to a temporary file first and then renamed, so that
+   * crashes cannot leave partially written entries behind.
+   * The total size of the cache is limited by removing the
+   * least recently used files when the cache is created.
+   */
+  class DxvkShaderCache {
+    constexpr static uint32_t Version = 2;
+  public:
+
+    DxvkShaderCache(DxvkDevice* device);
+
+    ~DxvkShaderCache();
+
+    /**
+     * \brief Checks whether the cache is enabled
+     * \returns \c true if the cache can be used
+     */
+    bool isEnabled() const {
+      return m_enable;
+    }
+
+    /**
+     * \brief Looks up a shader
+     *
+     * \param [in] key Cache key. Must include the shader
+     *    hash as well as all options that can affect
+     *    the generated code.
+     * \param [out] metadata Frontend-specific metadata
+     * \returns Shader object, or \c nullptr on a miss
+     */
+    Rc<DxvkShader> lookupShader(
+      const Sha1Hash&                 key,
+            std::vector<char>&        metadata);
+
+    /**
+     * \brief Adds a shader to the cache
+     *
+     * \param [in] key Cache key
+     * \param [in] shader The shader to store
+     * \param [in] metadata Frontend-specific metadata
+     */
+    void storeShader(
+      const Sha1Hash&                 key,
+      const Rc<DxvkShader>&           shader,
+      const std::vector<char>&        metadata);
+
+  private:
+
+    struct FileHeader {
+      char     magic[4] = { 'D', 'X', 'S', 'C' };
+      uint32_t version  = Version;
+      Sha1Hash key;
+      uint32_t dataSize = 0;
+    };
+
+    bool          m_enable   = false;
+    uint64_t      m_maxSize  = 0;
+
+    std::string   m_cacheDir;
+
+    dxvk::thread  m_trimThread;
+
+    str::path_string getFileName(
+      const Sha1Hash&                 key) const;
+
+    void trimCache();
+
+    static std::string getCacheDir();
+
+  };
+
+}
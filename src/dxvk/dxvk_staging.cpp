@@ -2,21 +2,49 @@
 #include "dxvk_staging.h"
 
 namespace dxvk {
-  
-  DxvkStagingBuffer::DxvkStagingBuffer(
-    const Rc<DxvkDevice>&     device,
-          VkDeviceSize        size)
-  : m_device(device), m_offset(0), m_size(size) {
+
+  DxvkStagingRing::DxvkStagingRing(
+          DxvkDevice*         device)
+  : m_device(device) {
 
   }
 
 
-  DxvkStagingBuffer::~DxvkStagingBuffer() {
+  DxvkStagingRing::~DxvkStagingRing() {
 
   }
 
 
-  DxvkBufferSlice DxvkStagingBuffer::alloc(VkDeviceSize align, VkDeviceSize size) {
+  Rc<DxvkBuffer> DxvkStagingRing::acquireChunk() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    // Start at the chunk following the one that was handed out
+    // last. Since chunks are typically released in the order in
+    // which they were acquired, this will usually succeed on the
+    // first try once the ring has been fully populated.
+    for (uint32_t i = 0; i < ChunkCount; i++) {
+      uint32_t index = (m_nextChunk + i) % ChunkCount;
+      Rc<DxvkBuffer>& chunk = m_chunks[index];
+
+      if (chunk == nullptr)
+        chunk = createBuffer(ChunkSize);
+      else if (!isChunkIdle(chunk))
+        continue;
+
+      m_nextChunk = (index + 1) % ChunkCount;
+      m_highWater = std::max(m_highWater, ChunkSize * (countUsedChunks() + 1));
+      return chunk;
+    }
+
+    // All chunks are in use, fall back to a temporary
+    // buffer rather than stalling the calling thread.
+    m_overflow += ChunkSize;
+    return createBuffer(ChunkSize);
+  }
+
+
+  Rc<DxvkBuffer> DxvkStagingRing::createBuffer(
+          VkDeviceSize        size) {
     DxvkBufferCreateInfo info;
     info.size   = size;
     info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
@@ -28,22 +56,73 @@ namespace dxvk {
     info.access = VK_ACCESS_TRANSFER_READ_BIT
                 | VK_ACCESS_SHADER_READ_BIT;
 
+    return m_device->createBuffer(info,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+
+
+  DxvkStagingRingStats DxvkStagingRing::getStats() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    uint32_t chunkCount = 0;
+
+    for (const auto& chunk : m_chunks)
+      chunkCount += chunk != nullptr ? 1 : 0;
+
+    DxvkStagingRingStats result;
+    result.capacity  = ChunkSize * ChunkCount;
+    result.allocated = ChunkSize * chunkCount;
+    result.used      = ChunkSize * countUsedChunks();
+    result.highWater = m_highWater;
+    result.overflow  = m_overflow;
+    return result;
+  }
+
+
+  uint32_t DxvkStagingRing::countUsedChunks() const {
+    uint32_t count = 0;
+
+    for (const auto& chunk : m_chunks)
+      count += chunk != nullptr && !isChunkIdle(chunk) ? 1 : 0;
+
+    return count;
+  }
+
+
+  bool DxvkStagingRing::isChunkIdle(
+    const Rc<DxvkBuffer>&     chunk) {
+    // The ring holds the only remaining reference, so no other
+    // thread can acquire a new one while we hold the lock
+    return chunk->getRefCount() == 1;
+  }
+
+
+  DxvkStagingBuffer::DxvkStagingBuffer(
+    const Rc<DxvkDevice>&     device)
+  : m_device(device), m_offset(0) {
+
+  }
+
+
+  DxvkStagingBuffer::~DxvkStagingBuffer() {
+
+  }
+
+
+  DxvkBufferSlice DxvkStagingBuffer::alloc(VkDeviceSize align, VkDeviceSize size) {
+    DxvkStagingRing& ring = m_device->stagingRing();
+
     VkDeviceSize alignedSize = dxvk::align(size, align);
     VkDeviceSize alignedOffset = dxvk::align(m_offset, align);
 
-    if (2 * alignedSize > m_size) {
-      return DxvkBufferSlice(m_device->createBuffer(info,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-    }
+    if (2 * alignedSize > DxvkStagingRing::ChunkSize)
+      return DxvkBufferSlice(ring.createBuffer(size));
 
-    if (alignedOffset + alignedSize > m_size || m_buffer == nullptr) {
-      info.size = m_size;
-
-      // Free resources first if possible, in some rare
-      // situations this may help avoid a memory allocation.
+    if (alignedOffset + alignedSize > DxvkStagingRing::ChunkSize || m_buffer == nullptr) {
+      // Drop our reference first so that the chunk
+      // can be recycled once the GPU is done with it.
       m_buffer = nullptr;
-      m_buffer = m_device->createBuffer(info,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+      m_buffer = ring.acquireChunk();
       alignedOffset = 0;
     }
 
@@ -57,5 +136,5 @@ namespace dxvk {
     m_buffer = nullptr;
     m_offset = 0;
   }
-  
+
 }
@@ -1,18 +1,104 @@
 #pragma once
 
+#include <array>
 #include <queue>
 
 #include "dxvk_buffer.h"
 
 namespace dxvk {
-  
+
   class DxvkDevice;
 
+  /**
+   * \brief Staging ring statistics
+   */
+  struct DxvkStagingRingStats {
+    VkDeviceSize capacity;      ///< Maximum amount of memory owned by the ring
+    VkDeviceSize allocated;     ///< Amount of memory currently owned by the ring
+    VkDeviceSize used;          ///< Amount of ring memory currently in use
+    VkDeviceSize highWater;     ///< Peak amount of ring memory in use
+    VkDeviceSize overflow;      ///< Total memory allocated outside the ring
+  };
+
+
+  /**
+   * \brief Staging ring
+   *
+   * Device-wide pool of fixed-size, persistently mapped upload
+   * buffers that are handed out in ring order. A chunk only gets
+   * reused once it is no longer referenced by anything other than
+   * the ring itself, which means that no pending CS chunk and no
+   * in-flight command list can access it anymore. If every chunk
+   * is busy, a temporary buffer is created instead.
+   */
+  class DxvkStagingRing {
+
+  public:
+
+    constexpr static VkDeviceSize ChunkSize  = 4ull << 20;
+    constexpr static uint32_t     ChunkCount = env::is32BitHostPlatform() ? 8u : 32u;
+
+    DxvkStagingRing(
+            DxvkDevice*         device);
+
+    ~DxvkStagingRing();
+
+    /**
+     * \brief Acquires an unused chunk
+     *
+     * The returned buffer has a size of \c ChunkSize and
+     * may be suballocated freely by the caller. It will
+     * not be returned again before all references to it,
+     * including the one returned here, have been dropped.
+     * \returns Staging buffer
+     */
+    Rc<DxvkBuffer> acquireChunk();
+
+    /**
+     * \brief Creates a dedicated staging buffer
+     *
+     * Used for allocations that are too large to be
+     * served from a ring chunk, and when the ring is
+     * exhausted.
+     * \param [in] size Buffer size
+     * \returns Staging buffer
+     */
+    Rc<DxvkBuffer> createBuffer(
+            VkDeviceSize        size);
+
+    /**
+     * \brief Queries ring statistics
+     * \returns Current ring statistics
+     */
+    DxvkStagingRingStats getStats();
+
+  private:
+
+    DxvkDevice*   m_device;
+
+    dxvk::mutex   m_mutex;
+
+    std::array<Rc<DxvkBuffer>, ChunkCount> m_chunks;
+    uint32_t      m_nextChunk = 0;
+
+    VkDeviceSize  m_highWater = 0;
+    VkDeviceSize  m_overflow  = 0;
+
+    uint32_t countUsedChunks() const;
+
+    static bool isChunkIdle(
+      const Rc<DxvkBuffer>&     chunk);
+
+  };
+
+
   /**
    * \brief Staging buffer
    *
    * Provides a simple linear staging buffer
-   * allocator for data uploads.
+   * allocator for data uploads. Memory is
+   * suballocated from chunks of the device's
+   * staging ring.
    */
   class DxvkStagingBuffer {
 
@@ -22,11 +108,9 @@ namespace dxvk {
      * \brief Creates staging buffer
      *
      * \param [in] device DXVK device
-     * \param [in] size Buffer size
      */
     DxvkStagingBuffer(
-      const Rc<DxvkDevice>&     device,
-            VkDeviceSize        size);
+      const Rc<DxvkDevice>&     device);
 
     /**
      * \brief Frees staging buffer
@@ -36,8 +120,8 @@ namespace dxvk {
     /**
      * \brief Allocates staging buffer memory
      *
-     * Tries to suballocate from existing buffer,
-     * or creates a new buffer if necessary.
+     * Tries to suballocate from the current chunk,
+     * or acquires a new chunk if necessary.
      * \param [in] align Minimum alignment
      * \param [in] size Number of bytes to allocate
      * \returns Allocated slice
@@ -54,7 +138,6 @@ namespace dxvk {
     Rc<DxvkDevice>  m_device;
     Rc<DxvkBuffer>  m_buffer;
     VkDeviceSize    m_offset;
-    VkDeviceSize    m_size;
 
   };
 
@@ -1,3 +1,5 @@
+#include <filesystem>
+
 #include "dxvk_device.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_state_cache.h"
@@ -181,12 +183,11 @@ namespace dxvk {
       return true;
     }
 
-    bool readFromStream(std::istream& stream, size_t size) {
+    bool readFromMemory(const char* data, size_t size) {
       if (size > MaxSize)
         return false;
 
-      if (!stream.read(m_data, size))
-        return false;
+      std::memcpy(m_data, data, size);
 
       m_size = size;
       m_read = 0;
@@ -271,14 +272,8 @@ namespace dxvk {
 
     bool newFile = (useStateCache == "reset") || (!readCacheFile());
 
-    if (newFile) {
-      auto file = openCacheFileForWrite(true);
-
-      // Write all valid entries to the cache file in
-      // case we're recovering a corrupted cache file
-      for (auto& e : m_entries)
-        writeCacheEntry(file, e);
-    }
+    if (newFile)
+      openCacheFileForWrite(true);
   }
   
 
@@ -292,17 +287,17 @@ namespace dxvk {
     if (!m_enable || shaders.vs.eq(g_nullShaderKey))
       return;
 
+    std::unique_lock<dxvk::mutex> lock(m_writerLock);
+
     // Do not add an entry that is already in the cache
-    auto entries = m_entryMap.equal_range(shaders);
+    auto& known = getKnownEntries(shaders);
 
-    for (auto e = entries.first; e != entries.second; e++) {
-      if (m_entries[e->second].type == DxvkStateCacheEntryType::PipelineLibrary)
-        return;
-    }
+    if (known.hasLibrary)
+      return;
 
-    // Queue a job to write this pipeline to the cache
-    std::unique_lock<dxvk::mutex> lock(m_writerLock);
+    known.hasLibrary = true;
 
+    // Queue a job to write this pipeline to the cache
     m_writerQueue.push({
       DxvkStateCacheEntryType::PipelineLibrary, shaders,
       DxvkGraphicsPipelineStateInfo(), g_nullHash });
@@ -318,18 +313,19 @@ namespace dxvk {
     if (!m_enable || shaders.vs.eq(g_nullShaderKey))
       return;
 
+    std::unique_lock<dxvk::mutex> lock(m_writerLock);
+
     // Do not add an entry that is already in the cache
-    auto entries = m_entryMap.equal_range(shaders);
+    auto& known = getKnownEntries(shaders);
 
-    for (auto e = entries.first; e != entries.second; e++) {
-      if (m_entries[e->second].type == DxvkStateCacheEntryType::MonolithicPipeline
-       && m_entries[e->second].gpState == state)
+    for (const auto& s : known.states) {
+      if (s == state)
         return;
     }
 
-    // Queue a job to write this pipeline to the cache
-    std::unique_lock<dxvk::mutex> lock(m_writerLock);
+    known.states.push_back(state);
 
+    // Queue a job to write this pipeline to the cache
     m_writerQueue.push({
       DxvkStateCacheEntryType::MonolithicPipeline,
       shaders, state, g_nullHash });
@@ -359,14 +355,20 @@ namespace dxvk {
 
     for (auto p = pipelines.first; p != pipelines.second; p++) {
       WorkerItem item;
-
-      if (!getShaderByKey(p->second.vs,  item.gp.vs)
-       || !getShaderByKey(p->second.tcs, item.gp.tcs)
-       || !getShaderByKey(p->second.tes, item.gp.tes)
-       || !getShaderByKey(p->second.gs,  item.gp.gs)
-       || !getShaderByKey(p->second.fs,  item.gp.fs))
+      item.useCount = m_index[p->second.entryId].useCount;
+      item.entryId = p->second.entryId;
+
+      if (!getShaderByKey(p->second.key.vs,  item.gp.vs)
+       || !getShaderByKey(p->second.key.tcs, item.gp.tcs)
+       || !getShaderByKey(p->second.key.tes, item.gp.tes)
+       || !getShaderByKey(p->second.key.gs,  item.gp.gs)
+       || !getShaderByKey(p->second.key.fs,  item.gp.fs))
         continue;
       
+      // All shaders of the set were created in this run,
+      // so count it as used when updating the cache file
+      m_indexUsed[item.entryId] = 1;
+
       if (!workerLock)
         workerLock = std::unique_lock<dxvk::mutex>(m_workerLock);
       
@@ -391,11 +393,13 @@ namespace dxvk {
       m_writerCond.notify_all();
     }
 
-    if (m_workerThread.joinable())
-      m_workerThread.join();
+    for (auto& worker : m_workerThreads)
+      worker.join();
     
     if (m_writerThread.joinable())
       m_writerThread.join();
+
+    writeUseCounts();
   }
 
 
@@ -425,12 +429,76 @@ namespace dxvk {
     m_entryMap.insert({ key, entryId });
   }
 
+
+  bool DxvkStateCache::getCachedEntries(
+    const DxvkStateCacheKey&        key,
+          std::vector<DxvkStateCacheEntry>& entries) const {
+    auto e = m_entryMap.find(key);
+
+    if (e == m_entryMap.end())
+      return false;
+
+    // Entries are validated and decoded on demand. Entry
+    // data always uses the current format at this point.
+    const DxvkStateCacheIndexEntry& index = m_index[e->second];
+    const char* data = m_entryData + index.dataOffset;
+
+    uint32_t version = DxvkStateCacheHeader().version;
+    entries.reserve(index.entryCount);
+
+    size_t offset = 0;
+
+    while (offset < index.dataSize) {
+      size_t size = getCacheEntrySize(version,
+        data + offset, index.dataSize - offset);
+
+      if (!size)
+        break;
+
+      DxvkStateCacheEntry entry;
+
+      if (readCacheEntry(version, data + offset, size, entry))
+        entries.push_back(entry);
+
+      offset += size;
+    }
+
+    return true;
+  }
+
+
+
+  DxvkStateCache::KnownEntries& DxvkStateCache::getKnownEntries(
+    const DxvkStateCacheKey&        key) {
+    auto entry = m_knownEntries.insert({ key, KnownEntries() });
+
+    if (!entry.second)
+      return entry.first->second;
+
+    // Decode the group stored in the file once, so that
+    // subsequent lookups do not have to validate it again
+    std::vector<DxvkStateCacheEntry> entries;
+    auto& known = entry.first->second;
+
+    if (getCachedEntries(key, entries)) {
+      for (const auto& e : entries) {
+        if (e.type == DxvkStateCacheEntryType::PipelineLibrary)
+          known.hasLibrary = true;
+        else
+          known.states.push_back(e.gpState);
+      }
+    }
+
+    return known;
+  }
+
   
   void DxvkStateCache::mapShaderToPipeline(
     const DxvkShaderKey&            shader,
-    const DxvkStateCacheKey&        key) {
+    const DxvkStateCacheKey&        key,
+          size_t                    entryId) {
     if (!shader.eq(g_nullShaderKey))
-      m_pipelineMap.insert({ shader, key });
+      m_pipelineMap.insert({ shader, { key, entryId } });
   }
 
 
@@ -443,11 +511,12 @@ namespace dxvk {
     key.fs  = getShaderKey(item.gp.fs);
 
     DxvkGraphicsPipeline* pipeline = nullptr;
-    auto entries = m_entryMap.equal_range(key);
+    std::vector<DxvkStateCacheEntry> entries;
 
-    for (auto e = entries.first; e != entries.second; e++) {
-      const auto& entry = m_entries[e->second];
+    if (!getCachedEntries(key, entries))
+      return;
 
+    for (const auto& entry : entries) {
       switch (entry.type) {
         case DxvkStateCacheEntryType::MonolithicPipeline: {
           if (!pipeline)
@@ -478,19 +547,22 @@ namespace dxvk {
   bool DxvkStateCache::readCacheFile() {
     // Return success if the file was not found.
     // This way we will only create it on demand.
-    std::ifstream ifile = openCacheFileForRead();
-
-    if (!ifile) {
+    if (!openCacheFileForRead()) {
       Logger::warn("DXVK: No state cache file found");
       return true;
     }
 
+    MappedFile file(getCacheFileName());
+
+    const char* data = file.data();
+    size_t size = file.size();
+
     // The header stores the state cache version,
     // we need to regenerate it if it's outdated
     DxvkStateCacheHeader newHeader;
     DxvkStateCacheHeader curHeader;
 
-    if (!readCacheHeader(ifile, curHeader)) {
+    if (!readCacheHeader(data, size, curHeader)) {
       Logger::warn("DXVK: Failed to read state cache header");
       return false;
     }
@@ -502,60 +574,345 @@ namespace dxvk {
       return false;
     }
 
+    data += sizeof(curHeader);
+    size -= sizeof(curHeader);
+
+    // Older versions store all entries as a flat list
+    std::vector<DxvkStateCacheIndexEntry> index;
+    size_t dataOffset = 0;
+    size_t logOffset = 0;
+
+    if (curHeader.version >= 18) {
+      if (!readCacheIndex(data, size, index, dataOffset, logOffset)) {
+        Logger::warn("DXVK: Failed to read state cache index");
+        return false;
+      }
+    }
+
+    // If the file is up to date and no entries were appended since
+    // it was last compacted, we can use the mapped file as-is and
+    // only decode entries once all their shaders get registered.
+    if (curHeader.version == newHeader.version && logOffset == size) {
+      const char* entryData = data + dataOffset;
+
+      m_fileMapping = std::move(file);
+      createIndex(std::move(index), entryData);
+
+      Logger::info(str::format("DXVK: Read state cache index with ",
+        m_index.size(), " pipelines"));
+      return true;
+    }
+
     // Notify user about format conversion
     if (curHeader.version != newHeader.version)
       Logger::warn(str::format("DXVK: Updating state cache version to v", newHeader.version));
 
-    // Read actual cache entries from the file.
-    // If we encounter invalid entries, we should
-    // regenerate the entire state cache file.
-    uint32_t numInvalidEntries = 0;
+    // Find entry boundaries. This only needs to look
+    // at entry headers and is therefore very fast.
+    std::vector<std::pair<size_t, size_t>> entryRanges;
 
-    while (ifile) {
-      DxvkStateCacheEntry entry;
+    auto findEntries = [&] (size_t offset, size_t end) {
+      while (offset < end) {
+        size_t entrySize = getCacheEntrySize(curHeader.version,
+          &data[offset], end - offset);
+
+        // Ignore truncated entries
+        if (!entrySize)
+          break;
+
+        entryRanges.push_back({ offset, entrySize });
+        offset += entrySize;
+      }
+    };
+
+    for (const auto& e : index)
+      findEntries(dataOffset + e.dataOffset, dataOffset + e.dataOffset + e.dataSize);
+
+    findEntries(logOffset, size);
+
+    // Decode all entries and rewrite the file. Invalid entries
+    // are dropped in the process, so there is no need to
+    // recreate the file in that case.
+    std::vector<DxvkStateCacheEntry> entries;
+    std::vector<uint8_t> entriesValid;
+
+    readCacheEntries(curHeader.version, data,
+      entryRanges, entries, entriesValid);
+
+    file = MappedFile();
+
+    compactCacheFile(index, entries, entriesValid);
+    return true;
+  }
+
+
+  bool DxvkStateCache::readCacheIndex(
+    const char*                     data,
+          size_t                    size,
+          std::vector<DxvkStateCacheIndexEntry>& index,
+          size_t&                   dataOffset,
+          size_t&                   logOffset) const {
+    DxvkStateCacheIndexHeader header;
+
+    if (size < sizeof(header))
+      return false;
+
+    std::memcpy(&header, data, sizeof(header));
+
+    uint64_t indexSize = uint64_t(header.indexCount) * sizeof(DxvkStateCacheIndexEntry);
+
+    if (sizeof(header) + indexSize + header.dataSize > size)
+      return false;
+
+    if (Sha1Hash::compute(data + sizeof(header), indexSize) != header.indexHash)
+      return false;
 
-      if (readCacheEntry(curHeader.version, ifile, entry)) {
-        size_t entryId = m_entries.size();
-        m_entries.push_back(entry);
+    index.resize(header.indexCount);
+
+    if (indexSize)
+      std::memcpy(index.data(), data + sizeof(header), indexSize);
+
+    for (const auto& e : index) {
+      if (uint64_t(e.dataOffset) + e.dataSize > header.dataSize)
+        return false;
+    }
+
+    dataOffset = sizeof(header) + indexSize;
+    logOffset = dataOffset + header.dataSize;
+    return true;
+  }
 
-        mapPipelineToEntry(entry.shaders, entryId);
 
-        mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
-        mapShaderToPipeline(entry.shaders.tes, entry.shaders);
-        mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
-      } else if (ifile) {
+  void DxvkStateCache::compactCacheFile(
+    const std::vector<DxvkStateCacheIndexEntry>& oldIndex,
+    const std::vector<DxvkStateCacheEntry>& entries,
+    const std::vector<uint8_t>&     valid) {
+    // Group entries by the set of shaders they use. Since entries
+    // are appended to the file when they are first used, groups
+    // are sorted by first use, which is used as a priority when
+    // compiling pipelines with the same use count. Duplicate
+    // entries are dropped.
+    std::vector<DxvkStateCacheIndexEntry> index;
+    std::vector<std::vector<size_t>> indexEntries;
+
+    std::unordered_map<DxvkStateCacheKey,
+      size_t, DxvkHash, DxvkEq> indexMap;
+
+    // Preserve use counts of groups that were already indexed.
+    // Groups that only exist in the log were used at least in
+    // the run that added them.
+    std::unordered_map<DxvkStateCacheKey,
+      uint32_t, DxvkHash, DxvkEq> useCounts;
+
+    for (const auto& e : oldIndex)
+      useCounts.insert({ e.shaders, e.useCount });
+
+    uint32_t numValidEntries = 0;
+    uint32_t numInvalidEntries = 0;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (!valid[i]) {
         numInvalidEntries += 1;
+        continue;
       }
+
+      const auto& entry = entries[i];
+      auto group = indexMap.insert({ entry.shaders, index.size() });
+
+      if (group.second) {
+        auto useCount = useCounts.find(entry.shaders);
+
+        index.push_back({ entry.shaders, 0u, 0u, 0u,
+          useCount != useCounts.end() ? useCount->second : 1u });
+        indexEntries.emplace_back();
+      }
+
+      auto& list = indexEntries[group.first->second];
+      bool isDuplicate = false;
+
+      for (size_t j : list) {
+        isDuplicate |= entries[j].type == entry.type
+          && (entry.type == DxvkStateCacheEntryType::PipelineLibrary
+           || entries[j].gpState == entry.gpState);
+      }
+
+      if (!isDuplicate) {
+        list.push_back(i);
+        numValidEntries += 1;
+      }
+    }
+
+    std::ostringstream stream(std::ios_base::out | std::ios_base::binary);
+
+    for (size_t i = 0; i < index.size(); i++) {
+      index[i].dataOffset = uint32_t(stream.tellp());
+      index[i].entryCount = uint32_t(indexEntries[i].size());
+
+      for (size_t j : indexEntries[i])
+        writeCacheEntry(stream, entries[j]);
+
+      index[i].dataSize = uint32_t(stream.tellp()) - index[i].dataOffset;
     }
 
+    std::string entryData = stream.str();
+
+    // Assemble the file in memory. This also serves as
+    // the backing storage for entries in this session.
+    DxvkStateCacheHeader header;
+    DxvkStateCacheIndexHeader indexHeader;
+
+    size_t indexSize = index.size() * sizeof(DxvkStateCacheIndexEntry);
+
+    indexHeader.indexCount = uint32_t(index.size());
+    indexHeader.dataSize = uint32_t(entryData.size());
+    indexHeader.indexHash = Sha1Hash::compute(index.data(), indexSize);
+
+    size_t indexOffset = sizeof(header) + sizeof(indexHeader);
+    size_t dataOffset = indexOffset + indexSize;
+
+    m_fileData.resize(dataOffset + entryData.size());
+
+    char* fileData = m_fileData.data();
+    std::memcpy(fileData, &header, sizeof(header));
+    std::memcpy(fileData + sizeof(header), &indexHeader, sizeof(indexHeader));
+
+    if (indexSize)
+      std::memcpy(fileData + indexOffset, index.data(), indexSize);
+
+    if (!entryData.empty())
+      std::memcpy(fileData + dataOffset, entryData.data(), entryData.size());
+
+    createIndex(std::move(index), fileData + dataOffset);
+
     Logger::info(str::format(
-      "DXVK: Read ", m_entries.size(),
+      "DXVK: Read ", numValidEntries,
       " valid state cache entries"));
 
     if (numInvalidEntries) {
       Logger::warn(str::format(
         "DXVK: Skipped ", numInvalidEntries,
         " invalid state cache entries"));
+    }
+
+    // Writing the file may take a while, so leave it to the
+    // writer thread, which needs to do this before appending
+    // any new entries anyway.
+    m_compactPending = true;
+    createWriter();
+  }
+
+
+  bool DxvkStateCache::writeCompactedFile() const {
+    // Write to a temporary file and only rename it over the cache
+    // file once complete, so that the existing cache file remains
+    // intact if the process gets terminated in the meantime.
+    str::path_string fileName = getCacheFileName();
+    str::path_string tempName = fileName;
+
+    for (char c : std::string(".tmp"))
+      tempName.push_back(c);
+
+    std::ofstream file(tempName.c_str(),
+      std::ios_base::binary | std::ios_base::trunc);
+
+    if (file)
+      file.write(m_fileData.data(), m_fileData.size());
+
+    file.close();
+
+    std::error_code ec;
+
+    if (file)
+      std::filesystem::rename(std::filesystem::path(tempName), std::filesystem::path(fileName), ec);
+
+    if (!file || ec) {
+      std::filesystem::remove(std::filesystem::path(tempName), ec);
+      Logger::warn("DXVK: Failed to write compacted state cache");
       return false;
     }
-    
-    // Rewrite entire state cache if it is outdated
-    return curHeader.version == newHeader.version;
+
+    return true;
+  }
+
+
+  void DxvkStateCache::writeUseCounts() {
+    std::lock_guard<dxvk::mutex> entryLock(m_entryLock);
+
+    // Only touch the file if any indexed pipelines were used
+    bool used = false;
+
+    for (uint8_t u : m_indexUsed)
+      used |= u != 0;
+
+    if (!used)
+      return;
+
+    // The index has a fixed size and is located right after the
+    // file header, so it can be updated in place. Check that the
+    // index on disk is still the one read at startup, since the
+    // file may have been replaced or failed to compact.
+    std::fstream file(getCacheFileName().c_str(),
+      std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+
+    DxvkStateCacheHeader header;
+    DxvkStateCacheIndexHeader indexHeader;
+
+    size_t indexSize = m_index.size() * sizeof(DxvkStateCacheIndexEntry);
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+     || !file.read(reinterpret_cast<char*>(&indexHeader), sizeof(indexHeader))
+     || header.version != DxvkStateCacheHeader().version
+     || indexHeader.indexCount != m_index.size()
+     || indexHeader.indexHash != Sha1Hash::compute(m_index.data(), indexSize))
+      return;
+
+    for (size_t i = 0; i < m_index.size(); i++) {
+      if (m_indexUsed[i] && m_index[i].useCount < ~0u)
+        m_index[i].useCount += 1;
+    }
+
+    indexHeader.indexHash = Sha1Hash::compute(m_index.data(), indexSize);
+
+    file.seekp(sizeof(header));
+    file.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+    file.write(reinterpret_cast<const char*>(m_index.data()), indexSize);
+
+    if (!file)
+      Logger::warn("DXVK: Failed to update state cache use counts");
+  }
+
+
+  void DxvkStateCache::createIndex(
+          std::vector<DxvkStateCacheIndexEntry>&& index,
+    const char*                     entryData) {
+    m_index = std::move(index);
+    m_indexUsed.resize(m_index.size());
+    m_entryData = entryData;
+
+    for (size_t i = 0; i < m_index.size(); i++) {
+      const auto& shaders = m_index[i].shaders;
+
+      mapPipelineToEntry(shaders, i);
+
+      mapShaderToPipeline(shaders.vs,  shaders, i);
+      mapShaderToPipeline(shaders.tcs, shaders, i);
+      mapShaderToPipeline(shaders.tes, shaders, i);
+      mapShaderToPipeline(shaders.gs,  shaders, i);
+      mapShaderToPipeline(shaders.fs,  shaders, i);
+    }
   }
 
 
   bool DxvkStateCache::readCacheHeader(
-          std::istream&             stream,
+    const char*                     data,
+          size_t                    size,
           DxvkStateCacheHeader&     header) const {
     DxvkStateCacheHeader expected;
 
-    auto data = reinterpret_cast<char*>(&header);
-    auto size = sizeof(header);
-
-    if (!stream.read(data, size))
+    if (!data || size < sizeof(header))
       return false;
+
+    std::memcpy(&header, data, sizeof(header));
     
     for (uint32_t i = 0; i < 4; i++) {
       if (expected.magic[i] != header.magic[i])
@@ -566,26 +923,49 @@ namespace dxvk {
   }
 
 
+  size_t DxvkStateCache::getCacheEntrySize(
+          uint32_t                  version,
+    const char*                     data,
+          size_t                    size) const {
+    // Both header versions have the same size
+    static_assert(sizeof(DxvkStateCacheEntryHeader) == sizeof(DxvkStateCacheEntryHeaderV8));
+
+    size_t result = sizeof(DxvkStateCacheEntryHeader) + sizeof(Sha1Hash);
+
+    if (size < result)
+      return 0;
+
+    if (version >= 16) {
+      DxvkStateCacheEntryHeader header;
+      std::memcpy(&header, data, sizeof(header));
+      result += header.entrySize;
+    } else {
+      DxvkStateCacheEntryHeaderV8 header;
+      std::memcpy(&header, data, sizeof(header));
+      result += header.entrySize;
+    }
+
+    return result <= size ? result : 0;
+  }
+
+
   bool DxvkStateCache::readCacheEntry(
           uint32_t                  version,
-          std::istream&             stream, 
+    const char*                     raw,
+          size_t                    size,
           DxvkStateCacheEntry&      entry) const {
     // Read entry metadata and actual data
     DxvkStateCacheEntryHeader header;
-    DxvkStateCacheEntryData data;
     VkShaderStageFlags stageMask;
     Sha1Hash hash;
 
     if (version >= 16) {
-      if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
-        return false;
+      std::memcpy(&header, raw, sizeof(header));
 
       stageMask = VkShaderStageFlags(header.stageMask);
     } else {
       DxvkStateCacheEntryHeaderV8 headerV8;
-
-      if (!stream.read(reinterpret_cast<char*>(&headerV8), sizeof(headerV8)))
-        return false;
+      std::memcpy(&headerV8, raw, sizeof(headerV8));
 
       header.entryType = uint32_t(DxvkStateCacheEntryType::MonolithicPipeline);
       header.stageMask = headerV8.stageMask & VK_SHADER_STAGE_ALL_GRAPHICS;
@@ -594,8 +974,16 @@ namespace dxvk {
       stageMask = VkShaderStageFlags(headerV8.stageMask);
     }
 
-    if (!stream.read(reinterpret_cast<char*>(&hash), sizeof(hash))
-     || !data.readFromStream(stream, header.entrySize))
+    std::memcpy(&hash, raw + sizeof(header), sizeof(hash));
+
+    size_t dataOffset = sizeof(header) + sizeof(hash);
+
+    if (dataOffset + header.entrySize > size)
+      return false;
+
+    DxvkStateCacheEntryData data;
+
+    if (!data.readFromMemory(raw + dataOffset, header.entrySize))
       return false;
 
     // Validate hash, skip entry if invalid
@@ -688,9 +1076,58 @@ namespace dxvk {
   }
 
 
+  void DxvkStateCache::readCacheEntries(
+          uint32_t                  version,
+    const char*                     data,
+    const std::vector<std::pair<size_t, size_t>>& ranges,
+          std::vector<DxvkStateCacheEntry>& entries,
+          std::vector<uint8_t>&     valid) const {
+    constexpr size_t ChunkSize = 256;
+
+    entries.resize(ranges.size());
+    valid.resize(ranges.size());
+
+    size_t chunkCount = (ranges.size() + ChunkSize - 1) / ChunkSize;
+    std::atomic<size_t> nextChunk = { 0u };
+
+    auto decodeChunks = [&] () {
+      size_t chunk;
+
+      while ((chunk = nextChunk++) < chunkCount) {
+        size_t first = chunk * ChunkSize;
+        size_t last = std::min(first + ChunkSize, ranges.size());
+
+        for (size_t i = first; i < last; i++) {
+          valid[i] = readCacheEntry(version,
+            &data[ranges[i].first], ranges[i].second, entries[i]);
+        }
+      }
+    };
+
+    // Hashing and decoding entries is the expensive part of
+    // reading the cache, so distribute it across threads.
+    uint32_t threadCount = dxvk::thread::hardware_concurrency();
+
+    if (env::is32BitHostPlatform())
+      threadCount = std::min(threadCount, 4u);
+
+    threadCount = uint32_t(std::min<size_t>(threadCount, chunkCount));
+
+    std::vector<dxvk::thread> threads;
+
+    for (uint32_t i = 1; i < threadCount; i++)
+      threads.push_back(dxvk::thread([&decodeChunks] () { decodeChunks(); }));
+
+    decodeChunks();
+
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+
   void DxvkStateCache::writeCacheEntry(
           std::ostream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
+    const DxvkStateCacheEntry&      entry) const {
     DxvkStateCacheEntryData data;
     VkShaderStageFlags stageMask = 0;
 
@@ -783,7 +1220,7 @@ namespace dxvk {
         if (m_workerQueue.empty())
           break;
         
-        item = m_workerQueue.front();
+        item = m_workerQueue.top();
         m_workerQueue.pop();
       }
 
@@ -797,6 +1234,10 @@ namespace dxvk {
 
     std::ofstream file;
 
+    // If the compacted file could not be written, the file on
+    // disk may still use an older format, so do not append to it
+    bool writable = !m_compactPending || writeCompactedFile();
+
     while (!m_stopThreads.load()) {
       DxvkStateCacheEntry entry;
 
@@ -814,6 +1255,9 @@ namespace dxvk {
         m_writerQueue.pop();
       }
 
+      if (!writable)
+        continue;
+
       if (!file.is_open())
         file = openCacheFileForWrite(false);
 
@@ -823,8 +1267,15 @@ namespace dxvk {
 
 
   void DxvkStateCache::createWorker() {
-    if (!m_workerThread.joinable())
-      m_workerThread = dxvk::thread([this] () { workerFunc(); });
+    if (m_workerThreads.empty()) {
+      // Workers mostly create pipeline objects and hand them
+      // off to the pipeline compiler, so a few are enough
+      uint32_t workerCount = dxvk::thread::hardware_concurrency() / 4;
+      workerCount = std::clamp(workerCount, 1u, 4u);
+
+      for (uint32_t i = 0; i < workerCount; i++)
+        m_workerThreads.push_back(dxvk::thread([this] () { workerFunc(); }));
+    }
   }
 
 
@@ -882,13 +1333,15 @@ namespace dxvk {
     if (recreate) {
       Logger::warn("DXVK: Creating new state cache file");
 
-      // Write header with the current version number
+      // Write header with the current version number,
+      // followed by an empty index. Entries will be
+      // appended and indexed on the next run.
       DxvkStateCacheHeader header;
+      DxvkStateCacheIndexHeader indexHeader;
+      indexHeader.indexHash = g_nullHash;
 
-      auto data = reinterpret_cast<const char*>(&header);
-      auto size = sizeof(header);
-
-      file.write(data, size);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
     }
 
     return file;
@@ -5,9 +5,12 @@
 #include <fstream>
 #include <mutex>
 #include <queue>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 
+#include "../util/util_mapped_file.h"
+
 #include "dxvk_state_cache_types.h"
 
 namespace dxvk {
@@ -24,6 +27,12 @@ namespace dxvk {
    * game, which allows DXVK to compile them ahead
    * of time instead of compiling them on the first
    * draw.
+   *
+   * Entries are stored in the cache file grouped by the
+   * set of shaders they use, and are only decoded once
+   * all shaders of a group have been registered. New
+   * entries are appended to the file, and the file is
+   * compacted the next time it gets loaded.
    */
   class DxvkStateCache {
 
@@ -80,6 +89,27 @@ namespace dxvk {
 
     struct WorkerItem {
       DxvkGraphicsPipelineShaders gp;
+      uint32_t                    useCount;
+      size_t                      entryId;
+    };
+
+    struct WorkerItemCompare {
+      bool operator () (const WorkerItem& a, const WorkerItem& b) const {
+        if (a.useCount != b.useCount)
+          return a.useCount < b.useCount;
+
+        return a.entryId > b.entryId;
+      }
+    };
+
+    struct PipelineItem {
+      DxvkStateCacheKey           key;
+      size_t                      entryId;
+    };
+
+    struct KnownEntries {
+      bool                        hasLibrary = false;
+      std::vector<DxvkGraphicsPipelineStateInfo> states;
     };
 
     DxvkDevice*                       m_device;
@@ -87,17 +117,24 @@ namespace dxvk {
     DxvkPipelineWorkers*              m_pipeWorkers;
     bool                              m_enable = false;
 
-    std::vector<DxvkStateCacheEntry>  m_entries;
+    MappedFile                        m_fileMapping;
+    std::vector<char>                 m_fileData;
+
+    const char*                       m_entryData = nullptr;
+    std::vector<DxvkStateCacheIndexEntry> m_index;
+    std::vector<uint8_t>              m_indexUsed;
+    bool                              m_compactPending = false;
+
     std::atomic<bool>                 m_stopThreads = { false };
 
     dxvk::mutex                       m_entryLock;
 
-    std::unordered_multimap<
+    std::unordered_map<
       DxvkStateCacheKey, size_t,
       DxvkHash, DxvkEq> m_entryMap;
 
     std::unordered_multimap<
-      DxvkShaderKey, DxvkStateCacheKey,
+      DxvkShaderKey, PipelineItem,
       DxvkHash, DxvkEq> m_pipelineMap;
     
     std::unordered_map<
@@ -106,14 +143,20 @@ namespace dxvk {
 
     dxvk::mutex                       m_workerLock;
     dxvk::condition_variable          m_workerCond;
-    std::queue<WorkerItem>            m_workerQueue;
-    dxvk::thread                      m_workerThread;
+    std::priority_queue<WorkerItem,
+      std::vector<WorkerItem>,
+      WorkerItemCompare>              m_workerQueue;
+    std::vector<dxvk::thread>         m_workerThreads;
 
     dxvk::mutex                       m_writerLock;
     dxvk::condition_variable          m_writerCond;
     std::queue<WriterItem>            m_writerQueue;
     dxvk::thread                      m_writerThread;
 
+    std::unordered_map<
+      DxvkStateCacheKey, KnownEntries,
+      DxvkHash, DxvkEq> m_knownEntries;
+
     DxvkShaderKey getShaderKey(
       const Rc<DxvkShader>&           shader) const;
 
@@ -124,28 +167,70 @@ namespace dxvk {
     void mapPipelineToEntry(
       const DxvkStateCacheKey&        key,
             size_t                    entryId);
+
+    bool getCachedEntries(
+      const DxvkStateCacheKey&        key,
+            std::vector<DxvkStateCacheEntry>& entries) const;
     
+    KnownEntries& getKnownEntries(
+      const DxvkStateCacheKey&        key);
+
     void mapShaderToPipeline(
       const DxvkShaderKey&            shader,
-      const DxvkStateCacheKey&        key);
+      const DxvkStateCacheKey&        key,
+            size_t                    entryId);
 
     void compilePipelines(
       const WorkerItem&               item);
 
     bool readCacheFile();
 
+    bool readCacheIndex(
+      const char*                     data,
+            size_t                    size,
+            std::vector<DxvkStateCacheIndexEntry>& index,
+            size_t&                   dataOffset,
+            size_t&                   logOffset) const;
+
+    void compactCacheFile(
+      const std::vector<DxvkStateCacheIndexEntry>& oldIndex,
+      const std::vector<DxvkStateCacheEntry>& entries,
+      const std::vector<uint8_t>&     valid);
+
+    bool writeCompactedFile() const;
+
+    void writeUseCounts();
+
+    void createIndex(
+            std::vector<DxvkStateCacheIndexEntry>&& index,
+      const char*                     entryData);
+
     bool readCacheHeader(
-            std::istream&             stream,
+      const char*                     data,
+            size_t                    size,
             DxvkStateCacheHeader&     header) const;
 
+    size_t getCacheEntrySize(
+            uint32_t                  version,
+      const char*                     data,
+            size_t                    size) const;
+
     bool readCacheEntry(
             uint32_t                  version,
-            std::istream&             stream, 
+      const char*                     data,
+            size_t                    size,
             DxvkStateCacheEntry&      entry) const;
+
+    void readCacheEntries(
+            uint32_t                  version,
+      const char*                     data,
+      const std::vector<std::pair<size_t, size_t>>& ranges,
+            std::vector<DxvkStateCacheEntry>& entries,
+            std::vector<uint8_t>&     valid) const;
     
     void writeCacheEntry(
             std::ostream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
+      const DxvkStateCacheEntry&      entry) const;
     
     void workerFunc();
 
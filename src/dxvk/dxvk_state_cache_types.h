@@ -60,12 +60,50 @@ namespace dxvk {
    */
   struct DxvkStateCacheHeader {
     char     magic[4]   = { 'D', 'X', 'V', 'K' };
-    uint32_t version    = 17;
+    uint32_t version    = 18;
     uint32_t entrySize  = 0; /* no longer meaningful */
   };
 
   static_assert(sizeof(DxvkStateCacheHeader) == 12);
 
+
+  /**
+   * \brief State cache index header
+   *
+   * Follows the file header since v18, and is followed
+   * by the index itself, the indexed entry data, and
+   * any entries appended to the file since it was last
+   * compacted. The hash is used to validate the index.
+   */
+  struct DxvkStateCacheIndexHeader {
+    uint32_t indexCount = 0;
+    uint32_t dataSize   = 0;
+    Sha1Hash indexHash;
+  };
+
+
+  /**
+   * \brief State cache index entry
+   *
+   * Stores the location of all entries that use a given
+   * set of shaders. These entries are stored contiguously,
+   * so that they can be decoded only once the shaders
+   * are actually used. Offsets are relative to the start
+   * of the indexed entry data. The use count stores the
+   * number of runs in which all shaders of the set were
+   * created, and is used to prioritize compilation.
+   */
+  struct DxvkStateCacheIndexEntry {
+    DxvkStateCacheKey shaders;
+    uint32_t          dataOffset;
+    uint32_t          dataSize;
+    uint32_t          entryCount;
+    uint32_t          useCount;
+  };
+
+  static_assert(sizeof(DxvkStateCacheIndexHeader) == 28);
+  static_assert(sizeof(DxvkStateCacheIndexEntry) == 136);
+
   using DxvkBindingMaskV10 = DxvkBindingSet<384>;
   using DxvkBindingMaskV8 = DxvkBindingSet<128>;
 
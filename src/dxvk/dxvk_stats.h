@@ -21,6 +21,7 @@ namespace dxvk {
     PipeTasksDone,            ///< Boolean indicating compiler activity
     PipeTasksTotal,           ///< Boolean indicating compiler activity
     QueueSubmitCount,         ///< Number of command buffer submissions
+    QueueAsyncSubmitCount,    ///< Number of async compute submissions
     QueuePresentCount,        ///< Number of present calls / frames
     GpuSyncCount,             ///< Number of GPU synchronizations
     GpuSyncTicks,             ///< Time spent waiting for GPU
@@ -30,6 +31,12 @@ namespace dxvk {
     CsChunkCount,             ///< Submitted CS chunks
     DescriptorPoolCount,      ///< Descriptor pool count
     DescriptorSetCount,       ///< Descriptor sets allocated
+    DescriptorCacheHits,      ///< Descriptor sets reused from the set cache
+    DescriptorCacheMisses,    ///< Descriptor sets written after a cache miss
+    DescriptorUpdatesSaved,   ///< Descriptor update calls skipped due to cache hits
+    FrameLatencyCount,        ///< Number of frames with latency measurements
+    FrameLatencyTicks,        ///< Accumulated frame start to present latency
+    FrameSleepTicks,          ///< Time spent in latency sleep
     NumCounters,              ///< Number of counters available
   };
   
@@ -310,21 +310,26 @@ namespace dxvk::hud {
     DxvkStatCounters counters = m_device->getStatCounters();
     
     uint64_t currSubmitCount = counters.getCtr(DxvkStatCounter::QueueSubmitCount);
+    uint64_t currAsyncCount = counters.getCtr(DxvkStatCounter::QueueAsyncSubmitCount);
     uint64_t currSyncCount = counters.getCtr(DxvkStatCounter::GpuSyncCount);
     uint64_t currSyncTicks = counters.getCtr(DxvkStatCounter::GpuSyncTicks);
 
     m_maxSubmitCount = std::max(m_maxSubmitCount, currSubmitCount - m_prevSubmitCount);
+    m_maxAsyncCount = std::max(m_maxAsyncCount, currAsyncCount - m_prevAsyncCount);
     m_maxSyncCount = std::max(m_maxSyncCount, currSyncCount - m_prevSyncCount);
     m_maxSyncTicks = std::max(m_maxSyncTicks, currSyncTicks - m_prevSyncTicks);
 
     m_prevSubmitCount = currSubmitCount;
+    m_prevAsyncCount = currAsyncCount;
     m_prevSyncCount = currSyncCount;
     m_prevSyncTicks = currSyncTicks;
 
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
 
     if (elapsed.count() >= UpdateInterval) {
-      m_submitString = str::format(m_maxSubmitCount);
+      m_submitString = m_maxAsyncCount
+        ? str::format(m_maxSubmitCount, " (", m_maxAsyncCount, " async)")
+        : str::format(m_maxSubmitCount);
 
       uint64_t syncTicks = m_maxSyncTicks / 100;
 
@@ -333,6 +338,7 @@ namespace dxvk::hud {
         : str::format(m_maxSyncCount);
 
       m_maxSubmitCount = 0;
+      m_maxAsyncCount = 0;
       m_maxSyncCount = 0;
       m_maxSyncTicks = 0;
 
@@ -518,7 +524,7 @@ namespace dxvk::hud {
 
 
   HudDescriptorStatsItem::HudDescriptorStatsItem(const Rc<DxvkDevice>& device)
-  : m_device(device) {
+  : m_device(device), m_prevCounters(device->getStatCounters()) {
 
   }
 
@@ -529,10 +535,30 @@ namespace dxvk::hud {
 
 
   void HudDescriptorStatsItem::update(dxvk::high_resolution_clock::time_point time) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
     DxvkStatCounters counters = m_device->getStatCounters();
 
     m_descriptorPoolCount = counters.getCtr(DxvkStatCounter::DescriptorPoolCount);
     m_descriptorSetCount  = counters.getCtr(DxvkStatCounter::DescriptorSetCount);
+
+    m_frameCount += 1;
+
+    // Accumulate cache statistics over the entire update
+    // interval, and average saved updates over all frames
+    if (elapsed.count() >= UpdateInterval) {
+      auto diffCounters = counters.diff(m_prevCounters);
+
+      uint64_t hits   = diffCounters.getCtr(DxvkStatCounter::DescriptorCacheHits);
+      uint64_t misses = diffCounters.getCtr(DxvkStatCounter::DescriptorCacheMisses);
+
+      m_cacheHitRate = (hits + misses) ? (100 * hits) / (hits + misses) : 0;
+      m_updatesSaved = diffCounters.getCtr(DxvkStatCounter::DescriptorUpdatesSaved) / m_frameCount;
+
+      m_prevCounters = counters;
+      m_frameCount = 0;
+      m_lastUpdate = time;
+    }
   }
 
 
@@ -561,6 +587,28 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format(m_descriptorSetCount));
 
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.5f, 1.0f },
+      "Set cache hits:");
+
+    renderer.drawText(16.0f,
+      { position.x + 216.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_cacheHitRate, "%"));
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.5f, 1.0f },
+      "Updates saved:");
+
+    renderer.drawText(16.0f,
+      { position.x + 216.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_updatesSaved));
+
     position.y += 8.0f;
     return position;
   }
@@ -580,6 +628,40 @@ namespace dxvk::hud {
   void HudMemoryStatsItem::update(dxvk::high_resolution_clock::time_point time) {
     for (uint32_t i = 0; i < m_memory.memoryHeapCount; i++)
       m_heaps[i] = m_device->getMemoryStats(i);
+
+    m_staging = m_device->stagingRing().getStats();
+
+    // Allocator lock statistics are global, so just use the first
+    // heap. Capture the per-frame maximum like other rate items.
+    if (!m_memory.memoryHeapCount)
+      return;
+
+    uint64_t currLockCount = m_heaps[0].lockCount;
+    uint64_t currLockContention = m_heaps[0].lockContention;
+    uint64_t currLockHoldTimeUs = m_heaps[0].lockHoldTimeUs;
+
+    m_maxLockCount = std::max(m_maxLockCount, currLockCount - m_prevLockCount);
+    m_maxLockContention = std::max(m_maxLockContention, currLockContention - m_prevLockContention);
+    m_maxLockHoldTimeUs = std::max(m_maxLockHoldTimeUs, currLockHoldTimeUs - m_prevLockHoldTimeUs);
+
+    m_prevLockCount = currLockCount;
+    m_prevLockContention = currLockContention;
+    m_prevLockHoldTimeUs = currLockHoldTimeUs;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() >= UpdateInterval) {
+      uint64_t holdTime = m_maxLockHoldTimeUs / 100;
+
+      m_lockString = str::format(m_maxLockCount, " (", m_maxLockContention, " contended, ",
+        (holdTime / 10), ".", (holdTime % 10), " ms held)");
+
+      m_maxLockCount = 0;
+      m_maxLockContention = 0;
+      m_maxLockHoldTimeUs = 0;
+
+      m_lastUpdate = time;
+    }
   }
 
 
@@ -610,6 +692,59 @@ namespace dxvk::hud {
       position.y += 4.0f;
     }
 
+    VkDeviceSize memReclaimed = 0;
+
+    for (uint32_t i = 0; i < m_memory.memoryHeapCount; i++)
+      memReclaimed += m_heaps[i].memoryReclaimed;
+
+    if (memReclaimed) {
+      position.y += 16.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 0.25f, 1.0f },
+        "Defragmentation:");
+
+      renderer.drawText(16.0f,
+        { position.x + 168.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format(memReclaimed >> 20, " MB reclaimed"));
+      position.y += 4.0f;
+    }
+
+    if (!m_lockString.empty()) {
+      position.y += 16.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 0.25f, 1.0f },
+        "Allocator locks:");
+
+      renderer.drawText(16.0f,
+        { position.x + 168.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        m_lockString);
+      position.y += 4.0f;
+    }
+
+    if (m_staging.allocated) {
+      position.y += 16.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 0.25f, 1.0f },
+        "Staging ring:");
+
+      std::string text = str::format(m_staging.used >> 20, " / ", m_staging.allocated >> 20,
+        " MB used (", m_staging.highWater >> 20, " MB peak");
+
+      if (m_staging.overflow)
+        text += str::format(", ", m_staging.overflow >> 20, " MB overflow");
+
+      renderer.drawText(16.0f,
+        { position.x + 168.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        text + ")");
+      position.y += 4.0f;
+    }
+
     position.y += 4.0f;
     return position;
   }
@@ -745,6 +880,70 @@ namespace dxvk::hud {
   }
 
 
+  HudLatencyItem::HudLatencyItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudLatencyItem::~HudLatencyItem() {
+
+  }
+
+
+  void HudLatencyItem::update(dxvk::high_resolution_clock::time_point time) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() >= UpdateInterval) {
+      DxvkStatCounters counters = m_device->getStatCounters();
+      auto diffCounters = counters.diff(m_prevCounters);
+
+      uint64_t frameCount = diffCounters.getCtr(DxvkStatCounter::FrameLatencyCount);
+
+      if (frameCount) {
+        uint64_t latencyTicks = diffCounters.getCtr(DxvkStatCounter::FrameLatencyTicks) / frameCount;
+        uint64_t sleepTicks = diffCounters.getCtr(DxvkStatCounter::FrameSleepTicks) / frameCount;
+
+        m_latencyString = str::format(latencyTicks / 1000, ".", (latencyTicks % 1000) / 100, " ms");
+        m_sleepString = str::format(sleepTicks / 1000, ".", (sleepTicks % 1000) / 100, " ms");
+      }
+
+      m_prevCounters = counters;
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudLatencyItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 1.0f, 0.75f, 1.0f },
+      "Latency:");
+
+    renderer.drawText(16.0f,
+      { position.x + 108.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_latencyString);
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 1.0f, 0.75f, 1.0f },
+      "Sleep:");
+
+    renderer.drawText(16.0f,
+      { position.x + 108.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_sleepString);
+
+    position.y += 8.0f;
+    return position;
+  }
+
+
   HudCompilerActivityItem::HudCompilerActivityItem(const Rc<DxvkDevice>& device)
   : m_device(device) {
 
@@ -259,10 +259,12 @@ namespace dxvk::hud {
     Rc<DxvkDevice>  m_device;
 
     uint64_t        m_prevSubmitCount = 0;
+    uint64_t        m_prevAsyncCount  = 0;
     uint64_t        m_prevSyncCount   = 0;
     uint64_t        m_prevSyncTicks   = 0;
 
     uint64_t        m_maxSubmitCount  = 0;
+    uint64_t        m_maxAsyncCount   = 0;
     uint64_t        m_maxSyncCount    = 0;
     uint64_t        m_maxSyncTicks    = 0;
 
@@ -341,7 +343,7 @@ namespace dxvk::hud {
    * \brief HUD item to display descriptor stats
    */
   class HudDescriptorStatsItem : public HudItem {
-
+    constexpr static int64_t UpdateInterval = 500'000;
   public:
 
     HudDescriptorStatsItem(const Rc<DxvkDevice>& device);
@@ -356,10 +358,18 @@ namespace dxvk::hud {
 
   private:
 
-    Rc<DxvkDevice> m_device;
+    Rc<DxvkDevice>    m_device;
+
+    DxvkStatCounters  m_prevCounters;
 
-    uint64_t m_descriptorPoolCount = 0;
-    uint64_t m_descriptorSetCount  = 0;
+    uint64_t m_descriptorPoolCount  = 0;
+    uint64_t m_descriptorSetCount   = 0;
+    uint64_t m_cacheHitRate         = 0;
+    uint64_t m_updatesSaved         = 0;
+    uint64_t m_frameCount           = 0;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
 
   };
 
@@ -368,7 +378,7 @@ namespace dxvk::hud {
    * \brief HUD item to display memory usage
    */
   class HudMemoryStatsItem : public HudItem {
-
+    constexpr static int64_t UpdateInterval = 500'000;
   public:
 
     HudMemoryStatsItem(const Rc<DxvkDevice>& device);
@@ -386,6 +396,20 @@ namespace dxvk::hud {
     Rc<DxvkDevice>                    m_device;
     VkPhysicalDeviceMemoryProperties  m_memory;
     DxvkMemoryStats                   m_heaps[VK_MAX_MEMORY_HEAPS];
+    DxvkStagingRingStats              m_staging = { };
+
+    uint64_t m_prevLockCount        = 0;
+    uint64_t m_prevLockContention   = 0;
+    uint64_t m_prevLockHoldTimeUs   = 0;
+
+    uint64_t m_maxLockCount         = 0;
+    uint64_t m_maxLockContention    = 0;
+    uint64_t m_maxLockHoldTimeUs    = 0;
+
+    std::string m_lockString;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
 
   };
 
@@ -461,6 +485,38 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display frame latency
+   */
+  class HudLatencyItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudLatencyItem(const Rc<DxvkDevice>& device);
+
+    ~HudLatencyItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice>    m_device;
+
+    DxvkStatCounters  m_prevCounters;
+
+    std::string m_latencyString = "--";
+    std::string m_sleepString   = "--";
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
   /**
    * \brief HUD item to display pipeline compiler activity
    */
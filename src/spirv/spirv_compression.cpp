@@ -1,19 +1,95 @@
 #include "spirv_compression.h"
 
+#ifndef DXVK_SPIRV_COMPRESSION_BLOCK
+#define DXVK_SPIRV_COMPRESSION_BLOCK 0
+#endif
+
 namespace dxvk {
 
+  constexpr SpirvCompressionCodec DefaultCodec = DXVK_SPIRV_COMPRESSION_BLOCK
+    ? SpirvCompressionCodec::Block
+    : SpirvCompressionCodec::Delta;
+
+  // Number of opcode buckets and operand slots used to
+  // predict operand values in the delta codec
+  constexpr uint32_t DeltaOpBuckets = 256;
+  constexpr uint32_t DeltaOpSlots   = 8;
+
+  // Number of SPIR-V header tokens
+  constexpr uint32_t HeaderDwords   = 5;
+
+
+  static inline void writeVarint(std::vector<uint8_t>& dst, uint32_t value) {
+    while (value >= 0x80) {
+      dst.push_back(uint8_t(value | 0x80));
+      value >>= 7;
+    }
+
+    dst.push_back(uint8_t(value));
+  }
+
+
+  static inline uint32_t readVarint(const uint8_t*& src) {
+    uint32_t byte = *(src++);
+    uint32_t value = byte & 0x7f;
+
+    // Most operands fit into a single byte
+    if (likely(byte < 0x80))
+      return value;
+
+    for (uint32_t shift = 7; byte >= 0x80; shift += 7) {
+      byte = *(src++);
+      value |= (byte & 0x7f) << shift;
+    }
+
+    return value;
+  }
+
+
   SpirvCompressedBuffer::SpirvCompressedBuffer()
-  : m_size(0) {
+  : m_size(0), m_codec(SpirvCompressionCodec::Block) {
 
   }
 
 
-  SpirvCompressedBuffer::SpirvCompressedBuffer(SpirvCodeBuffer& code)
-  : m_size(code.dwords()) {
+  SpirvCompressedBuffer::SpirvCompressedBuffer(
+          SpirvCodeBuffer&      code,
+          SpirvCompressionCodec codec)
+  : m_size(code.dwords()), m_codec(codec) {
+    if (m_codec == SpirvCompressionCodec::Default)
+      m_codec = DefaultCodec;
+
+    // The delta codec needs to parse instructions, so fall
+    // back to the block codec if that is not possible.
+    if (m_codec == SpirvCompressionCodec::Delta && !compressDelta(code.data()))
+      m_codec = SpirvCompressionCodec::Block;
+
+    if (m_codec == SpirvCompressionCodec::Block)
+      compressBlock(code.data());
+  }
+
+    
+  SpirvCompressedBuffer::~SpirvCompressedBuffer() {
+
+  }
+
+
+  SpirvCodeBuffer SpirvCompressedBuffer::decompress() const {
+    SpirvCodeBuffer code(m_size);
+
+    if (m_codec == SpirvCompressionCodec::Delta)
+      decompressDelta(code.data());
+    else
+      decompressBlock(code.data());
+
+    return code;
+  }
+
+
+  void SpirvCompressedBuffer::compressBlock(const uint32_t* data) {
     // The compression (detailed below) achieves roughly 55% of the
     // original size on average and is very consistent, so an initial
     // estimate of roughly 58% will be accurate most of the time.
-    const uint32_t* data = code.data();
     m_code.reserve((m_size * 75) / 128);
 
     std::array<uint32_t, 16> block;
@@ -80,16 +156,8 @@ namespace dxvk {
       m_code.shrink_to_fit();
   }
 
-    
-  SpirvCompressedBuffer::~SpirvCompressedBuffer() {
-
-  }
-
-
-  SpirvCodeBuffer SpirvCompressedBuffer::decompress() const {
-    SpirvCodeBuffer code(m_size);
-    uint32_t* data = code.data();
 
+  void SpirvCompressedBuffer::decompressBlock(uint32_t* data) const {
     uint32_t srcOffset = 0;
     uint32_t dstOffset = 0;
 
@@ -116,8 +184,105 @@ namespace dxvk {
 
       srcOffset += 17;
     }
+  }
 
-    return code;
+
+
+  bool SpirvCompressedBuffer::compressDelta(const uint32_t* data) {
+    if (!isWellFormed(data, m_size))
+      return false;
+
+    // This codec encodes every token as a variable-length integer with
+    // seven bits per byte. Header tokens are stored as-is, opcode tokens
+    // are stored as (opcode << 4 | length), with lengths of 15 or more
+    // being stored as a separate integer. All operands are stored as the
+    // zigzag-encoded difference to the same operand of the previous
+    // instruction with the same opcode. Since types tend to repeat and
+    // result IDs grow slowly, most operands encode to a single byte.
+    std::vector<uint8_t> bytes;
+    bytes.reserve(m_size * 2);
+
+    std::array<uint32_t, DeltaOpBuckets * DeltaOpSlots> prev = { };
+
+    for (uint32_t i = 0; i < HeaderDwords; i++)
+      writeVarint(bytes, data[i]);
+
+    for (size_t i = HeaderDwords; i < m_size; ) {
+      uint32_t op = data[i] & spv::OpCodeMask;
+      uint32_t len = data[i] >> spv::WordCountShift;
+
+      writeVarint(bytes, (op << 4) | std::min(len, 15u));
+
+      if (len >= 15)
+        writeVarint(bytes, len - 15);
+
+      uint32_t* slots = &prev[(op % DeltaOpBuckets) * DeltaOpSlots];
+
+      for (uint32_t j = 1; j < len; j++) {
+        uint32_t& last = slots[std::min(j - 1, DeltaOpSlots - 1)];
+        int32_t delta = int32_t(data[i + j] - last);
+
+        writeVarint(bytes, (uint32_t(delta) << 1) ^ uint32_t(delta >> 31));
+        last = data[i + j];
+      }
+
+      i += len;
+    }
+
+    // Store the byte stream in the DWORD array, padding as necessary
+    m_code.resize((bytes.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    std::memcpy(m_code.data(), bytes.data(), bytes.size());
+    return true;
+  }
+
+
+  void SpirvCompressedBuffer::decompressDelta(uint32_t* data) const {
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(m_code.data());
+
+    std::array<uint32_t, DeltaOpBuckets * DeltaOpSlots> prev = { };
+
+    for (uint32_t i = 0; i < HeaderDwords; i++)
+      data[i] = readVarint(src);
+
+    for (size_t i = HeaderDwords; i < m_size; ) {
+      uint32_t token = readVarint(src);
+      uint32_t op = token >> 4;
+      uint32_t len = token & 0xf;
+
+      if (unlikely(len == 15))
+        len += readVarint(src);
+
+      data[i] = op | (len << spv::WordCountShift);
+
+      uint32_t* slots = &prev[(op % DeltaOpBuckets) * DeltaOpSlots];
+
+      for (uint32_t j = 1; j < len; j++) {
+        uint32_t& last = slots[std::min(j - 1, DeltaOpSlots - 1)];
+        uint32_t zigzag = readVarint(src);
+
+        last += (zigzag >> 1) ^ -(zigzag & 1);
+        data[i + j] = last;
+      }
+
+      i += len;
+    }
+  }
+
+
+  bool SpirvCompressedBuffer::isWellFormed(const uint32_t* data, size_t size) {
+    if (size < HeaderDwords || data[0] != spv::MagicNumber)
+      return false;
+
+    for (size_t i = HeaderDwords; i < size; ) {
+      uint32_t len = data[i] >> spv::WordCountShift;
+
+      if (!len || len > size - i)
+        return false;
+
+      i += len;
+    }
+
+    return true;
   }
 
-}
\ No newline at end of file
+}
@@ -6,6 +6,21 @@
 
 namespace dxvk {
 
+  /**
+   * \brief SPIR-V compression codec
+   */
+  enum class SpirvCompressionCodec : uint32_t {
+    /// Packs up to two tokens into fixed-size
+    /// DWORDs. Fastest, but least efficient.
+    Block   = 0,
+    /// Byte-aligned variable-length encoding of
+    /// operands relative to the previous instruction
+    /// with the same opcode. Significantly smaller.
+    Delta   = 1,
+    /// Codec selected at build time
+    Default = ~0u,
+  };
+
   /**
    * \brief Compressed SPIR-V code buffer
    *
@@ -18,21 +33,49 @@ namespace dxvk {
 
     SpirvCompressedBuffer();
 
-    SpirvCompressedBuffer(SpirvCodeBuffer& code);
+    SpirvCompressedBuffer(
+            SpirvCodeBuffer&      code,
+            SpirvCompressionCodec codec = SpirvCompressionCodec::Default);
     
     ~SpirvCompressedBuffer();
     
     SpirvCodeBuffer decompress() const;
 
+    /**
+     * \brief Codec used for this buffer
+     *
+     * May differ from the requested codec if
+     * the code could not be parsed as SPIR-V.
+     * \returns Compression codec
+     */
+    SpirvCompressionCodec codec() const {
+      return m_codec;
+    }
+
+    /**
+     * \brief Size of the compressed data
+     * \returns Compressed size, in bytes
+     */
+    size_t compressedSize() const {
+      return m_code.size() * sizeof(uint32_t);
+    }
+
   private:
 
     size_t                m_size;
+    SpirvCompressionCodec m_codec;
     std::vector<uint32_t> m_code;
 
-    void encodeDword(uint32_t dw);
+    void compressBlock(const uint32_t* data);
+
+    bool compressDelta(const uint32_t* data);
+
+    void decompressBlock(uint32_t* data) const;
+
+    void decompressDelta(uint32_t* data) const;
 
-    uint32_t decodeDword(size_t& offset) const;
+    static bool isWellFormed(const uint32_t* data, size_t size);
 
   };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../dxvk/dxvk_allocator.h"
+
+#include "../util/util_math.h"
+#include "../util/util_string.h"
+#include "../util/util_time.h"
+
+using namespace dxvk;
+
+/**
+ * \brief Trace operation
+ *
+ * Allocations are identified by an arbitrary ID
+ * that is referenced again when freeing them.
+ */
+struct BenchOp {
+  bool      free;
+  uint32_t  id;
+  uint64_t  size;
+  uint64_t  align;
+};
+
+
+/**
+ * \brief Alloc/free trace
+ */
+struct BenchTrace {
+  std::string           name;
+  uint64_t              capacity;
+  uint32_t              idCount;
+  std::vector<BenchOp>  ops;
+};
+
+
+/**
+ * \brief Free list allocator
+ *
+ * Copy of the worst-fit free list that \c DxvkMemoryChunk
+ * used before the TLSF allocator, for comparison.
+ */
+class FreeListAllocator {
+
+public:
+
+  struct Range {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+  };
+
+  FreeListAllocator(uint64_t capacity) {
+    m_freeList.push_back({ 0, capacity });
+  }
+
+  Range alloc(uint64_t size, uint64_t align) {
+    if (m_freeList.empty())
+      return Range();
+
+    auto bestSlice = m_freeList.begin();
+
+    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
+      if (slice->length == size) {
+        bestSlice = slice;
+        break;
+      } else if (slice->length > bestSlice->length) {
+        bestSlice = slice;
+      }
+    }
+
+    uint64_t sliceStart = bestSlice->offset;
+    uint64_t sliceEnd   = bestSlice->offset + bestSlice->length;
+
+    uint64_t allocStart = dxvk::align(sliceStart,        align);
+    uint64_t allocEnd   = dxvk::align(allocStart + size, align);
+
+    if (allocEnd > sliceEnd)
+      return Range();
+
+    m_freeList.erase(bestSlice);
+
+    if (allocStart != sliceStart)
+      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
+
+    if (allocEnd != sliceEnd)
+      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
+
+    m_maxFreeCount = std::max(m_maxFreeCount, m_freeList.size());
+    return { allocStart, allocEnd - allocStart };
+  }
+
+  void free(uint64_t offset, uint64_t length) {
+    auto curr = m_freeList.begin();
+
+    while (curr != m_freeList.end()) {
+      if (curr->offset == offset + length) {
+        length += curr->length;
+        curr = m_freeList.erase(curr);
+      } else if (curr->offset + curr->length == offset) {
+        offset -= curr->length;
+        length += curr->length;
+        curr = m_freeList.erase(curr);
+      } else {
+        curr++;
+      }
+    }
+
+    m_freeList.push_back({ offset, length });
+  }
+
+  size_t maxFreeCount() const {
+    return m_maxFreeCount;
+  }
+
+private:
+
+  struct FreeSlice {
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  std::vector<FreeSlice> m_freeList;
+  size_t                 m_maxFreeCount = 1;
+
+};
+
+
+/**
+ * \brief Replay result
+ */
+struct BenchResult {
+  std::chrono::nanoseconds  time    = { };
+  uint32_t                  failed  = 0;
+  size_t                    maxFree = 0;
+};
+
+
+static uint64_t randomSize(std::mt19937& rng, uint32_t minLog2, uint32_t maxLog2) {
+  uint32_t log2 = minLog2 + rng() % (maxLog2 - minLog2);
+  return (uint64_t(1) << log2) + (rng() % (uint64_t(1) << log2));
+}
+
+
+/**
+ * \brief Streaming trace
+ *
+ * Keeps a bounded set of live resources of widely varying
+ * sizes and replaces random ones, which mimics resources
+ * being streamed in and out and fragments the chunk.
+ */
+static BenchTrace createStreamingTrace(uint32_t opCount, uint32_t liveCount) {
+  BenchTrace trace;
+  trace.name = str::format("streaming-", liveCount);
+  trace.capacity = 256ull << 20;
+  trace.idCount = 0;
+
+  std::mt19937 rng(liveCount);
+  std::vector<uint32_t> live;
+
+  while (trace.ops.size() < opCount) {
+    if (live.size() >= liveCount || (!live.empty() && rng() % 3 == 0)) {
+      size_t index = rng() % live.size();
+      trace.ops.push_back({ true, live[index], 0, 0 });
+      live[index] = live.back();
+      live.pop_back();
+    } else {
+      uint64_t align = rng() % 4 ? 256 : 65536;
+      trace.ops.push_back({ false, trace.idCount, randomSize(rng, 8, 20), align });
+      live.push_back(trace.idCount++);
+    }
+  }
+
+  return trace;
+}
+
+
+/**
+ * \brief FIFO trace
+ *
+ * Allocations are freed in order after a fixed delay,
+ * similar to upload buffers that are only used for a
+ * few frames.
+ */
+static BenchTrace createFifoTrace(uint32_t opCount, uint32_t delay) {
+  BenchTrace trace;
+  trace.name = str::format("fifo-", delay);
+  trace.capacity = 256ull << 20;
+  trace.idCount = 0;
+
+  std::mt19937 rng(delay);
+
+  while (trace.ops.size() < opCount) {
+    trace.ops.push_back({ false, trace.idCount, randomSize(rng, 10, 16), 256 });
+
+    if (trace.idCount >= delay)
+      trace.ops.push_back({ true, trace.idCount - delay, 0, 0 });
+
+    trace.idCount += 1;
+  }
+
+  return trace;
+}
+
+
+/**
+ * \brief Loads trace from a file
+ *
+ * Each line is either \c "a <id> <size> <align>" or
+ * \c "f <id>". The capacity can be set with a line
+ * \c "c <bytes>", and defaults to 256 MiB.
+ */
+static bool loadTrace(const std::string& path, BenchTrace& trace) {
+  std::ifstream stream(path);
+
+  if (!stream)
+    return false;
+
+  trace.name = path;
+  trace.capacity = 256ull << 20;
+  trace.idCount = 0;
+
+  std::string line;
+
+  while (std::getline(stream, line)) {
+    std::istringstream ls(line);
+    std::string type;
+
+    if (!(ls >> type) || type[0] == '#')
+      continue;
+
+    BenchOp op = { };
+
+    if (type == "c") {
+      ls >> trace.capacity;
+      continue;
+    } else if (type == "a") {
+      ls >> op.id >> op.size >> op.align;
+      op.align = std::max<uint64_t>(op.align, 1);
+    } else if (type == "f") {
+      op.free = true;
+      ls >> op.id;
+    } else {
+      std::cerr << path << ": Invalid line: " << line << std::endl;
+      return false;
+    }
+
+    trace.idCount = std::max(trace.idCount, op.id + 1);
+    trace.ops.push_back(op);
+  }
+
+  return true;
+}
+
+
+static BenchResult replayTlsf(const BenchTrace& trace) {
+  BenchResult result;
+
+  DxvkTlsfAllocator allocator(trace.capacity);
+  std::vector<uint32_t> blocks(trace.idCount, DxvkTlsfAllocator::InvalidBlock);
+
+  auto t0 = high_resolution_clock::now();
+
+  for (const auto& op : trace.ops) {
+    if (op.free) {
+      if (blocks[op.id] != DxvkTlsfAllocator::InvalidBlock)
+        allocator.free(blocks[op.id]);
+    } else {
+      auto range = allocator.alloc(op.size, op.align);
+      blocks[op.id] = range.block;
+      result.failed += range ? 0 : 1;
+    }
+  }
+
+  auto t1 = high_resolution_clock::now();
+  result.time = t1 - t0;
+  return result;
+}
+
+
+static BenchResult replayFreeList(const BenchTrace& trace) {
+  BenchResult result;
+
+  FreeListAllocator allocator(trace.capacity);
+  std::vector<FreeListAllocator::Range> ranges(trace.idCount);
+
+  auto t0 = high_resolution_clock::now();
+
+  for (const auto& op : trace.ops) {
+    if (op.free) {
+      if (ranges[op.id].length)
+        allocator.free(ranges[op.id].offset, ranges[op.id].length);
+    } else {
+      ranges[op.id] = allocator.alloc(op.size, op.align);
+      result.failed += ranges[op.id].length ? 0 : 1;
+    }
+  }
+
+  auto t1 = high_resolution_clock::now();
+  result.time = t1 - t0;
+  result.maxFree = allocator.maxFreeCount();
+  return result;
+}
+
+
+/**
+ * \brief Validates TLSF allocations
+ *
+ * Checks that returned ranges are aligned, do not
+ * overlap any live range, and that all memory is
+ * free again once every range has been freed.
+ */
+static bool validateTlsf(const BenchTrace& trace) {
+  DxvkTlsfAllocator allocator(trace.capacity);
+
+  std::vector<DxvkTlsfAllocator::Range> ranges(trace.idCount);
+  std::map<uint64_t, uint64_t> live;
+
+  for (const auto& op : trace.ops) {
+    auto& range = ranges[op.id];
+
+    if (op.free) {
+      if (range) {
+        live.erase(range.offset);
+        allocator.free(range.block);
+        range = DxvkTlsfAllocator::Range();
+      }
+    } else {
+      range = allocator.alloc(op.size, op.align);
+
+      if (!range)
+        continue;
+
+      if (range.offset % op.align || range.length < op.size
+       || range.offset + range.length > trace.capacity) {
+        std::cerr << trace.name << ": Invalid range for allocation " << op.id << std::endl;
+        return false;
+      }
+
+      auto next = live.lower_bound(range.offset);
+
+      if ((next != live.end() && next->first < range.offset + range.length)
+       || (next != live.begin() && std::prev(next)->second > range.offset)) {
+        std::cerr << trace.name << ": Overlapping range for allocation " << op.id << std::endl;
+        return false;
+      }
+
+      live.insert({ range.offset, range.offset + range.length });
+    }
+  }
+
+  for (auto& range : ranges) {
+    if (range)
+      allocator.free(range.block);
+  }
+
+  if (!allocator.isEmpty()) {
+    std::cerr << trace.name << ": Memory not free after replay" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+static bool runTrace(const BenchTrace& trace, uint32_t iterations) {
+  if (!validateTlsf(trace))
+    return false;
+
+  BenchResult tlsf, freeList;
+
+  // Use the fastest run of each allocator to reduce noise
+  for (uint32_t i = 0; i < iterations; i++) {
+    BenchResult a = replayTlsf(trace);
+    BenchResult b = replayFreeList(trace);
+
+    if (!i || a.time < tlsf.time)
+      tlsf = a;
+
+    if (!i || b.time < freeList.time)
+      freeList = b;
+  }
+
+  double opCount = double(trace.ops.size());
+
+  std::cout << trace.name << " (" << trace.ops.size() << " ops):" << std::endl
+            << "  tlsf    : " << double(tlsf.time.count()) / opCount << " ns/op, "
+            << tlsf.failed << " failed" << std::endl
+            << "  freelist: " << double(freeList.time.count()) / opCount << " ns/op, "
+            << freeList.failed << " failed, " << freeList.maxFree << " max free slices" << std::endl;
+  return true;
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t iterations = 5;
+  std::vector<BenchTrace> traces;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-n" && i + 1 < argc) {
+      iterations = uint32_t(std::max(std::atoi(argv[++i]), 1));
+    } else {
+      BenchTrace trace;
+
+      if (!loadTrace(arg, trace)) {
+        std::cerr << "Failed to load " << arg << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      traces.push_back(std::move(trace));
+    }
+  }
+
+  if (traces.empty()) {
+    traces.push_back(createStreamingTrace(200000, 64));
+    traces.push_back(createStreamingTrace(200000, 1024));
+    traces.push_back(createFifoTrace(200000, 256));
+    traces.push_back(createFifoTrace(200000, 4096));
+  }
+
+  bool success = true;
+
+  for (const auto& trace : traces)
+    success &= runTrace(trace, iterations);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../dxvk/dxvk_barrier.h"
+
+#include "../util/util_time.h"
+
+using namespace dxvk;
+
+using BufferSet = DxvkBarrierSubresourceSet<VkBuffer, DxvkBarrierBufferSlice>;
+
+/**
+ * \brief Synthetic buffer access
+ */
+struct BenchAccess {
+  VkBuffer                buffer;
+  DxvkBarrierBufferSlice  slice;
+};
+
+
+/**
+ * \brief Benchmark pattern
+ */
+struct BenchPattern {
+  std::string               name;
+  std::vector<BenchAccess>  accesses;
+};
+
+
+static VkBuffer getBuffer(uint32_t index) {
+  return VkBuffer(uint64_t(index + 1));
+}
+
+
+static DxvkAccessFlags getAccess(bool write) {
+  return write
+    ? DxvkAccessFlags(DxvkAccess::Read, DxvkAccess::Write)
+    : DxvkAccessFlags(DxvkAccess::Read);
+}
+
+
+/**
+ * \brief Linear sub-allocation
+ *
+ * Mimics constant buffer updates that sub-allocate
+ * aligned ranges from a small number of large buffers.
+ */
+static BenchPattern createLinearPattern(uint32_t count) {
+  BenchPattern pattern;
+  pattern.name = str::format("linear-", count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    VkDeviceSize offset = VkDeviceSize(i / 4) * 256;
+    pattern.accesses.push_back({ getBuffer(i % 4),
+      DxvkBarrierBufferSlice(offset, 192, getAccess(true)) });
+  }
+
+  return pattern;
+}
+
+
+/**
+ * \brief Random ranges
+ *
+ * Random reads and writes within a few buffers,
+ * which is the worst case for range coalescing.
+ */
+static BenchPattern createRandomPattern(uint32_t count) {
+  BenchPattern pattern;
+  pattern.name = str::format("random-", count);
+
+  std::mt19937 rng(count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    VkDeviceSize offset = VkDeviceSize(rng() % (1u << 20)) & ~VkDeviceSize(15);
+    VkDeviceSize length = 16 + VkDeviceSize(rng() % 1024);
+
+    pattern.accesses.push_back({ getBuffer(rng() % 4),
+      DxvkBarrierBufferSlice(offset, length, getAccess(rng() % 4 == 0)) });
+  }
+
+  return pattern;
+}
+
+
+static void runPattern(const BenchPattern& pattern, uint32_t iterations) {
+  BufferSet set;
+
+  std::chrono::nanoseconds insertTime = { };
+  std::chrono::nanoseconds queryTime = { };
+
+  uint32_t dirtyCount = 0;
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    // Check each access for hazards before inserting it,
+    // the same way the context does for each draw
+    for (const auto& access : pattern.accesses) {
+      auto t0 = high_resolution_clock::now();
+      dirtyCount += set.isDirty(access.buffer, access.slice) ? 1 : 0;
+      dirtyCount += set.getAccess(access.buffer, access.slice).isClear() ? 0 : 1;
+
+      auto t1 = high_resolution_clock::now();
+      set.insert(access.buffer, access.slice);
+
+      auto t2 = high_resolution_clock::now();
+      queryTime += t1 - t0;
+      insertTime += t2 - t1;
+    }
+
+    set.clear();
+  }
+
+  double opCount = double(pattern.accesses.size()) * double(iterations);
+
+  std::cout << pattern.name << ": "
+            << double(insertTime.count()) / opCount << " ns/insert, "
+            << double(queryTime.count()) / opCount << " ns/query"
+            << " (" << dirtyCount << " hazards)" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t iterations = argc > 1 ? uint32_t(std::max(std::atoi(argv[1]), 1)) : 100;
+
+  for (uint32_t count : { 16u, 256u, 4096u }) {
+    runPattern(createLinearPattern(count), iterations);
+    runPattern(createRandomPattern(count), iterations);
+  }
+
+  return 0;
+}
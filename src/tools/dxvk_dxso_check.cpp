@@ -0,0 +1,481 @@
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../dxso/dxso_interpreter.h"
+#include "../dxso/dxso_module.h"
+
+#include "../util/util_time.h"
+
+using namespace dxvk;
+
+/**
+ * \brief Minimal DXSO assembler
+ *
+ * Emits raw shader tokens so that test shaders can be
+ * written inline without depending on an external
+ * shader compiler.
+ */
+class DxsoAssembler {
+
+public:
+
+  DxsoAssembler(uint32_t major, uint32_t minor)
+  : m_major(major) {
+    m_code.push_back(0xfffe0000u | (major << 8) | minor);
+  }
+
+  static uint32_t reg(DxsoRegisterType type, uint32_t num) {
+    uint32_t t = uint32_t(type);
+
+    return 0x80000000u | (num & 0x7ffu)
+      | ((t & 0x7u) << 28) | ((t & 0x18u) << 8);
+  }
+
+  static uint32_t dst(DxsoRegisterType type, uint32_t num, uint32_t mask = 0xfu) {
+    return reg(type, num) | (mask << 16);
+  }
+
+  static uint32_t src(DxsoRegisterType type, uint32_t num, uint32_t swizzle = 0xe4u) {
+    return reg(type, num) | (swizzle << 16);
+  }
+
+  static uint32_t rel(uint32_t token) {
+    return token | (1u << 13);
+  }
+
+  void op(DxsoOpcode opcode, std::initializer_list<uint32_t> params, uint32_t control = 0) {
+    uint32_t token = uint32_t(opcode) | (control << 16);
+
+    if (m_major >= 2)
+      token |= uint32_t(params.size()) << 24;
+
+    m_code.push_back(token);
+    m_code.insert(m_code.end(), params.begin(), params.end());
+  }
+
+  void dcl(DxsoUsage usage, uint32_t index, uint32_t dstToken) {
+    op(DxsoOpcode::Dcl, { 0x80000000u | uint32_t(usage) | (index << 16), dstToken });
+  }
+
+  void def(uint32_t num, float x, float y, float z, float w) {
+    op(DxsoOpcode::Def, { dst(DxsoRegisterType::Const, num),
+      bit::cast<uint32_t>(x), bit::cast<uint32_t>(y),
+      bit::cast<uint32_t>(z), bit::cast<uint32_t>(w) });
+  }
+
+  const uint32_t* finalize() {
+    m_code.push_back(uint32_t(DxsoOpcode::End));
+    return m_code.data();
+  }
+
+  std::vector<uint32_t> code() const {
+    return m_code;
+  }
+
+private:
+
+  uint32_t              m_major;
+  std::vector<uint32_t> m_code;
+
+};
+
+
+static bool g_failed = false;
+
+
+static void check(const std::string& name, bool result) {
+  std::cout << (result ? "PASS " : "FAIL ") << name << std::endl;
+  g_failed |= !result;
+}
+
+
+static DxsoAnalysisInfo analyzeShader(const uint32_t* code) {
+  DxsoReader reader(reinterpret_cast<const char*>(code));
+  DxsoModule module(reader);
+  return module.analyze();
+}
+
+
+static bool checkConstantMask(const DxsoAnalysisInfo& info, std::initializer_list<uint32_t> expected) {
+  DxsoConstantMaskF mask = { };
+
+  for (uint32_t num : expected)
+    mask[num / 32] |= 1u << (num % 32);
+
+  return info.canPackConstantsF && info.constantMaskF == mask;
+}
+
+
+/**
+ * \brief Checks float constants reported by the analysis pass
+ *
+ * Matrix instructions read one constant register per
+ * destination component, all of which must be uploaded
+ * when constants are packed.
+ */
+static void checkConstantAnalysis() {
+  using R = DxsoRegisterType;
+
+  { DxsoAssembler a(1, 1);
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+    a.op(DxsoOpcode::M4x4, { a.dst(R::RasterizerOut, 0), a.src(R::Input, 0), a.src(R::Const, 0) });
+    check("analysis: vs_1_1 m4x4 reads c0-c3",
+      checkConstantMask(analyzeShader(a.finalize()), { 0, 1, 2, 3 }));
+  }
+
+  { DxsoAssembler a(2, 0);
+    a.def(5, 1.0f, 0.0f, 0.0f, 0.0f);
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+    a.op(DxsoOpcode::M3x3, { a.dst(R::Temp, 0, 0x7u), a.src(R::Input, 0), a.src(R::Const, 4) });
+    a.op(DxsoOpcode::M3x2, { a.dst(R::Temp, 1, 0x3u), a.src(R::Temp, 0), a.src(R::Const, 8) });
+    a.op(DxsoOpcode::Add, { a.dst(R::RasterizerOut, 0), a.src(R::Temp, 1), a.src(R::Const, 20) });
+    check("analysis: vs_2_0 m3x3/m3x2 skip defined rows",
+      checkConstantMask(analyzeShader(a.finalize()), { 4, 6, 8, 9, 20 }));
+  }
+
+  { DxsoAssembler a(2, 0);
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+    a.op(DxsoOpcode::M4x3, { a.dst(R::Temp, 0, 0x7u), a.src(R::Input, 0), a.src(R::Const, 254) });
+    a.op(DxsoOpcode::Mov, { a.dst(R::RasterizerOut, 0), a.src(R::Temp, 0) });
+    check("analysis: matrix past packing range disables packing",
+      !analyzeShader(a.finalize()).canPackConstantsF);
+  }
+}
+
+
+using DxsoLaneValues = std::array<Vector4, DxsoInterpreterLaneCount>;
+
+
+static DxsoOptions getInterpreterOptions() {
+  DxsoOptions options = { };
+  options.d3d9FloatEmulation = D3D9FloatEmulation::Enabled;
+  options.strictPow = true;
+  options.shaderModel = 3;
+  return options;
+}
+
+
+static void setInput(DxsoInterpreterIo& io, uint32_t reg, const DxsoLaneValues& values) {
+  for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+    for (uint32_t c = 0; c < 4; c++)
+      io.inputs[reg].c[c][i] = values[i][c];
+  }
+}
+
+
+static bool checkOutput(const DxsoInterpreterIo& io, uint32_t slot, const DxsoLaneValues& expected) {
+  bool result = true;
+
+  for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+    for (uint32_t c = 0; c < 4; c++) {
+      float value = io.outputs[slot].c[c][i];
+      float reference = expected[i][c];
+
+      if (std::abs(value - reference) > 1.0e-4f * std::max(std::abs(reference), 1.0f)) {
+        std::cout << "  lane " << i << " component " << c << ": got " << value
+                  << ", expected " << reference << std::endl;
+        result = false;
+      }
+    }
+  }
+
+  return result;
+}
+
+
+static bool runInterpreter(
+  const uint32_t*                 code,
+  const DxsoInterpreterConstants& constants,
+        DxsoInterpreterIo&        io) {
+  Rc<DxsoInterpreterProgram> program = new DxsoInterpreterProgram(getInterpreterOptions(), code);
+
+  if (!program->isSupported()) {
+    std::cout << "  shader not supported by interpreter" << std::endl;
+    return false;
+  }
+
+  program->execute(constants, io, (1u << DxsoInterpreterLaneCount) - 1u);
+  return true;
+}
+
+
+static std::vector<uint32_t> createTransformShader() {
+  using R = DxsoRegisterType;
+
+  DxsoAssembler a(1, 1);
+  a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+  a.op(DxsoOpcode::M4x4, { a.dst(R::RasterizerOut, 0), a.src(R::Input, 0), a.src(R::Const, 0) });
+  a.finalize();
+  return a.code();
+}
+
+
+static const std::array<Vector4, 4> g_transform = {{
+  Vector4( 1.0f,  2.0f,  0.0f, 10.0f),
+  Vector4( 0.0f,  0.5f, -1.0f,  0.0f),
+  Vector4( 3.0f,  0.0f,  1.0f, -2.0f),
+  Vector4( 0.0f,  0.0f,  0.25f, 1.0f),
+}};
+
+
+static const DxsoLaneValues g_positions = {{
+  Vector4( 0.0f,  0.0f,  0.0f,  1.0f),
+  Vector4( 1.0f,  2.0f,  3.0f,  1.0f),
+  Vector4(-4.0f,  0.5f,  8.0f,  1.0f),
+  Vector4( 0.5f, -1.0f, -2.0f,  0.0f),
+}};
+
+
+/**
+ * \brief Checks interpreter results
+ *
+ * Runs small vertex shaders covering transforms, loops,
+ * relative addressing and branches on four lanes with
+ * distinct inputs, and compares the outputs against
+ * values computed on the host.
+ */
+static void checkInterpreter() {
+  using R = DxsoRegisterType;
+
+  { auto code = createTransformShader();
+
+    DxsoInterpreterConstants constants;
+    constants.floats = g_transform.data();
+    constants.floatCount = g_transform.size();
+
+    DxsoInterpreterIo io = { };
+    setInput(io, 0, g_positions);
+
+    DxsoLaneValues expected;
+
+    for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+      for (uint32_t c = 0; c < 4; c++) {
+        expected[i][c] = g_positions[i][0] * g_transform[c][0] + g_positions[i][1] * g_transform[c][1]
+                       + g_positions[i][2] * g_transform[c][2] + g_positions[i][3] * g_transform[c][3];
+      }
+    }
+
+    check("interpreter: vs_1_1 m4x4 transform",
+      runInterpreter(code.data(), constants, io) && checkOutput(io, 0, expected));
+  }
+
+  { // oPos = sum of v0 * c[aL] for aL = 4, 5, 6, oT0 = c7 added twice
+    DxsoAssembler a(2, 0);
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+    a.op(DxsoOpcode::Mov, { a.dst(R::Temp, 0), a.src(R::Const, 0) });
+    a.op(DxsoOpcode::Loop, { a.src(R::Loop, 0), a.src(R::ConstInt, 0) });
+    a.op(DxsoOpcode::Mad, { a.dst(R::Temp, 0), a.src(R::Input, 0), a.rel(a.src(R::Const, 0)), a.reg(R::Loop, 0), a.src(R::Temp, 0) });
+    a.op(DxsoOpcode::EndLoop, { });
+    a.op(DxsoOpcode::Rep, { a.src(R::ConstInt, 1) });
+    a.op(DxsoOpcode::Add, { a.dst(R::Temp, 1), a.src(R::Temp, 1), a.src(R::Const, 7) });
+    a.op(DxsoOpcode::EndRep, { });
+    a.op(DxsoOpcode::Mov, { a.dst(R::RasterizerOut, 0), a.src(R::Temp, 0) });
+    a.op(DxsoOpcode::Mov, { a.dst(R::TexcoordOut, 0), a.src(R::Temp, 1) });
+
+    std::array<Vector4, 8> floats = {{
+      Vector4(0.0f), Vector4(0.0f), Vector4(0.0f), Vector4(0.0f),
+      Vector4(1.0f, 2.0f, 3.0f, 4.0f),
+      Vector4(0.5f, 0.5f, 0.5f, 0.5f),
+      Vector4(-1.0f, 0.0f, 2.0f, 1.0f),
+      Vector4(0.25f, 0.5f, 0.75f, 1.0f),
+    }};
+
+    std::array<Vector4i, 2> ints = {{
+      Vector4i(3, 4, 1, 0),
+      Vector4i(2, 0, 0, 0),
+    }};
+
+    DxsoInterpreterConstants constants;
+    constants.floats = floats.data();
+    constants.floatCount = floats.size();
+    constants.ints = ints.data();
+    constants.intCount = ints.size();
+
+    DxsoInterpreterIo io = { };
+    setInput(io, 0, g_positions);
+
+    DxsoLaneValues position;
+    DxsoLaneValues texcoord;
+
+    for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+      for (uint32_t c = 0; c < 4; c++) {
+        position[i][c] = g_positions[i][c] * (floats[4][c] + floats[5][c] + floats[6][c]);
+        texcoord[i][c] = floats[7][c] * 2.0f;
+      }
+    }
+
+    check("interpreter: vs_2_0 loop with aL and rep",
+      runInterpreter(a.finalize(), constants, io)
+        && checkOutput(io, 0, position)
+        && checkOutput(io, 5, texcoord));
+  }
+
+  { // oPos = c[a0.x + 2], with a0.x rounded in vs_2_0 and floored in vs_1_1
+    std::array<Vector4, 6> floats;
+
+    for (uint32_t i = 0; i < floats.size(); i++)
+      floats[i] = Vector4(float(i), float(i) * 2.0f, -float(i), 1.0f);
+
+    DxsoInterpreterConstants constants;
+    constants.floats = floats.data();
+    constants.floatCount = floats.size();
+
+    DxsoLaneValues indices = {{
+      Vector4( 0.0f), Vector4( 1.0f), Vector4( 2.6f), Vector4(-0.7f),
+    }};
+
+    for (uint32_t legacy = 0; legacy < 2; legacy++) {
+      DxsoAssembler a(legacy ? 1 : 2, legacy ? 1 : 0);
+      a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+
+      if (legacy) {
+        a.op(DxsoOpcode::Mov, { a.dst(R::Addr, 0, 0x1u), a.src(R::Input, 0) });
+        a.op(DxsoOpcode::Mov, { a.dst(R::RasterizerOut, 0), a.rel(a.src(R::Const, 2)) });
+      } else {
+        a.op(DxsoOpcode::Mova, { a.dst(R::Addr, 0, 0x1u), a.src(R::Input, 0) });
+        a.op(DxsoOpcode::Mov, { a.dst(R::RasterizerOut, 0), a.rel(a.src(R::Const, 2)), a.reg(R::Addr, 0) });
+      }
+
+      DxsoInterpreterIo io = { };
+      setInput(io, 0, indices);
+
+      DxsoLaneValues expected;
+
+      for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+        float index = legacy ? std::floor(indices[i][0]) : std::floor(indices[i][0] + 0.5f);
+        expected[i] = floats[uint32_t(int32_t(index) + 2)];
+      }
+
+      check(legacy
+          ? "interpreter: vs_1_1 mov a0 with relative constants"
+          : "interpreter: vs_2_0 mova with relative constants",
+        runInterpreter(a.finalize(), constants, io) && checkOutput(io, 0, expected));
+    }
+  }
+
+  for (uint32_t branch = 0; branch < 2; branch++) {
+    // Count up until r0.x >= v0.x, then take branches on b0 and v0.x < 1
+    DxsoAssembler a(3, 0);
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Input, 0));
+    a.dcl(DxsoUsage::Position, 0, a.dst(R::Output, 0));
+    a.op(DxsoOpcode::Mov, { a.dst(R::Temp, 0), a.src(R::Const, 0) });
+    a.op(DxsoOpcode::Rep, { a.src(R::ConstInt, 0) });
+    a.op(DxsoOpcode::Add, { a.dst(R::Temp, 0, 0x1u), a.src(R::Temp, 0), a.src(R::Const, 1) });
+    a.op(DxsoOpcode::BreakC, { a.src(R::Temp, 0, 0x00u), a.src(R::Input, 0, 0x00u) },
+      uint32_t(DxsoComparison::GreaterEqual));
+    a.op(DxsoOpcode::EndRep, { });
+    a.op(DxsoOpcode::If, { a.src(R::ConstBool, 0) });
+    a.op(DxsoOpcode::Add, { a.dst(R::Temp, 0, 0x2u), a.src(R::Temp, 0), a.src(R::Const, 1) });
+    a.op(DxsoOpcode::Else, { });
+    a.op(DxsoOpcode::Add, { a.dst(R::Temp, 0, 0x4u), a.src(R::Temp, 0), a.src(R::Const, 1) });
+    a.op(DxsoOpcode::EndIf, { });
+    a.op(DxsoOpcode::Ifc, { a.src(R::Input, 0, 0x00u), a.src(R::Const, 1, 0x00u) },
+      uint32_t(DxsoComparison::LessThan));
+    a.op(DxsoOpcode::Mov, { a.dst(R::Temp, 0, 0x8u), a.src(R::Const, 2) });
+    a.op(DxsoOpcode::EndIf, { });
+    a.op(DxsoOpcode::Mov, { a.dst(R::Output, 0), a.src(R::Temp, 0) });
+
+    std::array<Vector4, 3> floats = {{
+      Vector4(0.0f), Vector4(1.0f), Vector4(5.0f),
+    }};
+
+    Vector4i ints = Vector4i(8, 0, 0, 0);
+    uint32_t bools = branch;
+
+    DxsoInterpreterConstants constants;
+    constants.floats = floats.data();
+    constants.floatCount = floats.size();
+    constants.ints = &ints;
+    constants.intCount = 1;
+    constants.bools = &bools;
+    constants.boolCount = 1;
+
+    DxsoLaneValues limits = {{
+      Vector4(0.5f), Vector4(2.0f), Vector4(3.0f), Vector4(100.0f),
+    }};
+
+    DxsoInterpreterIo io = { };
+    setInput(io, 0, limits);
+
+    DxsoLaneValues expected;
+
+    for (uint32_t i = 0; i < DxsoInterpreterLaneCount; i++) {
+      expected[i] = Vector4(
+        std::min(std::ceil(limits[i][0]), 8.0f),
+        branch ? 1.0f : 0.0f,
+        branch ? 0.0f : 1.0f,
+        limits[i][0] < 1.0f ? 5.0f : 0.0f);
+    }
+
+    check(branch
+        ? "interpreter: vs_3_0 rep with break_ge, if b0 taken"
+        : "interpreter: vs_3_0 rep with break_ge, if b0 not taken",
+      runInterpreter(a.finalize(), constants, io) && checkOutput(io, 0, expected));
+  }
+}
+
+
+/**
+ * \brief Measures interpreter throughput
+ *
+ * Runs the transform shader over a large batch of vertices,
+ * once with all lanes active and once with a single active
+ * lane per invocation, and reports the time per vertex.
+ */
+static void benchmarkInterpreter(uint32_t vertexCount) {
+  auto code = createTransformShader();
+
+  Rc<DxsoInterpreterProgram> program = new DxsoInterpreterProgram(getInterpreterOptions(), code.data());
+
+  DxsoInterpreterConstants constants;
+  constants.floats = g_transform.data();
+  constants.floatCount = g_transform.size();
+
+  DxsoInterpreterIo io = { };
+  setInput(io, 0, g_positions);
+
+  for (uint32_t lanes : { DxsoInterpreterLaneCount, 1u }) {
+    uint32_t laneMask = (1u << lanes) - 1u;
+
+    auto t0 = high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < vertexCount; i += lanes)
+      program->execute(constants, io, laneMask);
+
+    auto t1 = high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+
+    std::cout << "interpreter: vs_1_1 m4x4, " << lanes << " lane(s) per invocation: "
+              << double(ns.count()) / double(vertexCount) << " ns/vertex" << std::endl;
+  }
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t vertexCount = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-b" && i + 1 < argc)
+      vertexCount = uint32_t(std::max(std::atoi(argv[++i]), 1));
+  }
+
+  checkConstantAnalysis();
+  checkInterpreter();
+
+  if (vertexCount)
+    benchmarkInterpreter(vertexCount);
+
+  if (g_failed) {
+    std::cout << "Some checks failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
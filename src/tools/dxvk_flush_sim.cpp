@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../util/util_flush.h"
+
+using namespace dxvk;
+
+/**
+ * \brief Timeline event type
+ */
+enum class SimEventType : uint32_t {
+  Chunk,    ///< CS chunk recorded, with GPU cost
+  Hint,     ///< Flush hint or synchronization command
+  Flush,    ///< Explicit flush or present
+  Wait,     ///< Application waits for all submitted work
+};
+
+
+/**
+ * \brief Timeline event
+ *
+ * Time stamps are in microseconds and refer to the
+ * application's CPU timeline, without any stalls
+ * caused by waiting for the GPU.
+ */
+struct SimEvent {
+  uint64_t      time;
+  SimEventType  type;
+  GpuFlushType  hint;
+  uint64_t      gpuCost;
+};
+
+
+/**
+ * \brief Expected outcome of a timeline
+ *
+ * Bounds that the adaptive policy must satisfy relative
+ * to the static one. Ratios of zero disable the check.
+ */
+struct SimExpectation {
+  float    minScale     = 0.0f;   ///< Minimum final threshold scale
+  float    maxScale     = 2.0f;   ///< Maximum final threshold scale
+  double   maxTimeRatio = 0.0;    ///< Maximum adaptive/static total time
+  double   maxSyncRatio = 0.0;    ///< Maximum adaptive/static sync time
+};
+
+
+/**
+ * \brief Submission timeline
+ */
+struct SimTimeline {
+  std::string           name;
+  std::vector<SimEvent> events;
+  bool                  hasExpectation = false;
+  SimExpectation        expectation;
+};
+
+
+/**
+ * \brief Simulation parameters
+ */
+struct SimParameters {
+  uint64_t submitCpuCost = 30;  ///< CPU time per submission, in us
+  uint64_t submitGpuCost = 10;  ///< GPU time per submission, in us
+  uint64_t submitLatency = 50;  ///< Time until the GPU can start, in us
+};
+
+
+/**
+ * \brief Simulation results
+ */
+struct SimResult {
+  uint64_t submissions  = 0;
+  uint64_t chunks       = 0;
+  uint64_t totalTime    = 0;
+  uint64_t idleTicks    = 0;
+  uint64_t syncTicks    = 0;
+  float    scale        = 1.0f;
+};
+
+
+/**
+ * \brief Deterministic GPU model
+ *
+ * Replays a timeline through a \c GpuFlushTracker. The GPU executes
+ * submissions in order, each taking the sum of the GPU cost of its
+ * chunks plus a fixed overhead. The application gets delayed by the
+ * CPU cost of each submission and by any explicit waits.
+ */
+class FlushSimulator {
+
+public:
+
+  FlushSimulator(const SimParameters& params, bool adaptive)
+  : m_params(params), m_adaptive(adaptive) { }
+
+  SimResult run(const SimTimeline& timeline) {
+    for (const auto& e : timeline.events) {
+      uint64_t now = e.time + m_cpuDelay;
+
+      switch (e.type) {
+        case SimEventType::Chunk:
+          m_chunkId += 1;
+          m_pendingCost += e.gpuCost;
+          break;
+
+        case SimEventType::Hint:
+          if (m_tracker.considerFlush(e.hint, m_chunkId, getCompletedSubmissions(now)))
+            flush(now);
+          break;
+
+        case SimEventType::Flush:
+          flush(now);
+          break;
+
+        case SimEventType::Wait:
+          flush(now);
+          wait(e.time + m_cpuDelay);
+          break;
+      }
+    }
+
+    SimResult result;
+    result.submissions = m_submissions.size();
+    result.chunks = m_chunkId;
+    result.totalTime = std::max(m_gpuBusyUntil,
+      timeline.events.empty() ? uint64_t(0) : timeline.events.back().time + m_cpuDelay);
+    result.idleTicks = m_idleTicks;
+    result.syncTicks = m_syncTicks;
+    result.scale = m_tracker.getThresholdScale();
+    return result;
+  }
+
+private:
+
+  SimParameters         m_params;
+  bool                  m_adaptive;
+
+  GpuFlushTracker       m_tracker;
+
+  uint64_t              m_chunkId       = 0;
+  uint64_t              m_flushChunkId  = 0;
+  uint64_t              m_pendingCost   = 0;
+
+  uint64_t              m_cpuDelay      = 0;
+  uint64_t              m_gpuBusyUntil  = 0;
+  uint64_t              m_idleTicks     = 0;
+  uint64_t              m_syncTicks     = 0;
+
+  std::vector<uint64_t> m_submissions;
+
+  uint32_t getCompletedSubmissions(uint64_t now) const {
+    auto entry = std::upper_bound(m_submissions.begin(), m_submissions.end(), now);
+    return uint32_t(entry - m_submissions.begin());
+  }
+
+  void flush(uint64_t now) {
+    if (m_chunkId == m_flushChunkId)
+      return;
+
+    m_cpuDelay += m_params.submitCpuCost;
+    now += m_params.submitCpuCost;
+
+    uint64_t gpuStart = std::max(m_gpuBusyUntil, now + m_params.submitLatency);
+    m_idleTicks += gpuStart - m_gpuBusyUntil;
+
+    m_gpuBusyUntil = gpuStart + m_params.submitGpuCost + m_pendingCost;
+    m_submissions.push_back(m_gpuBusyUntil);
+
+    m_flushChunkId = m_chunkId;
+    m_pendingCost = 0;
+
+    m_tracker.notifyFlush(m_chunkId, m_submissions.size());
+
+    if (m_adaptive) {
+      GpuFlushStats stats;
+      stats.time = now;
+      stats.idleTicks = m_idleTicks;
+      stats.syncTicks = m_syncTicks;
+
+      m_tracker.notifyGpuStats(stats);
+    }
+  }
+
+  void wait(uint64_t now) {
+    if (m_gpuBusyUntil <= now)
+      return;
+
+    uint64_t delay = m_gpuBusyUntil - now;
+    m_cpuDelay += delay;
+    m_syncTicks += delay;
+  }
+
+};
+
+
+static bool parseHint(const std::string& str, GpuFlushType& hint) {
+  if (str == "strong")
+    hint = GpuFlushType::ImplicitStrongHint;
+  else if (str == "weak")
+    hint = GpuFlushType::ImplicitWeakHint;
+  else if (str == "sync")
+    hint = GpuFlushType::ImplicitSynchronization;
+  else
+    return false;
+
+  return true;
+}
+
+
+/**
+ * \brief Loads timeline from a text file
+ *
+ * Each line consists of a time stamp in microseconds,
+ * followed by one of the following events:
+ * - \c chunk \c <gpu_cost_us>
+ * - \c hint \c strong|weak|sync
+ * - \c flush
+ * - \c wait
+ * Empty lines and lines starting with \c # are ignored.
+ */
+static bool loadTimeline(const std::string& path, SimTimeline& timeline) {
+  std::ifstream file(path);
+
+  if (!file) {
+    std::cerr << "Failed to open " << path << std::endl;
+    return false;
+  }
+
+  timeline.name = path;
+
+  std::string line;
+  uint32_t lineNumber = 0;
+
+  while (std::getline(file, line)) {
+    lineNumber += 1;
+
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream stream(line);
+    std::string type, arg;
+
+    SimEvent e = { };
+    stream >> e.time >> type;
+
+    bool valid = !stream.fail();
+
+    if (type == "chunk") {
+      e.type = SimEventType::Chunk;
+      valid &= bool(stream >> e.gpuCost);
+    } else if (type == "hint") {
+      e.type = SimEventType::Hint;
+      valid &= bool(stream >> arg) && parseHint(arg, e.hint);
+    } else if (type == "flush") {
+      e.type = SimEventType::Flush;
+    } else if (type == "wait") {
+      e.type = SimEventType::Wait;
+    } else {
+      valid = false;
+    }
+
+    if (!valid || (!timeline.events.empty() && e.time < timeline.events.back().time)) {
+      std::cerr << path << ":" << lineNumber << ": Invalid event" << std::endl;
+      return false;
+    }
+
+    timeline.events.push_back(e);
+  }
+
+  return true;
+}
+
+
+/**
+ * \brief Generates a synthetic timeline
+ *
+ * Records a fixed number of frames, each consisting of a
+ * number of chunks with the given CPU and GPU cost, weak
+ * hints after each chunk, and optional readbacks. The
+ * results are checked against the given expectation.
+ */
+static SimTimeline createTimeline(
+  const std::string&  name,
+        uint32_t      frameCount,
+        uint32_t      chunksPerFrame,
+        uint64_t      cpuCost,
+        uint64_t      gpuCost,
+        uint32_t      readbackInterval,
+  const SimExpectation& expectation) {
+  SimTimeline timeline;
+  timeline.name = name;
+  timeline.hasExpectation = true;
+  timeline.expectation = expectation;
+
+  std::mt19937 rng(chunksPerFrame * 31 + uint32_t(cpuCost + gpuCost));
+  uint64_t time = 0;
+
+  for (uint32_t f = 0; f < frameCount; f++) {
+    for (uint32_t c = 0; c < chunksPerFrame; c++) {
+      time += cpuCost / 2 + rng() % (cpuCost + 1);
+      timeline.events.push_back({ time, SimEventType::Chunk, GpuFlushType::ImplicitWeakHint,
+        gpuCost / 2 + rng() % (gpuCost + 1) });
+
+      if (readbackInterval && (c % readbackInterval) == readbackInterval - 1) {
+        timeline.events.push_back({ time, SimEventType::Hint, GpuFlushType::ImplicitStrongHint, 0 });
+
+        // Applications typically poll for a while before blocking
+        time += cpuCost * 4;
+        timeline.events.push_back({ time, SimEventType::Hint, GpuFlushType::ImplicitSynchronization, 0 });
+        timeline.events.push_back({ time, SimEventType::Wait, GpuFlushType::ImplicitWeakHint, 0 });
+      } else {
+        timeline.events.push_back({ time, SimEventType::Hint, GpuFlushType::ImplicitWeakHint, 0 });
+      }
+    }
+
+    timeline.events.push_back({ time, SimEventType::Flush, GpuFlushType::ExplicitFlush, 0 });
+  }
+
+  return timeline;
+}
+
+
+static void printResult(const char* policy, const SimResult& result) {
+  double total = double(std::max(result.totalTime, uint64_t(1)));
+
+  std::cout << "  " << policy << ": "
+            << result.submissions << " submissions, "
+            << double(result.chunks) / double(std::max(result.submissions, uint64_t(1))) << " chunks/submission, "
+            << double(result.totalTime) / 1000.0 << " ms total, "
+            << 100.0 * double(result.idleTicks) / total << "% idle, "
+            << double(result.syncTicks) / 1000.0 << " ms sync, "
+            << "scale " << result.scale << std::endl;
+}
+
+
+static bool checkRatio(const char* what, uint64_t adaptive, uint64_t base, double maxRatio) {
+  if (maxRatio == 0.0 || double(adaptive) <= double(base) * maxRatio)
+    return true;
+
+  std::cerr << "  FAIL: adaptive " << what << " " << adaptive
+            << " exceeds " << maxRatio << "x static " << base << std::endl;
+  return false;
+}
+
+
+static bool checkResult(const SimExpectation& expectation, const SimResult& base, const SimResult& adaptive) {
+  bool success = true;
+
+  if (adaptive.scale < expectation.minScale || adaptive.scale > expectation.maxScale) {
+    std::cerr << "  FAIL: threshold scale " << adaptive.scale << " not in ["
+              << expectation.minScale << ", " << expectation.maxScale << "]" << std::endl;
+    success = false;
+  }
+
+  success &= checkRatio("total time", adaptive.totalTime, base.totalTime, expectation.maxTimeRatio);
+  success &= checkRatio("sync time",  adaptive.syncTicks, base.syncTicks, expectation.maxSyncRatio);
+  return success;
+}
+
+
+static bool runTimeline(const SimTimeline& timeline, const SimParameters& params) {
+  std::cout << timeline.name << ":" << std::endl;
+
+  SimResult base = FlushSimulator(params, false).run(timeline);
+  SimResult adaptive = FlushSimulator(params, true).run(timeline);
+
+  printResult("static  ", base);
+  printResult("adaptive", adaptive);
+
+  return !timeline.hasExpectation
+      || checkResult(timeline.expectation, base, adaptive);
+}
+
+
+int main(int argc, char** argv) {
+  SimParameters params;
+  std::vector<SimTimeline> timelines;
+
+  for (int i = 1; i < argc; i++) {
+    SimTimeline timeline;
+
+    if (!loadTimeline(argv[i], timeline))
+      return EXIT_FAILURE;
+
+    timelines.push_back(std::move(timeline));
+  }
+
+  if (timelines.empty()) {
+    // A saturated GPU should batch more work without losing throughput,
+    // a GPU starved by a slow application should not get more submissions,
+    // and an application waiting for the GPU should flush earlier.
+    timelines.push_back(createTimeline("gpu-bound", 200, 40,  50, 400, 0,  { 1.5f, 2.0f,  1.01, 0.0 }));
+    timelines.push_back(createTimeline("cpu-bound", 200, 40, 200,  50, 0,  { 1.0f, 1.25f, 1.0,  0.0 }));
+    timelines.push_back(createTimeline("balanced",  200, 40, 100, 100, 0,  { 1.25f, 2.0f, 1.0,  0.0 }));
+    timelines.push_back(createTimeline("readback",  200, 40, 100, 100, 10, { 0.5f, 0.75f, 1.0,  0.9 }));
+  }
+
+  bool success = true;
+
+  for (const auto& timeline : timelines)
+    success &= runTimeline(timeline, params);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
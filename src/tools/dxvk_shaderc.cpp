@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../dxbc/dxbc_module.h"
+#include "../dxbc/dxbc_reader.h"
+
+#include "../dxso/dxso_analysis.h"
+#include "../dxso/dxso_module.h"
+#include "../dxso/dxso_reader.h"
+
+#include "../spirv/spirv_compression.h"
+
+#include "../d3d9/d3d9_caps.h"
+
+#include "../util/thread.h"
+#include "../util/util_time.h"
+
+using namespace dxvk;
+
+namespace fs = std::filesystem;
+
+/**
+ * \brief Compression benchmark result
+ */
+struct CompressionResult {
+  size_t                    size = 0;
+  std::chrono::nanoseconds  encode = { };
+  std::chrono::nanoseconds  decode = { };
+};
+
+constexpr std::array<SpirvCompressionCodec, 2> BenchCodecs = {
+  SpirvCompressionCodec::Block,
+  SpirvCompressionCodec::Delta,
+};
+
+constexpr std::array<const char*, 2> BenchCodecNames = {
+  "block", "delta",
+};
+
+
+/**
+ * \brief Translation result for a single shader
+ */
+struct ShaderResult {
+  std::string               name;
+  std::string               type;
+  std::string               error;
+  std::chrono::nanoseconds  decode = { };
+  DxvkShaderCompileTimings  timings;
+  size_t                    codeSize = 0;
+  std::array<CompressionResult, BenchCodecs.size()> compression;
+};
+
+
+/**
+ * \brief Tool options
+ */
+struct ToolOptions {
+  fs::path                  inputDir;
+  fs::path                  outputDir;
+  fs::path                  reportFile;
+  uint32_t                  threadCount = 0;
+  bool                      benchCompression = false;
+};
+
+
+static void printUsage() {
+  std::cerr << "Usage: dxvk-shaderc [-o outdir] [-r report.csv] [-j threads] [-c] <indir>" << std::endl
+            << std::endl
+            << "Translates all .dxbc and .dxso files found in the given directory, as" << std::endl
+            << "written by the dxvk.shaderDumpPath option, to SPIR-V and reports the" << std::endl
+            << "time spent in each compiler pass in CSV format." << std::endl
+            << std::endl
+            << "  -o outdir       Write SPIR-V binaries to the given directory" << std::endl
+            << "  -r report.csv   Write the report to a file instead of stdout" << std::endl
+            << "  -j threads      Number of worker threads, defaults to all cores" << std::endl
+            << "  -c              Benchmark SPIR-V compression codecs" << std::endl;
+}
+
+
+static const char* getDxbcTypeName(DxbcProgramType type) {
+  switch (type) {
+    case DxbcProgramType::PixelShader:    return "ps";
+    case DxbcProgramType::VertexShader:   return "vs";
+    case DxbcProgramType::GeometryShader: return "gs";
+    case DxbcProgramType::HullShader:     return "hs";
+    case DxbcProgramType::DomainShader:   return "ds";
+    case DxbcProgramType::ComputeShader:  return "cs";
+  }
+
+  return "unknown";
+}
+
+
+static std::vector<char> readFile(const fs::path& path) {
+  std::ifstream file(path, std::ios_base::binary);
+
+  if (!file)
+    throw DxvkError(str::format("Failed to open ", path.string()));
+
+  return std::vector<char>(
+    std::istreambuf_iterator<char>(file),
+    std::istreambuf_iterator<char>());
+}
+
+
+static Rc<DxvkShader> compileDxbc(
+  const std::vector<char>&          bytecode,
+  const std::string&                name,
+        ShaderResult&               result) {
+  auto t0 = high_resolution_clock::now();
+
+  DxbcReader reader(bytecode.data(), bytecode.size());
+  DxbcModule module(reader);
+
+  auto programInfo = module.programInfo();
+
+  if (!programInfo)
+    throw DxvkError("Invalid shader binary");
+
+  result.decode = high_resolution_clock::now() - t0;
+  result.type = getDxbcTypeName(programInfo->type());
+
+  // Device-specific options are not known offline, so this
+  // uses the most conservative compiler options available.
+  DxbcModuleInfo moduleInfo;
+  moduleInfo.options = DxbcOptions();
+  moduleInfo.options.minSsboAlignment = 256;
+  moduleInfo.tess = nullptr;
+  moduleInfo.xfb  = nullptr;
+
+  return module.compile(moduleInfo, name, &result.timings);
+}
+
+
+static Rc<DxvkShader> compileDxso(
+  const std::vector<char>&          bytecode,
+  const std::string&                name,
+        ShaderResult&               result) {
+  auto t0 = high_resolution_clock::now();
+
+  DxsoReader reader(bytecode.data());
+  DxsoModule module(reader);
+
+  auto t1 = high_resolution_clock::now();
+
+  DxsoAnalysisInfo analysis = module.analyze();
+
+  auto t2 = high_resolution_clock::now();
+
+  result.decode = t1 - t0;
+  result.type = module.info().type() == DxsoProgramTypes::VertexShader ? "vs" : "ps";
+
+  if (analysis.bytecodeByteLength > bytecode.size())
+    throw DxvkError("Truncated shader binary");
+
+  DxsoModuleInfo moduleInfo;
+  moduleInfo.options.strictConstantCopies = false;
+  moduleInfo.options.d3d9FloatEmulation = D3D9FloatEmulation::Enabled;
+  moduleInfo.options.strictPow = true;
+  moduleInfo.options.shaderModel = 3;
+  moduleInfo.options.invariantPosition = true;
+  moduleInfo.options.forceSamplerTypeSpecConstants = false;
+  moduleInfo.options.forceSampleRateShading = false;
+  moduleInfo.options.vertexFloatConstantBufferAsSSBO = false;
+  moduleInfo.options.longMad = false;
+  moduleInfo.options.robustness2Supported = true;
+
+  // Use the hardware vertex processing constant layout
+  D3D9ConstantLayout layout;
+
+  if (module.info().type() == DxsoProgramTypes::VertexShader) {
+    layout.floatCount = caps::MaxFloatConstantsVS;
+    layout.intCount   = caps::MaxOtherConstants;
+    layout.boolCount  = caps::MaxOtherConstants;
+  } else {
+    layout.floatCount = caps::MaxFloatConstantsPS;
+    layout.intCount   = caps::MaxOtherConstants;
+    layout.boolCount  = caps::MaxOtherConstants;
+  }
+
+  layout.bitmaskCount = align(layout.boolCount, 32) / 32;
+
+  Rc<DxvkShader> shader = module.compile(moduleInfo, name, analysis, layout, &result.timings);
+  result.timings.analyze = t2 - t1;
+  return shader;
+}
+
+
+static void benchCompression(
+        SpirvCodeBuffer&            code,
+        ShaderResult&               result) {
+  for (size_t i = 0; i < BenchCodecs.size(); i++) {
+    auto t0 = high_resolution_clock::now();
+    SpirvCompressedBuffer compressed(code, BenchCodecs[i]);
+
+    auto t1 = high_resolution_clock::now();
+    SpirvCodeBuffer decompressed = compressed.decompress();
+
+    auto t2 = high_resolution_clock::now();
+
+    if (decompressed.size() != code.size()
+     || std::memcmp(decompressed.data(), code.data(), code.size()))
+      throw DxvkError(str::format("Compression mismatch with codec ", BenchCodecNames[i]));
+
+    result.compression[i].size   = compressed.compressedSize();
+    result.compression[i].encode = t1 - t0;
+    result.compression[i].decode = t2 - t1;
+  }
+}
+
+
+static void processShader(
+  const ToolOptions&                options,
+  const fs::path&                   path,
+        ShaderResult&               result) {
+  result.name = path.stem().string();
+
+  try {
+    std::vector<char> bytecode = readFile(path);
+    Rc<DxvkShader> shader;
+
+    if (path.extension() == ".dxbc")
+      shader = compileDxbc(bytecode, result.name, result);
+    else
+      shader = compileDxso(bytecode, result.name, result);
+
+    SpirvCodeBuffer code = shader->getRawCode();
+    result.codeSize = code.size();
+
+    if (options.benchCompression)
+      benchCompression(code, result);
+
+    if (!options.outputDir.empty()) {
+      std::ofstream file(options.outputDir / (result.name + ".spv"),
+        std::ios_base::binary | std::ios_base::trunc);
+      code.store(file);
+    }
+  } catch (const DxvkError& e) {
+    result.error = e.message();
+  }
+}
+
+
+static void writeReport(
+        std::ostream&               stream,
+  const std::vector<ShaderResult>&  results) {
+  stream << "name,type,decode_ns,analyze_ns,compile_ns,finalize_ns,spirv_ns,spirv_bytes,error" << std::endl;
+
+  for (const auto& r : results) {
+    stream << r.name << ","
+           << r.type << ","
+           << r.decode.count() << ","
+           << r.timings.analyze.count() << ","
+           << r.timings.compile.count() << ","
+           << r.timings.finalize.count() << ","
+           << r.timings.spirv.count() << ","
+           << r.codeSize << ","
+           << r.error << std::endl;
+  }
+}
+
+
+static void printCompressionSummary(
+  const std::vector<ShaderResult>&  results) {
+  size_t totalSize = 0;
+
+  for (const auto& r : results)
+    totalSize += r.codeSize;
+
+  if (!totalSize)
+    return;
+
+  for (size_t i = 0; i < BenchCodecs.size(); i++) {
+    CompressionResult total;
+
+    for (const auto& r : results) {
+      total.size   += r.compression[i].size;
+      total.encode += r.compression[i].encode;
+      total.decode += r.compression[i].decode;
+    }
+
+    // Throughput is given in terms of uncompressed bytes
+    auto getThroughput = [totalSize] (std::chrono::nanoseconds time) {
+      return time.count() ? double(totalSize) * 1000.0 / double(time.count()) : 0.0;
+    };
+
+    std::cerr << BenchCodecNames[i] << ": "
+              << (100.0 * double(total.size) / double(totalSize)) << "% of "
+              << (totalSize >> 10) << " kB, compress "
+              << getThroughput(total.encode) << " MB/s, decompress "
+              << getThroughput(total.decode) << " MB/s" << std::endl;
+  }
+}
+
+
+static bool parseArgs(int argc, char** argv, ToolOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-o" && i + 1 < argc)
+      options.outputDir = argv[++i];
+    else if (arg == "-r" && i + 1 < argc)
+      options.reportFile = argv[++i];
+    else if (arg == "-c")
+      options.benchCompression = true;
+    else if (arg == "-j" && i + 1 < argc)
+      options.threadCount = uint32_t(std::max(std::atoi(argv[++i]), 0));
+    else if (arg[0] != '-' && options.inputDir.empty())
+      options.inputDir = arg;
+    else
+      return false;
+  }
+
+  return !options.inputDir.empty();
+}
+
+
+int main(int argc, char** argv) {
+  ToolOptions options;
+
+  if (!parseArgs(argc, argv, options)) {
+    printUsage();
+    return 1;
+  }
+
+  std::error_code ec;
+  std::vector<fs::path> files;
+
+  for (const auto& entry : fs::directory_iterator(options.inputDir, ec)) {
+    auto ext = entry.path().extension();
+
+    if (entry.is_regular_file() && (ext == ".dxbc" || ext == ".dxso"))
+      files.push_back(entry.path());
+  }
+
+  if (ec) {
+    std::cerr << "Failed to read " << options.inputDir << ": " << ec.message() << std::endl;
+    return 1;
+  }
+
+  std::sort(files.begin(), files.end());
+
+  if (!options.outputDir.empty())
+    fs::create_directories(options.outputDir, ec);
+
+  if (!options.threadCount)
+    options.threadCount = std::max(dxvk::thread::hardware_concurrency(), 1u);
+
+  // Distribute shaders across worker threads. Each
+  // result has its own slot so no locking is needed.
+  std::vector<ShaderResult> results(files.size());
+  std::vector<dxvk::thread> threads;
+  std::atomic<size_t> nextIndex = { 0u };
+
+  auto t0 = high_resolution_clock::now();
+
+  for (uint32_t i = 0; i < std::min<size_t>(options.threadCount, files.size()); i++) {
+    threads.emplace_back([&] {
+      size_t index;
+
+      while ((index = nextIndex++) < files.size())
+        processShader(options, files[index], results[index]);
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  auto t1 = high_resolution_clock::now();
+
+  if (!options.reportFile.empty()) {
+    std::ofstream file(options.reportFile, std::ios_base::trunc);
+    writeReport(file, results);
+  } else {
+    writeReport(std::cout, results);
+  }
+
+  // Print a short summary
+  std::chrono::nanoseconds cpuTime = { };
+  size_t errorCount = 0;
+
+  for (const auto& r : results) {
+    cpuTime += r.decode + r.timings.analyze + r.timings.compile
+             + r.timings.finalize + r.timings.spirv;
+    errorCount += r.error.empty() ? 0 : 1;
+  }
+
+  auto wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0);
+
+  std::cerr << "Translated " << (results.size() - errorCount) << " shaders"
+            << " (" << errorCount << " failed) using " << threads.size() << " threads"
+            << " in " << wallTime.count() << " ms"
+            << " (" << std::chrono::duration_cast<std::chrono::milliseconds>(cpuTime).count() << " ms CPU)"
+            << std::endl;
+
+  if (options.benchCompression)
+    printCompressionSummary(results);
+
+  return errorCount ? 2 : 0;
+}
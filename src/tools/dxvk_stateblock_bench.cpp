@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../d3d9/d3d9_stateblock.h"
+
+#include "../util/util_time.h"
+
+using namespace dxvk;
+
+/**
+ * \brief Device stand-in
+ *
+ * Implements the setters used by state blocks on top of a plain
+ * device state object. Each call takes a lock and compares against
+ * the current value before marking state as dirty, which roughly
+ * matches the fixed per-call overhead of the actual device.
+ */
+class BenchDevice {
+
+public:
+
+  BenchDevice()
+  : m_state(std::make_unique<D3D9DeviceState>()) { }
+
+  D3D9DeviceState* state() {
+    return m_state.get();
+  }
+
+  uint64_t calls() const {
+    return m_calls;
+  }
+
+  uint64_t dirty() const {
+    return m_dirty;
+  }
+
+  HRESULT SetStreamSourceFreq(UINT StreamNumber, UINT Setting) {
+    auto lock = beginCall();
+    return update(m_state->streamFreq[StreamNumber], Setting);
+  }
+
+  HRESULT SetIndices(D3D9IndexBuffer* pIndexData) {
+    auto lock = beginCall();
+    return D3D_OK;
+  }
+
+  HRESULT SetRenderState(D3DRENDERSTATETYPE State, DWORD Value) {
+    auto lock = beginCall();
+    return update(m_state->renderStates[State], Value);
+  }
+
+  HRESULT SetStateSamplerState(DWORD StateSampler, D3DSAMPLERSTATETYPE Type, DWORD Value) {
+    auto lock = beginCall();
+    return update(m_state->samplerStates[StateSampler][Type], Value);
+  }
+
+  HRESULT SetStreamSource(UINT StreamNumber, D3D9VertexBuffer* pStreamData, UINT OffsetInBytes, UINT Stride) {
+    auto lock = beginCall();
+    update(m_state->vertexBuffers[StreamNumber].offset, OffsetInBytes);
+    return update(m_state->vertexBuffers[StreamNumber].stride, Stride);
+  }
+
+  HRESULT SetMaterial(const D3DMATERIAL9* pMaterial) {
+    auto lock = beginCall();
+    m_state->material = *pMaterial;
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetStateTexture(DWORD StateSampler, IDirect3DBaseTexture9* pTexture) {
+    auto lock = beginCall();
+    return update(m_state->textures[StateSampler], pTexture);
+  }
+
+  HRESULT SetVertexShader(D3D9VertexShader* pShader) {
+    auto lock = beginCall();
+    return D3D_OK;
+  }
+
+  HRESULT SetPixelShader(D3D9PixelShader* pShader) {
+    auto lock = beginCall();
+    return D3D_OK;
+  }
+
+  HRESULT SetStateTransform(uint32_t idx, const D3DMATRIX* pMatrix) {
+    auto lock = beginCall();
+    m_state->transforms[idx] = ConvertMatrix(pMatrix);
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetStateTextureStageState(DWORD Stage, D3D9TextureStageStateTypes Type, DWORD Value) {
+    auto lock = beginCall();
+    return update(m_state->textureStages[Stage][Type], Value);
+  }
+
+  HRESULT SetViewport(const D3DVIEWPORT9* pViewport) {
+    auto lock = beginCall();
+    m_state->viewport = *pViewport;
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetScissorRect(const RECT* pRect) {
+    auto lock = beginCall();
+    m_state->scissorRect = *pRect;
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetClipPlane(DWORD Index, const float* pPlane) {
+    auto lock = beginCall();
+    std::memcpy(m_state->clipPlanes[Index].coeff, pPlane, sizeof(m_state->clipPlanes[Index].coeff));
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetVertexShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Count) {
+    auto lock = beginCall();
+    std::memcpy(m_state->vsConsts->fConsts[StartRegister].data, pConstantData, Count * sizeof(Vector4));
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetVertexShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Count) {
+    auto lock = beginCall();
+    std::memcpy(m_state->vsConsts->iConsts[StartRegister].data, pConstantData, Count * sizeof(Vector4i));
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetPixelShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Count) {
+    auto lock = beginCall();
+    std::memcpy(m_state->psConsts->fConsts[StartRegister].data, pConstantData, Count * sizeof(Vector4));
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  HRESULT SetPixelShaderConstantI(UINT StartRegister, const int* pConstantData, UINT Count) {
+    auto lock = beginCall();
+    std::memcpy(m_state->psConsts->iConsts[StartRegister].data, pConstantData, Count * sizeof(Vector4i));
+    m_dirty += 1;
+    return D3D_OK;
+  }
+
+  void SetVertexBoolBitfield(uint32_t idx, uint32_t mask, uint32_t bits) {
+    auto lock = beginCall();
+    m_state->vsConsts->bConsts[idx] = (m_state->vsConsts->bConsts[idx] & ~mask) | (bits & mask);
+    m_dirty += 1;
+  }
+
+  void SetPixelBoolBitfield(uint32_t idx, uint32_t mask, uint32_t bits) {
+    auto lock = beginCall();
+    m_state->psConsts->bConsts[idx] = (m_state->psConsts->bConsts[idx] & ~mask) | (bits & mask);
+    m_dirty += 1;
+  }
+
+  HRESULT SetLight(DWORD Index, const D3DLIGHT9* pLight) {
+    auto lock = beginCall();
+    return D3D_OK;
+  }
+
+  HRESULT LightEnable(DWORD Index, BOOL Enable) {
+    auto lock = beginCall();
+    return D3D_OK;
+  }
+
+private:
+
+  std::unique_ptr<D3D9DeviceState> m_state;
+
+  sync::RecursiveSpinlock m_mutex;
+
+  uint64_t m_calls = 0;
+  uint64_t m_dirty = 0;
+
+  std::unique_lock<sync::RecursiveSpinlock> beginCall() {
+    m_calls += 1;
+    return std::unique_lock<sync::RecursiveSpinlock>(m_mutex);
+  }
+
+  template <typename T>
+  HRESULT update(T& dst, T value) {
+    if (dst != value) {
+      dst = value;
+      m_dirty += 1;
+    }
+
+    return D3D_OK;
+  }
+
+};
+
+
+/**
+ * \brief Applies captured state by walking the capture bitsets
+ *
+ * Reference implementation that sets state one value or
+ * constant register at a time, without any comparisons.
+ */
+static void applyBitsets(BenchDevice* dst, const D3D9CapturableState* src, const D3D9StateCaptures& captures) {
+  if (captures.flags.test(D3D9CapturedStateFlag::StreamFreq)) {
+    for (uint32_t idx : bit::BitMask(captures.streamFreq.dword(0)))
+      dst->SetStreamSourceFreq(idx, src->streamFreq[idx]);
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::RenderStates)) {
+    for (uint32_t i = 0; i < captures.renderStates.dwordCount(); i++) {
+      for (uint32_t rs : bit::BitMask(captures.renderStates.dword(i)))
+        dst->SetRenderState(D3DRENDERSTATETYPE(i * 32 + rs), src->renderStates[i * 32 + rs]);
+    }
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::SamplerStates)) {
+    for (uint32_t samplerIdx : bit::BitMask(captures.samplers.dword(0))) {
+      for (uint32_t stateIdx : bit::BitMask(captures.samplerStates[samplerIdx].dword(0)))
+        dst->SetStateSamplerState(samplerIdx, D3DSAMPLERSTATETYPE(stateIdx), src->samplerStates[samplerIdx][stateIdx]);
+    }
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::Textures)) {
+    for (uint32_t idx : bit::BitMask(captures.textures.dword(0)))
+      dst->SetStateTexture(idx, src->textures[idx]);
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::Transforms)) {
+    for (uint32_t i = 0; i < captures.transforms.dwordCount(); i++) {
+      for (uint32_t trans : bit::BitMask(captures.transforms.dword(i))) {
+        uint32_t idx = i * 32 + trans;
+        dst->SetStateTransform(idx, reinterpret_cast<const D3DMATRIX*>(&src->transforms[idx]));
+      }
+    }
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::TextureStages)) {
+    for (uint32_t stageIdx : bit::BitMask(captures.textureStages.dword(0))) {
+      for (uint32_t stateIdx : bit::BitMask(captures.textureStageStates[stageIdx].dword(0)))
+        dst->SetStateTextureStageState(stageIdx, D3D9TextureStageStateTypes(stateIdx), src->textureStages[stageIdx][stateIdx]);
+    }
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::VsConstants)) {
+    for (uint32_t i = 0; i < captures.vsConsts.fConsts.dwordCount(); i++) {
+      for (uint32_t consts : bit::BitMask(captures.vsConsts.fConsts.dword(i))) {
+        uint32_t idx = i * 32 + consts;
+        dst->SetVertexShaderConstantF(idx, src->vsConsts->fConsts[idx].data, 1);
+      }
+    }
+
+    for (uint32_t i = 0; i < captures.vsConsts.bConsts.dwordCount(); i++)
+      dst->SetVertexBoolBitfield(i, captures.vsConsts.bConsts.dword(i), src->vsConsts->bConsts[i]);
+  }
+
+  if (captures.flags.test(D3D9CapturedStateFlag::PsConstants)) {
+    for (uint32_t i = 0; i < captures.psConsts.fConsts.dwordCount(); i++) {
+      for (uint32_t consts : bit::BitMask(captures.psConsts.fConsts.dword(i))) {
+        uint32_t idx = i * 32 + consts;
+        dst->SetPixelShaderConstantF(idx, src->psConsts->fConsts[idx].data, 1);
+      }
+    }
+
+    for (uint32_t i = 0; i < captures.psConsts.bConsts.dwordCount(); i++)
+      dst->SetPixelBoolBitfield(i, captures.psConsts.bConsts.dword(i), src->psConsts->bConsts[i]);
+  }
+}
+
+
+/**
+ * \brief Benchmark scenario
+ *
+ * Two state blocks that capture the same set of state
+ * with different values, so that alternating between
+ * them changes every captured value.
+ */
+struct BenchScenario {
+  std::string         name;
+  D3D9StateCaptures   captures;
+  D3D9CapturableState states[2];
+};
+
+
+static void fillState(D3D9CapturableState& state, uint32_t seed) {
+  for (uint32_t i = 0; i < RenderStateCount; i++)
+    state.renderStates[i] = seed + i;
+
+  for (uint32_t i = 0; i < SamplerCount; i++) {
+    for (uint32_t j = 0; j < SamplerStateCount; j++)
+      state.samplerStates[i][j] = seed + j;
+  }
+
+  for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+    for (uint32_t j = 0; j < TextureStageStateCount; j++)
+      state.textureStages[i][j] = seed + j;
+  }
+
+  for (uint32_t i = 0; i < caps::MaxTransforms; i++)
+    state.transforms[i] = Matrix4(float(seed + i));
+
+  for (uint32_t i = 0; i < caps::MaxFloatConstantsSoftware; i++)
+    state.vsConsts->fConsts[i] = Vector4(float(seed + i));
+
+  for (uint32_t i = 0; i < caps::MaxFloatConstantsPS; i++)
+    state.psConsts->fConsts[i] = Vector4(float(seed + i));
+
+  for (uint32_t i = 0; i < caps::MaxOtherConstantsSoftware / 32; i++)
+    state.vsConsts->bConsts[i] = seed ? ~0u : 0u;
+
+  state.psConsts->bConsts[0] = seed ? ~0u : 0u;
+}
+
+
+/**
+ * \brief Captures everything, like a D3DSBT_ALL block
+ */
+static std::unique_ptr<BenchScenario> createAllScenario() {
+  auto scenario = std::make_unique<BenchScenario>();
+  scenario->name = "all";
+
+  auto& c = scenario->captures;
+  c.flags.set(D3D9CapturedStateFlag::RenderStates,
+              D3D9CapturedStateFlag::SamplerStates,
+              D3D9CapturedStateFlag::Transforms,
+              D3D9CapturedStateFlag::TextureStages,
+              D3D9CapturedStateFlag::VsConstants,
+              D3D9CapturedStateFlag::PsConstants);
+
+  for (uint32_t i = D3DRS_ZENABLE; i < RenderStateCount; i++)
+    c.renderStates.set(i, true);
+
+  for (uint32_t i = 0; i < SamplerCount; i++) {
+    c.samplers.set(i, true);
+
+    for (uint32_t j = D3DSAMP_ADDRESSU; j < SamplerStateCount; j++)
+      c.samplerStates[i].set(j, true);
+  }
+
+  c.transforms.setAll();
+  c.textureStages.setAll();
+
+  for (auto& stage : c.textureStageStates)
+    stage.setAll();
+
+  c.vsConsts.fConsts.setN(caps::MaxFloatConstantsVS);
+  c.vsConsts.bConsts.setN(caps::MaxOtherConstants);
+  c.psConsts.fConsts.setAll();
+  c.psConsts.bConsts.setAll();
+  return scenario;
+}
+
+
+/**
+ * \brief Captures a handful of values, like a typical recorded block
+ */
+static std::unique_ptr<BenchScenario> createRecordedScenario() {
+  auto scenario = std::make_unique<BenchScenario>();
+  scenario->name = "recorded";
+
+  auto& c = scenario->captures;
+  c.flags.set(D3D9CapturedStateFlag::RenderStates,
+              D3D9CapturedStateFlag::SamplerStates,
+              D3D9CapturedStateFlag::Transforms,
+              D3D9CapturedStateFlag::VsConstants,
+              D3D9CapturedStateFlag::PsConstants);
+
+  for (uint32_t rs : { D3DRS_ZENABLE, D3DRS_ZWRITEENABLE, D3DRS_ALPHABLENDENABLE,
+                       D3DRS_SRCBLEND, D3DRS_DESTBLEND, D3DRS_CULLMODE })
+    c.renderStates.set(rs, true);
+
+  for (uint32_t i = 0; i < 2; i++) {
+    c.samplers.set(i, true);
+    c.samplerStates[i].set(D3DSAMP_MINFILTER, true);
+    c.samplerStates[i].set(D3DSAMP_MAGFILTER, true);
+  }
+
+  c.transforms.set(GetTransformIndex(D3DTS_WORLD), true);
+
+  for (uint32_t i = 0; i < 8; i++)
+    c.vsConsts.fConsts.set(i, true);
+
+  for (uint32_t i = 0; i < 4; i++) {
+    c.vsConsts.fConsts.set(20 + i, true);
+    c.psConsts.fConsts.set(i, true);
+  }
+
+  return scenario;
+}
+
+
+template <typename Fn>
+static void runVariant(const char* name, const BenchScenario& scenario, uint32_t iterations, bool alternate, const Fn& fn) {
+  BenchDevice device;
+
+  auto t0 = high_resolution_clock::now();
+
+  for (uint32_t i = 0; i < iterations; i++)
+    fn(device, scenario.states[alternate ? (i & 1) : 0]);
+
+  auto t1 = high_resolution_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0);
+
+  std::cout << "  " << name << ": "
+            << double(ns.count()) / double(iterations) << " ns/apply, "
+            << double(device.calls()) / double(iterations) << " calls/apply, "
+            << double(device.dirty()) / double(iterations) << " changes/apply" << std::endl;
+}
+
+
+static void runScenario(BenchScenario& scenario, uint32_t iterations) {
+  fillState(scenario.states[0], 0);
+  fillState(scenario.states[1], 1);
+
+  D3D9StateProgram program;
+  program.Compile(scenario.captures);
+
+  for (bool alternate : { true, false }) {
+    std::cout << scenario.name << (alternate ? " (changing):" : " (redundant):") << std::endl;
+
+    runVariant("bitsets ", scenario, iterations, alternate,
+      [&] (BenchDevice& device, const D3D9CapturableState& state) {
+        applyBitsets(&device, &state, scenario.captures);
+      });
+
+    runVariant("program ", scenario, iterations, alternate,
+      [&] (BenchDevice& device, const D3D9CapturableState& state) {
+        program.Execute(&device, &state, nullptr);
+      });
+
+    runVariant("filtered", scenario, iterations, alternate,
+      [&] (BenchDevice& device, const D3D9CapturableState& state) {
+        program.Execute(&device, &state, device.state());
+      });
+  }
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t iterations = argc > 1 ? uint32_t(std::max(std::atoi(argv[1]), 1)) : 10000;
+
+  runScenario(*createAllScenario(), iterations);
+  runScenario(*createRecordedScenario(), iterations);
+  return 0;
+}
@@ -151,6 +151,23 @@ namespace dxvk::bit {
     #endif
   }
 
+  inline uint32_t lzcnt(uint64_t n) {
+    #if defined(DXVK_ARCH_X86_64) && ((defined(_MSC_VER) && !defined(__clang__)) || defined(__LZCNT__))
+    return (uint32_t)_lzcnt_u64(n);
+    #elif defined(__GNUC__) || defined(__clang__)
+    return n != 0 ? __builtin_clzll(n) : 64;
+    #else
+    uint32_t hi = uint32_t(n >> 32);
+
+    if (hi) {
+      return lzcnt(hi);
+    } else {
+      uint32_t lo = uint32_t(n);
+      return lzcnt(lo) + 32;
+    }
+    #endif
+  }
+
   template<typename T>
   uint32_t pack(T& dst, uint32_t& shift, T src, uint32_t count) {
     constexpr uint32_t Bits = 8 * sizeof(T);
@@ -310,11 +327,15 @@ namespace dxvk::bit {
       return m_dwords[idx];
     }
 
-    constexpr size_t bitCount() {
+    constexpr uint32_t dword(uint32_t idx) const {
+      return m_dwords[idx];
+    }
+
+    constexpr size_t bitCount() const {
       return Bits;
     }
 
-    constexpr size_t dwordCount() {
+    constexpr size_t dwordCount() const {
       return Dwords;
     }
 
@@ -417,6 +438,10 @@ namespace dxvk::bit {
       return m_dwords[idx];
     }
 
+    uint32_t dword(uint32_t idx) const {
+      return m_dwords[idx];
+    }
+
     size_t bitCount() const {
       return m_bitCount;
     }
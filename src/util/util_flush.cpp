@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+
 #include "util_flush.h"
 
 namespace dxvk {
@@ -34,13 +37,13 @@ namespace dxvk {
 
       case GpuFlushType::ImplicitStrongHint: {
         // Flush aggressively with a strong hint to reduce readback latency.
-        return chunkCount >= minChunkCount;
+        return chunkCount >= scaleChunkCount(minChunkCount);
       }
 
       case GpuFlushType::ImplicitWeakHint: {
         // Aim for a higher number of chunks per submission with
         // a weak hint in order to avoid submitting too often.
-        if (chunkCount < 2 * minChunkCount)
+        if (chunkCount < scaleChunkCount(2 * minChunkCount))
           return false;
 
         // Actual heuristic is shared with synchronization commands
@@ -58,7 +61,7 @@ namespace dxvk {
         // than ignoring the minimum chunk count condition, we should treat this
         // the same as weak hints to avoid unnecessary synchronization.
         uint32_t threshold = std::min(maxChunkCount, pendingSubmissions * minChunkCount);
-        return chunkCount >= threshold;
+        return chunkCount >= scaleChunkCount(threshold);
       }
     }
 
@@ -76,4 +79,47 @@ namespace dxvk {
     m_lastFlushSubmissionId = submissionId;
   }
 
+
+  void GpuFlushTracker::notifyGpuStats(
+    const GpuFlushStats&        stats) {
+    if (!m_hasStats || stats.time < m_lastStats.time) {
+      m_lastStats = stats;
+      m_hasStats = true;
+      return;
+    }
+
+    uint64_t elapsed = stats.time - m_lastStats.time;
+
+    if (elapsed < SampleInterval)
+      return;
+
+    // Compute the fraction of time during which the GPU had no work
+    // to do, as well as the fraction of time the application spent
+    // waiting for the GPU.
+    float idle = float(stats.idleTicks - m_lastStats.idleTicks) / float(elapsed);
+    float sync = float(stats.syncTicks - m_lastStats.syncTicks) / float(elapsed);
+
+    m_gpuIdle += (std::clamp(idle, 0.0f, 1.0f) - m_gpuIdle) * 0.25f;
+    m_gpuSync += (std::clamp(sync, 0.0f, 1.0f) - m_gpuSync) * 0.25f;
+    m_lastStats = stats;
+
+    // Batch up to twice as much work per submission while the GPU is
+    // saturated. GPU idle time on its own does not mean that flushing
+    // earlier would help, since the application may simply be CPU-bound,
+    // in which case more submissions only add overhead. Only flush more
+    // often if the application also waits for the GPU, which means that
+    // work it depends on was held back in an unflushed command list.
+    float batchScale = std::clamp(2.0f - 16.0f * m_gpuIdle, 1.0f, 2.0f);
+    float syncScale = std::clamp(1.0f - 8.0f * m_gpuSync, 0.25f, 1.0f);
+
+    m_thresholdScale = std::clamp(batchScale * syncScale, 0.5f, 2.0f);
+  }
+
+
+  uint32_t GpuFlushTracker::scaleChunkCount(
+          uint32_t              chunkCount) const {
+    float scaled = std::round(float(chunkCount) * m_thresholdScale);
+    return std::max(uint32_t(scaled), 1u);
+  }
+
 }
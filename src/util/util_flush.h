@@ -24,14 +24,40 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief GPU load sample
+   *
+   * Accumulated GPU idle time and time spent by the
+   * application waiting for the GPU, sampled at a given
+   * point in time. All values are in microseconds and
+   * are expected to increase monotonically.
+   */
+  struct GpuFlushStats {
+    uint64_t time       = 0ull;   ///< Time at which the sample was taken
+    uint64_t idleTicks  = 0ull;   ///< Accumulated GPU idle time
+    uint64_t syncTicks  = 0ull;   ///< Accumulated GPU synchronization time
+  };
+
+
   /**
    * \brief GPU flush tracker
    *
    * Helper class that implements a context flush
    * heuristic for various scenarios.
+   *
+   * Chunk count thresholds are scaled based on measured GPU load:
+   * if the application frequently waits for the GPU, the tracker
+   * flushes earlier so that the work it waits on gets submitted
+   * sooner. If the GPU is saturated, it batches more work per
+   * submission to reduce submission overhead. GPU idle time alone
+   * keeps the baseline, since it also occurs when the application
+   * is CPU-bound, where more submissions would only hurt. The
+   * tracker does not query any timers itself, so that decisions
+   * are fully deterministic for a given sequence of inputs.
    */
   class GpuFlushTracker {
-
+    /** Minimum interval between GPU load samples, in us */
+    constexpr static uint64_t SampleInterval = 8000ull;
   public:
 
     /**
@@ -59,6 +85,28 @@ namespace dxvk {
             uint64_t              chunkId,
             uint64_t              submissionId);
 
+    /**
+     * \brief Updates GPU load estimate
+     *
+     * Samples that are taken within a short interval after
+     * the previous sample are ignored, so this may be called
+     * on every flush.
+     * \param [in] stats Current GPU load statistics
+     */
+    void notifyGpuStats(
+      const GpuFlushStats&        stats);
+
+    /**
+     * \brief Queries current threshold scale
+     *
+     * Values below 1 mean that the tracker flushes
+     * more eagerly than the baseline heuristic.
+     * \returns Chunk count threshold scale factor
+     */
+    float getThresholdScale() const {
+      return m_thresholdScale;
+    }
+
   private:
 
     GpuFlushType  m_lastMissedType        = GpuFlushType::ImplicitWeakHint;
@@ -66,6 +114,16 @@ namespace dxvk {
     uint64_t      m_lastFlushChunkId      = 0ull;
     uint64_t      m_lastFlushSubmissionId = 0ull;
 
+    GpuFlushStats m_lastStats             = { };
+    bool          m_hasStats              = false;
+
+    float         m_gpuIdle               = 0.0f;
+    float         m_gpuSync               = 0.0f;
+    float         m_thresholdScale        = 1.0f;
+
+    uint32_t scaleChunkCount(
+            uint32_t              chunkCount) const;
+
   };
 
 }
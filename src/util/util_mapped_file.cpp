@@ -0,0 +1,109 @@
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "util_mapped_file.h"
+
+#include "./com/com_include.h"
+
+namespace dxvk {
+
+  MappedFile::MappedFile(const str::path_string& path) {
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+      nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+      return;
+
+    LARGE_INTEGER size = { };
+
+    if (::GetFileSizeEx(file, &size) && size.QuadPart > 0
+     && uint64_t(size.QuadPart) <= uint64_t(SIZE_MAX)) {
+      // The mapping object keeps the file open
+      m_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+      if (m_mapping) {
+        m_data = reinterpret_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = size_t(size.QuadPart);
+
+        if (!m_data)
+          unmap();
+      }
+    }
+
+    ::CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+      return;
+
+    struct stat st = { };
+
+    if (!::fstat(fd, &st) && st.st_size > 0) {
+      void* data = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (data != MAP_FAILED) {
+        m_data = reinterpret_cast<const char*>(data);
+        m_size = size_t(st.st_size);
+      }
+    }
+
+    // The mapping stays valid after closing the file
+    ::close(fd);
+#endif
+  }
+
+
+  MappedFile::MappedFile(MappedFile&& other)
+  : m_data    (std::exchange(other.m_data, nullptr)),
+    m_size    (std::exchange(other.m_size, 0))
+#ifdef _WIN32
+  , m_mapping (std::exchange(other.m_mapping, nullptr))
+#endif
+  { }
+
+
+  MappedFile& MappedFile::operator = (MappedFile&& other) {
+    unmap();
+
+    m_data    = std::exchange(other.m_data, nullptr);
+    m_size    = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    return *this;
+  }
+
+
+  MappedFile::~MappedFile() {
+    unmap();
+  }
+
+
+  void MappedFile::unmap() {
+#ifdef _WIN32
+    if (m_data)
+      ::UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+      ::CloseHandle(m_mapping);
+
+    m_mapping = nullptr;
+#else
+    if (m_data)
+      ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+#include "util_string.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Read-only file mapping
+   *
+   * Maps the entire contents of a file into the address
+   * space of the process. The mapping is not updated if
+   * the file gets modified, however appending data to
+   * the file while it is mapped is allowed.
+   */
+  class MappedFile {
+
+  public:
+
+    MappedFile() { }
+
+    MappedFile(const str::path_string& path);
+
+    MappedFile(MappedFile&& other);
+
+    MappedFile& operator = (MappedFile&& other);
+
+    ~MappedFile();
+
+    /**
+     * \brief Pointer to mapped file contents
+     * \returns Pointer to file data, or \c nullptr
+     */
+    const char* data() const {
+      return m_data;
+    }
+
+    /**
+     * \brief Size of the mapping
+     * \returns Size of the mapped file, in bytes
+     */
+    size_t size() const {
+      return m_size;
+    }
+
+    /**
+     * \brief Checks whether the file was mapped
+     */
+    explicit operator bool () const {
+      return m_data != nullptr;
+    }
+
+  private:
+
+    const char* m_data    = nullptr;
+    size_t      m_size    = 0;
+#ifdef _WIN32
+    void*       m_mapping = nullptr;
+#endif
+
+    void unmap();
+
+  };
+
+}